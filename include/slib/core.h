@@ -30,6 +30,7 @@
 #include "core/object.h"
 #include "core/ptr.h"
 #include "core/function.h"
+#include "core/inline_function.h"
 #include "core/new_helper.h"
 
 #include "core/macro.h"
@@ -77,7 +78,9 @@
 #include "core/asset.h"
 
 #include "core/io.h"
+#include "core/buffered_io.h"
 #include "core/file.h"
+#include "core/mapped_file.h"
 #include "core/pipe.h"
 #include "core/async.h"
 #include "core/dispatch.h"
@@ -95,6 +98,8 @@
 #include "core/setting.h"
 
 #include "core/json.h"
+#include "core/json_reader.h"
+#include "core/json_writer.h"
 #include "core/xml.h"
 #include "core/base64.h"
 
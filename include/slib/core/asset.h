@@ -28,6 +28,9 @@ namespace slib
 	
 
 		static Memory readAllBytes(const String& path);
+
+		// maps large files of the file-system based assets without copying, otherwise same as `readAllBytes`
+		static Memory mapAllBytes(const String& path);
 	
 	};
 
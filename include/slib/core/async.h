@@ -14,6 +14,8 @@
 #include "definition.h"
 
 #include "dispatch_loop.h"
+#include "mpsc_queue.h"
+#include "timer_wheel.h"
 #include "file.h"
 #include "variant.h"
 #include "ptr.h"
@@ -30,6 +32,7 @@ namespace slib
 	};
 
 	class AsyncIoLoop;
+	class AsyncIoLoopGroup;
 	class AsyncIoInstance;
 	class AsyncIoObject;
 	class AsyncStreamInstance;
@@ -61,6 +64,15 @@ namespace slib
 
 
 		sl_bool addTask(const Function<void()>& task);
+
+		// queues the task without creating a `Function`
+		sl_bool addTask(InlineFunction<void()>&& task);
+
+		template <class FUNC, class = typename EnableIf<IsInlineFunctionCallable<FUNC>()>::Type>
+		sl_bool addTask(FUNC&& task)
+		{
+			return addTask(InlineFunction<void()>(Forward<FUNC>(task)));
+		}
 	
 		void wake();
 
@@ -74,6 +86,13 @@ namespace slib
 		// override
 		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms);
 
+		// runs `task` on the loop after `delay_ms`, returns the handle to cancel the task by `clearTimeout()`
+		Ref<TimerWheelEntry> setTimeout(InlineFunction<void()>&& task, sl_uint64 delay_ms);
+
+		sl_bool clearTimeout(const Ref<TimerWheelEntry>& entry);
+
+		sl_uint64 getElapsedMilliseconds();
+
 	protected:
 		sl_bool m_flagInit;
 		sl_bool m_flagRunning;
@@ -81,12 +100,22 @@ namespace slib
 
 		Ref<Thread> m_thread;
 
-		LinkedQueue< Function<void()> > m_queueTasks;
-	
-		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesOrder;
-		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesClosing;
+		// pushed by any thread without locking, drained by the loop thread
+		MpscQueue< InlineFunction<void()> > m_queueTasks;
+		MpscQueue< Ref<AsyncIoInstance> > m_queueInstancesOrder;
+		MpscQueue< Ref<AsyncIoInstance> > m_queueInstancesClosing;
+
 		LinkedQueue< Ref<AsyncIoInstance> > m_queueInstancesClosed;
 
+		// set by the first `wake()` after the loop drained the queues, so that concurrent requests wake the loop only once
+		sl_int32 m_flagWakePending;
+
+		TimeCounter m_timeCounter;
+		TimerWheel m_timers;
+		Mutex m_lockTimers;
+		// time when the loop will wake up by itself, the timers due before need to wake the loop
+		sl_uint64 m_timeWaitUntil;
+
 	protected:
 		static void* _native_createHandle();
 		static void _native_closeHandle(void* handle);
@@ -97,10 +126,45 @@ namespace slib
 
 	protected:
 		void _stepBegin();
+		// runs the expired timers, and returns the milliseconds to wait for the events (-1 for infinite)
+		sl_int32 _getTimeout();
 		void _stepEnd();
 	
 	};
 	
+	class SLIB_EXPORT AsyncIoLoopGroup : public Object
+	{
+		SLIB_DECLARE_OBJECT
+
+	private:
+		AsyncIoLoopGroup();
+
+		~AsyncIoLoopGroup();
+
+	public:
+		// nLoops: 0 means the count of the processors
+		static Ref<AsyncIoLoopGroup> create(sl_uint32 nLoops = 0, sl_bool flagAutoStart = sl_true);
+
+	public:
+		void release();
+
+		void start();
+
+		sl_uint32 getLoopsCount();
+
+		Ref<AsyncIoLoop> getLoop(sl_uint32 index);
+
+		List< Ref<AsyncIoLoop> > getLoops();
+
+		// round-robin
+		Ref<AsyncIoLoop> getNextLoop();
+
+	protected:
+		List< Ref<AsyncIoLoop> > m_loops;
+		sl_reg m_indexNext;
+
+	};
+	
 	
 	class AsyncIoObject;
 	
@@ -130,7 +194,7 @@ namespace slib
 
 		void setClosing();
 
-		void addToQueue(LinkedQueue< Ref<AsyncIoInstance> >& queue);
+		void addToQueue(MpscQueue< Ref<AsyncIoInstance> >& queue);
 
 		void requestOrder();
 	
@@ -230,6 +294,10 @@ namespace slib
 		Ref<Referable> userObject;
 		Function<void(AsyncStreamResult*)> callback;
 		sl_bool flagRead;
+		
+		// used for zero-copy file transfer (`data` is null)
+		Ref<File> file;
+		sl_uint64 offsetFile;
 
 	protected:
 		AsyncStreamRequest(void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback, sl_bool flagRead);
@@ -239,6 +307,8 @@ namespace slib
 
 		static Ref<AsyncStreamRequest> createWrite(void* data, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
 
+		static Ref<AsyncStreamRequest> createSendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, Referable* userObject, const Function<void(AsyncStreamResult*)>& callback);
+
 	public:
 		void runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError);
 
@@ -265,6 +335,10 @@ namespace slib
 
 		virtual sl_uint64 getSize();
 
+		virtual sl_bool isSupportingSendFile();
+
+		sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject);
+
 		sl_size getWaitingSizeForWrite();
 
 	protected:
@@ -322,6 +396,12 @@ namespace slib
 
 		virtual sl_bool addTask(const Function<void()>& callback) = 0;
 
+		// returns true if the stream can transfer the file contents directly in kernel (sendfile)
+		virtual sl_bool isSupportingSendFile();
+
+		// writes `size` bytes of the file from `offset` without copying through the user-space
+		virtual sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 	};
 	
 	class SLIB_EXPORT AsyncStreamBase : public AsyncStream
@@ -356,6 +436,12 @@ namespace slib
 		// override
 		sl_bool addTask(const Function<void()>& callback);
 
+		// override
+		sl_bool isSupportingSendFile();
+
+		// override
+		sl_bool sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject = sl_null);
+
 		sl_size getWaitingSizeForWrite();
 	
 	protected:
@@ -719,6 +805,9 @@ namespace slib
 		sl_bool copyFromFile(const String& path, const Ref<Dispatcher>& dispatcher);
 
 		sl_uint64 getOutputLength() const;
+		
+		// returns sl_false if the output contains a stream
+		sl_bool getMemoryOutput(List<Memory>& output);
 	
 	protected:
 		sl_uint64 m_lengthOutput;
@@ -782,6 +871,9 @@ namespace slib
 
 		void close();
 
+		// true until all the merged output is written to the stream
+		sl_bool isWriting();
+
 	protected:
 		// override
 		void onAsyncCopyExit(AsyncCopy* task);
@@ -789,6 +881,8 @@ namespace slib
 	private:
 		void onWriteStream(AsyncStreamResult* result);
 
+		void onSendFile(AsyncStreamResult* result);
+
 	protected:
 		void _onError();
 
@@ -796,6 +890,10 @@ namespace slib
 
 		void _write(sl_bool flagCompleted);
 
+		sl_bool _startSendFile(AsyncStream* body, sl_uint64 size);
+
+		void _sendFile();
+
 	protected:
 		Ref<AsyncStream> m_streamOutput;
 		sl_uint32 m_bufferSize;
@@ -810,6 +908,10 @@ namespace slib
 		sl_bool m_flagWriting;
 		sl_bool m_flagClosed;
 
+		Ref<File> m_fileSending;
+		sl_uint64 m_offsetFileSending;
+		sl_uint64 m_sizeFileSending;
+
 	};
 	
 	
@@ -0,0 +1,325 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_BUFFERED_IO
+#define CHECKHEADER_SLIB_CORE_BUFFERED_IO
+
+#include "definition.h"
+
+#include "io.h"
+#include "ptr.h"
+#include "mio.h"
+
+#define SLIB_BUFFERED_IO_DEFAULT_SIZE 8192
+
+/*
+	Buffered layer over `IReader`, `IWriter` and `IO`.
+
+	The `IReader::readInt32()`, `IWriter::writeUint64()`, ... helpers call the virtual `read`/`write`
+	of the stream for every field, which is a system call on a `File`.
+	`BufferedReader` and `BufferedWriter` hide these helpers with inline versions that access
+	the buffer directly while enough bytes remain, and call the underlying stream only to refill/flush it.
+	The typed helpers keep the byte order and CVLI format of `IReader`/`IWriter`.
+	Calling them through an `IReader*`/`IWriter*` still works (served by the buffered `read`/`write`),
+	but without the inline fast paths.
+
+	`peek()`/`consume()` give access to the buffered bytes without copying.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT BufferedReader : public Object, public IReader
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BufferedReader();
+
+		~BufferedReader();
+
+	public:
+		static Ref<BufferedReader> create(const Ptr<IReader>& reader, sl_size bufferSize = SLIB_BUFFERED_IO_DEFAULT_SIZE);
+
+	public:
+		Ptr<IReader> getReader();
+
+		sl_size getBufferSize();
+
+		// releases the reader and the buffer
+		void close();
+
+		// override
+		sl_reg read(void* buf, sl_size size);
+
+		// count of the bytes which are read from the stream, but not consumed yet
+		sl_size getAvailableSize();
+
+		// returns the next `size` bytes without consuming them, reading from the stream if needed.
+		// returns null when the stream ends before `size` bytes, or `size` is larger than the buffer
+		const void* peek(sl_size size);
+
+		// returns the buffered bytes (reads from the stream when the buffer is empty), and stores their count to `size`.
+		// returns null at the end of the stream
+		const void* peek(sl_size* size);
+
+		// `size` must not be larger than the count returned by `peek()` or `getAvailableSize()`
+		void consume(sl_size size);
+
+		// returns the count of the skipped bytes
+		sl_uint64 skip(sl_uint64 size);
+
+	public:
+		sl_bool readInt8(sl_int8* output);
+
+		sl_int8 readInt8(sl_int8 def = 0);
+
+		sl_bool readUint8(sl_uint8* output);
+
+		sl_uint8 readUint8(sl_uint8 def = 0);
+
+		sl_bool readInt16(sl_int16* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int16 readInt16(sl_int16 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint16(sl_uint16* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint16 readUint16(sl_uint16 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readInt32(sl_int32* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int32 readInt32(sl_int32 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint32(sl_uint32* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint32 readUint32(sl_uint32 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readInt64(sl_int64* output, sl_bool flagBigEndian = sl_false);
+
+		sl_int64 readInt64(sl_int64 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readUint64(sl_uint64* output, sl_bool flagBigEndian = sl_false);
+
+		sl_uint64 readUint64(sl_uint64 def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readFloat(float* output, sl_bool flagBigEndian = sl_false);
+
+		float readFloat(float def = 0, sl_bool flagBigEndian = sl_false);
+
+		sl_bool readDouble(double* output, sl_bool flagBigEndian = sl_false);
+
+		double readDouble(double def = 0, sl_bool flagBigEndian = sl_false);
+
+		//  CVLI (Chain Variable Length Integer)
+		sl_bool readUint32CVLI(sl_uint32* output);
+
+		sl_uint32 readUint32CVLI(sl_uint32 def = 0);
+
+		sl_bool readInt32CVLI(sl_int32* output);
+
+		sl_int32 readInt32CVLI(sl_int32 def = 0);
+
+		sl_bool readUint64CVLI(sl_uint64* output);
+
+		sl_uint64 readUint64CVLI(sl_uint64 def = 0);
+
+		sl_bool readInt64CVLI(sl_int64* output);
+
+		sl_int64 readInt64CVLI(sl_int64 def = 0);
+
+		sl_bool readSizeCVLI(sl_size* output);
+
+		sl_size readSizeCVLI(sl_size def = 0);
+
+		sl_bool readIntCVLI(sl_reg* output);
+
+		sl_reg readIntCVLI(sl_reg def = 0);
+
+	protected:
+		// reads until `size` bytes are available
+		sl_bool _fill(sl_size size);
+
+		sl_bool _readSlow(void* buf, sl_size size);
+
+		sl_bool _readUint32CVLI(sl_uint32* output);
+
+		sl_bool _readUint64CVLI(sl_uint64* output);
+
+	protected:
+		Ptr<IReader> m_reader;
+		sl_uint8* m_buf;
+		sl_size m_size;
+		sl_size m_pos;
+		sl_size m_end;
+
+	};
+
+	class SLIB_EXPORT BufferedWriter : public Object, public IWriter
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BufferedWriter();
+
+		// flushes the buffered bytes
+		~BufferedWriter();
+
+	public:
+		static Ref<BufferedWriter> create(const Ptr<IWriter>& writer, sl_size bufferSize = SLIB_BUFFERED_IO_DEFAULT_SIZE);
+
+	public:
+		Ptr<IWriter> getWriter();
+
+		sl_size getBufferSize();
+
+		// flushes the buffered bytes, and releases the writer and the buffer
+		sl_bool close();
+
+		// writes the buffered bytes to the stream
+		sl_bool flush();
+
+		// override
+		sl_reg write(const void* buf, sl_size size);
+
+		// returns the space for the next `size` bytes in the buffer, flushing it if needed.
+		// returns null when `size` is larger than the buffer or the flush fails
+		void* reserve(sl_size size);
+
+		// appends the `size` bytes written to the space returned by `reserve()`
+		void commit(sl_size size);
+
+	public:
+		sl_bool writeInt8(sl_int8 value);
+
+		sl_bool writeUint8(sl_uint8 value);
+
+		sl_bool writeInt16(sl_int16 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint16(sl_uint16 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeInt32(sl_int32 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint32(sl_uint32 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeInt64(sl_int64 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeUint64(sl_uint64 value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeFloat(float value, sl_bool flagBigEndian = sl_false);
+
+		sl_bool writeDouble(double value, sl_bool flagBigEndian = sl_false);
+
+		//  CVLI (Chain Variable Length Integer)
+		sl_bool writeUint32CVLI(sl_uint32 value);
+
+		sl_bool writeInt32CVLI(sl_int32 value);
+
+		sl_bool writeUint64CVLI(sl_uint64 value);
+
+		sl_bool writeInt64CVLI(sl_int64 value);
+
+		sl_bool writeSizeCVLI(sl_size value);
+
+		sl_bool writeIntCVLI(sl_reg value);
+
+	protected:
+		sl_bool _writeSlow(const void* buf, sl_size size);
+
+		sl_bool _writeUint32CVLI(sl_uint32 value);
+
+		sl_bool _writeUint64CVLI(sl_uint64 value);
+
+	protected:
+		Ptr<IWriter> m_writer;
+		sl_uint8* m_buf;
+		sl_size m_size;
+		sl_size m_pos;
+
+	};
+
+	/*
+		Buffered `IO` for the seekable streams (for example, `File`).
+		One buffer is used for reading or writing: the written bytes are flushed
+		before reading, seeking, resizing and closing, and seeking inside the read buffer does not access the stream.
+		The typed helpers are served by the buffered `read`/`write`; use `BufferedReader`/`BufferedWriter`
+		or `peek()`/`consume()` for the inline versions.
+	*/
+	class SLIB_EXPORT BufferedIO : public IO
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		BufferedIO();
+
+		// flushes the buffered bytes
+		~BufferedIO();
+
+	public:
+		static Ref<BufferedIO> create(const Ref<IO>& io, sl_size bufferSize = SLIB_BUFFERED_IO_DEFAULT_SIZE);
+
+	public:
+		Ref<IO> getIO();
+
+		sl_size getBufferSize();
+
+		sl_bool flush();
+
+		// override
+		sl_reg read(void* buf, sl_size size);
+
+		// override
+		sl_reg write(const void* buf, sl_size size);
+
+		// override
+		sl_uint64 getPosition();
+
+		// override
+		sl_uint64 getSize();
+
+		// override
+		sl_bool seek(sl_int64 offset, SeekPosition pos);
+
+		// override
+		sl_bool setSize(sl_uint64 size);
+
+		// override, flushes the buffered bytes and closes the stream
+		void close();
+
+		// see `BufferedReader::peek()`
+		const void* peek(sl_size size);
+
+		const void* peek(sl_size* size);
+
+		void consume(sl_size size);
+
+	protected:
+		// flushes the written bytes, or moves the stream to the read position
+		sl_bool _sync();
+
+		sl_bool _fill(sl_size size);
+
+	protected:
+		Ref<IO> m_io;
+		sl_uint8* m_buf;
+		sl_size m_size;
+		sl_size m_pos;
+		// end of the read bytes in the buffer
+		sl_size m_end;
+		// position of the buffer in the stream
+		sl_uint64 m_offset;
+		sl_bool m_flagWriting;
+
+	};
+
+}
+
+#include "detail/buffered_io.inc"
+
+#endif
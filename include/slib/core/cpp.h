@@ -38,6 +38,9 @@ namespace slib
 	template <class T> struct IsSameTypeHelper<T, T> : ConstValue<bool, true> {};
 	template <class T1, class T2> constexpr bool IsSameType() { return IsSameTypeHelper<T1, T2>::value; }
 
+	template <bool CONDITION, class T = void> struct EnableIf {};
+	template <class T> struct EnableIf<true, T> { typedef T Type; };
+
 	template <class T>
 	constexpr typename RemoveReference<T>::Type&& Move(T&& v)
 	{
@@ -16,6 +16,9 @@
 #include "dispatch.h"
 #include "thread.h"
 #include "time.h"
+#include "event.h"
+#include "mpsc_queue.h"
+#include "timer_wheel.h"
 
 namespace slib
 {
@@ -46,6 +49,20 @@ namespace slib
 		// override
 		sl_bool dispatch(const Function<void()>& task, sl_uint64 delay_ms = 0);
 
+		// queues the task without creating a `Function`
+		sl_bool dispatch(InlineFunction<void()>&& task, sl_uint64 delay_ms = 0);
+
+		template <class FUNC, class = typename EnableIf<IsInlineFunctionCallable<FUNC>()>::Type>
+		sl_bool dispatch(FUNC&& task, sl_uint64 delay_ms = 0)
+		{
+			return dispatch(InlineFunction<void()>(Forward<FUNC>(task)), delay_ms);
+		}
+
+		// returns the handle to cancel the task by `clearTimeout()`
+		Ref<TimerWheelEntry> setTimeout(InlineFunction<void()>&& task, sl_uint64 delay_ms);
+
+		sl_bool clearTimeout(const Ref<TimerWheelEntry>& entry);
+
 		sl_bool addTimer(const Ref<Timer>& timer);
 		
 		void removeTimer(const Ref<Timer>& timer);
@@ -59,32 +76,24 @@ namespace slib
 
 		TimeCounter m_timeCounter;
 
-		LinkedQueue< Function<void()> > m_queueTasks;
-
-		struct TimeTask
-		{
-			sl_uint64 time;
-			Function<void()> task;
-		};
-		BTree<sl_uint64, TimeTask> m_timeTasks;
-		Mutex m_lockTimeTasks;
-
-		class TimerTask
-		{
-		public:
-			WeakRef<Timer> timer;
+		// pushed by any thread without locking, drained by the loop thread
+		MpscQueue< InlineFunction<void()> > m_queueTasks;
+		// set by the first `dispatch()` after the loop drained the tasks, so that concurrent dispatches wake the loop only once
+		sl_int32 m_flagWakePending;
+		Ref<Event> m_eventWake;
 
-		public:
-			sl_bool operator==(const TimerTask& other) const;
-		};
-		LinkedQueue<TimerTask> m_queueTimers;
-		Mutex m_lockTimer;
+		// delayed tasks and timers
+		TimerWheel m_timers;
+		Mutex m_lockTimers;
+		// time when the loop will wake up by itself, the timers due before need to wake the loop
+		sl_uint64 m_timeWaitUntil;
 
 	protected:
 		void _wake();
 		sl_int32 _getTimeout();
-		sl_int32 _getTimeout_TimeTasks();
-		sl_int32 _getTimeout_Timer();
+		sl_int32 _getTimeout_Timers();
+		sl_bool _addTimeout(TimerWheelEntry* entry, sl_uint64 time);
+		void _runTimer(const WeakRef<Timer>& timer);
 		void _runLoop();
 
 	};
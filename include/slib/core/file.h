@@ -154,6 +154,9 @@ namespace slib
 		// works only if the file is already opened
 		sl_bool setSize(sl_uint64 size);
 
+		// writes the cached data of the file to the storage device
+		sl_bool flush();
+
 		sl_bool lock();
 
 		sl_bool unlock();
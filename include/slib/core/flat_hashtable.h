@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+#define CHECKHEADER_SLIB_CORE_FLAT_HASHTABLE
+
+#include "definition.h"
+
+#include "constants.h"
+#include "hash.h"
+#include "compare.h"
+#include "list.h"
+#include "math.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define SLIB_FLAT_HASHTABLE_USE_SSE2
+#elif defined(SLIB_ARCH_IS_ARM64)
+#	define SLIB_FLAT_HASHTABLE_USE_NEON
+#endif
+
+#define _SLIB_FLAT_HASHTABLE_GROUP_WIDTH 16
+#define _SLIB_FLAT_HASHTABLE_MIN_CAPACITY 16
+#define _SLIB_FLAT_HASHTABLE_MAX_CAPACITY 0x80000000
+
+namespace slib
+{
+
+	template <class KT, class VT>
+	class FlatHashEntry
+	{
+	public:
+		KT key;
+		VT value;
+
+	public:
+		template <class _KT, class _VT>
+		SLIB_INLINE FlatHashEntry(_KT&& _key, _VT&& _value)
+		 : key(Forward<_KT>(_key)), value(Forward<_VT>(_value))
+		{
+		}
+
+	};
+
+	/*
+		16 control bytes, probed in parallel with SSE2 or NEON
+
+		Control byte values:
+			full: 0 ~ 127 (7 bits of the hash)
+			empty: -128
+			deleted: -2
+	*/
+	class SLIB_EXPORT _FlatHashTableGroup
+	{
+	public:
+		enum {
+			Empty = -128,
+			Deleted = -2
+		};
+
+	public:
+		_FlatHashTableGroup(const sl_int8* ctrl);
+
+	public:
+		// bit `i` is set when the control byte `i` equals to `h2`
+		sl_uint32 match(sl_int8 h2) const;
+
+		sl_uint32 matchEmpty() const;
+
+		sl_uint32 matchEmptyOrDeleted() const;
+
+		static sl_uint32 getLowestBitIndex(sl_uint32 mask);
+
+	private:
+#if defined(SLIB_FLAT_HASHTABLE_USE_SSE2) || defined(SLIB_FLAT_HASHTABLE_USE_NEON)
+		const sl_int8* m_ctrl;
+#else
+		sl_int8 m_ctrl[_SLIB_FLAT_HASHTABLE_GROUP_WIDTH];
+#endif
+
+	};
+
+	/*
+		Open-addressing hash table (Swiss table layout).
+
+		Entries are stored inline in a single array, so inserting does not allocate per item,
+		and lookups probe 16 control bytes at once.
+		Unlike `HashTable`, the iteration order is not the insertion order,
+		and the entry pointers are invalidated when the table is rehashed.
+	*/
+	template < class KT, class VT, class HASH = Hash<KT>, class KEY_EQUALS = Equals<KT> >
+	class SLIB_EXPORT FlatHashTable
+	{
+	public:
+		typedef FlatHashEntry<KT, VT> Entry;
+
+	public:
+		FlatHashTable(sl_size capacity = 0, const HASH& hash = HASH(), const KEY_EQUALS& key_equals = KEY_EQUALS());
+
+		~FlatHashTable();
+
+	public:
+		sl_size getCount() const;
+
+		sl_size getCapacity() const;
+
+		Entry* getFirstEntry() const;
+
+		Entry* getNextEntry(Entry* entry) const;
+
+		Entry* search(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		Entry* searchKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		sl_bool get(const KT& key, VT* outValue = sl_null) const;
+
+		VT* getItemPointer(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		VT* getItemPointerByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		List<VT> getValues(const KT& key) const;
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		List<VT> getValuesByKeyAndValue(const KT& key, const _VT& value, const VALUE_EQUALS& value_equals = VALUE_EQUALS()) const;
+
+		template <class _KT, class _VT>
+		sl_bool put(_KT&& key, _VT&& value, MapPutMode mode = MapPutMode::Default, sl_bool* pFlagExist = sl_null);
+
+		template < class _KT, class _VT, class VALUE_EQUALS = Equals<VT, typename RemoveConstReference<_VT>::Type> >
+		sl_bool addIfNewKeyAndValue(_KT&& key, _VT&& value, sl_bool* pFlagExist = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_bool remove(const KT& key, VT* outValue = sl_null);
+
+		sl_size removeItems(const KT& key, List<VT>* outValues = sl_null);
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_bool removeKeyAndValue(const KT& key, const _VT& value, VT* outValue = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		template < class _VT, class VALUE_EQUALS = Equals<VT, _VT> >
+		sl_size removeItemsByKeyAndValue(const KT& key, const _VT& value, List<VT>* outValues = sl_null, const VALUE_EQUALS& value_equals = VALUE_EQUALS());
+
+		sl_size removeAll();
+
+		sl_bool copyFrom(const FlatHashTable<KT, VT, HASH, KEY_EQUALS>* other);
+
+		// makes room for `count` items without rehashing
+		sl_bool reserve(sl_size count);
+
+		// rebuilds the table with the smallest capacity holding the current items (at least `capacity`), dropping the deleted slots
+		sl_bool rehash(sl_size capacity = 0);
+
+	private:
+		sl_int8* m_ctrl;
+		Entry* m_slots;
+		sl_size m_nSize;
+		sl_size m_nCapacity;
+		sl_size m_nGrowthLeft;
+		sl_uint32 m_nShift;
+		HASH m_hash;
+		KEY_EQUALS m_equals;
+
+	private:
+		sl_uint32 _hash(const KT& key) const;
+
+		sl_size _getIndex(sl_uint32 hash) const;
+
+		void _setCtrl(sl_size index, sl_int8 h);
+
+		sl_size _findInsertSlot(sl_uint32 hash) const;
+
+		Entry* _insert(sl_uint32 hash);
+
+		void _removeAt(sl_size index);
+
+		sl_bool _resize(sl_size capacity);
+
+		static sl_size _getCapacityForCount(sl_size count);
+
+		static sl_size _getMaxCountForCapacity(sl_size capacity);
+
+	};
+
+}
+
+#include "detail/flat_hashtable.inc"
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_INLINE_FUNCTION
+#define CHECKHEADER_SLIB_CORE_INLINE_FUNCTION
+
+#include "definition.h"
+
+#include "function.h"
+
+// 48 bytes on 64-bit platforms: a `WeakRef`, a member function pointer and two more pointers
+#define SLIB_INLINE_FUNCTION_DEFAULT_SIZE (sizeof(void*) * 6)
+
+/*
+	Move-only callable object for the hot callback paths.
+
+	Unlike `Function`, `InlineFunction` is not reference-counted: the callable is stored
+	in place when it fits in `INLINE_SIZE` bytes (and does not need stricter alignment than 8 bytes),
+	and is allocated on the heap otherwise. Constructing from a `Function` stores its reference in place.
+
+	Dispatch queues (`DispatchLoop`, `AsyncIoLoop`, `WorkStealingThreadPool`, `TimerWheel`)
+	accept lambdas and `InlineFunction`s without creating a `Function`.
+*/
+
+namespace slib
+{
+
+	template <class T, sl_size INLINE_SIZE = SLIB_INLINE_FUNCTION_DEFAULT_SIZE>
+	class InlineFunction;
+
+	template <class T>
+	struct _InlineFunction_IsWrapper : ConstValue<bool, false> {};
+
+	template <class T>
+	struct _InlineFunction_IsWrapper< Function<T> > : ConstValue<bool, true> {};
+
+	template <class T, sl_size INLINE_SIZE>
+	struct _InlineFunction_IsWrapper< InlineFunction<T, INLINE_SIZE> > : ConstValue<bool, true> {};
+
+	// true for the callable types which are converted to `InlineFunction` by its template constructor
+	template <class FUNC>
+	constexpr bool IsInlineFunctionCallable()
+	{
+		return !(_InlineFunction_IsWrapper<typename RemoveConst<typename RemoveConstReference<FUNC>::Type>::Type>::value);
+	}
+
+	template <class RET_TYPE, class... ARGS>
+	class _InlineFunction_Ops
+	{
+	public:
+		RET_TYPE (*invoke)(void* storage, ARGS... params);
+		// constructs `dst` by moving `src`, and destructs `src`
+		void (*move)(void* dst, void* src);
+		void (*destroy)(void* storage);
+	};
+
+	template <class RET_TYPE, class... ARGS, sl_size INLINE_SIZE>
+	class SLIB_EXPORT InlineFunction<RET_TYPE(ARGS...), INLINE_SIZE>
+	{
+	public:
+		InlineFunction() noexcept;
+
+		InlineFunction(sl_null_t) noexcept;
+
+		InlineFunction(InlineFunction&& other) noexcept;
+
+		InlineFunction(const Function<RET_TYPE(ARGS...)>& func) noexcept;
+
+		InlineFunction(Function<RET_TYPE(ARGS...)>&& func) noexcept;
+
+		template <class FUNC, class = typename EnableIf<IsInlineFunctionCallable<FUNC>()>::Type>
+		InlineFunction(FUNC&& func);
+
+		~InlineFunction();
+
+	public:
+		InlineFunction& operator=(InlineFunction&& other) noexcept;
+
+		InlineFunction& operator=(sl_null_t) noexcept;
+
+		template <class FUNC>
+		InlineFunction& operator=(FUNC&& func);
+
+		RET_TYPE operator()(ARGS... params) const;
+
+	public:
+		sl_bool isNull() const noexcept;
+
+		sl_bool isNotNull() const noexcept;
+
+		void setNull() noexcept;
+
+		// true if the callable is stored in place
+		template <class FUNC>
+		static constexpr sl_bool isStoredInPlace();
+
+	public:
+		template <class CLASS, class FUNC>
+		static InlineFunction fromClass(CLASS* object, FUNC func);
+
+		template <class CLASS, class FUNC>
+		static InlineFunction fromRef(const Ref<CLASS>& object, FUNC func);
+
+		template <class CLASS, class FUNC>
+		static InlineFunction fromWeakRef(const WeakRef<CLASS>& object, FUNC func);
+
+		template <class CLASS, class FUNC, class... BINDS>
+		static InlineFunction bindClass(CLASS* object, FUNC func, const BINDS&... binds);
+
+		template <class CLASS, class FUNC, class... BINDS>
+		static InlineFunction bindRef(const Ref<CLASS>& object, FUNC func, const BINDS&... binds);
+
+		template <class CLASS, class FUNC, class... BINDS>
+		static InlineFunction bindWeakRef(const WeakRef<CLASS>& object, FUNC func, const BINDS&... binds);
+
+	private:
+		template <class FUNC>
+		void _init(FUNC&& func);
+
+	private:
+		const _InlineFunction_Ops<RET_TYPE, ARGS...>* m_ops;
+		union {
+			sl_uint8 m_storage[INLINE_SIZE];
+			sl_uint64 _m_align;
+			void* _m_alignPtr;
+		};
+
+	private:
+		InlineFunction(const InlineFunction& other) = delete;
+		InlineFunction& operator=(const InlineFunction& other) = delete;
+
+	};
+
+}
+
+#define SLIB_INLINE_BIND_CLASS(TYPE, CLASS, CALLBACK, OBJECT, ...) slib::InlineFunction<TYPE>::bindClass(OBJECT, &CLASS::CALLBACK, ##__VA_ARGS__)
+#define SLIB_INLINE_BIND_REF(TYPE, CLASS, CALLBACK, OBJECT, ...) slib::InlineFunction<TYPE>::bindRef(slib::Ref<CLASS>(OBJECT), &CLASS::CALLBACK, ##__VA_ARGS__)
+#define SLIB_INLINE_BIND_WEAKREF(TYPE, CLASS, CALLBACK, OBJECT, ...) slib::InlineFunction<TYPE>::bindWeakRef(slib::WeakRef<CLASS>(OBJECT), &CLASS::CALLBACK, ##__VA_ARGS__)
+
+#include "detail/inline_function.inc"
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_JSON_READER
+#define CHECKHEADER_SLIB_CORE_JSON_READER
+
+#include "definition.h"
+
+#include "json.h"
+#include "io.h"
+#include "ptr.h"
+#include "list.h"
+#include "memory.h"
+
+#define SLIB_JSON_READER_DEFAULT_CHUNK_SIZE 65536
+#define SLIB_JSON_READER_MAX_FILTERS 64
+
+namespace slib
+{
+
+	class JsonReader;
+
+	enum class JsonTokenType
+	{
+		None = 0,
+		BeginObject = 1,
+		EndObject = 2,
+		BeginArray = 3,
+		EndArray = 4,
+		Key = 5,
+		String = 6,
+		Number = 7,
+		Boolean = 8,
+		Null = 9,
+		EndOfDocument = 10,
+		Error = 11
+	};
+
+	/*
+		Text of a key, string or number token.
+		Points into the input buffer when the token has no escape sequences,
+		and is only valid until the next call of `JsonReader::next()`.
+	*/
+	class SLIB_EXPORT JsonStringView
+	{
+	public:
+		const sl_char8* data;
+		sl_size length;
+
+	public:
+		JsonStringView();
+
+	public:
+		String toString() const;
+
+		sl_bool equals(const sl_char8* str, sl_size len) const;
+
+		sl_bool equals(const String& str) const;
+
+	};
+
+	class SLIB_EXPORT IJsonReaderListener
+	{
+	public:
+		IJsonReaderListener();
+
+		virtual ~IJsonReaderListener();
+
+	public:
+		virtual void onBeginObject(JsonReader* reader);
+
+		virtual void onEndObject(JsonReader* reader);
+
+		virtual void onBeginArray(JsonReader* reader);
+
+		virtual void onEndArray(JsonReader* reader);
+
+		virtual void onKey(JsonReader* reader, const JsonStringView& key);
+
+		virtual void onString(JsonReader* reader, const JsonStringView& value);
+
+		// `text` is the literal text of the number
+		virtual void onNumber(JsonReader* reader, const JsonStringView& text);
+
+		virtual void onBoolean(JsonReader* reader, sl_bool value);
+
+		virtual void onNull(JsonReader* reader);
+
+	};
+
+	class SLIB_EXPORT JsonReaderParam
+	{
+	public:
+		// in
+		sl_bool flagSupportComments;
+		// in
+		sl_bool flagLogError;
+		// in, size of the buffer used to read from `IReader`, grown when a single token is larger
+		sl_size chunkSize;
+		/*
+			in, JSON Pointers (RFC 6901) of the values to be read, for example "/data/items/0/name".
+			When not empty, only the matching values (with their children) are returned
+			and all other subtrees are skipped without decoding.
+		*/
+		List<String> filters;
+
+	public:
+		JsonReaderParam();
+
+		~JsonReaderParam();
+
+	};
+
+	/*
+		Streaming JSON reader.
+
+		Reads one token on each call of `next()` without building the `Variant` tree,
+		from a memory block or from an `IReader` in bounded chunks.
+		Accepts the same syntax as `Json::parseJson()` (comments, single quotes, unquoted keys).
+		`parse()` drives the reader and calls an `IJsonReaderListener` on each token (SAX style).
+	*/
+	class SLIB_EXPORT JsonReader
+	{
+	public:
+		JsonReader();
+
+		~JsonReader();
+
+	public:
+		// `data` is not copied, and must be kept until the reading is finished
+		sl_bool open(const void* data, sl_size size, const JsonReaderParam& param);
+
+		sl_bool open(const void* data, sl_size size);
+
+		sl_bool open(const Memory& mem, const JsonReaderParam& param);
+
+		sl_bool open(const Memory& mem);
+
+		sl_bool open(const Ptr<IReader>& reader, const JsonReaderParam& param);
+
+		sl_bool open(const Ptr<IReader>& reader);
+
+		void close();
+
+		JsonTokenType next();
+
+		// reads all tokens, returns `sl_false` on error
+		sl_bool parse(IJsonReaderListener* listener);
+
+		// stops reading: `next()` will return `EndOfDocument`
+		void stop();
+
+	public:
+		JsonTokenType getTokenType() const;
+
+		// text of `Key`, `String` and `Number` tokens
+		const JsonStringView& getString() const;
+
+		String getStringValue() const;
+
+		sl_bool getBoolean() const;
+
+		sl_bool isInteger() const;
+
+		sl_int64 getInt64() const;
+
+		double getDouble() const;
+
+		/*
+			Returns the value of the current token.
+			On `BeginObject` or `BeginArray`, reads the whole container and returns it as `Map` or `List`.
+			On `Key`, reads the value of the key.
+		*/
+		Json readValue();
+
+		/*
+			On `BeginObject` or `BeginArray`, skips the rest of the container (`next()` returns the token after its end).
+			On `Key`, skips the value of the key.
+		*/
+		sl_bool skipValue();
+
+		// count of the opened containers which are returned by `next()`
+		sl_uint32 getDepth() const;
+
+		// index of the filter matched by the latest top-level value, -1 when there is no filter
+		sl_int32 getMatchedFilterIndex() const;
+
+		// current offset in the input
+		sl_uint64 getPosition() const;
+
+		sl_bool isError() const;
+
+		String getErrorMessage() const;
+
+		sl_uint64 getErrorPosition() const;
+
+		String getErrorText() const;
+
+	protected:
+		enum class State
+		{
+			Value, // top-level value or value of a key
+			Item, // item of an array or `]`
+			Key, // key of an object or `}`
+			Colon,
+			Next,
+			End
+		};
+
+		enum class Match
+		{
+			Emit,
+			Descend,
+			Skip
+		};
+
+		struct Level
+		{
+			sl_bool flagObject;
+			sl_bool flagEmit;
+			sl_uint64 index;
+			sl_uint64 filterMask;
+		};
+
+		struct Filter
+		{
+			List<String> names;
+			List<sl_int64> indices;
+		};
+
+	protected:
+		void _init(const JsonReaderParam& param);
+
+		sl_bool _setFilters(const List<String>& filters);
+
+		sl_bool _fill();
+
+		sl_bool _ensure(sl_size n);
+
+		sl_bool _skipSpaces();
+
+		sl_bool _readString(sl_bool flagDecode);
+
+		sl_bool _readIdentifier();
+
+		sl_bool _readLiteral(sl_bool flagParse);
+
+		sl_bool _skipContainer(sl_size nesting);
+
+		sl_bool _skipScalar();
+
+		void _computeMatch();
+
+		void _pushLevel(sl_bool flagObject, sl_bool flagEmit, sl_uint64 mask);
+
+		JsonTokenType _popLevel(sl_bool& flagEmit);
+
+		JsonTokenType _setError(const char* message);
+
+		Json _readValue(JsonTokenType token);
+
+	protected:
+		const sl_char8* m_buf;
+		sl_size m_pos;
+		sl_size m_len;
+		sl_size m_posKeep;
+		sl_uint64 m_offset;
+
+		Memory m_mem;
+		Ptr<IReader> m_reader;
+		sl_char8* m_chunk;
+		sl_size m_sizeChunk;
+		sl_bool m_flagEndOfInput;
+
+		sl_bool m_flagSupportComments;
+		sl_bool m_flagLogError;
+
+		State m_state;
+		List<Level> m_levels;
+		sl_uint32 m_depth;
+		sl_uint32 m_depthEmit;
+
+		List<Filter> m_filters;
+		Match m_match;
+		sl_uint64 m_matchMask;
+		sl_int32 m_matchFilter;
+		sl_int32 m_matchedFilter;
+
+		JsonTokenType m_token;
+		JsonStringView m_string;
+		String m_stringDecoded;
+		sl_bool m_valueBoolean;
+		sl_bool m_flagInteger;
+		sl_int64 m_valueInt64;
+		double m_valueDouble;
+
+		String m_errorMessage;
+		sl_uint64 m_errorPosition;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_JSON_WRITER
+#define CHECKHEADER_SLIB_CORE_JSON_WRITER
+
+#include "definition.h"
+
+#include "json.h"
+#include "io.h"
+#include "ptr.h"
+#include "list.h"
+#include "memory.h"
+
+#define SLIB_JSON_WRITER_DEFAULT_CHUNK_SIZE 65536
+
+namespace slib
+{
+
+	/*
+		Streaming JSON writer.
+
+		Serializes `Json`/`Variant` trees, or the values pushed one by one (`beginObject()`, `writeKey()`, `writeInt64()`, ...),
+		as compact UTF-8 JSON text without creating the temporary strings of the scalar values.
+		The output is kept in memory chunks (see `getOutput()` and `getOutputChunks()`),
+		or written to an `IWriter` whenever a chunk is filled.
+
+		Doubles and floats are written in the shortest form which is parsed back to the same value (Grisu2),
+		with a decimal point or exponent so that they are not read as integers. NaN and infinities are written as `null`.
+		Values written at the top level after the first one are separated by new lines.
+	*/
+	class SLIB_EXPORT JsonWriter
+	{
+	public:
+		JsonWriter();
+
+		~JsonWriter();
+
+	public:
+		// writes into the memory chunks
+		void open();
+
+		// writes to `writer` in chunks of `chunkSize` bytes
+		void open(const Ptr<IWriter>& writer, sl_size chunkSize = SLIB_JSON_WRITER_DEFAULT_CHUNK_SIZE);
+
+		// flushes the output to the `IWriter`, and releases the buffers
+		sl_bool close();
+
+		// writes the buffered output to the `IWriter`
+		sl_bool flush();
+
+	public:
+		sl_bool beginObject();
+
+		sl_bool endObject();
+
+		sl_bool beginArray();
+
+		sl_bool endArray();
+
+		sl_bool writeKey(const sl_char8* key, sl_size len);
+
+		sl_bool writeKey(const sl_char8* key);
+
+		sl_bool writeKey(const String& key);
+
+		sl_bool writeNull();
+
+		sl_bool writeBoolean(sl_bool value);
+
+		sl_bool writeInt32(sl_int32 value);
+
+		sl_bool writeUint32(sl_uint32 value);
+
+		sl_bool writeInt64(sl_int64 value);
+
+		sl_bool writeUint64(sl_uint64 value);
+
+		sl_bool writeFloat(float value);
+
+		sl_bool writeDouble(double value);
+
+		// `str` is UTF-8 text
+		sl_bool writeString(const sl_char8* str, sl_size len);
+
+		sl_bool writeString(const sl_char8* str);
+
+		sl_bool writeString(const String& str);
+
+		sl_bool writeString(const sl_char16* str, sl_size len);
+
+		sl_bool writeString(const String16& str);
+
+		// writes a `Json` value with its children
+		sl_bool writeValue(const Variant& value);
+
+		// writes the text of a value which is already serialized
+		sl_bool writeRawValue(const sl_char8* json, sl_size len);
+
+	public:
+		// count of the opened containers
+		sl_uint32 getDepth() const;
+
+		sl_bool isError() const;
+
+		// total count of the written bytes
+		sl_uint64 getOutputLength() const;
+
+		// output written into the memory chunks; merged when it occupies more than one chunk
+		Memory getOutput();
+
+		String getOutputString();
+
+		// output written into the memory chunks, without copying
+		List<Memory> getOutputChunks();
+
+	public:
+		static Memory serialize(const Variant& value);
+
+		static String serializeToString(const Variant& value);
+
+	private:
+		sl_bool _reserve(sl_size size);
+
+		sl_bool _grow(sl_size size);
+
+		sl_bool _flushChunk();
+
+		sl_bool _beginValue();
+
+		sl_bool _beginContainer(sl_bool flagObject, sl_char8 ch);
+
+		sl_bool _endContainer(sl_bool flagObject, sl_char8 ch);
+
+		sl_bool _writeAscii(const sl_char8* str, sl_size len);
+
+		sl_bool _writeEscaped(const sl_char8* str, sl_size len);
+
+		sl_bool _writeEscaped(const sl_char16* str, sl_size len);
+
+		sl_bool _writeVariant(const Variant& value);
+
+		sl_bool _writeVariantList(const List<Variant>& list);
+
+		sl_bool _writeVariantMap(const Map<String, Variant>& map);
+
+		sl_bool _writeVariantMapList(const List< Map<String, Variant> >& list);
+
+	private:
+		Ptr<IWriter> m_writer;
+		sl_size m_sizeChunk;
+
+		Memory m_chunk;
+		sl_char8* m_buf;
+		sl_size m_pos;
+		sl_size m_size;
+		List<Memory> m_chunks;
+		sl_uint64 m_lengthFlushed;
+
+		List<sl_bool> m_levels;
+		sl_bool m_flagComma;
+		sl_bool m_flagAfterKey;
+		sl_bool m_flagError;
+
+	};
+
+}
+
+#endif
@@ -17,11 +17,17 @@
 #include "object.h"
 #include "list.h"
 #include "variant.h"
+#include "spin_lock.h"
 
 namespace slib
 {
 
 	class LoggerSet;
+	class File;
+	class Thread;
+	class Event;
+	class _AsyncFileLogger_Staging;
+	struct _AsyncFileLogger_Segment;
 	
 	class SLIB_EXPORT Console
 	{
@@ -61,6 +67,8 @@ namespace slib
 
 		static Ref<Logger> createFileLogger(const String& fileName);
 
+		static Ref<Logger> createAsyncFileLogger(const String& fileName);
+
 		static void logGlobal(const String& tag, const String& content);
 
 		static void logGlobalError(const String& tag, const String& content);
@@ -85,6 +93,97 @@ namespace slib
 	
 	};
 	
+	class SLIB_EXPORT AsyncFileLoggerParam
+	{
+	public:
+		String fileName;
+		
+		// optional
+		sl_uint64 maxFileSize; // default: 0 (no size-based rotation)
+		sl_uint32 rotationInterval; // milliseconds, default: 0 (no time-based rotation)
+		sl_uint32 maxBackupFilesCount; // default: 5, rotated files are named as `fileName.1`, `fileName.2`, ...
+		
+		sl_uint32 flushInterval; // milliseconds, default: 200
+		sl_size flushThreshold; // pending bytes of a thread waking the flusher before the interval, default: 64KB
+		
+		sl_size maxPendingSize; // per logging thread, default: 16MB
+		sl_bool flagBlockWhenFull; // default: false (drops the lines when the pending buffer of the thread is full)
+		
+	public:
+		AsyncFileLoggerParam();
+		
+		AsyncFileLoggerParam(const String& fileName);
+		
+		~AsyncFileLoggerParam();
+		
+	};
+	
+	/*
+		Lines are staged in memory and written by a background thread in batches,
+		keeping the file opened between the batches.
+
+		Each logging thread appends to its own staging buffer without locking,
+		and the background thread gathers the buffers of all threads into one `writev()` call.
+		The lines of a thread keep their order; the lines of different threads are interleaved per batch.
+	*/
+	class SLIB_EXPORT AsyncFileLogger : public Logger
+	{
+		SLIB_DECLARE_OBJECT
+		
+	protected:
+		AsyncFileLogger();
+		
+		~AsyncFileLogger();
+		
+	public:
+		static Ref<AsyncFileLogger> create(const AsyncFileLoggerParam& param);
+		
+	public:
+		// override
+		void log(const String& tag, const String& content);
+		
+		// blocks until all the lines logged before this call are written
+		void flush();
+		
+		// flushes the pending lines and stops the background thread
+		void release();
+		
+		sl_uint64 getDroppedLinesCount();
+		
+	protected:
+		void _run();
+		
+		_AsyncFileLogger_Staging* _getStaging();
+		
+		void _processPending();
+		
+		void _write(const _AsyncFileLogger_Segment* segments, sl_uint32 countSegments, sl_size size);
+		
+		sl_bool _openFile();
+		
+		void _rotate();
+		
+	protected:
+		AsyncFileLoggerParam m_param;
+		
+		// identifies this logger in the per-thread staging tables
+		sl_uint64 m_id;
+		
+		SpinLock m_lockStagings;
+		List< Ref<_AsyncFileLogger_Staging> > m_stagings;
+		// dropped lines of the released stagings, protected by `m_lockStagings`
+		sl_uint64 m_countDropped;
+		
+		Ref<Thread> m_thread;
+		Ref<Event> m_eventWritten;
+		volatile sl_bool m_flagRunning;
+		
+		Ref<File> m_file;
+		sl_uint64 m_sizeFile;
+		sl_int64 m_timeFileOpened;
+		
+	};
+	
 	class SLIB_EXPORT LoggerSet : public Logger
 	{
 	public:
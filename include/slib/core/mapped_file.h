@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_MAPPED_FILE
+#define CHECKHEADER_SLIB_CORE_MAPPED_FILE
+
+#include "definition.h"
+
+#include "file.h"
+#include "memory.h"
+
+/*
+	Memory-mapped files
+
+	`MappedFile` maps windows (`MappedRegion`) of an opened file into the address space.
+	A region stays mapped while it is referenced, so a `Memory` returned by
+	`MappedRegion::getMemory()` keeps the mapping alive and can be passed to
+	any API taking `Memory` without copying the content.
+
+	Files larger than the address-space budget (see `getDefaultWindowSize`)
+	can be accessed by mapping a window at a time.
+
+	Accessing the pages beyond the end of a file truncated by another process
+	raises a fault (SIGBUS on Unix).
+*/
+
+namespace slib
+{
+
+	enum class MappedFileAdvice
+	{
+		Normal = 0,
+		Sequential = 1,
+		Random = 2,
+		// starts reading the pages ahead
+		WillNeed = 3,
+		// the pages may be dropped from memory
+		DontNeed = 4,
+		// backs the pages with huge pages where supported (Linux)
+		HugePage = 5
+	};
+
+	class SLIB_EXPORT MappedRegion : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+
+	private:
+		MappedRegion();
+
+		~MappedRegion();
+
+	public:
+		void* getData() const;
+
+		sl_size getSize() const;
+
+		// position of the region in the file
+		sl_uint64 getOffset() const;
+
+		sl_bool isWritable() const;
+
+		// the returned memory keeps the region mapped
+		Memory getMemory();
+
+		sl_bool advise(MappedFileAdvice advice);
+
+		// writes the modified pages back to the file
+		sl_bool flush(sl_bool flagAsync = sl_false);
+
+	private:
+		void* m_base;
+		sl_size m_sizeBase;
+		void* m_data;
+		sl_size m_size;
+		sl_uint64 m_offset;
+		sl_bool m_flagWritable;
+
+		friend class MappedFile;
+
+	};
+
+	class SLIB_EXPORT MappedFile : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+
+	private:
+		MappedFile();
+
+		~MappedFile();
+
+	public:
+		// the size of the mapping is fixed to the size of the file at this time
+		static Ref<MappedFile> open(const Ref<File>& file, sl_bool flagWritable);
+
+		static Ref<MappedFile> open(const String& filePath, sl_bool flagWritable);
+
+		static Ref<MappedFile> openForRead(const String& filePath);
+
+		// opens an existing file without truncating
+		static Ref<MappedFile> openForReadWrite(const String& filePath);
+
+	public:
+		Ref<File> getFile() const;
+
+		sl_uint64 getSize() const;
+
+		sl_bool isWritable() const;
+
+		// `offset` does not need to be aligned; `size` is clipped at the end of the file
+		Ref<MappedRegion> map(sl_uint64 offset, sl_size size = SLIB_SIZE_MAX);
+
+		// returns null if the whole file does not fit in the address space
+		Ref<MappedRegion> mapAll();
+
+		// alignment of the mapped offsets (page size, or allocation granularity on Windows)
+		static sl_size getGranularity();
+
+		// recommended size of the windows for files larger than the address-space budget
+		static sl_size getDefaultWindowSize();
+
+		// files smaller than this are read instead of mapped by `mapAllBytes`
+		static sl_size getMinimumMappingSize();
+
+		/*
+			Returns the whole content of the file as a read-only mapped memory.
+			Falls back to `File::readAllBytes` for small files and for files which can not be mapped.
+		*/
+		static Memory mapAllBytes(const String& filePath, MappedFileAdvice advice = MappedFileAdvice::Sequential);
+
+	private:
+		sl_bool _initialize();
+
+		void _free();
+
+		sl_bool _map(MappedRegion* region, sl_uint64 offset, sl_size size);
+
+		static void _unmap(MappedRegion* region);
+
+	private:
+		Ref<File> m_file;
+		sl_uint64 m_size;
+		sl_bool m_flagWritable;
+		void* m_handle;
+
+		friend class MappedRegion;
+
+	};
+
+}
+
+#endif
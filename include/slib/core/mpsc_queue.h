@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_MPSC_QUEUE
+#define CHECKHEADER_SLIB_CORE_MPSC_QUEUE
+
+#include "definition.h"
+
+#include "base.h"
+#include "cpp.h"
+#include "spin_lock.h"
+
+#include <new>
+#include <atomic>
+
+// count of the popped nodes kept by `MpscQueue` for the next pushes
+#define SLIB_MPSC_QUEUE_MAX_FREE_NODES 256
+// count of the popped nodes returned to the producers at once
+#define SLIB_MPSC_QUEUE_FREE_NODES_BATCH 16
+
+namespace slib
+{
+	
+	class SLIB_EXPORT MpscQueueNode
+	{
+	public:
+		MpscQueueNode* volatile next;
+
+	public:
+		SLIB_INLINE MpscQueueNode() noexcept: next(sl_null) {}
+
+	};
+	
+	/*
+		Intrusive multi-producer single-consumer queue (Vyukov).
+
+		`push()` is wait-free and may be called from any thread (one atomic exchange, no lock).
+		`pop()` and `isEmpty()` must be called only by one consumer thread at a time.
+		`pop()` may return null while a producer is in the middle of `push()`,
+		so the producers should notify the consumer after pushing.
+	*/
+	class SLIB_EXPORT MpscQueueBase
+	{
+	public:
+		MpscQueueBase() noexcept;
+
+		~MpscQueueBase() noexcept;
+
+	public:
+		void push(MpscQueueNode* node) noexcept;
+
+		MpscQueueNode* pop() noexcept;
+
+		sl_bool isEmpty() const noexcept;
+
+	private:
+		MpscQueueNode* volatile m_head;
+		char m_padding[64 - sizeof(void*)];
+		MpscQueueNode* m_tail;
+		MpscQueueNode m_stub;
+
+	private:
+		MpscQueueBase(const MpscQueueBase& other) = delete;
+		MpscQueueBase& operator=(const MpscQueueBase& other) = delete;
+
+	};
+	
+	/*
+		`MpscQueue` recycles the popped nodes (up to `SLIB_MPSC_QUEUE_MAX_FREE_NODES`),
+		so `push()` allocates only when no free node is left. The consumer returns the nodes
+		in batches, and a producer takes a free node under a spin lock held for a few instructions;
+		the linking itself is still a single atomic exchange.
+	*/
+	template <class T>
+	class SLIB_EXPORT MpscQueue : public MpscQueueBase
+	{
+	public:
+		MpscQueue();
+
+		~MpscQueue();
+
+	public:
+		// can be called from any thread
+		sl_bool push(const T& value);
+
+		sl_bool push(T&& value);
+
+		// consumer only
+		sl_bool pop(T* _out = sl_null);
+
+		// consumer only, or after all producers are finished
+		sl_size removeAll();
+
+	private:
+		class Node : public MpscQueueNode
+		{
+		public:
+			T value;
+
+		public:
+			template <class _T>
+			SLIB_INLINE Node(_T&& _value): value(Forward<_T>(_value)) {}
+		};
+
+	private:
+		template <class _T>
+		sl_bool _push(_T&& value);
+
+		// consumer only
+		void _freeNode(Node* node);
+
+		void _flushPoppedNodes();
+
+		static void _deleteNodes(MpscQueueNode* node);
+
+	private:
+		SpinLock m_lockFreeNodes;
+		// written under `m_lockFreeNodes`; the loads outside of the lock are only hints, checked again under the lock
+		std::atomic<MpscQueueNode*> m_freeNodes;
+		std::atomic<sl_uint32> m_countFreeNodes;
+
+		// accessed only by the consumer
+		MpscQueueNode* m_poppedNodesFirst;
+		MpscQueueNode* m_poppedNodesLast;
+		sl_uint32 m_countPoppedNodes;
+
+	};
+
+}
+
+#include "detail/mpsc_queue.inc"
+
+#endif
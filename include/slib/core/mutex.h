@@ -16,6 +16,12 @@
 namespace slib
 {
 	
+	/*
+		Recursive mutex.
+
+		The platform lock object is allocated on the first `lock()` or `tryLock()`,
+		so constructing and destructing a mutex which is never locked costs no allocation.
+	*/
 	class SLIB_EXPORT Mutex
 	{
 	public:
@@ -39,12 +45,30 @@ namespace slib
 		mutable void* m_pObject;
 
 	private:
-		void _init();
+		void* _getObject() const;
+
+		static void* _create();
+
+		static void _destroy(void* object);
 
 		void _free();
 
 	};
 	
+#define SLIB_MUTEX_POOL_SIZE 971
+
+	/*
+		Striped table of shared mutexes, selected by the address of the guarded object.
+		Unrelated objects may share a mutex, so a thread holding a pooled mutex
+		must not wait for another thread which may lock an arbitrary pooled mutex.
+	*/
+	class SLIB_EXPORT MutexPool
+	{
+	public:
+		static Mutex* get(const void* ptr);
+
+	};
+
 #define SLIB_MAX_LOCK_MUTEX 16
 	
 	class SLIB_EXPORT MutexLocker
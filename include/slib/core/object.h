@@ -17,6 +17,14 @@
 #include "ref.h"
 #include "mutex.h"
 
+/*
+	Define to lock the objects with the shared mutexes of `MutexPool` instead of
+	embedding a `Mutex` in each object (saves a pointer per object, and the lock
+	allocation of the objects which are locked).
+	Must be defined equally for the library and the applications.
+*/
+// #define SLIB_OBJECT_STRIPED_LOCK
+
 namespace slib
 {
 	
@@ -46,9 +54,13 @@ namespace slib
 		void setProperty(const String& name, const Variant& value);
 		
 		void clearProperty(const String& name);
+		
+		void clearAllProperties();
 	
 	private:
+#if !defined(SLIB_OBJECT_STRIPED_LOCK)
 		Mutex m_locker;
+#endif
 		Ref<Referable> m_properties;
 
 	};
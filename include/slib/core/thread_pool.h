@@ -16,6 +16,7 @@
 #include "queue.h"
 #include "thread.h"
 #include "dispatch.h"
+#include "inline_function.h"
 
 namespace slib
 {
@@ -59,6 +60,83 @@ namespace slib
 		sl_bool m_flagRunning;
 
 	};
+	
+	class _WorkStealingWorker;
+	class _WorkStealingShared;
+	class _WorkStealingTask;
+	
+	/*
+		Thread pool scheduling the tasks by work stealing.
+
+		Every worker owns a Chase-Lev deque. Tasks added from a worker are pushed to its own deque
+		and run in LIFO order, while idle workers steal the oldest tasks of random victims.
+		Tasks added from other threads are queued in a shared queue.
+		Idle workers are parked on an event, and woken when a task is added.
+		The task nodes are recycled, and small callables are stored in the nodes by `InlineFunction`,
+		so adding a lambda task does not allocate.
+	*/
+	class SLIB_EXPORT WorkStealingThreadPool : public Dispatcher
+	{
+		SLIB_DECLARE_OBJECT
+		
+	private:
+		WorkStealingThreadPool();
+		
+		~WorkStealingThreadPool();
+		
+	public:
+		// `nThreads`: count of the workers, 0 means the count of the processors
+		static Ref<WorkStealingThreadPool> create(sl_uint32 nThreads = 0);
+		
+	public:
+		/*
+			Stops the workers after their running tasks. Like `ThreadPool`, the tasks which are not started yet
+			are not run: their callables are destroyed with the pool. Use `runTask()` before releasing to drain them.
+		*/
+		void release();
+		
+		sl_bool isRunning();
+		
+		sl_uint32 getThreadsCount();
+		
+		sl_bool addTask(const Function<void()>& task);
+
+		sl_bool addTask(InlineFunction<void()>&& task);
+
+		template <class FUNC, class = typename EnableIf<IsInlineFunctionCallable<FUNC>()>::Type>
+		sl_bool addTask(FUNC&& task)
+		{
+			return addTask(InlineFunction<void()>(Forward<FUNC>(task)));
+		}
+		
+		/*
+			Runs a pending task in the calling thread, and returns `sl_false` if no task is found.
+			Used to wait for the child tasks without blocking a worker.
+		*/
+		sl_bool runTask();
+		
+		// override
+		sl_bool dispatch(const Function<void()>& callback, sl_uint64 delay_ms = 0);
+		
+	protected:
+		void onRunWorker(sl_uint32 index);
+		
+		_WorkStealingWorker* _getCurrentWorker();
+		
+		_WorkStealingTask* _findTask(_WorkStealingWorker* worker);
+		
+		void _runTask(_WorkStealingWorker* worker, _WorkStealingTask* task);
+		
+		void _wakeWorker();
+		
+	protected:
+		_WorkStealingWorker** m_workers;
+		sl_uint32 m_nWorkers;
+		_WorkStealingShared* m_shared;
+		
+		sl_bool m_flagRunning;
+		
+	};
 
 }
 
@@ -15,6 +15,7 @@
 
 #include "object.h"
 #include "function.h"
+#include "timer_wheel.h"
 
 namespace slib
 {
@@ -78,6 +79,11 @@ namespace slib
 
 		sl_bool m_flagDispatched;
 
+		// scheduled in the timers of `m_loop`, guarded by the lock of the loop's timers
+		Ref<TimerWheelEntry> m_entryLoop;
+
+		friend class DispatchLoop;
+
 	};
 
 }
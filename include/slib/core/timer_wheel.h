@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CORE_TIMER_WHEEL
+#define CHECKHEADER_SLIB_CORE_TIMER_WHEEL
+
+#include "definition.h"
+
+#include "ref.h"
+#include "inline_function.h"
+#include "list.h"
+
+#define SLIB_TIMER_WHEEL_LEVELS 6
+#define SLIB_TIMER_WHEEL_SLOT_BITS 6
+#define SLIB_TIMER_WHEEL_SLOTS (1 << SLIB_TIMER_WHEEL_SLOT_BITS)
+
+namespace slib
+{
+
+	class TimerWheel;
+
+	/*
+		Task scheduled in a `TimerWheel`.
+		Also used as the handle to cancel the task.
+	*/
+	class SLIB_EXPORT TimerWheelEntry : public Referable
+	{
+	public:
+		TimerWheelEntry(InlineFunction<void()>&& task);
+
+		~TimerWheelEntry();
+
+	public:
+		const InlineFunction<void()>& getTask();
+
+		sl_uint64 getTime();
+
+		sl_bool isScheduled();
+
+	protected:
+		InlineFunction<void()> m_task;
+		sl_uint64 m_time;
+
+		TimerWheel* m_wheel;
+		sl_uint32 m_slot;
+		TimerWheelEntry* m_prev;
+		TimerWheelEntry* m_next;
+
+		friend class TimerWheel;
+	};
+
+	/*
+		Hierarchical hashed timing wheel with the resolution of 1 millisecond.
+
+		6 levels of 64 slots: level `n` holds the entries due in less than 64^(n+1) ms,
+		and its slots are moved down to the lower levels as the time advances.
+		Adding and removing an entry is O(1), and the next deadline is found
+		with one bit scan per level.
+
+		Not thread-safe: the owner must serialize the calls.
+		The times are given by the owner in milliseconds from any fixed origin.
+	*/
+	class SLIB_EXPORT TimerWheel
+	{
+	public:
+		TimerWheel(sl_uint64 timeStart = 0);
+
+		~TimerWheel();
+
+	public:
+		sl_size getCount();
+
+		// time of the next tick to be processed; the entries added for an earlier time are due at this tick
+		sl_uint64 getCurrentTime();
+
+		Ref<TimerWheelEntry> add(sl_uint64 time, InlineFunction<void()>&& task);
+
+		// schedules again an expired or removed entry, or moves a scheduled entry
+		sl_bool add(TimerWheelEntry* entry, sl_uint64 time);
+
+		sl_bool remove(TimerWheelEntry* entry);
+
+		void removeAll();
+
+		// removes the entries due at or before `now`, and appends them to `expired` in order of the time
+		void advance(sl_uint64 now, List< Ref<TimerWheelEntry> >& expired);
+
+		/*
+			Returns the milliseconds from `now` to the next deadline, or -1 when the wheel is empty.
+			May be earlier than the real deadline (when the entries of the upper levels are moved down),
+			but never later.
+		*/
+		sl_int64 getTimeout(sl_uint64 now);
+
+	private:
+		void _insert(TimerWheelEntry* entry);
+
+		void _unlink(TimerWheelEntry* entry);
+
+		void _cascade(sl_uint32 level, sl_uint32 index);
+
+	private:
+		TimerWheelEntry* m_slots[SLIB_TIMER_WHEEL_LEVELS * SLIB_TIMER_WHEEL_SLOTS];
+		sl_uint64 m_bitmaps[SLIB_TIMER_WHEEL_LEVELS];
+		sl_uint64 m_current;
+		sl_size m_count;
+
+	private:
+		TimerWheel(const TimerWheel& other) = delete;
+		TimerWheel& operator=(const TimerWheel& other) = delete;
+
+	};
+
+}
+
+#endif
@@ -218,6 +218,9 @@ namespace slib
 		
 		virtual void releaseNodeData(NodeData* data);
 		
+		// called by `put()` and `addIfNewKeyAndValue()` before modifying any node; the item is not stored when it returns false
+		virtual sl_bool canStoreItem(const KT& key, const VT& value) const;
+		
 	};
 
 }
@@ -15,6 +15,7 @@
 #include "crypto/sha1.h"
 #include "crypto/sha2.h"
 #include "crypto/hash.h"
+#include "crypto/parallel_file_hasher.h"
 
 #include "crypto/gcm.h"
 #include "crypto/block_cipher.h"
@@ -24,5 +25,6 @@
 #include "crypto/rsa.h"
 
 #include "crypto/zlib.h"
+#include "crypto/parallel_zlib.h"
 
 #endif
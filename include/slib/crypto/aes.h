@@ -38,6 +38,9 @@ namespace slib
 	public:
 		static sl_uint32 getBlockSize();
 
+		// returns sl_true when the running CPU provides AES-NI and PCLMULQDQ, used by all the operations below
+		static sl_bool isHardwareAccelerated();
+
 		sl_bool setKey(const void* key, sl_uint32 lenKey /* 16, 24, 32 bytes */);
 
 		void setKey_SHA256(const String& key);
@@ -52,6 +55,17 @@ namespace slib
 		// 128 bit (16 byte) block
 		void decryptBlock(const void* src, void* dst) const;
 
+	public: /* multi-block operations, pipelining several blocks on hardware AES */
+		void encryptBlocks_ECB(const void* src, void* dst, sl_size nBlocks) const;
+
+		void decryptBlocks_ECB(const void* src, void* dst, sl_size nBlocks) const;
+
+		// `iv` (16 bytes) is updated to the last cipher block
+		void decryptBlocks_CBC(void* iv, const void* src, void* dst, sl_size nBlocks) const;
+
+		// dst = src ^ E(counter++), incrementing the trailing `sizeCounter` bytes of `counter` (16 bytes) as a big-endian number: 16 for CTR, 4 for GCM
+		void encryptBlocks_CTR(void* counter, const void* src, void* dst, sl_size nBlocks, sl_uint32 sizeCounter = 16) const;
+
 	public: /* common functions for block ciphers */
 		sl_size encryptBlocks(const void* src, void* dst, sl_size size) const;
 
@@ -86,6 +100,8 @@ namespace slib
 	private:
 		sl_uint32 m_roundKeyEnc[64];
 		sl_uint32 m_roundKeyDec[64];
+		sl_uint8 m_roundKeyEncBytes[240];
+		sl_uint8 m_roundKeyDecBytes[240];
 		sl_uint32 m_nCountRounds;
 
 	};
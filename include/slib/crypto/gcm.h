@@ -34,6 +34,7 @@ namespace slib
 	{
 	public:
 		Uint128 M[16]; // Shoup's, 4-bit table
+		sl_uint8 HP[128]; // H^1 ~ H^8, for carry-less multiplication (PCLMULQDQ)
 	
 	public:
 		void generateTable(const void* H /* 16 bytes */);
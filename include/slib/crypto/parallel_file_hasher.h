@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_PARALLEL_FILE_HASHER
+#define CHECKHEADER_SLIB_CRYPTO_PARALLEL_FILE_HASHER
+
+#include "definition.h"
+
+#include "../core/string.h"
+#include "../core/memory.h"
+#include "../core/thread_pool.h"
+
+/*
+	Parallel tree hashing of large files
+
+	The input is split into fixed-size chunks which are hashed on a thread pool,
+	and the chunk digests are combined into a Merkle root (RFC 6962, section 2.1):
+
+		leaf = SHA256(0x00 || chunk)
+		node = SHA256(0x01 || left || right), splitting n leaves at the largest power of two less than n
+		empty input = SHA256("")
+
+	Output: 256bits (32 bytes). The root depends on the chunk size, so the same size must be used to compare results.
+*/
+
+namespace slib
+{
+
+	class SLIB_EXPORT ParallelFileHasher
+	{
+	public:
+		static sl_uint32 getHashSize();
+
+		// 1MB
+		static sl_size getDefaultChunkSize();
+
+		/*
+			`chunkSize`: 0 means the default chunk size
+			`pool`: the chunks are hashed on a shared pool of as many threads as processors when null
+		*/
+		static sl_bool hashFile(const String& path, void* output, sl_size chunkSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static Memory hashFile(const String& path, sl_size chunkSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static void hash(const void* data, sl_size size, void* output, sl_size chunkSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static Memory hash(const void* data, sl_size size, sl_size chunkSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		// computes the Merkle root from the leaf digests (32 bytes per leaf)
+		static void combine(const void* leaves, sl_size nLeaves, void* output);
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_PARALLEL_ZLIB
+#define CHECKHEADER_SLIB_CRYPTO_PARALLEL_ZLIB
+
+#include "definition.h"
+
+#include "zlib.h"
+
+#include "../core/io.h"
+#include "../core/ptr.h"
+#include "../core/queue.h"
+#include "../core/event.h"
+#include "../core/thread_pool.h"
+
+/*
+	Parallel deflate compression (in the manner of pigz)
+
+	The input is split into blocks which are compressed concurrently as raw deflate streams.
+	Every block is primed with the last 32KB of the previous block as the dictionary,
+	and all but the last block end with a sync flush, so the blocks concatenate into
+	one deflate stream. The checksums of the blocks are combined into the trailer.
+
+	The output is a single standard zlib, gzip or raw deflate stream,
+	which can be decompressed by `ZlibDecompress` or any other inflater.
+*/
+
+namespace slib
+{
+
+	class _ParallelZlibCompress_Block;
+
+	class SLIB_EXPORT ParallelZlibCompress : public Object, public IWriter
+	{
+	public:
+		ParallelZlibCompress();
+
+		~ParallelZlibCompress();
+
+	public:
+		// 128KB
+		static sl_size getDefaultBlockSize();
+
+		/*
+			Whole-buffer compression
+				level = 0 ~ 9
+				`blockSize`: 0 means the default block size
+				`pool`: the blocks are compressed on a shared pool of as many threads as processors when null
+		*/
+		static Memory compress(const void* data, sl_size size, sl_int32 level = 6, sl_size blockSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static Memory compressRaw(const void* data, sl_size size, sl_int32 level = 6, sl_size blockSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static Memory compressGzip(const GzipParam& param, const void* data, sl_size size, sl_int32 level = 6, sl_size blockSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+		static Memory compressGzip(const void* data, sl_size size, sl_int32 level = 6, sl_size blockSize = 0, const Ref<ThreadPool>& pool = sl_null);
+
+	public:
+		sl_size getBlockSize();
+
+		// applied by the next start
+		void setBlockSize(sl_size size);
+
+		Ref<ThreadPool> getThreadPool();
+
+		// applied by the next start
+		void setThreadPool(const Ref<ThreadPool>& pool);
+
+		sl_bool isStarted();
+
+		/*
+			Streaming compression: the compressed stream is written to `output` in order.
+			contains zlib wrapper
+			level = 0 ~ 9
+		*/
+		sl_bool start(const Ptr<IWriter>& output, sl_int32 level = 6);
+
+		// raw deflate content
+		sl_bool startRaw(const Ptr<IWriter>& output, sl_int32 level = 6);
+
+		// contains gzip header
+		sl_bool startGzip(const Ptr<IWriter>& output, const GzipParam& param, sl_int32 level = 6);
+
+		sl_bool startGzip(const Ptr<IWriter>& output, sl_int32 level = 6);
+
+		// override
+		sl_reg write(const void* data, sl_size size);
+
+		// compresses the remaining input, and writes the trailer
+		sl_bool finish();
+
+		void abort();
+
+	private:
+		static Memory _compress(sl_uint32 format, const GzipParam* param, const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool);
+
+		sl_bool _start(const Ptr<IWriter>& output, sl_uint32 format, const GzipParam* param, sl_int32 level);
+
+		sl_bool _writeBlocks(const void* data, sl_size size);
+
+		sl_bool _submit(const sl_uint8* data, sl_size size, const Memory& mem, sl_bool flagLast);
+
+		sl_bool _writeBlock(_ParallelZlibCompress_Block* block);
+
+		sl_bool _writeOutput(const void* data, sl_size size);
+
+		sl_bool _waitFront();
+
+	private:
+		sl_bool m_flagStarted;
+		sl_bool m_flagError;
+		sl_uint32 m_format;
+		sl_int32 m_level;
+		sl_size m_blockSize;
+		sl_size m_blockSizeCurrent;
+		sl_uint32 m_nMaxPendingBlocks;
+
+		Ptr<IWriter> m_output;
+		Ref<ThreadPool> m_pool;
+		Ref<ThreadPool> m_poolCurrent;
+		Ref<Event> m_eventDone;
+		LinkedQueue< Ref<_ParallelZlibCompress_Block> > m_blocks;
+
+		Memory m_memInput;
+		sl_size m_sizeInput;
+		const sl_uint8* m_dict;
+		sl_uint32 m_sizeDict;
+		Memory m_memDict;
+
+		sl_uint32 m_check;
+		sl_uint64 m_sizeTotal;
+
+	};
+
+}
+
+#endif
@@ -41,6 +41,10 @@ namespace slib
 		// override
 		void finish(void* output);
 
+	public:
+		// hashes `count` independent messages at once, writing 20 bytes per message to `outputs`
+		static void hashBatch(const void* const* inputs, const sl_size* sizes, sl_size count, void* outputs);
+
 	public: /* common functions for CryptoHash */
 		static void hash(const void* input, sl_size n, void* output);
 
@@ -60,6 +64,8 @@ namespace slib
 	
 	private:
 		void _updateSection(const sl_uint8* input);
+
+		void _updateSections(const sl_uint8* input, sl_size nSections);
 	
 	private:
 		sl_size sizeTotalInput;
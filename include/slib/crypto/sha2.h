@@ -45,6 +45,8 @@ namespace slib
 		void _finish();
 
 		void _updateSection(const sl_uint8* input);
+
+		void _updateSections(const sl_uint8* input, sl_size nSections);
 	
 	protected:
 		sl_size sizeTotalInput;
@@ -103,6 +105,9 @@ namespace slib
 	public:
 		static sl_uint32 make32bitChecksum(const void* input, sl_size n);
 
+		// hashes `count` independent messages at once, writing 32 bytes per message to `outputs`
+		static void hashBatch(const void* const* inputs, const sl_size* sizes, sl_size count, void* outputs);
+
 	public: /* common functions for CryptoHash */
 		static void hash(const void* input, sl_size n, void* output);
 
@@ -16,4 +16,6 @@
 #include "db/sqlite.h"
 #include "db/mysql.h"
 
+#include "db/file_btree.h"
+
 #endif
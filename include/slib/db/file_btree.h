@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_DB_FILE_BTREE
+#define CHECKHEADER_SLIB_DB_FILE_BTREE
+
+#include "definition.h"
+
+#include "../core/tree.h"
+#include "../core/file.h"
+#include "../core/hashtable.h"
+
+#include <type_traits>
+
+#define SLIB_FILE_BTREE_DEFAULT_CACHE_SIZE 1024
+#define SLIB_FILE_BTREE_SIGNATURE 0x31544253 // "SBT1"
+#define SLIB_FILE_BTREE_HEADER_SIZE 64
+#define SLIB_FILE_BTREE_PAGE_HEADER_SIZE 32
+#define SLIB_FILE_BTREE_LOG_COMMIT ((sl_uint64)-1)
+#define SLIB_FILE_BTREE_CHECKSUM_INIT SLIB_UINT64(0xcbf29ce484222325)
+
+namespace slib
+{
+
+	/*
+		Fixed-size serialization of the keys and values stored in FileBTree.
+		`maxLength` is the maximum length of the variable-sized types (ignored for POD types).
+		The generic serializer copies the bytes of the value, so other types need a specialization.
+	*/
+	template <class T>
+	class SLIB_EXPORT FileBTreeSerializer
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "FileBTreeSerializer: specialize for the types which are not trivially copyable");
+
+	public:
+		static sl_uint32 getSize(sl_uint32 maxLength);
+
+		// false if `value` does not fit in `maxLength`
+		static sl_bool canWrite(const T& value, sl_uint32 maxLength);
+
+		static void write(sl_uint8* buf, const T& value, sl_uint32 maxLength);
+
+		static void read(const sl_uint8* buf, T& value, sl_uint32 maxLength);
+
+	};
+
+	// length-prefixed, up to `maxLength` bytes
+	template <>
+	class SLIB_EXPORT FileBTreeSerializer<String>
+	{
+	public:
+		static sl_uint32 getSize(sl_uint32 maxLength);
+
+		static sl_bool canWrite(const String& value, sl_uint32 maxLength);
+
+		static void write(sl_uint8* buf, const String& value, sl_uint32 maxLength);
+
+		static void read(const sl_uint8* buf, String& value, sl_uint32 maxLength);
+
+	};
+
+	class SLIB_EXPORT _FileBTreeLog
+	{
+	public:
+		// FNV-1a
+		static sl_uint64 updateChecksum(sl_uint64 checksum, const void* data, sl_size size);
+
+	};
+
+	class SLIB_EXPORT FileBTreeParam
+	{
+	public:
+		String path;
+
+		// optional
+		sl_uint32 maxKeyLength; // default: 64, used for variable-sized keys
+		sl_uint32 maxValueLength; // default: 64, used for variable-sized values
+		sl_uint32 cacheSize; // count of cached pages, default: SLIB_FILE_BTREE_DEFAULT_CACHE_SIZE
+
+	public:
+		FileBTreeParam();
+
+		FileBTreeParam(const String& path);
+
+		~FileBTreeParam();
+
+	};
+
+	/*
+		BTree storing every node in a fixed-size page of a file.
+
+		Pages are loaded on demand into a LRU cache of `cacheSize` pages.
+		Modified pages are never written over the main file before `commit()`:
+		dirty pages evicted from the cache are appended to the write-ahead log (`path.wal`),
+		and `commit()` appends the remaining dirty pages and a checksummed commit record to the log,
+		syncs it, and then copies the pages into the main file.
+		On open, a committed log is replayed and an incomplete log is discarded,
+		so the file always reflects the last successful commit.
+		`close()` and the destructor do not commit: the changes after the last commit are discarded.
+
+		The order of the tree is stored in the file, and must be equal to the order given to the constructor.
+		`put()` and `addIfNewKeyAndValue()` fail for the keys and values longer than `maxKeyLength` or `maxValueLength`.
+		Like BTree, this class is not thread-safe, and the pointers returned by `getValuePointerAt()`
+		are only valid until the next operation.
+	*/
+	template < class KT, class VT, class KEY_COMPARE = Compare<KT> >
+	class SLIB_EXPORT FileBTree : public BTree<KT, VT, KEY_COMPARE>
+	{
+	public:
+		typedef typename BTree<KT, VT, KEY_COMPARE>::NodeData NodeData;
+
+	public:
+		FileBTree(sl_uint32 order = SLIB_BTREE_DEFAULT_ORDER);
+
+		FileBTree(const KEY_COMPARE& compare, sl_uint32 order = SLIB_BTREE_DEFAULT_ORDER);
+
+		~FileBTree();
+
+	public:
+		sl_bool open(const FileBTreeParam& param);
+
+		sl_bool open(const String& path);
+
+		// closes the file, discarding the changes which are not committed
+		void close();
+
+		sl_bool isOpened() const;
+
+		sl_bool commit();
+
+		// discards the changes after the last commit
+		sl_bool rollback();
+
+		sl_uint32 getPageSize() const;
+
+		sl_uint32 getCachedPagesCount() const;
+
+	protected:
+		// override
+		BTreeNode getRootNode() const;
+
+		// override
+		sl_bool setRootNode(BTreeNode node);
+
+		// override
+		BTreeNode createNode(NodeData* data);
+
+		// override
+		sl_bool deleteNode(BTreeNode node);
+
+		// override
+		NodeData* readNodeData(const BTreeNode& node) const;
+
+		// override
+		sl_bool writeNodeData(const BTreeNode& node, NodeData* data);
+
+		// override
+		void releaseNodeData(NodeData* data);
+
+		// override, rejects the keys and values longer than `maxKeyLength` or `maxValueLength`
+		sl_bool canStoreItem(const KT& key, const VT& value) const;
+
+	protected:
+		struct Page
+		{
+			NodeData data; // must be the first member
+			sl_uint64 index;
+			sl_uint32 countRef;
+			sl_bool flagDirty;
+			sl_bool flagDeleted;
+			Page* before;
+			Page* next;
+		};
+
+	protected:
+		Page* _createPage(sl_uint64 index);
+
+		void _freePage(Page* page);
+
+		Page* _getPage(sl_uint64 index);
+
+		Page* _allocatePage();
+
+		void _recyclePage(Page* page);
+
+		void _linkPage(Page* page);
+
+		void _unlinkPage(Page* page);
+
+		void _evictPages();
+
+		void _serializePage(NodeData* data, sl_uint8* buf);
+
+		void _deserializePage(const sl_uint8* buf, NodeData* data);
+
+		void _serializeHeader(sl_uint8* buf);
+
+		// checks the signature and the layout of the header
+		sl_bool _checkHeader(const sl_uint8* buf);
+
+		sl_bool _readHeader();
+
+		sl_bool _canWriteData(NodeData* data);
+
+		// `record` is `m_bufPage`: 8 bytes reserved for the index, followed by the page
+		sl_bool _appendLog(sl_uint64 index, sl_uint8* record);
+
+		// copies the pages in `m_pagesInLog` to the main file
+		sl_bool _applyLog();
+
+		// replays the committed log, or ignores the incomplete log.
+		// fails on the I/O errors and the invalid logs, which must be kept
+		sl_bool _recoverLog(sl_bool flagHeaderInFile);
+
+		sl_bool _resetLog();
+
+		void _freeAllPages();
+
+	protected:
+		Ref<File> m_file;
+		Ref<File> m_fileLog;
+
+		sl_uint32 m_pageSize;
+		sl_uint32 m_maxKeyLength;
+		sl_uint32 m_maxValueLength;
+		sl_uint32 m_sizeKey;
+		sl_uint32 m_sizeValue;
+		sl_uint32 m_cacheSize;
+
+		sl_uint64 m_root;
+		sl_uint64 m_countPages;
+		sl_uint64 m_firstFreePage;
+		sl_bool m_flagHeaderDirty;
+
+		HashTable<sl_uint64, Page*> m_pages;
+		sl_uint32 m_countCachedPages;
+		Page* m_pageFirst; // most recently used
+		Page* m_pageLast;
+
+		// page index -> offset of the latest copy in the log
+		HashTable<sl_uint64, sl_uint64> m_pagesInLog;
+		sl_uint64 m_sizeLog;
+		sl_uint64 m_countLogRecords;
+		sl_uint64 m_checksumLog;
+
+		Memory m_bufPage;
+
+	};
+
+}
+
+#include "detail/file_btree.inc"
+
+#endif
@@ -308,10 +308,12 @@ namespace slib
 			Available Input:
 				M - an odd value (M%2=1), M>0
 				E > 0
+			flagConstantTime - uses a fixed-window ladder over the full modulus length, whose
+				sequence of operations and memory accesses does not depend on E (use for private keys)
 		*/
-		sl_bool pow_montgomery(const CBigInt& A, const CBigInt& E, const CBigInt& M);
+		sl_bool pow_montgomery(const CBigInt& A, const CBigInt& E, const CBigInt& M, sl_bool flagConstantTime = sl_false);
 
-		sl_bool pow_montgomery(const CBigInt& E, const CBigInt& M);
+		sl_bool pow_montgomery(const CBigInt& E, const CBigInt& M, sl_bool flagConstantTime = sl_false);
 	
 		/*
 			C = A^-1 mod M
@@ -648,10 +650,12 @@ namespace slib
 			Available Input:
 				M - an odd value (M%2=1), M>0
 				E > 0
+			flagConstantTime - uses a fixed-window ladder over the full modulus length, whose
+				sequence of operations and memory accesses does not depend on E (use for private keys)
 		*/
-		static BigInt pow_montgomery(const BigInt& A, const BigInt& E, const BigInt& M);
+		static BigInt pow_montgomery(const BigInt& A, const BigInt& E, const BigInt& M, sl_bool flagConstantTime = sl_false);
 
-		sl_bool pow_montgomery(const BigInt& E, const BigInt& M);
+		sl_bool pow_montgomery(const BigInt& E, const BigInt& M, sl_bool flagConstantTime = sl_false);
 	
 
 		/*
@@ -133,6 +133,7 @@ namespace slib
 		
 		// optional
 		sl_bool flagIPv6; // default: false
+		sl_bool flagReusePort; // default: false, allows multiple listeners (one per loop) on the same port
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		Ref<AsyncIoLoop> ioLoop;
@@ -194,6 +195,14 @@ namespace slib
 	class AsyncUdpSocket;
 	class AsyncUdpSocketInstance;
 	
+	struct SLIB_EXPORT AsyncUdpPacket
+	{
+		SocketAddress address;
+		void* data;
+		sl_uint32 size;
+
+	};
+	
 	class SLIB_EXPORT IAsyncUdpSocketListener
 	{
 	public:
@@ -204,6 +213,12 @@ namespace slib
 	public:
 		virtual void onReceiveFrom(AsyncUdpSocket* socket, const SocketAddress& address, void* data, sl_uint32 sizeReceived) = 0;
 		
+		/*
+			Receives the datagrams read together (by one system call on Linux). The packet buffers are reused after returning.
+			The default implementation calls `onReceiveFrom` for every packet.
+		*/
+		virtual void onReceiveBatch(AsyncUdpSocket* socket, AsyncUdpPacket* packets, sl_uint32 count);
+		
 	};
 	
 	
@@ -218,10 +233,15 @@ namespace slib
 		sl_bool flagAutoStart; // default: true
 		sl_bool flagLogError; // default: true
 		sl_uint32 packetSize; // default: 65536
+		sl_uint32 batchCount; // default: 16, count of datagrams received or sent by one system call (recvmmsg/sendmmsg on Linux)
+		sl_bool flagGSO; // default: false, coalesces the queued datagrams of same size and destination by UDP segmentation offload (Linux)
+		sl_bool flagGRO; // default: false, receives the coalesced datagrams by UDP generic receive offload, split before the delivery (Linux)
 		Ref<AsyncIoLoop> ioLoop;
 		
 		Ptr<IAsyncUdpSocketListener> listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> onReceiveFrom;
+		// called instead of `onReceiveFrom` when it is set
+		Function<void(AsyncUdpSocket*, AsyncUdpPacket*, sl_uint32)> onReceiveBatch;
 		
 	public:
 		AsyncUdpSocketParam();
@@ -269,12 +289,15 @@ namespace slib
 		
 		void _onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived);
 		
+		void _onReceiveBatch(AsyncUdpPacket* packets, sl_uint32 count);
+		
 	protected:
-		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, sl_uint32 packetSize);
+		static Ref<AsyncUdpSocketInstance> _createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param);
 		
 	protected:
 		Ptr<IAsyncUdpSocketListener> m_listener;
 		Function<void(AsyncUdpSocket*, const SocketAddress&, void*, sl_uint32)> m_onReceiveFrom;
+		Function<void(AsyncUdpSocket*, AsyncUdpPacket*, sl_uint32)> m_onReceiveBatch;
 		
 		friend class AsyncUdpSocketInstance;
 		
@@ -143,6 +143,8 @@ namespace slib
 		static const String& AcceptEncoding;
 		static const String& TransferEncoding;
 		static const String& ContentEncoding;
+		static const String& Connection;
+		static const String& Vary;
 		
 		static const String& Range;
 		static const String& ContentRange;
@@ -228,6 +230,10 @@ namespace slib
 		
 		void setRequestContentEncoding(const String& type);
 		
+		String getRequestAcceptEncoding() const;
+		
+		void setRequestAcceptEncoding(const String& type);
+		
 		String getRequestTransferEncoding() const;
 		
 		void setRequestTransferEncoding(const String& type);
@@ -277,6 +283,15 @@ namespace slib
 		
 		sl_bool containsPostParameter(String name) const;
 		
+		// parameters captured from the path by the router, also added to the parameters
+		const Map<String, String>& getPathParameters() const;
+		
+		String getPathParameter(const String& name) const;
+		
+		sl_bool containsPathParameter(const String& name) const;
+		
+		void setPathParameter(const String& name, const String& value);
+		
 		void applyPostParameters(const void* data, sl_size size);
 		
 		void applyPostParameters(const String& str);
@@ -309,6 +324,7 @@ namespace slib
 		Map<String, String> m_parameters;
 		Map<String, String> m_queryParameters;
 		Map<String, String> m_postParameters;
+		Map<String, String> m_pathParameters;
 		
 	};
 	
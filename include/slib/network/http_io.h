@@ -20,6 +20,8 @@
 
 namespace slib
 {
+
+	class Json;
 	
 	class SLIB_EXPORT HttpOutputBuffer
 	{
@@ -37,6 +39,9 @@ namespace slib
 		
 		void write(const Memory& mem);
 		
+		// serializes `json` by `JsonWriter`, and appends its chunks without copying
+		sl_bool writeJson(const Json& json);
+		
 		void copyFrom(AsyncStream* stream, sl_uint64 size);
 		
 		void copyFromFile(const String& path);
@@ -45,6 +50,9 @@ namespace slib
 		
 		sl_uint64 getOutputLength() const;
 		
+		// returns sl_false if the output contains a stream or a file
+		sl_bool getMemoryOutput(List<Memory>& output);
+		
 	protected:
 		AsyncOutputBuffer m_bufferOutput;
 		
@@ -111,6 +119,13 @@ namespace slib
 	public:
 		sl_bool isDecompressing();
 		
+		/*
+			Decodes the content received by the caller, when the reader is created without the source stream (`io` is null).
+			Chunked content is decoded in place, so `data` must be writable.
+			The listener is notified before returning when the content ends, with the data following the content.
+		*/
+		Memory decodeData(void* data, sl_uint32 size, Referable* refData = sl_null);
+		
 	protected:
 		// override
 		sl_bool write(void* data, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* ref);
@@ -18,12 +18,14 @@
 #include "socket_address.h"
 
 #include "../core/thread_pool.h"
+#include "../core/linked_list.h"
 
 namespace slib
 {
 
 	class HttpService;
 	class HttpServiceConnection;
+	class HttpServiceParam;
 	
 	class SLIB_EXPORT HttpServiceContext : public Object, public HttpRequest, public HttpResponse, public HttpOutputBuffer
 	{
@@ -81,6 +83,8 @@ namespace slib
 	private:
 		WeakRef<HttpServiceConnection> m_connection;
 		
+		void _reset();
+		
 		friend class HttpServiceConnection;
 		
 	};
@@ -135,20 +139,41 @@ namespace slib
 		Ref<AsyncOutput> m_output;
 		
 		AtomicRef<HttpServiceContext> m_contextCurrent;
+		CLinkedList< Ref<HttpServiceContext> > m_contextsQueued;
+		CLinkedList< Ref<HttpServiceContext> > m_contextsFinished;
+		CLinkedList< Ref<HttpServiceContext> > m_contextsFree;
 		
 		sl_bool m_flagClosed;
 		Memory m_bufRead;
+		Memory m_bufReadBusy;
 		sl_bool m_flagReading;
+		sl_bool m_flagInputSuspended;
+		sl_bool m_flagProcessing;
+		sl_bool m_flagDispatching;
+		
+		// request whose `preprocessRequest()` waits for the previous responses to be written
+		Ref<HttpServiceContext> m_contextPreprocessing;
+		Memory m_inputPreprocessing;
+		sl_bool m_flagPreprocessingDeferred;
 		
 	protected:
 		void _read();
 		
-		void _processInput(const void* data, sl_uint32 size);
+		// returns false when the service has taken over the connection or the input is broken
+		sl_bool _processInput(const void* data, sl_uint32 size, Referable* refData);
+		
+		Ref<HttpServiceContext> _createContext(const HttpServiceParam& param);
+		
+		void _processQueue(sl_bool flagCurrentThread);
 		
 		void _processContext(const Ref<HttpServiceContext>& context);
 		
 		void _completeResponse(HttpServiceContext* context);
 		
+		void _recycleContexts();
+		
+		void _resumePreprocessing();
+		
 	protected:
 		void onReadStream(AsyncStreamResult* result);
 		
@@ -204,6 +229,8 @@ namespace slib
 		sl_uint32 maxThreadsCount;
 		sl_bool flagProcessByThreads;
 		
+		sl_uint32 ioLoopsCount; // default: 1, 0 means the count of the processors
+		
 		sl_bool flagUseAsset;
 		String prefixAsset;
 		
@@ -213,6 +240,12 @@ namespace slib
 		sl_bool flagAllowCrossOrigin;
 		sl_bool flagAlwaysRespondAcceptRangesHeader;
 		
+		sl_bool flagUseCompression; // gzip/deflate by Accept-Encoding, default: false
+		sl_int32 compressionLevel; // default: 6
+		sl_uint64 compressionThreshold; // responses smaller than this are not compressed, default: 1KB
+		sl_uint64 maxCompressedFileSize; // static files larger than this are not compressed, default: 8MB
+		sl_uint64 maxCompressionCacheSize; // total size of the precompressed static files, 0 disables the cache, default: 32MB
+		
 		sl_bool flagLogDebug;
 		
 		Ptr<IHttpServiceProcessor> processor;
@@ -227,6 +260,25 @@ namespace slib
 		
 	};
 	
+	class SLIB_EXPORT HttpServiceCompressionStatistics
+	{
+	public:
+		sl_uint64 countCompressedResponses;
+		sl_uint64 sizeOriginal;
+		sl_uint64 sizeCompressed;
+		sl_uint64 countCacheHits;
+		sl_uint64 countCacheMisses;
+		
+	public:
+		HttpServiceCompressionStatistics();
+		
+	public:
+		sl_uint64 getSavedSize() const;
+		
+		float getCacheHitRate() const;
+		
+	};
+
 	class SLIB_EXPORT HttpService : public Object
 	{
 		SLIB_DECLARE_OBJECT
@@ -246,6 +298,8 @@ namespace slib
 		
 		Ref<AsyncIoLoop> getAsyncIoLoop();
 		
+		Ref<AsyncIoLoopGroup> getAsyncIoLoopGroup();
+		
 		Ref<ThreadPool> getThreadPool();
 		
 		const HttpServiceParam& getParam();
@@ -263,6 +317,11 @@ namespace slib
 		
 		sl_bool processRangeRequest(const Ref<HttpServiceContext>& context, sl_uint64 totalLength, const String& range, sl_uint64& outStart, sl_uint64& outLength);
 		
+		// compresses the content kept in memory, when the client accepts the encoding
+		sl_bool compressResponse(const Ref<HttpServiceContext>& context);
+		
+		HttpServiceCompressionStatistics getCompressionStatistics();
+		
 		virtual Ref<HttpServiceConnection> addConnection(const Ref<AsyncStream>& stream, const SocketAddress& remoteAddress, const SocketAddress& localAddress);
 		
 		virtual void closeConnection(HttpServiceConnection* connection);
@@ -295,6 +354,7 @@ namespace slib
 		
 	protected:
 		AtomicRef<AsyncIoLoop> m_ioLoop;
+		AtomicRef<AsyncIoLoopGroup> m_ioLoopGroup;
 		AtomicRef<ThreadPool> m_threadPool;
 		sl_bool m_flagRunning;
 		
@@ -306,6 +366,16 @@ namespace slib
 		
 		HttpServiceParam m_param;
 		
+		Ref<Referable> m_compressionCache;
+		sl_int64 m_countCompressedResponses;
+		sl_int64 m_sizeCompressionOriginal;
+		sl_int64 m_sizeCompressionResult;
+		sl_int64 m_countCompressionCacheHits;
+		sl_int64 m_countCompressionCacheMisses;
+		
+	protected:
+		sl_bool _processCompressedContent(const Ref<HttpServiceContext>& context, const String& key, const Time& modifiedTime, const String& filePath, const Memory& content, sl_uint64 size);
+		
 	};
 
 }
@@ -68,6 +68,11 @@ namespace slib
 		sl_bool flagStoreResponseContent;
 		sl_bool flagSynchronous;
 		
+		// deadline of the whole request in milliseconds, 0 means no deadline
+		sl_uint32 timeout;
+		// allows sending this request on a keep-alive connection before the previous responses arrive (only GET and HEAD)
+		sl_bool flagAllowPipelining;
+		
 	public:
 		UrlRequestParam();
 		
@@ -203,6 +208,10 @@ namespace slib
 		
 		sl_bool isStoringResponseContent();
 		
+		sl_uint32 getTimeout();
+		
+		sl_bool isAllowingPipelining();
+		
 		
 		sl_uint64 getSentRequestBodySize();
 		
@@ -274,6 +283,8 @@ namespace slib
 		sl_bool m_flagUseBackgroundSession;
 		sl_bool m_flagSelfAlive;
 		sl_bool m_flagStoreResponseContent;
+		sl_uint32 m_timeout;
+		sl_bool m_flagAllowPipelining;
 		
 		sl_uint64 m_sizeBodySent;
 		sl_uint64 m_sizeContentTotal;
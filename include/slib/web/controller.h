@@ -19,11 +19,67 @@
 
 #define SWEB_HANDLER_PARAMS_LIST const slib::Ref<slib::HttpServiceContext>& context, HttpMethod method, const slib::String& path
 
+#define SLIB_WEB_ROUTER_MAX_PARAMETERS 16
+#define SLIB_WEB_ROUTER_METHODS_COUNT ((sl_uint32)(slib::HttpMethod::TRACE) + 1)
+
 namespace slib
 {
 
 	typedef Function<Variant(SWEB_HANDLER_PARAMS_LIST)> WebHandler;
 
+	class SLIB_EXPORT WebRouteMatch
+	{
+	public:
+		const WebHandler* handler;
+		// names of the captured parameters, in the order of the pattern
+		const String* parameterNames;
+		sl_uint32 countParameters;
+		// captured parameters, pointing into the matched path
+		const sl_char8* parameterValues[SLIB_WEB_ROUTER_MAX_PARAMETERS];
+		sl_size parameterLengths[SLIB_WEB_ROUTER_MAX_PARAMETERS];
+
+	public:
+		WebRouteMatch();
+
+	public:
+		String getParameterValue(sl_uint32 index) const;
+
+	};
+
+	class _WebRouterNode;
+
+	/*
+		Routing tree keyed by the method and then by the path segments.
+
+		Pattern segments:
+			{name}: matches one non-empty segment
+			*name (or *): matches the rest of the path, must be the last segment
+		Static segments take precedence over parameters, and parameters over wildcards.
+		`match()` does not allocate memory.
+	*/
+	class SLIB_EXPORT WebRouter : public Referable
+	{
+		SLIB_DECLARE_OBJECT
+
+	public:
+		WebRouter();
+
+		~WebRouter();
+
+	public:
+		// replaces the handler registered for the same method and pattern
+		sl_bool add(HttpMethod method, const String& pattern, const WebHandler& handler);
+
+		// the pointers in `match` are valid while this router is alive
+		sl_bool match(HttpMethod method, const sl_char8* path, sl_size length, WebRouteMatch& match) const;
+
+		sl_bool match(HttpMethod method, const String& path, WebRouteMatch& match) const;
+
+	protected:
+		_WebRouterNode* m_roots[SLIB_WEB_ROUTER_METHODS_COUNT];
+
+	};
+
 	class WebController : public Object, public IHttpServiceProcessor
 	{
 		SLIB_DECLARE_OBJECT
@@ -42,10 +98,18 @@ namespace slib
 		sl_bool onHttpRequest(const Ref<HttpServiceContext>& context);
 		
 	protected:
-		static String _getHandlerSignature(HttpMethod method, const String& path);
+		// compiles the registered handlers into the router on the first request after registering
+		Ref<WebRouter> _getRouter();
 		
 	protected:
-		TreeMap<String, WebHandler> m_handlers;
+		struct _Handler
+		{
+			HttpMethod method;
+			String path;
+			WebHandler handler;
+		};
+		List<_Handler> m_handlers;
+		AtomicRef<WebRouter> m_router;
 		
 		friend class WebModule;
 		
@@ -91,6 +155,7 @@ namespace SWEB_MODULE_##NAME { \
 	slib::Variant NAME(SWEB_HANDLER_PARAMS_LIST)
 
 #define SWEB_STRING_PARAM(NAME) slib::String NAME = context->getParameter(#NAME);
+#define SWEB_PATH_PARAM(NAME) slib::String NAME = context->getPathParameter(#NAME);
 #define SWEB_INT_PARAM(NAME, ...) sl_int32 NAME = context->getParameter(#NAME).parseInt32(10, ##__VA_ARGS__);
 #define SWEB_INT64_PARAM(NAME, ...) sl_int64 NAME = context->getParameter(#NAME).parseInt64(10, ##__VA_ARGS__);
 #define SWEB_FLOAT_PARAM(NAME, ...) float NAME = context->getParameter(#NAME).parseFloat(##__VA_ARGS__);
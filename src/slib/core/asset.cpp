@@ -11,6 +11,7 @@
 #include "slib/core/asset.h"
 
 #include "slib/core/file.h"
+#include "slib/core/mapped_file.h"
 #include "slib/core/system.h"
 #include "slib/core/app.h"
 
@@ -58,6 +59,16 @@ namespace slib
 		}
 		return ret;
 	}
+
+	Memory Assets::mapAllBytes(const String& path)
+	{
+		Memory ret;
+		String s = Assets::getFilePath(path);
+		if (s.isNotEmpty()) {
+			ret = MappedFile::mapAllBytes(s);
+		}
+		return ret;
+	}
 }
 
 #endif
@@ -82,6 +93,11 @@ namespace slib
 		return Android::readAllBytesFromAsset(path);
 	}
 
+	Memory Assets::mapAllBytes(const String& path)
+	{
+		return Android::readAllBytesFromAsset(path);
+	}
+
 }
 
 #endif
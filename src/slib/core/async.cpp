@@ -10,8 +10,12 @@
 
 #include "slib/core/async.h"
 
+#include "slib/core/system.h"
 #include "slib/core/safe_static.h"
 
+// items taken from each queue in one step, before the events are polled
+#define _SLIB_ASYNC_IO_LOOP_MAX_TASKS_PER_STEP 1024
+
 namespace slib
 {
 
@@ -26,6 +30,8 @@ namespace slib
 		m_flagInit = sl_false;
 		m_flagRunning = sl_false;
 		m_handle = sl_null;
+		m_flagWakePending = 0;
+		m_timeWaitUntil = 0;
 	}
 
 	AsyncIoLoop::~AsyncIoLoop()
@@ -89,9 +95,13 @@ namespace slib
 		
 		_native_closeHandle(m_handle);
 		
+		m_queueTasks.removeAll();
 		m_queueInstancesOrder.removeAll();
 		m_queueInstancesClosing.removeAll();
 		m_queueInstancesClosed.removeAll();
+
+		MutexLocker lockTimers(&m_lockTimers);
+		m_timers.removeAll();
 		
 	}
 
@@ -116,11 +126,16 @@ namespace slib
 	}
 
 	sl_bool AsyncIoLoop::addTask(const Function<void()>& task)
+	{
+		return addTask(InlineFunction<void()>(task));
+	}
+
+	sl_bool AsyncIoLoop::addTask(InlineFunction<void()>&& task)
 	{
 		if (task.isNull()) {
 			return sl_false;
 		}
-		if (m_queueTasks.push(task)) {
+		if (m_queueTasks.push(Move(task))) {
 			wake();
 			return sl_true;
 		}
@@ -129,11 +144,53 @@ namespace slib
 
 	sl_bool AsyncIoLoop::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
 	{
-		return addTask(callback);
+		if (delay_ms == 0) {
+			return addTask(callback);
+		}
+		return setTimeout(callback, delay_ms).isNotNull();
+	}
+
+	Ref<TimerWheelEntry> AsyncIoLoop::setTimeout(InlineFunction<void()>&& task, sl_uint64 delay_ms)
+	{
+		if (task.isNull()) {
+			return sl_null;
+		}
+		Ref<TimerWheelEntry> entry = new TimerWheelEntry(Move(task));
+		if (entry.isNull()) {
+			return sl_null;
+		}
+		sl_uint64 time = getElapsedMilliseconds() + delay_ms;
+		MutexLocker lock(&m_lockTimers);
+		if (!(m_timers.add(entry.get(), time))) {
+			return sl_null;
+		}
+		if (time < m_timeWaitUntil) {
+			m_timeWaitUntil = time;
+			lock.unlock();
+			if (!(m_thread->isCurrentThread())) {
+				wake();
+			}
+		}
+		return entry;
+	}
+
+	sl_bool AsyncIoLoop::clearTimeout(const Ref<TimerWheelEntry>& entry)
+	{
+		MutexLocker lock(&m_lockTimers);
+		return m_timers.remove(entry.get());
+	}
+
+	sl_uint64 AsyncIoLoop::getElapsedMilliseconds()
+	{
+		return m_timeCounter.getElapsedMilliseconds();
 	}
 
 	void AsyncIoLoop::wake()
 	{
+		if (!(Base::interlockedCompareExchange32(&m_flagWakePending, 1, 0))) {
+			// already requested, and the loop has not drained the queues yet
+			return;
+		}
 		ObjectLocker lock(this);
 		if (!m_flagRunning) {
 			return;
@@ -177,27 +234,74 @@ namespace slib
 
 	void AsyncIoLoop::_stepBegin()
 	{
+		// clear before draining: the requests pushed from now will wake the loop again
+		Base::interlockedCompareExchange32(&m_flagWakePending, 0, 1);
+
+		sl_bool flagMore = sl_false;
+
 		// Async Tasks
 		{
-			LinkedQueue< Function<void()> > tasks;
-			tasks.merge(&m_queueTasks);
-			Function<void()> task;
+			InlineFunction<void()> task;
+			sl_uint32 n = 0;
 			while (m_queueTasks.pop(&task)) {
 				task();
+				n++;
+				if (n >= _SLIB_ASYNC_IO_LOOP_MAX_TASKS_PER_STEP) {
+					flagMore = sl_true;
+					break;
+				}
 			}
 		}
 		
 		// Request Orders
 		{
-			LinkedQueue< Ref<AsyncIoInstance> > instances;
-			instances.merge(&m_queueInstancesOrder);
 			Ref<AsyncIoInstance> instance;
-			while (instances.pop(&instance)) {
+			sl_uint32 n = 0;
+			while (m_queueInstancesOrder.pop(&instance)) {
 				if (instance.isNotNull() && instance->isOpened()) {
 					instance->processOrder();
 				}
+				n++;
+				if (n >= _SLIB_ASYNC_IO_LOOP_MAX_TASKS_PER_STEP) {
+					flagMore = sl_true;
+					break;
+				}
 			}
 		}
+
+		if (flagMore) {
+			// poll the events without blocking, and process the rest in the next step
+			wake();
+		}
+	}
+
+	sl_int32 AsyncIoLoop::_getTimeout()
+	{
+		m_timeCounter.update();
+		MutexLocker lock(&m_lockTimers);
+		sl_uint64 now = getElapsedMilliseconds();
+		List< Ref<TimerWheelEntry> > expired;
+		m_timers.advance(now, expired);
+		if (expired.isNotEmpty()) {
+			// the loop does not block until the expired tasks are finished
+			m_timeWaitUntil = now;
+			lock.unlock();
+			ListElements< Ref<TimerWheelEntry> > entries(expired);
+			for (sl_size i = 0; i < entries.count; i++) {
+				entries[i]->getTask()();
+			}
+			return 0;
+		}
+		sl_int64 timeout = m_timers.getTimeout(now);
+		if (timeout < 0) {
+			m_timeWaitUntil = (sl_uint64)-1;
+			return -1;
+		}
+		if (timeout > SLIB_INT32_MAX) {
+			timeout = SLIB_INT32_MAX;
+		}
+		m_timeWaitUntil = now + timeout;
+		return (sl_int32)timeout;
 	}
 
 	void AsyncIoLoop::_stepEnd()
@@ -212,6 +316,91 @@ namespace slib
 		}
 	}
 
+/*************************************
+		AsyncIoLoopGroup
+*************************************/
+
+	SLIB_DEFINE_OBJECT(AsyncIoLoopGroup, Object)
+
+	AsyncIoLoopGroup::AsyncIoLoopGroup()
+	{
+		m_indexNext = 0;
+	}
+
+	AsyncIoLoopGroup::~AsyncIoLoopGroup()
+	{
+		release();
+	}
+
+	Ref<AsyncIoLoopGroup> AsyncIoLoopGroup::create(sl_uint32 nLoops, sl_bool flagAutoStart)
+	{
+		if (nLoops == 0) {
+			nLoops = System::getProcessorsCount();
+			if (nLoops == 0) {
+				nLoops = 1;
+			}
+		}
+		List< Ref<AsyncIoLoop> > loops;
+		for (sl_uint32 i = 0; i < nLoops; i++) {
+			Ref<AsyncIoLoop> loop = AsyncIoLoop::create(flagAutoStart);
+			if (loop.isNull()) {
+				ListElements< Ref<AsyncIoLoop> > created(loops);
+				for (sl_size k = 0; k < created.count; k++) {
+					created[k]->release();
+				}
+				return sl_null;
+			}
+			loops.add_NoLock(loop);
+		}
+		Ref<AsyncIoLoopGroup> ret = new AsyncIoLoopGroup;
+		if (ret.isNotNull()) {
+			ret->m_loops = loops;
+			return ret;
+		}
+		return sl_null;
+	}
+
+	void AsyncIoLoopGroup::release()
+	{
+		ListElements< Ref<AsyncIoLoop> > loops(m_loops);
+		for (sl_size i = 0; i < loops.count; i++) {
+			loops[i]->release();
+		}
+	}
+
+	void AsyncIoLoopGroup::start()
+	{
+		ListElements< Ref<AsyncIoLoop> > loops(m_loops);
+		for (sl_size i = 0; i < loops.count; i++) {
+			loops[i]->start();
+		}
+	}
+
+	sl_uint32 AsyncIoLoopGroup::getLoopsCount()
+	{
+		return (sl_uint32)(m_loops.getCount());
+	}
+
+	Ref<AsyncIoLoop> AsyncIoLoopGroup::getLoop(sl_uint32 index)
+	{
+		return m_loops.getValueAt(index);
+	}
+
+	List< Ref<AsyncIoLoop> > AsyncIoLoopGroup::getLoops()
+	{
+		return m_loops;
+	}
+
+	Ref<AsyncIoLoop> AsyncIoLoopGroup::getNextLoop()
+	{
+		sl_size n = m_loops.getCount();
+		if (n == 0) {
+			return sl_null;
+		}
+		sl_size index = (sl_size)(Base::interlockedIncrement(&m_indexNext));
+		return m_loops.getValueAt(index % n);
+	}
+
 /*************************************
 		AsyncIoInstance
 **************************************/
@@ -284,7 +473,7 @@ namespace slib
 		m_flagClosing = sl_true;
 	}
 
-	void AsyncIoInstance::addToQueue(LinkedQueue< Ref<AsyncIoInstance> >& queue)
+	void AsyncIoInstance::addToQueue(MpscQueue< Ref<AsyncIoInstance> >& queue)
 	{
 		MutexLocker lock(&m_lockOrdering);
 		if (!m_flagOrdering) {
@@ -384,7 +573,7 @@ namespace slib
 		Referable* _userObject,
 		const Function<void(AsyncStreamResult*)>& _callback,
 		sl_bool _flagRead)
-	 : data(_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead)
+	 : data(_data), size(_size), userObject(_userObject), callback(_callback), flagRead(_flagRead), offsetFile(0)
 	{
 	}
 
@@ -406,6 +595,24 @@ namespace slib
 		return new AsyncStreamRequest(data, size, userObject, callback, sl_false);
 	}
 
+	Ref<AsyncStreamRequest> AsyncStreamRequest::createSendFile(
+		const Ref<File>& file,
+		sl_uint64 offset,
+		sl_uint32 size,
+		Referable* userObject,
+		const Function<void(AsyncStreamResult*)>& callback)
+	{
+		if (file.isNull()) {
+			return sl_null;
+		}
+		Ref<AsyncStreamRequest> ret = new AsyncStreamRequest(sl_null, size, userObject, callback, sl_false);
+		if (ret.isNotNull()) {
+			ret->file = file;
+			ret->offsetFile = offset;
+		}
+		return ret;
+	}
+
 	void AsyncStreamRequest::runCallback(AsyncStream* stream, sl_uint32 resultSize, sl_bool flagError)
 	{
 		if (callback.isNotNull()) {
@@ -451,8 +658,7 @@ namespace slib
 		}
 		Ref<AsyncStreamRequest> req = AsyncStreamRequest::createWrite(data, size, userObject, callback);
 		if (req.isNotNull()) {
-			m_requestsWrite.push(req);
-			return sl_true;
+			return addWriteRequest(req);
 		}
 		return sl_false;
 	}
@@ -472,6 +678,26 @@ namespace slib
 		return 0;
 	}
 
+	sl_bool AsyncStreamInstance::isSupportingSendFile()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamInstance::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		if (size == 0) {
+			return sl_false;
+		}
+		if (!(isSupportingSendFile())) {
+			return sl_false;
+		}
+		Ref<AsyncStreamRequest> req = AsyncStreamRequest::createSendFile(file, offset, size, userObject, callback);
+		if (req.isNotNull()) {
+			return addWriteRequest(req);
+		}
+		return sl_false;
+	}
+
 	sl_size AsyncStreamInstance::getWaitingSizeForWrite()
 	{
 		return m_sizeWriteWaiting;
@@ -529,6 +755,16 @@ namespace slib
 	{
 	}
 
+	sl_bool AsyncStream::isSupportingSendFile()
+	{
+		return sl_false;
+	}
+
+	sl_bool AsyncStream::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		return sl_false;
+	}
+
 	Ref<AsyncStream> AsyncStream::create(AsyncStreamInstance* instance, AsyncIoMode mode, const Ref<AsyncIoLoop>& loop)
 	{
 		Ref<AsyncStreamBase> ret;
@@ -701,6 +937,31 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool AsyncStreamBase::isSupportingSendFile()
+	{
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			return instance->isSupportingSendFile();
+		}
+		return sl_false;
+	}
+
+	sl_bool AsyncStreamBase::sendFile(const Ref<File>& file, sl_uint64 offset, sl_uint32 size, const Function<void(AsyncStreamResult*)>& callback, Referable* userObject)
+	{
+		Ref<AsyncIoLoop> loop = getIoLoop();
+		if (loop.isNull()) {
+			return sl_false;
+		}
+		Ref<AsyncStreamInstance> instance = getIoInstance();
+		if (instance.isNotNull()) {
+			if (instance->sendFile(file, offset, size, callback, userObject)) {
+				loop->requestOrder(instance.get());
+				return sl_true;
+			}
+		}
+		return sl_false;
+	}
+
 	sl_size AsyncStreamBase::getWaitingSizeForWrite()
 	{
 		Ref<AsyncStreamInstance> instance = getIoInstance();
@@ -1607,6 +1868,24 @@ namespace slib
 		return m_lengthOutput;
 	}
 
+	sl_bool AsyncOutputBuffer::getMemoryOutput(List<Memory>& output)
+	{
+		ObjectLocker lock(this);
+		Link< Ref<AsyncOutputBufferElement> >* link = m_queueOutput.getFront();
+		while (link) {
+			AsyncOutputBufferElement* element = link->value.get();
+			if (!(element->isEmptyBody())) {
+				return sl_false;
+			}
+			Memory mem = element->getHeader().merge();
+			if (mem.isNotEmpty()) {
+				output.add_NoLock(mem);
+			}
+			link = link->next;
+		}
+		return sl_true;
+	}
+
 /**********************************************
 				AsyncOutput
 **********************************************/
@@ -1645,6 +1924,9 @@ namespace slib
 
 		m_bufferCount = 1;
 		m_bufferSize = 0x10000;
+
+		m_offsetFileSending = 0;
+		m_sizeFileSending = 0;
 	}
 
 	AsyncOutput::~AsyncOutput()
@@ -1664,6 +1946,7 @@ namespace slib
 			copy->close();
 		}
 		m_copy.setNull();
+		m_fileSending.setNull();
 		m_streamOutput.setNull();
 	}
 
@@ -1701,6 +1984,12 @@ namespace slib
 		_write(sl_false);
 	}
 
+	sl_bool AsyncOutput::isWriting()
+	{
+		ObjectLocker lock(this);
+		return m_flagWriting || m_elementWriting.isNotNull() || m_queueOutput.isNotEmpty();
+	}
+
 	void AsyncOutput::_write(sl_bool flagCompleted)
 	{
 		ObjectLocker lock(this);
@@ -1741,6 +2030,9 @@ namespace slib
 			if (sizeBody != 0 && body.isNotNull()) {
 				m_flagWriting = sl_true;
 				m_elementWriting.setNull();
+				if (_startSendFile(body.get(), sizeBody)) {
+					return;
+				}
 				AsyncCopyParam param;
 				param.source = body;
 				param.target = m_streamOutput;
@@ -1759,6 +2051,70 @@ namespace slib
 		}
 	}
 
+#define ASYNC_OUTPUT_SEND_FILE_CHUNK_SIZE 0x1000000
+
+	sl_bool AsyncOutput::_startSendFile(AsyncStream* body, sl_uint64 size)
+	{
+		if (!(m_streamOutput->isSupportingSendFile())) {
+			return sl_false;
+		}
+		AsyncFile* asyncFile = CastInstance<AsyncFile>(body);
+		if (!asyncFile) {
+			return sl_false;
+		}
+		Ref<File> file = asyncFile->getFile();
+		if (file.isNull()) {
+			return sl_false;
+		}
+		m_fileSending = file;
+		m_offsetFileSending = file->getPosition();
+		m_sizeFileSending = size;
+		_sendFile();
+		return sl_true;
+	}
+
+	void AsyncOutput::_sendFile()
+	{
+		Ref<AsyncStream> stream = m_streamOutput;
+		if (stream.isNotNull()) {
+			sl_uint32 size = ASYNC_OUTPUT_SEND_FILE_CHUNK_SIZE;
+			if (m_sizeFileSending < size) {
+				size = (sl_uint32)m_sizeFileSending;
+			}
+			if (stream->sendFile(m_fileSending, m_offsetFileSending, size, SLIB_FUNCTION_WEAKREF(AsyncOutput, onSendFile, this))) {
+				return;
+			}
+		}
+		m_fileSending.setNull();
+		m_flagWriting = sl_false;
+		_onError();
+	}
+
+	void AsyncOutput::onSendFile(AsyncStreamResult* result)
+	{
+		ObjectLocker lock(this);
+		if (m_flagClosed) {
+			return;
+		}
+		if (result->flagError || result->size == 0) {
+			m_fileSending.setNull();
+			m_flagWriting = sl_false;
+			lock.unlock();
+			_onError();
+			return;
+		}
+		m_offsetFileSending += result->size;
+		m_sizeFileSending -= result->size;
+		if (m_sizeFileSending > 0) {
+			_sendFile();
+			return;
+		}
+		m_fileSending.setNull();
+		m_flagWriting = sl_false;
+		lock.unlock();
+		_write(sl_true);
+	}
+
 	void AsyncOutput::onAsyncCopyExit(AsyncCopy* task)
 	{
 		m_flagWriting = sl_false;
@@ -80,7 +80,7 @@ namespace slib
 
 			_stepBegin();
 
-			int nEvents = ::epoll_wait(handle->fdEpoll, waitEvents, ASYNC_MAX_WAIT_EVENT, -1);
+			int nEvents = ::epoll_wait(handle->fdEpoll, waitEvents, ASYNC_MAX_WAIT_EVENT, _getTimeout());
 			if (nEvents == 0) {
 				m_queueInstancesClosed.removeAll();
 			}
@@ -85,7 +85,8 @@ namespace slib
 
 			DWORD nCount = 0;
 			
-			if (!fGetQueuedCompletionStatusEx(handle->hCompletionPort, entries, ASYNC_MAX_WAIT_EVENT, &nCount, INFINITE, FALSE)) {
+			sl_int32 timeout = _getTimeout();
+			if (!fGetQueuedCompletionStatusEx(handle->hCompletionPort, entries, ASYNC_MAX_WAIT_EVENT, &nCount, timeout >= 0 ? (DWORD)timeout : INFINITE, FALSE)) {
 				nCount = 0;
 			}
 			if (nCount == 0) {
@@ -0,0 +1,708 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/buffered_io.h"
+
+#include "slib/core/base.h"
+#include "slib/core/thread.h"
+
+// large enough for any fixed-width value and CVLI
+#define _BUFFERED_IO_MIN_SIZE 16
+
+namespace slib
+{
+
+	// reads at least one byte, waiting while the stream has no data
+	static sl_reg _BufferedIO_readSome(IReader* reader, void* buf, sl_size size)
+	{
+		for (;;) {
+			sl_reg n = reader->read(buf, size);
+			if (n) {
+				return n;
+			}
+			if (Thread::isStoppingCurrent()) {
+				return -1;
+			}
+			Thread::sleep(1);
+			if (Thread::isStoppingCurrent()) {
+				return -1;
+			}
+		}
+	}
+
+	static sl_uint8* _BufferedIO_createBuffer(sl_size& size)
+	{
+		if (size < _BUFFERED_IO_MIN_SIZE) {
+			size = _BUFFERED_IO_MIN_SIZE;
+		}
+		return (sl_uint8*)(Base::createMemory(size));
+	}
+
+/***************
+	BufferedReader
+***************/
+
+	SLIB_DEFINE_OBJECT(BufferedReader, Object)
+
+	BufferedReader::BufferedReader()
+	{
+		m_buf = sl_null;
+		m_size = 0;
+		m_pos = 0;
+		m_end = 0;
+	}
+
+	BufferedReader::~BufferedReader()
+	{
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+		}
+	}
+
+	Ref<BufferedReader> BufferedReader::create(const Ptr<IReader>& reader, sl_size bufferSize)
+	{
+		if (reader.isNotNull()) {
+			sl_uint8* buf = _BufferedIO_createBuffer(bufferSize);
+			if (buf) {
+				Ref<BufferedReader> ret = new BufferedReader;
+				if (ret.isNotNull()) {
+					ret->m_reader = reader;
+					ret->m_buf = buf;
+					ret->m_size = bufferSize;
+					return ret;
+				}
+				Base::freeMemory(buf);
+			}
+		}
+		return sl_null;
+	}
+
+	Ptr<IReader> BufferedReader::getReader()
+	{
+		return m_reader;
+	}
+
+	sl_size BufferedReader::getBufferSize()
+	{
+		return m_size;
+	}
+
+	void BufferedReader::close()
+	{
+		m_reader.setNull();
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+			m_buf = sl_null;
+		}
+		m_size = 0;
+		m_pos = 0;
+		m_end = 0;
+	}
+
+	sl_reg BufferedReader::read(void* buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		sl_size n = m_end - m_pos;
+		if (n) {
+			if (n > size) {
+				n = size;
+			}
+			Base::copyMemory(buf, m_buf + m_pos, n);
+			m_pos += n;
+			return n;
+		}
+		if (m_reader.isNull()) {
+			return -1;
+		}
+		m_pos = 0;
+		m_end = 0;
+		if (size >= m_size) {
+			return m_reader->read(buf, size);
+		}
+		sl_reg m = m_reader->read(m_buf, m_size);
+		if (m <= 0) {
+			return m;
+		}
+		m_end = m;
+		n = m;
+		if (n > size) {
+			n = size;
+		}
+		Base::copyMemory(buf, m_buf, n);
+		m_pos = n;
+		return n;
+	}
+
+	const void* BufferedReader::peek(sl_size* size)
+	{
+		if (m_pos == m_end) {
+			if (!(_fill(1))) {
+				*size = 0;
+				return sl_null;
+			}
+		}
+		*size = m_end - m_pos;
+		return m_buf + m_pos;
+	}
+
+	sl_uint64 BufferedReader::skip(sl_uint64 size)
+	{
+		sl_uint64 nSkipped = 0;
+		for (;;) {
+			sl_size n = m_end - m_pos;
+			if (n >= size) {
+				m_pos += (sl_size)size;
+				return nSkipped + size;
+			}
+			nSkipped += n;
+			size -= n;
+			m_pos = m_end;
+			if (!(_fill(1))) {
+				return nSkipped;
+			}
+		}
+	}
+
+	sl_bool BufferedReader::_fill(sl_size size)
+	{
+		if (m_reader.isNull() || size > m_size) {
+			return sl_false;
+		}
+		if (m_pos == m_end) {
+			m_pos = 0;
+			m_end = 0;
+		} else if (m_size - m_pos < size) {
+			m_end -= m_pos;
+			Base::moveMemory(m_buf, m_buf + m_pos, m_end);
+			m_pos = 0;
+		}
+		while (m_end - m_pos < size) {
+			sl_reg m = _BufferedIO_readSome(m_reader._ptr, m_buf + m_end, m_size - m_end);
+			if (m <= 0) {
+				return sl_false;
+			}
+			m_end += m;
+		}
+		return sl_true;
+	}
+
+	sl_bool BufferedReader::_readSlow(void* _buf, sl_size size)
+	{
+		sl_uint8* buf = (sl_uint8*)_buf;
+		for (;;) {
+			sl_size n = m_end - m_pos;
+			if (n >= size) {
+				Base::copyMemory(buf, m_buf + m_pos, size);
+				m_pos += size;
+				return sl_true;
+			}
+			if (n) {
+				Base::copyMemory(buf, m_buf + m_pos, n);
+				buf += n;
+				size -= n;
+			}
+			m_pos = 0;
+			m_end = 0;
+			if (m_reader.isNull()) {
+				return sl_false;
+			}
+			if (size >= m_size) {
+				return m_reader->readFully(buf, size) == (sl_reg)size;
+			}
+			sl_reg m = _BufferedIO_readSome(m_reader._ptr, m_buf, m_size);
+			if (m <= 0) {
+				return sl_false;
+			}
+			m_end = m;
+		}
+	}
+
+	sl_bool BufferedReader::_readUint32CVLI(sl_uint32* output)
+	{
+		sl_uint32 v = 0;
+		int m = 0;
+		while (1) {
+			if (m_pos == m_end) {
+				if (!(_fill(1))) {
+					return sl_false;
+				}
+			}
+			sl_uint8 n = m_buf[m_pos];
+			m_pos++;
+			v += (((sl_uint32)(n & 127)) << m);
+			m += 7;
+			if ((n & 128) == 0) {
+				break;
+			}
+		}
+		*output = v;
+		return sl_true;
+	}
+
+	sl_bool BufferedReader::_readUint64CVLI(sl_uint64* output)
+	{
+		sl_uint64 v = 0;
+		int m = 0;
+		while (1) {
+			if (m_pos == m_end) {
+				if (!(_fill(1))) {
+					return sl_false;
+				}
+			}
+			sl_uint8 n = m_buf[m_pos];
+			m_pos++;
+			v += (((sl_uint64)(n & 127)) << m);
+			m += 7;
+			if ((n & 128) == 0) {
+				break;
+			}
+		}
+		*output = v;
+		return sl_true;
+	}
+
+/***************
+	BufferedWriter
+***************/
+
+	SLIB_DEFINE_OBJECT(BufferedWriter, Object)
+
+	BufferedWriter::BufferedWriter()
+	{
+		m_buf = sl_null;
+		m_size = 0;
+		m_pos = 0;
+	}
+
+	BufferedWriter::~BufferedWriter()
+	{
+		flush();
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+		}
+	}
+
+	Ref<BufferedWriter> BufferedWriter::create(const Ptr<IWriter>& writer, sl_size bufferSize)
+	{
+		if (writer.isNotNull()) {
+			sl_uint8* buf = _BufferedIO_createBuffer(bufferSize);
+			if (buf) {
+				Ref<BufferedWriter> ret = new BufferedWriter;
+				if (ret.isNotNull()) {
+					ret->m_writer = writer;
+					ret->m_buf = buf;
+					ret->m_size = bufferSize;
+					return ret;
+				}
+				Base::freeMemory(buf);
+			}
+		}
+		return sl_null;
+	}
+
+	Ptr<IWriter> BufferedWriter::getWriter()
+	{
+		return m_writer;
+	}
+
+	sl_size BufferedWriter::getBufferSize()
+	{
+		return m_size;
+	}
+
+	sl_bool BufferedWriter::close()
+	{
+		sl_bool flagSuccess = flush();
+		m_writer.setNull();
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+			m_buf = sl_null;
+		}
+		m_size = 0;
+		return flagSuccess;
+	}
+
+	sl_bool BufferedWriter::flush()
+	{
+		if (!m_pos) {
+			return sl_true;
+		}
+		sl_size size = m_pos;
+		m_pos = 0;
+		if (m_writer.isNotNull()) {
+			return m_writer->writeFully(m_buf, size) == (sl_reg)size;
+		}
+		return sl_false;
+	}
+
+	sl_reg BufferedWriter::write(const void* buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		if (m_writer.isNull()) {
+			return -1;
+		}
+		if (m_size - m_pos >= size) {
+			Base::copyMemory(m_buf + m_pos, buf, size);
+			m_pos += size;
+			return size;
+		}
+		if (!(flush())) {
+			return -1;
+		}
+		if (size >= m_size) {
+			return m_writer->write(buf, size);
+		}
+		Base::copyMemory(m_buf, buf, size);
+		m_pos = size;
+		return size;
+	}
+
+	sl_bool BufferedWriter::_writeSlow(const void* buf, sl_size size)
+	{
+		return write(buf, size) == (sl_reg)size;
+	}
+
+	sl_bool BufferedWriter::_writeUint32CVLI(sl_uint32 value)
+	{
+		if (m_size - m_pos < 5) {
+			if (!(flush()) || m_size < 5) {
+				return sl_false;
+			}
+		}
+		sl_uint8* p = m_buf + m_pos;
+		do {
+			sl_uint8 n = ((sl_uint8)value) & 127;
+			value = value >> 7;
+			if (value != 0) {
+				n |= 128;
+			}
+			*(p++) = n;
+		} while (value);
+		m_pos = p - m_buf;
+		return sl_true;
+	}
+
+	sl_bool BufferedWriter::_writeUint64CVLI(sl_uint64 value)
+	{
+		if (m_size - m_pos < 10) {
+			if (!(flush()) || m_size < 10) {
+				return sl_false;
+			}
+		}
+		sl_uint8* p = m_buf + m_pos;
+		do {
+			sl_uint8 n = ((sl_uint8)value) & 127;
+			value = value >> 7;
+			if (value != 0) {
+				n |= 128;
+			}
+			*(p++) = n;
+		} while (value);
+		m_pos = p - m_buf;
+		return sl_true;
+	}
+
+/***************
+	BufferedIO
+***************/
+
+	SLIB_DEFINE_OBJECT(BufferedIO, IO)
+
+	BufferedIO::BufferedIO()
+	{
+		m_buf = sl_null;
+		m_size = 0;
+		m_pos = 0;
+		m_end = 0;
+		m_offset = 0;
+		m_flagWriting = sl_false;
+	}
+
+	BufferedIO::~BufferedIO()
+	{
+		flush();
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+		}
+	}
+
+	Ref<BufferedIO> BufferedIO::create(const Ref<IO>& io, sl_size bufferSize)
+	{
+		if (io.isNotNull()) {
+			sl_uint8* buf = _BufferedIO_createBuffer(bufferSize);
+			if (buf) {
+				Ref<BufferedIO> ret = new BufferedIO;
+				if (ret.isNotNull()) {
+					ret->m_io = io;
+					ret->m_buf = buf;
+					ret->m_size = bufferSize;
+					ret->m_offset = io->getPosition();
+					return ret;
+				}
+				Base::freeMemory(buf);
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<IO> BufferedIO::getIO()
+	{
+		return m_io;
+	}
+
+	sl_size BufferedIO::getBufferSize()
+	{
+		return m_size;
+	}
+
+	sl_bool BufferedIO::flush()
+	{
+		if (!m_flagWriting || !m_pos) {
+			return sl_true;
+		}
+		sl_size size = m_pos;
+		m_pos = 0;
+		if (m_io.isNotNull()) {
+			sl_reg n = m_io->writeFully(m_buf, size);
+			if (n > 0) {
+				m_offset += n;
+			}
+			return n == (sl_reg)size;
+		}
+		return sl_false;
+	}
+
+	sl_reg BufferedIO::read(void* buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		if (m_flagWriting) {
+			if (!(_sync())) {
+				return -1;
+			}
+		}
+		sl_size n = m_end - m_pos;
+		if (n) {
+			if (n > size) {
+				n = size;
+			}
+			Base::copyMemory(buf, m_buf + m_pos, n);
+			m_pos += n;
+			return n;
+		}
+		if (m_io.isNull()) {
+			return -1;
+		}
+		m_offset += m_end;
+		m_pos = 0;
+		m_end = 0;
+		if (size >= m_size) {
+			sl_reg m = m_io->read(buf, size);
+			if (m > 0) {
+				m_offset += m;
+			}
+			return m;
+		}
+		sl_reg m = m_io->read(m_buf, m_size);
+		if (m <= 0) {
+			return m;
+		}
+		m_end = m;
+		n = m;
+		if (n > size) {
+			n = size;
+		}
+		Base::copyMemory(buf, m_buf, n);
+		m_pos = n;
+		return n;
+	}
+
+	sl_reg BufferedIO::write(const void* buf, sl_size size)
+	{
+		if (!size) {
+			return 0;
+		}
+		if (m_io.isNull()) {
+			return -1;
+		}
+		if (!m_flagWriting) {
+			if (!(_sync())) {
+				return -1;
+			}
+			m_flagWriting = sl_true;
+		}
+		if (m_size - m_pos >= size) {
+			Base::copyMemory(m_buf + m_pos, buf, size);
+			m_pos += size;
+			return size;
+		}
+		if (!(flush())) {
+			return -1;
+		}
+		if (size >= m_size) {
+			sl_reg m = m_io->write(buf, size);
+			if (m > 0) {
+				m_offset += m;
+			}
+			return m;
+		}
+		Base::copyMemory(m_buf, buf, size);
+		m_pos = size;
+		return size;
+	}
+
+	sl_uint64 BufferedIO::getPosition()
+	{
+		return m_offset + m_pos;
+	}
+
+	sl_uint64 BufferedIO::getSize()
+	{
+		if (m_io.isNull()) {
+			return 0;
+		}
+		sl_uint64 size = m_io->getSize();
+		if (m_flagWriting) {
+			sl_uint64 end = m_offset + m_pos;
+			if (end > size) {
+				size = end;
+			}
+		}
+		return size;
+	}
+
+	sl_bool BufferedIO::seek(sl_int64 offset, SeekPosition pos)
+	{
+		if (m_io.isNull()) {
+			return sl_false;
+		}
+		sl_int64 base = 0;
+		if (pos == SeekPosition::Current) {
+			base = (sl_int64)(getPosition());
+		} else if (pos == SeekPosition::End) {
+			base = (sl_int64)(getSize());
+		}
+		if (offset < -base) {
+			return sl_false;
+		}
+		sl_uint64 target = (sl_uint64)(base + offset);
+		if (!m_flagWriting && target >= m_offset && target <= m_offset + m_end) {
+			m_pos = (sl_size)(target - m_offset);
+			return sl_true;
+		}
+		sl_bool flagSuccess = flush();
+		m_flagWriting = sl_false;
+		m_pos = 0;
+		m_end = 0;
+		if (m_io->seek(target, SeekPosition::Begin)) {
+			m_offset = target;
+			return flagSuccess;
+		}
+		m_offset = m_io->getPosition();
+		return sl_false;
+	}
+
+	sl_bool BufferedIO::setSize(sl_uint64 size)
+	{
+		if (m_io.isNull()) {
+			return sl_false;
+		}
+		if (!(_sync())) {
+			return sl_false;
+		}
+		sl_bool flagSuccess = m_io->setSize(size);
+		// some streams move the position into the new size
+		m_offset = m_io->getPosition();
+		return flagSuccess;
+	}
+
+	void BufferedIO::close()
+	{
+		if (m_io.isNotNull()) {
+			_sync();
+			m_io->close();
+			m_io.setNull();
+		}
+		if (m_buf) {
+			Base::freeMemory(m_buf);
+			m_buf = sl_null;
+		}
+		m_size = 0;
+		m_pos = 0;
+		m_end = 0;
+		m_flagWriting = sl_false;
+	}
+
+	const void* BufferedIO::peek(sl_size* size)
+	{
+		if (m_flagWriting || m_pos == m_end) {
+			if (!(_fill(1))) {
+				*size = 0;
+				return sl_null;
+			}
+		}
+		*size = m_end - m_pos;
+		return m_buf + m_pos;
+	}
+
+	sl_bool BufferedIO::_sync()
+	{
+		if (m_flagWriting) {
+			sl_bool flagSuccess = flush();
+			m_flagWriting = sl_false;
+			return flagSuccess;
+		}
+		if (m_pos != m_end) {
+			if (!(m_io->seek(m_offset + m_pos, SeekPosition::Begin))) {
+				return sl_false;
+			}
+		}
+		m_offset += m_pos;
+		m_pos = 0;
+		m_end = 0;
+		return sl_true;
+	}
+
+	sl_bool BufferedIO::_fill(sl_size size)
+	{
+		if (m_io.isNull() || size > m_size) {
+			return sl_false;
+		}
+		if (m_flagWriting) {
+			if (!(_sync())) {
+				return sl_false;
+			}
+		}
+		if (m_pos == m_end) {
+			m_offset += m_end;
+			m_pos = 0;
+			m_end = 0;
+		} else if (m_size - m_pos < size) {
+			m_offset += m_pos;
+			m_end -= m_pos;
+			Base::moveMemory(m_buf, m_buf + m_pos, m_end);
+			m_pos = 0;
+		}
+		while (m_end - m_pos < size) {
+			sl_reg m = _BufferedIO_readSome(m_io.get(), m_buf + m_end, m_size - m_end);
+			if (m <= 0) {
+				return sl_false;
+			}
+			m_end += m;
+		}
+		return sl_true;
+	}
+
+}
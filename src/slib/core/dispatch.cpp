@@ -14,6 +14,10 @@
 #include "slib/core/safe_static.h"
 #include "slib/core/system.h"
 
+// tasks run in one step before the timers are checked
+#define _SLIB_DISPATCH_LOOP_MAX_TASKS_PER_STEP 1024
+#define _SLIB_DISPATCH_LOOP_MAX_WAIT 10000
+
 namespace slib
 {
 
@@ -84,6 +88,8 @@ namespace slib
 	{
 		m_flagInit = sl_false;
 		m_flagRunning = sl_false;
+		m_flagWakePending = 0;
+		m_timeWaitUntil = 0;
 	}
 
 	DispatchLoop::~DispatchLoop()
@@ -112,6 +118,10 @@ namespace slib
 	{
 		Ref<DispatchLoop> ret = new DispatchLoop;
 		if (ret.isNotNull()) {
+			ret->m_eventWake = Event::create();
+			if (ret->m_eventWake.isNull()) {
+				return sl_null;
+			}
 			ret->m_thread = Thread::create(SLIB_FUNCTION_CLASS(DispatchLoop, _runLoop, ret.get()));
 			if (ret->m_thread.isNotNull()) {
 				ret->m_flagInit = sl_true;
@@ -140,8 +150,8 @@ namespace slib
 
 		m_queueTasks.removeAll();
 		
-		MutexLocker lockTime(&m_lockTimeTasks);
-		m_timeTasks.removeAll();
+		MutexLocker lockTimers(&m_lockTimers);
+		m_timers.removeAll();
 	}
 
 	void DispatchLoop::start()
@@ -170,129 +180,119 @@ namespace slib
 		if (!m_flagRunning) {
 			return;
 		}
-		m_thread->wake();
+		m_eventWake->set();
 	}
 
 	sl_int32 DispatchLoop::_getTimeout()
 	{
 		m_timeCounter.update();
-		if (m_queueTasks.isNotEmpty()) {
+		sl_int32 timeout = _getTimeout_Timers();
+		if (!(m_queueTasks.isEmpty())) {
 			return 0;
 		}
-		sl_int32 t1 = _getTimeout_TimeTasks();
-		sl_int32 t2 = _getTimeout_Timer();
-		if (t1 < 0) {
-			return t2;
-		} else {
-			if (t2 < 0) {
-				return t1;
-			} else {
-				return SLIB_MIN(t1, t2);
-			}
-		}
+		return timeout;
 	}
 
 	sl_bool DispatchLoop::dispatch(const Function<void()>& task, sl_uint64 delay_ms)
+	{
+		return dispatch(InlineFunction<void()>(task), delay_ms);
+	}
+
+	sl_bool DispatchLoop::dispatch(InlineFunction<void()>&& task, sl_uint64 delay_ms)
 	{
 		if (task.isNull()) {
 			return sl_false;
 		}
 		if (delay_ms == 0) {
-			if (m_queueTasks.push(task)) {
-				_wake();
+			if (m_queueTasks.push(Move(task))) {
+				if (Base::interlockedCompareExchange32(&m_flagWakePending, 1, 0)) {
+					_wake();
+				}
 				return sl_true;
 			}
 		} else {
-			MutexLocker lock(&m_lockTimeTasks);
-			TimeTask tt;
-			tt.time = getElapsedMilliseconds() + delay_ms;
-			tt.task = task;
-			if (m_timeTasks.put(tt.time, tt, MapPutMode::AddAlways)) {
-				_wake();
-				return sl_true;
-			}
+			return setTimeout(Move(task), delay_ms).isNotNull();
 		}
 		return sl_false;
 	}
 
-	sl_int32 DispatchLoop::_getTimeout_TimeTasks()
+	Ref<TimerWheelEntry> DispatchLoop::setTimeout(InlineFunction<void()>&& task, sl_uint64 delay_ms)
 	{
-		MutexLocker lock(&m_lockTimeTasks);
-		sl_uint64 rel = getElapsedMilliseconds();
-		if (m_timeTasks.getCount() == 0) {
-			return -1;
+		if (task.isNull()) {
+			return sl_null;
 		}
-		sl_int32 timeout = -1;
-		BTreePosition pos;
-		TimeTask timeTask;
-		LinkedQueue< Function<void()> > tasks;
-		sl_uint64 t;
-		while (m_timeTasks.getFirstPosition(pos, &t, &timeTask)) {
-			if (rel >= t) {
-				tasks.push(timeTask.task);
-				m_timeTasks.removeAt(pos);
-			} else {
-				t = t - rel;
-				timeout = (sl_int32)t;
-				break;
+		Ref<TimerWheelEntry> entry = new TimerWheelEntry(Move(task));
+		if (entry.isNotNull()) {
+			if (_addTimeout(entry.get(), getElapsedMilliseconds() + delay_ms)) {
+				return entry;
 			}
 		}
-		lock.unlock();
+		return sl_null;
+	}
 
-		Function<void()> task;
-		while (tasks.pop(&task)) {
-			task();
-		}
-		return timeout;
+	sl_bool DispatchLoop::clearTimeout(const Ref<TimerWheelEntry>& entry)
+	{
+		MutexLocker lock(&m_lockTimers);
+		return m_timers.remove(entry.get());
 	}
 
-	sl_int32 DispatchLoop::_getTimeout_Timer()
+	sl_bool DispatchLoop::_addTimeout(TimerWheelEntry* entry, sl_uint64 time)
 	{
-		MutexLocker lock(&m_lockTimer);
-
-		sl_int32 timeout = -1;
-		LinkedQueue< Ref<Timer> > tasks;
-
-		sl_uint64 rel = getElapsedMilliseconds();
-		Link<TimerTask>* link = m_queueTimers.getFront();
-		while (link) {
-			Ref<Timer> timer(link->value.timer);
-			if (timer.isNotNull()) {
-				if (timer->isStarted()) {
-					sl_uint64 t = rel - timer->getLastRunTime();
-					if (t >= timer->getInterval()) {
-						tasks.push(timer);
-						timer->setLastRunTime(rel);
-						t = timer->getInterval();
-					} else {
-						t = timer->getInterval() - t;
-					}
-					if (timeout < 0 || t < (sl_uint64)timeout) {
-						timeout = (sl_uint32)t;
-					}
-				}
-				link = link->next;
-			} else {
-				Link<TimerTask>* linkRemove = link;
-				link = link->next;
-				m_queueTimers.removeItem(linkRemove);
+		MutexLocker lock(&m_lockTimers);
+		if (!(m_timers.add(entry, time))) {
+			return sl_false;
+		}
+		if (time < m_timeWaitUntil) {
+			m_timeWaitUntil = time;
+			lock.unlock();
+			if (!(m_thread->isCurrentThread())) {
+				_wake();
 			}
 		}
+		return sl_true;
+	}
 
-		lock.unlock();
-
-		Ref<Timer> task;
-		while (tasks.pop(&task)) {
-			if (task.isNotNull()) {
-				task->run();
+	sl_int32 DispatchLoop::_getTimeout_Timers()
+	{
+		MutexLocker lock(&m_lockTimers);
+		sl_uint64 now = getElapsedMilliseconds();
+		List< Ref<TimerWheelEntry> > expired;
+		m_timers.advance(now, expired);
+		if (expired.isNotEmpty()) {
+			// the loop does not sleep until the expired tasks are finished
+			m_timeWaitUntil = now;
+			lock.unlock();
+			ListElements< Ref<TimerWheelEntry> > entries(expired);
+			for (sl_size i = 0; i < entries.count; i++) {
+				entries[i]->getTask()();
 			}
+			return 0;
 		}
-		return timeout;
+		sl_int64 timeout = m_timers.getTimeout(now);
+		if (timeout < 0 || timeout > _SLIB_DISPATCH_LOOP_MAX_WAIT) {
+			timeout = _SLIB_DISPATCH_LOOP_MAX_WAIT;
+		}
+		m_timeWaitUntil = now + timeout;
+		return (sl_int32)timeout;
 	}
 
-	sl_bool DispatchLoop::TimerTask::operator==(const DispatchLoop::TimerTask& other) const
+	void DispatchLoop::_runTimer(const WeakRef<Timer>& _timer)
 	{
-		return timer == other.timer;
+		Ref<Timer> timer(_timer);
+		if (timer.isNull()) {
+			return;
+		}
+		sl_uint64 now = getElapsedMilliseconds();
+		timer->setLastRunTime(now);
+		timer->run();
+		if (timer->isStarted()) {
+			MutexLocker lock(&m_lockTimers);
+			Ref<TimerWheelEntry> entry = timer->m_entryLoop;
+			// not rescheduled when the timer is stopped, or restarted with a new entry while running
+			if (entry.isNotNull() && !(entry->isScheduled())) {
+				m_timers.add(entry.get(), now + timer->getInterval());
+			}
+		}
 	}
 
 	sl_bool DispatchLoop::addTimer(const Ref<Timer>& timer)
@@ -300,23 +300,30 @@ namespace slib
 		if (timer.isNull()) {
 			return sl_false;
 		}
-		TimerTask t;
-		t.timer = timer;
-		MutexLocker lock(&m_lockTimer);
-		if (m_queueTimers.push(t)) {
-			_wake();
+		MutexLocker lock(&m_lockTimers);
+		if (timer->m_entryLoop.isNotNull()) {
 			return sl_true;
-		} else {
+		}
+		Ref<TimerWheelEntry> entry = new TimerWheelEntry(SLIB_INLINE_BIND_CLASS(void(), DispatchLoop, _runTimer, this, WeakRef<Timer>(timer)));
+		if (entry.isNull()) {
 			return sl_false;
 		}
+		timer->m_entryLoop = entry;
+		lock.unlock();
+		return _addTimeout(entry.get(), timer->getLastRunTime() + timer->getInterval());
 	}
 
 	void DispatchLoop::removeTimer(const Ref<Timer>& timer)
 	{
-		MutexLocker lock(&m_lockTimer);
-		TimerTask t;
-		t.timer = timer;
-		m_queueTimers.removeValue(t);
+		if (timer.isNull()) {
+			return;
+		}
+		MutexLocker lock(&m_lockTimers);
+		Ref<TimerWheelEntry> entry = timer->m_entryLoop;
+		if (entry.isNotNull()) {
+			m_timers.remove(entry.get());
+			timer->m_entryLoop.setNull();
+		}
 	}
 
 	sl_uint64 DispatchLoop::getElapsedMilliseconds()
@@ -330,22 +337,21 @@ namespace slib
 
 			// Async Tasks
 			{
-				LinkedQueue< Function<void()> > tasks;
-				tasks.merge(&m_queueTasks);
-				Function<void()> task;
-				while (tasks.pop_NoLock(&task)) {
+				// clear before draining: the tasks pushed from now will wake the loop again
+				Base::interlockedCompareExchange32(&m_flagWakePending, 0, 1);
+				InlineFunction<void()> task;
+				sl_uint32 n = 0;
+				while (n < _SLIB_DISPATCH_LOOP_MAX_TASKS_PER_STEP && m_queueTasks.pop(&task)) {
 					task();
+					n++;
 				}
 			}
 			
 			sl_int32 _t = _getTimeout();
-			if (_t < 0) {
-				_t = 10000;
-			}
-			if (_t > 10000) {
-				_t = 10000;
+			if (_t < 0 || _t > _SLIB_DISPATCH_LOOP_MAX_WAIT) {
+				_t = _SLIB_DISPATCH_LOOP_MAX_WAIT;
 			}
-			Thread::sleep(_t);
+			m_eventWake->wait(_t);
 
 		}
 	}
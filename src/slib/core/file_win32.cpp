@@ -177,6 +177,15 @@ namespace slib
 		return sl_false;
 	}
 
+	sl_bool File::flush()
+	{
+		if (isOpened()) {
+			HANDLE handle = (HANDLE)m_file;
+			return ::FlushFileBuffers(handle) != 0;
+		}
+		return sl_false;
+	}
+
 	sl_int32 File::read32(void* buf, sl_uint32 size)
 	{
 		if (isOpened()) {
@@ -16,6 +16,7 @@
 #include "slib/core/map.h"
 
 #include "slib/core/file.h"
+#include "slib/core/mapped_file.h"
 #include "slib/core/log.h"
 
 namespace slib
@@ -681,7 +682,7 @@ namespace slib
 
 	Json Json::parseJsonFromTextFile(const String& filePath, JsonParseParam& param)
 	{
-		String16 json = File::readAllText16(filePath);
+		String16 json = String16::fromUtf(MappedFile::mapAllBytes(filePath));
 		return parseJson16(json, param);
 	}
 
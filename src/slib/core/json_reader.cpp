@@ -0,0 +1,1082 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/json_reader.h"
+
+#include "slib/core/map.h"
+#include "slib/core/parse.h"
+#include "slib/core/log.h"
+
+namespace slib
+{
+
+	JsonStringView::JsonStringView()
+	{
+		data = sl_null;
+		length = 0;
+	}
+
+	String JsonStringView::toString() const
+	{
+		return String(data, length);
+	}
+
+	sl_bool JsonStringView::equals(const sl_char8* str, sl_size len) const
+	{
+		if (length != len) {
+			return sl_false;
+		}
+		return Base::compareMemory((const sl_uint8*)data, (const sl_uint8*)str, len) == 0;
+	}
+
+	sl_bool JsonStringView::equals(const String& str) const
+	{
+		return equals(str.getData(), str.getLength());
+	}
+
+
+	IJsonReaderListener::IJsonReaderListener()
+	{
+	}
+
+	IJsonReaderListener::~IJsonReaderListener()
+	{
+	}
+
+	void IJsonReaderListener::onBeginObject(JsonReader* reader)
+	{
+	}
+
+	void IJsonReaderListener::onEndObject(JsonReader* reader)
+	{
+	}
+
+	void IJsonReaderListener::onBeginArray(JsonReader* reader)
+	{
+	}
+
+	void IJsonReaderListener::onEndArray(JsonReader* reader)
+	{
+	}
+
+	void IJsonReaderListener::onKey(JsonReader* reader, const JsonStringView& key)
+	{
+	}
+
+	void IJsonReaderListener::onString(JsonReader* reader, const JsonStringView& value)
+	{
+	}
+
+	void IJsonReaderListener::onNumber(JsonReader* reader, const JsonStringView& text)
+	{
+	}
+
+	void IJsonReaderListener::onBoolean(JsonReader* reader, sl_bool value)
+	{
+	}
+
+	void IJsonReaderListener::onNull(JsonReader* reader)
+	{
+	}
+
+
+	JsonReaderParam::JsonReaderParam()
+	{
+		flagSupportComments = sl_true;
+		flagLogError = sl_true;
+		chunkSize = SLIB_JSON_READER_DEFAULT_CHUNK_SIZE;
+	}
+
+	JsonReaderParam::~JsonReaderParam()
+	{
+	}
+
+
+	JsonReader::JsonReader()
+	{
+		m_buf = sl_null;
+		m_pos = 0;
+		m_len = 0;
+		m_posKeep = 0;
+		m_offset = 0;
+
+		m_chunk = sl_null;
+		m_sizeChunk = 0;
+		m_flagEndOfInput = sl_true;
+
+		m_flagSupportComments = sl_true;
+		m_flagLogError = sl_true;
+
+		m_state = State::End;
+		m_depth = 0;
+		m_depthEmit = 0;
+
+		m_match = Match::Emit;
+		m_matchMask = 0;
+		m_matchFilter = -1;
+		m_matchedFilter = -1;
+
+		m_token = JsonTokenType::None;
+		m_valueBoolean = sl_false;
+		m_flagInteger = sl_false;
+		m_valueInt64 = 0;
+		m_valueDouble = 0;
+
+		m_errorPosition = 0;
+	}
+
+	JsonReader::~JsonReader()
+	{
+		close();
+	}
+
+	sl_bool JsonReader::open(const void* data, sl_size size, const JsonReaderParam& param)
+	{
+		close();
+		if (!(_setFilters(param.filters))) {
+			return sl_false;
+		}
+		m_buf = (const sl_char8*)data;
+		m_len = size;
+		_init(param);
+		return sl_true;
+	}
+
+	sl_bool JsonReader::open(const void* data, sl_size size)
+	{
+		JsonReaderParam param;
+		return open(data, size, param);
+	}
+
+	sl_bool JsonReader::open(const Memory& mem, const JsonReaderParam& param)
+	{
+		if (!(open(mem.getData(), mem.getSize(), param))) {
+			return sl_false;
+		}
+		m_mem = mem;
+		return sl_true;
+	}
+
+	sl_bool JsonReader::open(const Memory& mem)
+	{
+		JsonReaderParam param;
+		return open(mem, param);
+	}
+
+	sl_bool JsonReader::open(const Ptr<IReader>& reader, const JsonReaderParam& param)
+	{
+		close();
+		if (reader.isNull()) {
+			return sl_false;
+		}
+		if (!(_setFilters(param.filters))) {
+			return sl_false;
+		}
+		sl_size size = param.chunkSize;
+		if (size < 16) {
+			size = 16;
+		}
+		m_chunk = (sl_char8*)(Base::createMemory(size));
+		if (!m_chunk) {
+			return sl_false;
+		}
+		m_sizeChunk = size;
+		m_reader = reader;
+		m_buf = m_chunk;
+		m_len = 0;
+		_init(param);
+		m_flagEndOfInput = sl_false;
+		return sl_true;
+	}
+
+	sl_bool JsonReader::open(const Ptr<IReader>& reader)
+	{
+		JsonReaderParam param;
+		return open(reader, param);
+	}
+
+	void JsonReader::close()
+	{
+		m_mem.setNull();
+		m_reader.setNull();
+		if (m_chunk) {
+			Base::freeMemory(m_chunk);
+			m_chunk = sl_null;
+		}
+		m_sizeChunk = 0;
+		m_buf = sl_null;
+		m_pos = 0;
+		m_len = 0;
+		m_posKeep = 0;
+		m_offset = 0;
+		m_flagEndOfInput = sl_true;
+		m_state = State::End;
+		m_depth = 0;
+		m_depthEmit = 0;
+		m_filters.setNull();
+		m_token = JsonTokenType::None;
+		m_string = JsonStringView();
+		m_stringDecoded.setNull();
+	}
+
+	JsonTokenType JsonReader::next()
+	{
+		if (m_token == JsonTokenType::Error) {
+			return JsonTokenType::Error;
+		}
+		for (;;) {
+			if (m_state == State::End) {
+				m_token = JsonTokenType::EndOfDocument;
+				return m_token;
+			}
+			if (!(_skipSpaces())) {
+				if (m_depth == 0) {
+					if (m_state == State::Next) {
+						m_state = State::End;
+						m_token = JsonTokenType::EndOfDocument;
+						return m_token;
+					}
+					return _setError("Missing value");
+				}
+				if (m_levels.getData()[m_depth - 1].flagObject) {
+					return _setError("Object: Missing character } ");
+				} else {
+					return _setError("Array: Missing character ] ");
+				}
+			}
+			sl_char8 ch = m_buf[m_pos];
+			switch (m_state) {
+				case State::Next:
+				{
+					if (m_depth == 0) {
+						return _setError("Invalid token");
+					}
+					Level& level = m_levels.getData()[m_depth - 1];
+					if (ch == ',') {
+						m_pos++;
+						m_state = level.flagObject ? State::Key : State::Item;
+						break;
+					}
+					if (ch == (level.flagObject ? '}' : ']')) {
+						m_pos++;
+						sl_bool flagEmit;
+						JsonTokenType token = _popLevel(flagEmit);
+						if (flagEmit) {
+							m_token = token;
+							return token;
+						}
+						break;
+					}
+					if (level.flagObject) {
+						return _setError("Object: Missing character , ");
+					} else {
+						return _setError("Array: Missing character ] ");
+					}
+				}
+				case State::Key:
+				{
+					if (ch == '}') {
+						m_pos++;
+						sl_bool flagEmit;
+						JsonTokenType token = _popLevel(flagEmit);
+						if (flagEmit) {
+							m_token = token;
+							return token;
+						}
+						break;
+					}
+					if (ch == '"' || ch == '\'') {
+						if (!(_readString(sl_true))) {
+							return m_token;
+						}
+					} else {
+						if (!(_readIdentifier())) {
+							return m_token;
+						}
+					}
+					m_state = State::Colon;
+					Level& level = m_levels.getData()[m_depth - 1];
+					if (level.flagEmit) {
+						m_match = Match::Emit;
+						m_token = JsonTokenType::Key;
+						return m_token;
+					}
+					_computeMatch();
+					break;
+				}
+				case State::Colon:
+				{
+					if (ch != ':') {
+						return _setError("Object: Missing character : ");
+					}
+					m_pos++;
+					m_state = State::Value;
+					break;
+				}
+				case State::Item:
+				case State::Value:
+				{
+					if (m_state == State::Item) {
+						if (ch == ']') {
+							m_pos++;
+							sl_bool flagEmit;
+							JsonTokenType token = _popLevel(flagEmit);
+							if (flagEmit) {
+								m_token = token;
+								return token;
+							}
+							break;
+						}
+						Level& level = m_levels.getData()[m_depth - 1];
+						if (level.flagEmit) {
+							m_match = Match::Emit;
+						} else {
+							_computeMatch();
+						}
+						level.index++;
+					}
+					m_state = State::Next;
+					if (m_match == Match::Skip) {
+						if (ch == '{' || ch == '[') {
+							if (!(_skipContainer(0))) {
+								return m_token;
+							}
+						} else {
+							if (!(_skipScalar())) {
+								return m_token;
+							}
+						}
+						break;
+					}
+					sl_bool flagEmit = m_match == Match::Emit;
+					if (flagEmit && (m_depth == 0 || !(m_levels.getData()[m_depth - 1].flagEmit))) {
+						m_matchedFilter = m_matchFilter;
+					}
+					if (ch == '{' || ch == '[') {
+						m_pos++;
+						sl_bool flagObject = ch == '{';
+						_pushLevel(flagObject, flagEmit, m_matchMask);
+						m_state = flagObject ? State::Key : State::Item;
+						if (flagEmit) {
+							m_token = flagObject ? JsonTokenType::BeginObject : JsonTokenType::BeginArray;
+							return m_token;
+						}
+						break;
+					}
+					if (!flagEmit) {
+						if (!(_skipScalar())) {
+							return m_token;
+						}
+						break;
+					}
+					if (ch == '"' || ch == '\'') {
+						if (!(_readString(sl_true))) {
+							return m_token;
+						}
+						m_token = JsonTokenType::String;
+						return m_token;
+					}
+					if (!(_readLiteral(sl_true))) {
+						return m_token;
+					}
+					return m_token;
+				}
+				default:
+					break;
+			}
+		}
+	}
+
+	sl_bool JsonReader::parse(IJsonReaderListener* listener)
+	{
+		for (;;) {
+			switch (next()) {
+				case JsonTokenType::BeginObject:
+					listener->onBeginObject(this);
+					break;
+				case JsonTokenType::EndObject:
+					listener->onEndObject(this);
+					break;
+				case JsonTokenType::BeginArray:
+					listener->onBeginArray(this);
+					break;
+				case JsonTokenType::EndArray:
+					listener->onEndArray(this);
+					break;
+				case JsonTokenType::Key:
+					listener->onKey(this, m_string);
+					break;
+				case JsonTokenType::String:
+					listener->onString(this, m_string);
+					break;
+				case JsonTokenType::Number:
+					listener->onNumber(this, m_string);
+					break;
+				case JsonTokenType::Boolean:
+					listener->onBoolean(this, m_valueBoolean);
+					break;
+				case JsonTokenType::Null:
+					listener->onNull(this);
+					break;
+				case JsonTokenType::EndOfDocument:
+					return sl_true;
+				default:
+					return sl_false;
+			}
+		}
+	}
+
+	void JsonReader::stop()
+	{
+		m_state = State::End;
+	}
+
+	JsonTokenType JsonReader::getTokenType() const
+	{
+		return m_token;
+	}
+
+	const JsonStringView& JsonReader::getString() const
+	{
+		return m_string;
+	}
+
+	String JsonReader::getStringValue() const
+	{
+		if (m_stringDecoded.isNotNull()) {
+			return m_stringDecoded;
+		}
+		return String(m_string.data, m_string.length);
+	}
+
+	sl_bool JsonReader::getBoolean() const
+	{
+		return m_valueBoolean;
+	}
+
+	sl_bool JsonReader::isInteger() const
+	{
+		return m_flagInteger;
+	}
+
+	sl_int64 JsonReader::getInt64() const
+	{
+		if (m_flagInteger) {
+			return m_valueInt64;
+		}
+		return (sl_int64)m_valueDouble;
+	}
+
+	double JsonReader::getDouble() const
+	{
+		if (m_flagInteger) {
+			return (double)m_valueInt64;
+		}
+		return m_valueDouble;
+	}
+
+	Json JsonReader::readValue()
+	{
+		if (m_token == JsonTokenType::Key) {
+			return _readValue(next());
+		}
+		return _readValue(m_token);
+	}
+
+	sl_bool JsonReader::skipValue()
+	{
+		if (m_token == JsonTokenType::Key) {
+			if (m_state == State::Colon) {
+				m_match = Match::Skip;
+			}
+			return sl_true;
+		}
+		if (m_token == JsonTokenType::BeginObject || m_token == JsonTokenType::BeginArray) {
+			if (!(_skipContainer(1))) {
+				return sl_false;
+			}
+			sl_bool flagEmit;
+			m_token = _popLevel(flagEmit);
+			return sl_true;
+		}
+		return m_token != JsonTokenType::Error;
+	}
+
+	sl_uint32 JsonReader::getDepth() const
+	{
+		return m_depthEmit;
+	}
+
+	sl_int32 JsonReader::getMatchedFilterIndex() const
+	{
+		return m_matchedFilter;
+	}
+
+	sl_uint64 JsonReader::getPosition() const
+	{
+		return m_offset + m_pos;
+	}
+
+	sl_bool JsonReader::isError() const
+	{
+		return m_token == JsonTokenType::Error;
+	}
+
+	String JsonReader::getErrorMessage() const
+	{
+		return m_errorMessage;
+	}
+
+	sl_uint64 JsonReader::getErrorPosition() const
+	{
+		return m_errorPosition;
+	}
+
+	String JsonReader::getErrorText() const
+	{
+		if (m_token != JsonTokenType::Error) {
+			return sl_null;
+		}
+		if (m_reader.isNull() && m_buf) {
+			sl_size column = 0;
+			sl_size line = ParseUtil::countLineNumber(m_buf, (sl_size)m_errorPosition, &column);
+			return "(" + String::fromSize(line) + ":" + String::fromSize(column) + ") " + m_errorMessage;
+		}
+		return "(" + String::fromUint64(m_errorPosition) + ") " + m_errorMessage;
+	}
+
+	void JsonReader::_init(const JsonReaderParam& param)
+	{
+		m_flagSupportComments = param.flagSupportComments;
+		m_flagLogError = param.flagLogError;
+		m_state = State::Value;
+		m_token = JsonTokenType::None;
+		m_errorMessage.setNull();
+		m_errorPosition = 0;
+		m_matchFilter = -1;
+		m_matchedFilter = -1;
+		m_matchMask = 0;
+		sl_size nFilters = m_filters.getCount();
+		if (nFilters) {
+			m_match = Match::Descend;
+			Filter* filters = m_filters.getData();
+			for (sl_size i = 0; i < nFilters; i++) {
+				if (filters[i].names.isEmpty()) {
+					m_match = Match::Emit;
+					m_matchFilter = (sl_int32)i;
+					break;
+				}
+				m_matchMask |= ((sl_uint64)1) << i;
+			}
+		} else {
+			m_match = Match::Emit;
+		}
+	}
+
+	sl_bool JsonReader::_setFilters(const List<String>& pointers)
+	{
+		m_filters.setNull();
+		ListLocker<String> list(pointers);
+		if (list.count > SLIB_JSON_READER_MAX_FILTERS) {
+			return sl_false;
+		}
+		for (sl_size i = 0; i < list.count; i++) {
+			String pointer = list[i];
+			Filter filter;
+			sl_size len = pointer.getLength();
+			if (len) {
+				const sl_char8* sz = pointer.getData();
+				if (sz[0] != '/') {
+					return sl_false;
+				}
+				sl_size start = 1;
+				for (sl_size k = 1; k <= len; k++) {
+					if (k == len || sz[k] == '/') {
+						String name = String(sz + start, k - start);
+						if (name.indexOf('~') >= 0) {
+							name = name.replaceAll("~1", "/").replaceAll("~0", "~");
+						}
+						sl_int64 index = -1;
+						sl_size n = name.getLength();
+						if (n && (n == 1 || name.getData()[0] != '0')) {
+							sl_int64 v;
+							if (String::parseInt64(10, &v, name.getData(), 0, n) == (sl_reg)n && v >= 0) {
+								index = v;
+							}
+						}
+						filter.names.add_NoLock(name);
+						filter.indices.add_NoLock(index);
+						start = k + 1;
+					}
+				}
+			}
+			m_filters.add_NoLock(filter);
+		}
+		return sl_true;
+	}
+
+	sl_bool JsonReader::_fill()
+	{
+		if (m_flagEndOfInput) {
+			return sl_false;
+		}
+		sl_size keep = m_posKeep;
+		if (keep > m_pos) {
+			keep = m_pos;
+		}
+		if (keep) {
+			m_len -= keep;
+			Base::moveMemory(m_chunk, m_chunk + keep, m_len);
+			m_pos -= keep;
+			m_posKeep -= keep;
+			m_offset += keep;
+		}
+		if (m_len >= m_sizeChunk) {
+			// a single token is larger than the chunk
+			sl_size size = m_sizeChunk << 1;
+			sl_char8* chunk = (sl_char8*)(Base::createMemory(size));
+			if (!chunk) {
+				m_flagEndOfInput = sl_true;
+				return sl_false;
+			}
+			Base::copyMemory(chunk, m_chunk, m_len);
+			Base::freeMemory(m_chunk);
+			m_chunk = chunk;
+			m_sizeChunk = size;
+		}
+		m_buf = m_chunk;
+		sl_reg n = m_reader->read(m_chunk + m_len, m_sizeChunk - m_len);
+		if (n <= 0) {
+			m_flagEndOfInput = sl_true;
+			return sl_false;
+		}
+		m_len += n;
+		return sl_true;
+	}
+
+	sl_bool JsonReader::_ensure(sl_size n)
+	{
+		while (m_pos + n > m_len) {
+			if (!(_fill())) {
+				return sl_false;
+			}
+		}
+		return sl_true;
+	}
+
+	sl_bool JsonReader::_skipSpaces()
+	{
+		for (;;) {
+			const sl_char8* buf = m_buf;
+			sl_size len = m_len;
+			sl_size i = m_pos;
+			while (i < len && SLIB_CHAR_IS_WHITE_SPACE(buf[i])) {
+				i++;
+			}
+			m_pos = i;
+			if (i >= len) {
+				m_posKeep = i;
+				if (_fill()) {
+					continue;
+				}
+				return sl_false;
+			}
+			if (buf[i] != '/' || !m_flagSupportComments) {
+				return sl_true;
+			}
+			m_posKeep = i;
+			if (!(_ensure(2))) {
+				return sl_true;
+			}
+			sl_char8 ch = m_buf[m_pos + 1];
+			if (ch == '/') {
+				m_pos += 2;
+				for (;;) {
+					if (m_pos >= m_len) {
+						m_posKeep = m_pos;
+						if (!(_fill())) {
+							return sl_false;
+						}
+					}
+					ch = m_buf[m_pos];
+					if (ch == '\r' || ch == '\n') {
+						break;
+					}
+					m_pos++;
+				}
+			} else if (ch == '*') {
+				m_pos += 2;
+				for (;;) {
+					if (m_pos >= m_len) {
+						m_posKeep = m_pos;
+						if (!(_fill())) {
+							return sl_false;
+						}
+					}
+					if (m_buf[m_pos] == '*') {
+						m_posKeep = m_pos;
+						if (!(_ensure(2))) {
+							return sl_false;
+						}
+						if (m_buf[m_pos + 1] == '/') {
+							m_pos += 2;
+							break;
+						}
+					}
+					m_pos++;
+				}
+			} else {
+				return sl_true;
+			}
+		}
+	}
+
+	sl_bool JsonReader::_readString(sl_bool flagDecode)
+	{
+		sl_char8 quote = m_buf[m_pos];
+		m_posKeep = m_pos;
+		sl_size i = m_pos + 1;
+		sl_bool flagEscaped = sl_false;
+		for (;;) {
+			const sl_char8* buf = m_buf;
+			sl_size len = m_len;
+			while (i < len) {
+				sl_char8 ch = buf[i];
+				if (ch == quote) {
+					m_pos = i + 1;
+					if (!flagDecode) {
+						return sl_true;
+					}
+					sl_size start = m_posKeep;
+					if (flagEscaped) {
+						sl_size m = 0;
+						sl_bool flagError = sl_false;
+						m_stringDecoded = ParseUtil::parseBackslashEscapes(buf + start, i + 1 - start, &m, &flagError);
+						if (flagError) {
+							_setError("String: Invalid escape sequence");
+							return sl_false;
+						}
+						m_string.data = m_stringDecoded.getData();
+						m_string.length = m_stringDecoded.getLength();
+					} else {
+						m_stringDecoded.setNull();
+						m_string.data = buf + start + 1;
+						m_string.length = i - start - 1;
+					}
+					return sl_true;
+				}
+				if (ch == '\\') {
+					if (i + 1 >= len) {
+						break;
+					}
+					flagEscaped = sl_true;
+					i += 2;
+				} else {
+					i++;
+				}
+			}
+			m_pos = i;
+			if (!(_fill())) {
+				_setError("String: Missing terminating character \" or ' ");
+				return sl_false;
+			}
+			i = m_pos;
+		}
+	}
+
+	sl_bool JsonReader::_readIdentifier()
+	{
+		m_posKeep = m_pos;
+		sl_size i = m_pos;
+		for (;;) {
+			const sl_char8* buf = m_buf;
+			sl_size len = m_len;
+			while (i < len) {
+				sl_char8 ch = buf[i];
+				if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_' || (i != m_posKeep && ch >= '0' && ch <= '9')) {
+					i++;
+				} else {
+					break;
+				}
+			}
+			m_pos = i;
+			if (i < len || !(_fill())) {
+				break;
+			}
+			i = m_pos;
+		}
+		if (m_pos == m_posKeep) {
+			_setError("Object: Missing character } ");
+			return sl_false;
+		}
+		m_stringDecoded.setNull();
+		m_string.data = m_buf + m_posKeep;
+		m_string.length = m_pos - m_posKeep;
+		return sl_true;
+	}
+
+	sl_bool JsonReader::_readLiteral(sl_bool flagParse)
+	{
+		m_posKeep = m_pos;
+		sl_size i = m_pos;
+		for (;;) {
+			const sl_char8* buf = m_buf;
+			sl_size len = m_len;
+			while (i < len) {
+				sl_char8 ch = buf[i];
+				if (ch == '\r' || ch == '\n' || ch == ' ' || ch == '\t' || ch == '/' || ch == ']' || ch == '}' || ch == ',') {
+					break;
+				}
+				i++;
+			}
+			m_pos = i;
+			if (i < len || !(_fill())) {
+				break;
+			}
+			i = m_pos;
+		}
+		const sl_char8* sz = m_buf + m_posKeep;
+		sl_size n = m_pos - m_posKeep;
+		if (!n) {
+			_setError("Invalid token");
+			return sl_false;
+		}
+		if (!flagParse) {
+			return sl_true;
+		}
+		m_stringDecoded.setNull();
+		m_string.data = sz;
+		m_string.length = n;
+		if (n == 4) {
+			if (Base::compareMemory((const sl_uint8*)sz, (const sl_uint8*)"null", 4) == 0) {
+				m_token = JsonTokenType::Null;
+				return sl_true;
+			}
+			if (Base::compareMemory((const sl_uint8*)sz, (const sl_uint8*)"true", 4) == 0) {
+				m_token = JsonTokenType::Boolean;
+				m_valueBoolean = sl_true;
+				return sl_true;
+			}
+		} else if (n == 5) {
+			if (Base::compareMemory((const sl_uint8*)sz, (const sl_uint8*)"false", 5) == 0) {
+				m_token = JsonTokenType::Boolean;
+				m_valueBoolean = sl_false;
+				return sl_true;
+			}
+		}
+		if (String::parseInt64(10, &m_valueInt64, sz, 0, n) == (sl_reg)n) {
+			m_token = JsonTokenType::Number;
+			m_flagInteger = sl_true;
+			return sl_true;
+		}
+		if (String::parseDouble(&m_valueDouble, sz, 0, n) == (sl_reg)n) {
+			m_token = JsonTokenType::Number;
+			m_flagInteger = sl_false;
+			return sl_true;
+		}
+		_setError("Invalid token");
+		return sl_false;
+	}
+
+	sl_bool JsonReader::_skipContainer(sl_size nesting)
+	{
+		sl_char8 quote = 0;
+		for (;;) {
+			const sl_char8* buf = m_buf;
+			sl_size len = m_len;
+			sl_size i = m_pos;
+			sl_bool flagComment = sl_false;
+			while (i < len) {
+				sl_char8 ch = buf[i];
+				if (quote) {
+					if (ch == quote) {
+						quote = 0;
+					} else if (ch == '\\') {
+						if (i + 1 >= len) {
+							break;
+						}
+						i++;
+					}
+					i++;
+					continue;
+				}
+				if (ch == '{' || ch == '[') {
+					nesting++;
+				} else if (ch == '}' || ch == ']') {
+					nesting--;
+					if (!nesting) {
+						m_pos = i + 1;
+						return sl_true;
+					}
+				} else if (ch == '"' || ch == '\'') {
+					quote = ch;
+				} else if (ch == '/' && m_flagSupportComments) {
+					flagComment = sl_true;
+					break;
+				}
+				i++;
+			}
+			m_pos = i;
+			if (flagComment) {
+				sl_uint64 offset = m_offset + m_pos;
+				if (!(_skipSpaces())) {
+					break;
+				}
+				if (m_offset + m_pos == offset) {
+					m_pos++;
+				}
+				continue;
+			}
+			m_posKeep = m_pos;
+			if (!(_fill())) {
+				break;
+			}
+		}
+		_setError("Missing character } or ]");
+		return sl_false;
+	}
+
+	sl_bool JsonReader::_skipScalar()
+	{
+		if (m_buf[m_pos] == '"' || m_buf[m_pos] == '\'') {
+			return _readString(sl_false);
+		}
+		return _readLiteral(sl_false);
+	}
+
+	void JsonReader::_computeMatch()
+	{
+		sl_uint32 indexSegment = m_depth - 1;
+		Level& level = m_levels.getData()[indexSegment];
+		Filter* filters = m_filters.getData();
+		sl_uint64 mask = level.filterMask;
+		sl_uint64 maskChild = 0;
+		for (sl_uint32 i = 0; mask; i++, mask >>= 1) {
+			if (!(mask & 1)) {
+				continue;
+			}
+			Filter& filter = filters[i];
+			sl_bool flagMatch;
+			if (level.flagObject) {
+				flagMatch = m_string.equals(filter.names.getData()[indexSegment]);
+			} else {
+				flagMatch = filter.indices.getData()[indexSegment] == (sl_int64)(level.index);
+			}
+			if (flagMatch) {
+				if (filter.names.getCount() == indexSegment + 1) {
+					m_match = Match::Emit;
+					m_matchFilter = (sl_int32)i;
+					m_matchMask = 0;
+					return;
+				}
+				maskChild |= ((sl_uint64)1) << i;
+			}
+		}
+		m_match = maskChild ? Match::Descend : Match::Skip;
+		m_matchMask = maskChild;
+	}
+
+	void JsonReader::_pushLevel(sl_bool flagObject, sl_bool flagEmit, sl_uint64 mask)
+	{
+		if (m_depth >= m_levels.getCount()) {
+			m_levels.setCount_NoLock(m_depth + 16);
+		}
+		Level& level = m_levels.getData()[m_depth];
+		level.flagObject = flagObject;
+		level.flagEmit = flagEmit;
+		level.index = 0;
+		level.filterMask = flagEmit ? 0 : mask;
+		m_depth++;
+		if (flagEmit) {
+			m_depthEmit++;
+		}
+	}
+
+	JsonTokenType JsonReader::_popLevel(sl_bool& flagEmit)
+	{
+		m_depth--;
+		Level& level = m_levels.getData()[m_depth];
+		flagEmit = level.flagEmit;
+		if (flagEmit) {
+			m_depthEmit--;
+		}
+		m_state = State::Next;
+		return level.flagObject ? JsonTokenType::EndObject : JsonTokenType::EndArray;
+	}
+
+	JsonTokenType JsonReader::_setError(const char* message)
+	{
+		m_token = JsonTokenType::Error;
+		m_state = State::End;
+		m_errorMessage = message;
+		m_errorPosition = m_offset + m_pos;
+		if (m_flagLogError) {
+			LogError("JsonReader", getErrorText());
+		}
+		return JsonTokenType::Error;
+	}
+
+	Json JsonReader::_readValue(JsonTokenType token)
+	{
+		switch (token) {
+			case JsonTokenType::String:
+				return getStringValue();
+			case JsonTokenType::Number:
+				if (m_flagInteger) {
+					if (m_valueInt64 >= SLIB_INT64(-0x80000000) && m_valueInt64 < SLIB_INT64(0x7fffffff)) {
+						return (sl_int32)m_valueInt64;
+					} else {
+						return m_valueInt64;
+					}
+				}
+				return m_valueDouble;
+			case JsonTokenType::Boolean:
+				return Variant::fromBoolean(m_valueBoolean);
+			case JsonTokenType::BeginArray:
+			{
+				VariantList list = VariantList::create();
+				for (;;) {
+					token = next();
+					if (token == JsonTokenType::EndArray) {
+						return list;
+					}
+					Json item = _readValue(token);
+					if (m_token == JsonTokenType::Error || m_token == JsonTokenType::EndOfDocument) {
+						return sl_null;
+					}
+					list.add_NoLock(item);
+				}
+			}
+			case JsonTokenType::BeginObject:
+			{
+				VariantMap map = VariantMap::createHash();
+				for (;;) {
+					token = next();
+					if (token == JsonTokenType::EndObject) {
+						return map;
+					}
+					if (token != JsonTokenType::Key) {
+						return sl_null;
+					}
+					String key = getStringValue();
+					Json item = _readValue(next());
+					if (m_token == JsonTokenType::Error || m_token == JsonTokenType::EndOfDocument) {
+						return sl_null;
+					}
+					map.put_NoLock(key, item);
+				}
+			}
+			default:
+				break;
+		}
+		return sl_null;
+	}
+
+}
@@ -0,0 +1,1189 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/json_writer.h"
+
+#include "slib/core/map.h"
+#include "slib/core/math.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define _JSON_WRITER_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(SLIB_ARCH_IS_ARM64)
+#	define _JSON_WRITER_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+#define _JSON_WRITER_INITIAL_CHUNK_SIZE 1024
+#define _JSON_WRITER_MIN_CHUNK_SIZE 4096
+// longest text of a number: sign, 17 digits, "0." and 5 leading zeros
+#define _JSON_WRITER_MAX_NUMBER_LENGTH 32
+// count of UTF-16 characters escaped in a reserved block
+#define _JSON_WRITER_UTF16_BLOCK 256
+
+namespace slib
+{
+
+	static const sl_char8 _JsonWriter_digits[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	static const sl_char8 _JsonWriter_hex[] = "0123456789abcdef";
+
+	// escape letter of each byte: 0 for the bytes written as is, 'u' for "\u00XX"
+	static const sl_char8 _JsonWriter_escapes[256] = {
+		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+		'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+		0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0
+		// the rest are zero
+	};
+
+	SLIB_INLINE static sl_uint32 _JsonWriter_getLowestBitIndex(sl_uint32 n)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctz(n));
+#else
+		return Math::getLeastSignificantBits(n);
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _JsonWriter_getLeadingZeros(sl_uint64 n)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_clzll(n));
+#else
+		return 64 - Math::getMostSignificantBits(n);
+#endif
+	}
+
+	// copies the raw value: dereferencing `_value` as another type breaks the strict aliasing rules
+	template <class T>
+	SLIB_INLINE static T _JsonWriter_getVariantValue(const Variant& v)
+	{
+		T ret;
+		Base::copyMemory(&ret, &(v._value), sizeof(T));
+		return ret;
+	}
+
+	// length of the leading run of the bytes which need no escape
+	static sl_size _JsonWriter_getPlainLength(const sl_char8* str, sl_size len)
+	{
+		sl_size i = 0;
+#if defined(_JSON_WRITER_USE_SSE2)
+		__m128i quote = _mm_set1_epi8('"');
+		__m128i backslash = _mm_set1_epi8('\\');
+		__m128i control = _mm_set1_epi8(0x1F);
+		__m128i zero = _mm_setzero_si128();
+		while (i + 16 <= len) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(str + i));
+			// unsigned x <= 0x1F when the saturated subtraction is zero
+			__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)), _mm_cmpeq_epi8(_mm_subs_epu8(x, control), zero));
+			sl_uint32 mask = (sl_uint32)(_mm_movemask_epi8(m));
+			if (mask) {
+				return i + _JsonWriter_getLowestBitIndex(mask);
+			}
+			i += 16;
+		}
+#elif defined(_JSON_WRITER_USE_NEON)
+		uint8x16_t quote = vdupq_n_u8('"');
+		uint8x16_t backslash = vdupq_n_u8('\\');
+		uint8x16_t control = vdupq_n_u8(0x20);
+		while (i + 16 <= len) {
+			uint8x16_t x = vld1q_u8((const sl_uint8*)(str + i));
+			uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(x, quote), vceqq_u8(x, backslash)), vcltq_u8(x, control));
+			if (vmaxvq_u8(m)) {
+				break;
+			}
+			i += 16;
+		}
+#endif
+		while (i < len && !(_JsonWriter_escapes[(sl_uint8)(str[i])])) {
+			i++;
+		}
+		return i;
+	}
+
+	SLIB_INLINE static sl_size _JsonWriter_writeEscape(sl_char8* out, sl_uint32 ch, sl_char8 escape)
+	{
+		out[0] = '\\';
+		if (escape != 'u') {
+			out[1] = escape;
+			return 2;
+		}
+		out[1] = 'u';
+		out[2] = _JsonWriter_hex[(ch >> 12) & 15];
+		out[3] = _JsonWriter_hex[(ch >> 8) & 15];
+		out[4] = _JsonWriter_hex[(ch >> 4) & 15];
+		out[5] = _JsonWriter_hex[ch & 15];
+		return 6;
+	}
+
+	// two digits at a time from the end; `out` must have 20 bytes
+	static sl_size _JsonWriter_formatUint64(sl_char8* out, sl_uint64 value)
+	{
+		sl_char8 buf[20];
+		sl_char8* p = buf + 20;
+		while (value >= 100000000) {
+			sl_uint32 low = (sl_uint32)(value % 100000000);
+			value /= 100000000;
+			for (int i = 0; i < 4; i++) {
+				sl_uint32 r = low % 100;
+				low /= 100;
+				p -= 2;
+				p[0] = _JsonWriter_digits[r << 1];
+				p[1] = _JsonWriter_digits[(r << 1) + 1];
+			}
+		}
+		sl_uint32 v = (sl_uint32)value;
+		while (v >= 100) {
+			sl_uint32 r = v % 100;
+			v /= 100;
+			p -= 2;
+			p[0] = _JsonWriter_digits[r << 1];
+			p[1] = _JsonWriter_digits[(r << 1) + 1];
+		}
+		if (v >= 10) {
+			p -= 2;
+			p[0] = _JsonWriter_digits[v << 1];
+			p[1] = _JsonWriter_digits[(v << 1) + 1];
+		} else {
+			*(--p) = (sl_char8)('0' + v);
+		}
+		sl_size n = buf + 20 - p;
+		Base::copyMemory(out, p, n);
+		return n;
+	}
+
+	static sl_size _JsonWriter_formatInt64(sl_char8* out, sl_int64 value)
+	{
+		if (value < 0) {
+			*out = '-';
+			return 1 + _JsonWriter_formatUint64(out + 1, (sl_uint64)0 - (sl_uint64)value);
+		}
+		return _JsonWriter_formatUint64(out, (sl_uint64)value);
+	}
+
+	/*
+		Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers", 2010).
+		Produces the shortest digits which are parsed back to the same value in almost all cases,
+		and a correctly round-tripping representation always.
+	*/
+
+	struct _JsonWriter_DiyFp
+	{
+		sl_uint64 f;
+		sl_int32 e;
+	};
+
+	// cached powers of ten: 10^(-348 + 8 * i) = f * 2^e
+	static const sl_uint64 _JsonWriter_cachedPowersF[] = {
+		SLIB_UINT64(0xfa8fd5a0081c0288), SLIB_UINT64(0xbaaee17fa23ebf76), SLIB_UINT64(0x8b16fb203055ac76), SLIB_UINT64(0xcf42894a5dce35ea),
+		SLIB_UINT64(0x9a6bb0aa55653b2d), SLIB_UINT64(0xe61acf033d1a45df), SLIB_UINT64(0xab70fe17c79ac6ca), SLIB_UINT64(0xff77b1fcbebcdc4f),
+		SLIB_UINT64(0xbe5691ef416bd60c), SLIB_UINT64(0x8dd01fad907ffc3c), SLIB_UINT64(0xd3515c2831559a83), SLIB_UINT64(0x9d71ac8fada6c9b5),
+		SLIB_UINT64(0xea9c227723ee8bcb), SLIB_UINT64(0xaecc49914078536d), SLIB_UINT64(0x823c12795db6ce57), SLIB_UINT64(0xc21094364dfb5637),
+		SLIB_UINT64(0x9096ea6f3848984f), SLIB_UINT64(0xd77485cb25823ac7), SLIB_UINT64(0xa086cfcd97bf97f4), SLIB_UINT64(0xef340a98172aace5),
+		SLIB_UINT64(0xb23867fb2a35b28e), SLIB_UINT64(0x84c8d4dfd2c63f3b), SLIB_UINT64(0xc5dd44271ad3cdba), SLIB_UINT64(0x936b9fcebb25c996),
+		SLIB_UINT64(0xdbac6c247d62a584), SLIB_UINT64(0xa3ab66580d5fdaf6), SLIB_UINT64(0xf3e2f893dec3f126), SLIB_UINT64(0xb5b5ada8aaff80b8),
+		SLIB_UINT64(0x87625f056c7c4a8b), SLIB_UINT64(0xc9bcff6034c13053), SLIB_UINT64(0x964e858c91ba2655), SLIB_UINT64(0xdff9772470297ebd),
+		SLIB_UINT64(0xa6dfbd9fb8e5b88f), SLIB_UINT64(0xf8a95fcf88747d94), SLIB_UINT64(0xb94470938fa89bcf), SLIB_UINT64(0x8a08f0f8bf0f156b),
+		SLIB_UINT64(0xcdb02555653131b6), SLIB_UINT64(0x993fe2c6d07b7fac), SLIB_UINT64(0xe45c10c42a2b3b06), SLIB_UINT64(0xaa242499697392d3),
+		SLIB_UINT64(0xfd87b5f28300ca0e), SLIB_UINT64(0xbce5086492111aeb), SLIB_UINT64(0x8cbccc096f5088cc), SLIB_UINT64(0xd1b71758e219652c),
+		SLIB_UINT64(0x9c40000000000000), SLIB_UINT64(0xe8d4a51000000000), SLIB_UINT64(0xad78ebc5ac620000), SLIB_UINT64(0x813f3978f8940984),
+		SLIB_UINT64(0xc097ce7bc90715b3), SLIB_UINT64(0x8f7e32ce7bea5c70), SLIB_UINT64(0xd5d238a4abe98068), SLIB_UINT64(0x9f4f2726179a2245),
+		SLIB_UINT64(0xed63a231d4c4fb27), SLIB_UINT64(0xb0de65388cc8ada8), SLIB_UINT64(0x83c7088e1aab65db), SLIB_UINT64(0xc45d1df942711d9a),
+		SLIB_UINT64(0x924d692ca61be758), SLIB_UINT64(0xda01ee641a708dea), SLIB_UINT64(0xa26da3999aef774a), SLIB_UINT64(0xf209787bb47d6b85),
+		SLIB_UINT64(0xb454e4a179dd1877), SLIB_UINT64(0x865b86925b9bc5c2), SLIB_UINT64(0xc83553c5c8965d3d), SLIB_UINT64(0x952ab45cfa97a0b3),
+		SLIB_UINT64(0xde469fbd99a05fe3), SLIB_UINT64(0xa59bc234db398c25), SLIB_UINT64(0xf6c69a72a3989f5c), SLIB_UINT64(0xb7dcbf5354e9bece),
+		SLIB_UINT64(0x88fcf317f22241e2), SLIB_UINT64(0xcc20ce9bd35c78a5), SLIB_UINT64(0x98165af37b2153df), SLIB_UINT64(0xe2a0b5dc971f303a),
+		SLIB_UINT64(0xa8d9d1535ce3b396), SLIB_UINT64(0xfb9b7cd9a4a7443c), SLIB_UINT64(0xbb764c4ca7a44410), SLIB_UINT64(0x8bab8eefb6409c1a),
+		SLIB_UINT64(0xd01fef10a657842c), SLIB_UINT64(0x9b10a4e5e9913129), SLIB_UINT64(0xe7109bfba19c0c9d), SLIB_UINT64(0xac2820d9623bf429),
+		SLIB_UINT64(0x80444b5e7aa7cf85), SLIB_UINT64(0xbf21e44003acdd2d), SLIB_UINT64(0x8e679c2f5e44ff8f), SLIB_UINT64(0xd433179d9c8cb841),
+		SLIB_UINT64(0x9e19db92b4e31ba9), SLIB_UINT64(0xeb96bf6ebadf77d9), SLIB_UINT64(0xaf87023b9bf0ee6b)
+	};
+
+	static const sl_int16 _JsonWriter_cachedPowersE[] = {
+		-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+		-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+		-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+		-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+		56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+		375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+		694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+		1013, 1039, 1066
+	};
+
+	static const sl_uint32 _JsonWriter_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+	SLIB_INLINE static _JsonWriter_DiyFp _JsonWriter_multiply(const _JsonWriter_DiyFp& x, const _JsonWriter_DiyFp& y)
+	{
+		const sl_uint64 M32 = 0xFFFFFFFF;
+		sl_uint64 a = x.f >> 32;
+		sl_uint64 b = x.f & M32;
+		sl_uint64 c = y.f >> 32;
+		sl_uint64 d = y.f & M32;
+		sl_uint64 ac = a * c;
+		sl_uint64 bc = b * c;
+		sl_uint64 ad = a * d;
+		sl_uint64 bd = b * d;
+		sl_uint64 tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+		// rounds the lower half
+		tmp += (sl_uint64)1 << 31;
+		_JsonWriter_DiyFp ret;
+		ret.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+		ret.e = x.e + y.e + 64;
+		return ret;
+	}
+
+	SLIB_INLINE static _JsonWriter_DiyFp _JsonWriter_normalize(sl_uint64 f, sl_int32 e)
+	{
+		sl_uint32 shift = _JsonWriter_getLeadingZeros(f);
+		_JsonWriter_DiyFp ret;
+		ret.f = f << shift;
+		ret.e = e - (sl_int32)shift;
+		return ret;
+	}
+
+	// returns 10^(-K), scaling the binary exponent `e` into [-60, -32]
+	SLIB_INLINE static _JsonWriter_DiyFp _JsonWriter_getCachedPower(sl_int32 e, sl_int32& K)
+	{
+		double dk = (-61 - e) * 0.30102999566398114 + 347;
+		sl_int32 k = (sl_int32)dk;
+		if (dk - k > 0.0) {
+			k++;
+		}
+		sl_uint32 index = (sl_uint32)((k >> 3) + 1);
+		K = -(-348 + (sl_int32)(index << 3));
+		_JsonWriter_DiyFp ret;
+		ret.f = _JsonWriter_cachedPowersF[index];
+		ret.e = _JsonWriter_cachedPowersE[index];
+		return ret;
+	}
+
+	SLIB_INLINE static sl_uint32 _JsonWriter_countDecimalDigits(sl_uint32 n)
+	{
+		sl_uint32 count = 1;
+		while (count < 10 && n >= _JsonWriter_pow10[count]) {
+			count++;
+		}
+		return count;
+	}
+
+	SLIB_INLINE static void _JsonWriter_roundWeed(sl_char8* buffer, sl_int32 len, sl_uint64 delta, sl_uint64 rest, sl_uint64 tenKappa, sl_uint64 distance)
+	{
+		while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+			buffer[len - 1]--;
+			rest += tenKappa;
+		}
+	}
+
+	static void _JsonWriter_generateDigits(const _JsonWriter_DiyFp& W, const _JsonWriter_DiyFp& Mp, sl_uint64 delta, sl_char8* buffer, sl_int32& len, sl_int32& K)
+	{
+		sl_uint32 shift = (sl_uint32)(-Mp.e);
+		sl_uint64 one = (sl_uint64)1 << shift;
+		sl_uint64 distance = Mp.f - W.f;
+		sl_uint32 p1 = (sl_uint32)(Mp.f >> shift);
+		sl_uint64 p2 = Mp.f & (one - 1);
+		sl_uint32 kappa = _JsonWriter_countDecimalDigits(p1);
+		len = 0;
+		while (kappa > 0) {
+			sl_uint32 divisor = _JsonWriter_pow10[kappa - 1];
+			sl_uint32 d = p1 / divisor;
+			p1 %= divisor;
+			if (d || len) {
+				buffer[len++] = (sl_char8)('0' + d);
+			}
+			kappa--;
+			sl_uint64 rest = ((sl_uint64)p1 << shift) + p2;
+			if (rest <= delta) {
+				K += kappa;
+				_JsonWriter_roundWeed(buffer, len, delta, rest, (sl_uint64)(_JsonWriter_pow10[kappa]) << shift, distance);
+				return;
+			}
+		}
+		for (;;) {
+			p2 *= 10;
+			delta *= 10;
+			sl_char8 d = (sl_char8)(p2 >> shift);
+			if (d || len) {
+				buffer[len++] = (sl_char8)('0' + d);
+			}
+			p2 &= one - 1;
+			kappa++;
+			if (p2 < delta) {
+				K -= kappa;
+				_JsonWriter_roundWeed(buffer, len, delta, p2, one, kappa < 10 ? distance * _JsonWriter_pow10[kappa] : 0);
+				return;
+			}
+		}
+	}
+
+	// v = f * 2^e (f > 0); the lower boundary is closer when `f` is the smallest significand of a binade
+	static void _JsonWriter_grisu2(sl_uint64 f, sl_int32 e, sl_bool flagLowerBoundaryCloser, sl_char8* buffer, sl_int32& len, sl_int32& K)
+	{
+		_JsonWriter_DiyFp plus = _JsonWriter_normalize((f << 1) + 1, e - 1);
+		_JsonWriter_DiyFp minus;
+		if (flagLowerBoundaryCloser) {
+			minus.f = (f << 2) - 1;
+			minus.e = e - 2;
+		} else {
+			minus.f = (f << 1) - 1;
+			minus.e = e - 1;
+		}
+		minus.f <<= minus.e - plus.e;
+		minus.e = plus.e;
+		_JsonWriter_DiyFp c = _JsonWriter_getCachedPower(plus.e, K);
+		_JsonWriter_DiyFp W = _JsonWriter_multiply(_JsonWriter_normalize(f, e), c);
+		_JsonWriter_DiyFp Wp = _JsonWriter_multiply(plus, c);
+		_JsonWriter_DiyFp Wm = _JsonWriter_multiply(minus, c);
+		Wm.f++;
+		Wp.f--;
+		_JsonWriter_generateDigits(W, Wp, Wp.f - Wm.f, buffer, len, K);
+	}
+
+	SLIB_INLINE static sl_size _JsonWriter_writeExponent(sl_char8* out, sl_int32 exponent)
+	{
+		sl_size n = 0;
+		if (exponent < 0) {
+			out[n++] = '-';
+			exponent = -exponent;
+		}
+		if (exponent >= 100) {
+			out[n++] = (sl_char8)('0' + exponent / 100);
+			exponent %= 100;
+			out[n++] = _JsonWriter_digits[exponent << 1];
+			out[n++] = _JsonWriter_digits[(exponent << 1) + 1];
+		} else if (exponent >= 10) {
+			out[n++] = _JsonWriter_digits[exponent << 1];
+			out[n++] = _JsonWriter_digits[(exponent << 1) + 1];
+		} else {
+			out[n++] = (sl_char8)('0' + exponent);
+		}
+		return n;
+	}
+
+	// places the decimal point into `len` digits multiplied by 10^K; `buffer` must have 32 bytes
+	static sl_size _JsonWriter_formatDecimal(sl_char8* buffer, sl_int32 len, sl_int32 K)
+	{
+		sl_int32 kk = len + K;
+		if (K >= 0 && kk <= 21) {
+			// 1234e7 -> 12340000000.0
+			for (sl_int32 i = len; i < kk; i++) {
+				buffer[i] = '0';
+			}
+			buffer[kk] = '.';
+			buffer[kk + 1] = '0';
+			return kk + 2;
+		} else if (kk > 0 && kk <= 21) {
+			// 1234e-2 -> 12.34
+			Base::moveMemory(buffer + kk + 1, buffer + kk, len - kk);
+			buffer[kk] = '.';
+			return len + 1;
+		} else if (kk > -6 && kk <= 0) {
+			// 1234e-6 -> 0.001234
+			sl_int32 offset = 2 - kk;
+			Base::moveMemory(buffer + offset, buffer, len);
+			buffer[0] = '0';
+			buffer[1] = '.';
+			for (sl_int32 i = 2; i < offset; i++) {
+				buffer[i] = '0';
+			}
+			return len + offset;
+		} else if (len == 1) {
+			// 1e30
+			buffer[1] = 'e';
+			return 2 + _JsonWriter_writeExponent(buffer + 2, kk - 1);
+		} else {
+			// 1234e30 -> 1.234e33
+			Base::moveMemory(buffer + 2, buffer + 1, len - 1);
+			buffer[1] = '.';
+			buffer[len + 1] = 'e';
+			return len + 2 + _JsonWriter_writeExponent(buffer + len + 2, kk - 1);
+		}
+	}
+
+	static sl_size _JsonWriter_formatDouble(sl_char8* out, double value)
+	{
+		union {
+			double d;
+			sl_uint64 n;
+		} u;
+		u.d = value;
+		sl_uint64 bits = u.n;
+		sl_size n = 0;
+		if (bits >> 63) {
+			out[n++] = '-';
+		}
+		sl_uint32 biased = (sl_uint32)((bits >> 52) & 0x7FF);
+		sl_uint64 significand = bits & SLIB_UINT64(0xFFFFFFFFFFFFF);
+		if (!biased && !significand) {
+			out[n++] = '0';
+			out[n++] = '.';
+			out[n++] = '0';
+			return n;
+		}
+		sl_uint64 f;
+		sl_int32 e;
+		if (biased) {
+			f = significand | SLIB_UINT64(0x10000000000000);
+			e = (sl_int32)biased - 1075;
+		} else {
+			f = significand;
+			e = -1074;
+		}
+		sl_int32 len, K;
+		_JsonWriter_grisu2(f, e, !significand && biased > 1, out + n, len, K);
+		return n + _JsonWriter_formatDecimal(out + n, len, K);
+	}
+
+	static sl_size _JsonWriter_formatFloat(sl_char8* out, float value)
+	{
+		union {
+			float f;
+			sl_uint32 n;
+		} u;
+		u.f = value;
+		sl_uint32 bits = u.n;
+		sl_size n = 0;
+		if (bits >> 31) {
+			out[n++] = '-';
+		}
+		sl_uint32 biased = (bits >> 23) & 0xFF;
+		sl_uint32 significand = bits & 0x7FFFFF;
+		if (!biased && !significand) {
+			out[n++] = '0';
+			out[n++] = '.';
+			out[n++] = '0';
+			return n;
+		}
+		sl_uint64 f;
+		sl_int32 e;
+		if (biased) {
+			f = significand | 0x800000;
+			e = (sl_int32)biased - 150;
+		} else {
+			f = significand;
+			e = -149;
+		}
+		sl_int32 len, K;
+		_JsonWriter_grisu2(f, e, !significand && biased > 1, out + n, len, K);
+		return n + _JsonWriter_formatDecimal(out + n, len, K);
+	}
+
+
+	JsonWriter::JsonWriter()
+	{
+		m_sizeChunk = SLIB_JSON_WRITER_DEFAULT_CHUNK_SIZE;
+		m_buf = sl_null;
+		m_pos = 0;
+		m_size = 0;
+		m_lengthFlushed = 0;
+		m_flagComma = sl_false;
+		m_flagAfterKey = sl_false;
+		m_flagError = sl_false;
+	}
+
+	JsonWriter::~JsonWriter()
+	{
+		close();
+	}
+
+	void JsonWriter::open()
+	{
+		close();
+		m_sizeChunk = SLIB_JSON_WRITER_DEFAULT_CHUNK_SIZE;
+	}
+
+	void JsonWriter::open(const Ptr<IWriter>& writer, sl_size chunkSize)
+	{
+		close();
+		m_writer = writer;
+		if (chunkSize < _JSON_WRITER_MIN_CHUNK_SIZE) {
+			chunkSize = _JSON_WRITER_MIN_CHUNK_SIZE;
+		}
+		m_sizeChunk = chunkSize;
+	}
+
+	sl_bool JsonWriter::close()
+	{
+		sl_bool flagSuccess = flush() && !m_flagError;
+		m_writer.setNull();
+		m_chunk.setNull();
+		m_chunks.setNull();
+		m_buf = sl_null;
+		m_pos = 0;
+		m_size = 0;
+		m_lengthFlushed = 0;
+		m_levels.setNull();
+		m_flagComma = sl_false;
+		m_flagAfterKey = sl_false;
+		m_flagError = sl_false;
+		return flagSuccess;
+	}
+
+	sl_bool JsonWriter::flush()
+	{
+		if (m_writer.isNull() || !m_pos) {
+			return sl_true;
+		}
+		return _flushChunk();
+	}
+
+	sl_bool JsonWriter::_flushChunk()
+	{
+		if (m_writer.isNotNull()) {
+			if (m_writer->writeFully(m_buf, m_pos) != (sl_reg)m_pos) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+		} else {
+			if (!(m_chunks.add_NoLock(m_chunk.sub(0, m_pos)))) {
+				m_flagError = sl_true;
+				return sl_false;
+			}
+			m_chunk.setNull();
+			m_buf = sl_null;
+			m_size = 0;
+		}
+		m_lengthFlushed += m_pos;
+		m_pos = 0;
+		return sl_true;
+	}
+
+	SLIB_INLINE sl_bool JsonWriter::_reserve(sl_size size)
+	{
+		if (m_pos + size <= m_size) {
+			return sl_true;
+		}
+		return _grow(size);
+	}
+
+	sl_bool JsonWriter::_grow(sl_size size)
+	{
+		sl_size sizeNew;
+		if (m_writer.isNotNull()) {
+			if (m_pos) {
+				if (!(_flushChunk())) {
+					return sl_false;
+				}
+			}
+			if (size <= m_size) {
+				return sl_true;
+			}
+			sizeNew = m_sizeChunk;
+		} else {
+			// the chunks grow up to `m_sizeChunk` so that small outputs stay small
+			sizeNew = m_size ? m_size << 1 : _JSON_WRITER_INITIAL_CHUNK_SIZE;
+			if (sizeNew > m_sizeChunk) {
+				sizeNew = m_sizeChunk;
+			}
+			if (m_pos) {
+				if (!(_flushChunk())) {
+					return sl_false;
+				}
+			}
+		}
+		if (sizeNew < size) {
+			sizeNew = size;
+		}
+		Memory chunk = Memory::create(sizeNew);
+		if (chunk.isNull()) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		m_chunk = chunk;
+		m_buf = (sl_char8*)(chunk.getData());
+		m_size = sizeNew;
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_beginValue()
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		if (m_flagAfterKey) {
+			m_flagAfterKey = sl_false;
+			m_flagComma = sl_true;
+			return sl_true;
+		}
+		sl_size depth = m_levels.getCount();
+		if (depth) {
+			if (m_levels.getData()[depth - 1]) {
+				// value in an object without a key
+				m_flagError = sl_true;
+				return sl_false;
+			}
+		}
+		if (m_flagComma) {
+			if (!(_reserve(1))) {
+				return sl_false;
+			}
+			m_buf[m_pos++] = depth ? ',' : '\n';
+		}
+		m_flagComma = sl_true;
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_beginContainer(sl_bool flagObject, sl_char8 ch)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		if (!(m_levels.add_NoLock(flagObject))) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		m_buf[m_pos++] = ch;
+		m_flagComma = sl_false;
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_endContainer(sl_bool flagObject, sl_char8 ch)
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		sl_size depth = m_levels.getCount();
+		if (!depth || m_levels.getData()[depth - 1] != flagObject || m_flagAfterKey) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_levels.popBack_NoLock();
+		m_buf[m_pos++] = ch;
+		m_flagComma = sl_true;
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::beginObject()
+	{
+		return _beginContainer(sl_true, '{');
+	}
+
+	sl_bool JsonWriter::endObject()
+	{
+		return _endContainer(sl_true, '}');
+	}
+
+	sl_bool JsonWriter::beginArray()
+	{
+		return _beginContainer(sl_false, '[');
+	}
+
+	sl_bool JsonWriter::endArray()
+	{
+		return _endContainer(sl_false, ']');
+	}
+
+	sl_bool JsonWriter::writeKey(const sl_char8* key, sl_size len)
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		sl_size depth = m_levels.getCount();
+		if (!depth || !(m_levels.getData()[depth - 1]) || m_flagAfterKey) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (m_flagComma) {
+			if (!(_reserve(1))) {
+				return sl_false;
+			}
+			m_buf[m_pos++] = ',';
+		}
+		if (!(_writeEscaped(key, len))) {
+			return sl_false;
+		}
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_buf[m_pos++] = ':';
+		m_flagAfterKey = sl_true;
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::writeKey(const sl_char8* key)
+	{
+		return writeKey(key, Base::getStringLength(key));
+	}
+
+	sl_bool JsonWriter::writeKey(const String& key)
+	{
+		return writeKey(key.getData(), key.getLength());
+	}
+
+	sl_bool JsonWriter::writeNull()
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		return _writeAscii("null", 4);
+	}
+
+	sl_bool JsonWriter::writeBoolean(sl_bool value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (value) {
+			return _writeAscii("true", 4);
+		} else {
+			return _writeAscii("false", 5);
+		}
+	}
+
+	sl_bool JsonWriter::writeInt32(sl_int32 value)
+	{
+		return writeInt64(value);
+	}
+
+	sl_bool JsonWriter::writeUint32(sl_uint32 value)
+	{
+		return writeUint64(value);
+	}
+
+	sl_bool JsonWriter::writeInt64(sl_int64 value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (!(_reserve(_JSON_WRITER_MAX_NUMBER_LENGTH))) {
+			return sl_false;
+		}
+		m_pos += _JsonWriter_formatInt64(m_buf + m_pos, value);
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::writeUint64(sl_uint64 value)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (!(_reserve(_JSON_WRITER_MAX_NUMBER_LENGTH))) {
+			return sl_false;
+		}
+		m_pos += _JsonWriter_formatUint64(m_buf + m_pos, value);
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::writeFloat(float value)
+	{
+		if (Math::isNaN(value) || Math::isInfinite(value)) {
+			return writeNull();
+		}
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (!(_reserve(_JSON_WRITER_MAX_NUMBER_LENGTH))) {
+			return sl_false;
+		}
+		m_pos += _JsonWriter_formatFloat(m_buf + m_pos, value);
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::writeDouble(double value)
+	{
+		if (Math::isNaN(value) || Math::isInfinite(value)) {
+			return writeNull();
+		}
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		if (!(_reserve(_JSON_WRITER_MAX_NUMBER_LENGTH))) {
+			return sl_false;
+		}
+		m_pos += _JsonWriter_formatDouble(m_buf + m_pos, value);
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::writeString(const sl_char8* str, sl_size len)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		return _writeEscaped(str, len);
+	}
+
+	sl_bool JsonWriter::writeString(const sl_char8* str)
+	{
+		return writeString(str, Base::getStringLength(str));
+	}
+
+	sl_bool JsonWriter::writeString(const String& str)
+	{
+		return writeString(str.getData(), str.getLength());
+	}
+
+	sl_bool JsonWriter::writeString(const sl_char16* str, sl_size len)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		return _writeEscaped(str, len);
+	}
+
+	sl_bool JsonWriter::writeString(const String16& str)
+	{
+		return writeString(str.getData(), str.getLength());
+	}
+
+	sl_bool JsonWriter::writeValue(const Variant& value)
+	{
+		if (m_flagError) {
+			return sl_false;
+		}
+		return _writeVariant(value);
+	}
+
+	sl_bool JsonWriter::writeRawValue(const sl_char8* json, sl_size len)
+	{
+		if (!(_beginValue())) {
+			return sl_false;
+		}
+		return _writeAscii(json, len);
+	}
+
+	sl_uint32 JsonWriter::getDepth() const
+	{
+		return (sl_uint32)(m_levels.getCount());
+	}
+
+	sl_bool JsonWriter::isError() const
+	{
+		return m_flagError;
+	}
+
+	sl_uint64 JsonWriter::getOutputLength() const
+	{
+		return m_lengthFlushed + m_pos;
+	}
+
+	Memory JsonWriter::getOutput()
+	{
+		if (m_writer.isNotNull()) {
+			return sl_null;
+		}
+		sl_size nChunks = m_chunks.getCount();
+		if (!nChunks) {
+			if (m_pos) {
+				return m_chunk.sub(0, m_pos);
+			}
+			return sl_null;
+		}
+		Memory ret = Memory::create((sl_size)(getOutputLength()));
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		sl_char8* p = (sl_char8*)(ret.getData());
+		Memory* chunks = m_chunks.getData();
+		for (sl_size i = 0; i < nChunks; i++) {
+			sl_size n = chunks[i].getSize();
+			Base::copyMemory(p, chunks[i].getData(), n);
+			p += n;
+		}
+		if (m_pos) {
+			Base::copyMemory(p, m_buf, m_pos);
+		}
+		return ret;
+	}
+
+	String JsonWriter::getOutputString()
+	{
+		if (m_writer.isNotNull()) {
+			return sl_null;
+		}
+		String ret = String::allocate((sl_size)(getOutputLength()));
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		sl_char8* p = ret.getData();
+		ListElements<Memory> chunks(m_chunks);
+		for (sl_size i = 0; i < chunks.count; i++) {
+			sl_size n = chunks[i].getSize();
+			Base::copyMemory(p, chunks[i].getData(), n);
+			p += n;
+		}
+		if (m_pos) {
+			Base::copyMemory(p, m_buf, m_pos);
+		}
+		return ret;
+	}
+
+	List<Memory> JsonWriter::getOutputChunks()
+	{
+		if (m_writer.isNotNull()) {
+			return sl_null;
+		}
+		List<Memory> ret = m_chunks.duplicate_NoLock();
+		if (m_pos) {
+			ret.add_NoLock(m_chunk.sub(0, m_pos));
+		}
+		return ret;
+	}
+
+	Memory JsonWriter::serialize(const Variant& value)
+	{
+		JsonWriter writer;
+		if (writer.writeValue(value)) {
+			return writer.getOutput();
+		}
+		return sl_null;
+	}
+
+	String JsonWriter::serializeToString(const Variant& value)
+	{
+		JsonWriter writer;
+		if (writer.writeValue(value)) {
+			return writer.getOutputString();
+		}
+		return sl_null;
+	}
+
+	sl_bool JsonWriter::_writeAscii(const sl_char8* str, sl_size len)
+	{
+		while (len) {
+			if (m_pos >= m_size) {
+				if (!(_grow(1))) {
+					return sl_false;
+				}
+			}
+			sl_size n = m_size - m_pos;
+			if (n > len) {
+				n = len;
+			}
+			Base::copyMemory(m_buf + m_pos, str, n);
+			m_pos += n;
+			str += n;
+			len -= n;
+		}
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_writeEscaped(const sl_char8* str, sl_size len)
+	{
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_buf[m_pos++] = '"';
+		const sl_char8* end = str + len;
+		while (str < end) {
+			sl_size n = _JsonWriter_getPlainLength(str, end - str);
+			if (n) {
+				if (!(_writeAscii(str, n))) {
+					return sl_false;
+				}
+				str += n;
+				if (str >= end) {
+					break;
+				}
+			}
+			if (!(_reserve(6))) {
+				return sl_false;
+			}
+			sl_uint8 ch = (sl_uint8)(*str);
+			m_pos += _JsonWriter_writeEscape(m_buf + m_pos, ch, _JsonWriter_escapes[ch]);
+			str++;
+		}
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_buf[m_pos++] = '"';
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_writeEscaped(const sl_char16* str, sl_size len)
+	{
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_buf[m_pos++] = '"';
+		sl_size i = 0;
+		while (i < len) {
+			sl_size n = len - i;
+			if (n > _JSON_WRITER_UTF16_BLOCK) {
+				n = _JSON_WRITER_UTF16_BLOCK;
+			}
+			// a surrogate pair at the end of the block is written with the next character
+			if (!(_reserve(n * 6 + 6))) {
+				return sl_false;
+			}
+			sl_size end = i + n;
+			sl_char8* out = m_buf + m_pos;
+			while (i < end) {
+				sl_uint32 ch = (sl_uint16)(str[i++]);
+				if (ch < 0x80) {
+					sl_char8 escape = _JsonWriter_escapes[ch];
+					if (escape) {
+						out += _JsonWriter_writeEscape(out, ch, escape);
+					} else {
+						*(out++) = (sl_char8)ch;
+					}
+				} else if (ch < 0x800) {
+					out[0] = (sl_char8)(0xC0 | (ch >> 6));
+					out[1] = (sl_char8)(0x80 | (ch & 0x3F));
+					out += 2;
+				} else if (ch >= 0xD800 && ch < 0xE000) {
+					sl_uint32 low = i < len ? (sl_uint16)(str[i]) : 0;
+					if (ch < 0xDC00 && low >= 0xDC00 && low < 0xE000) {
+						i++;
+						sl_uint32 code = 0x10000 + (((ch - 0xD800) << 10) | (low - 0xDC00));
+						out[0] = (sl_char8)(0xF0 | (code >> 18));
+						out[1] = (sl_char8)(0x80 | ((code >> 12) & 0x3F));
+						out[2] = (sl_char8)(0x80 | ((code >> 6) & 0x3F));
+						out[3] = (sl_char8)(0x80 | (code & 0x3F));
+						out += 4;
+					} else {
+						// unpaired surrogate can not be encoded in UTF-8
+						out += _JsonWriter_writeEscape(out, ch, 'u');
+					}
+				} else {
+					out[0] = (sl_char8)(0xE0 | (ch >> 12));
+					out[1] = (sl_char8)(0x80 | ((ch >> 6) & 0x3F));
+					out[2] = (sl_char8)(0x80 | (ch & 0x3F));
+					out += 3;
+				}
+			}
+			m_pos = out - m_buf;
+		}
+		if (!(_reserve(1))) {
+			return sl_false;
+		}
+		m_buf[m_pos++] = '"';
+		return sl_true;
+	}
+
+	sl_bool JsonWriter::_writeVariant(const Variant& value)
+	{
+		switch (value._type) {
+			case VariantType::Null:
+				return writeNull();
+			case VariantType::Int32:
+				return writeInt64(_JsonWriter_getVariantValue<sl_int32>(value));
+			case VariantType::Uint32:
+				return writeUint64(_JsonWriter_getVariantValue<sl_uint32>(value));
+			case VariantType::Int64:
+				return writeInt64(_JsonWriter_getVariantValue<sl_int64>(value));
+			case VariantType::Uint64:
+				return writeUint64(_JsonWriter_getVariantValue<sl_uint64>(value));
+			case VariantType::Float:
+				return writeFloat(_JsonWriter_getVariantValue<float>(value));
+			case VariantType::Double:
+				return writeDouble(_JsonWriter_getVariantValue<double>(value));
+			case VariantType::Boolean:
+				return writeBoolean(_JsonWriter_getVariantValue<sl_bool>(value));
+			case VariantType::String8:
+				{
+					// written from the container without copying the string reference
+					StringContainer* container = _JsonWriter_getVariantValue<StringContainer*>(value);
+					if (container) {
+						return writeString(container->sz, container->len);
+					}
+					return writeString(String::getEmpty());
+				}
+			case VariantType::String16:
+				{
+					StringContainer16* container = _JsonWriter_getVariantValue<StringContainer16*>(value);
+					if (container) {
+						return writeString(container->sz, container->len);
+					}
+					return writeString(String16::getEmpty());
+				}
+			case VariantType::Sz8:
+				return writeString(_JsonWriter_getVariantValue<const sl_char8*>(value));
+			case VariantType::Sz16:
+				{
+					const sl_char16* sz = _JsonWriter_getVariantValue<const sl_char16*>(value);
+					return writeString(sz, Base::getStringLength2(sz));
+				}
+			case VariantType::Time:
+				return writeString(value.getTime().toString());
+			case VariantType::Object:
+			case VariantType::Weak:
+				{
+					Ref<Referable> obj(value.getObject());
+					if (obj.isNotNull()) {
+						if (CList<Variant>* p1 = CastInstance< CList<Variant> >(obj._ptr)) {
+							return _writeVariantList(p1);
+						} else if (IMap<String, Variant>* p2 = CastInstance< IMap<String, Variant> >(obj._ptr)) {
+							return _writeVariantMap(p2);
+						} else if (CList< Map<String, Variant> >* p3 = CastInstance< CList< Map<String, Variant> > >(obj._ptr)) {
+							return _writeVariantMapList(p3);
+						}
+					}
+					return writeNull();
+				}
+			default:
+				return writeNull();
+		}
+	}
+
+	sl_bool JsonWriter::_writeVariantList(const List<Variant>& list)
+	{
+		if (!(beginArray())) {
+			return sl_false;
+		}
+		ListLocker<Variant> items(list);
+		for (sl_size i = 0; i < items.count; i++) {
+			if (!(_writeVariant(items[i]))) {
+				return sl_false;
+			}
+		}
+		return endArray();
+	}
+
+	sl_bool JsonWriter::_writeVariantMap(const Map<String, Variant>& map)
+	{
+		if (!(beginObject())) {
+			return sl_false;
+		}
+		Iterator< Pair<String, Variant> > iterator(map.toIterator());
+		Pair<String, Variant> pair;
+		while (iterator.next(&pair)) {
+			if (!(writeKey(pair.key))) {
+				return sl_false;
+			}
+			if (!(_writeVariant(pair.value))) {
+				return sl_false;
+			}
+		}
+		return endObject();
+	}
+
+	sl_bool JsonWriter::_writeVariantMapList(const List< Map<String, Variant> >& list)
+	{
+		if (!(beginArray())) {
+			return sl_false;
+		}
+		ListLocker< Map<String, Variant> > items(list);
+		for (sl_size i = 0; i < items.count; i++) {
+			if (!(_writeVariantMap(items[i]))) {
+				return sl_false;
+			}
+		}
+		return endArray();
+	}
+
+}
@@ -12,6 +12,9 @@
 
 #include "slib/core/file.h"
 #include "slib/core/variant.h"
+#include "slib/core/thread.h"
+#include "slib/core/event.h"
+#include "slib/core/system.h"
 #include "slib/core/safe_static.h"
 
 #if defined(SLIB_PLATFORM_IS_ANDROID)
@@ -22,6 +25,16 @@
 #include <dlog.h>
 #endif
 
+#if defined(SLIB_PLATFORM_IS_UNIX)
+#include <sys/uio.h>
+#include <errno.h>
+#endif
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#define USE_CPP_ATOMIC
+#include <atomic>
+#endif
+
 namespace slib
 {
 
@@ -85,6 +98,577 @@ namespace slib
 		}
 	}
 	
+
+	AsyncFileLoggerParam::AsyncFileLoggerParam()
+	{
+		maxFileSize = 0;
+		rotationInterval = 0;
+		maxBackupFilesCount = 5;
+		
+		flushInterval = 200;
+		flushThreshold = 0x10000;
+		
+		maxPendingSize = 0x1000000;
+		flagBlockWhenFull = sl_false;
+	}
+
+	AsyncFileLoggerParam::AsyncFileLoggerParam(const String& _fileName): AsyncFileLoggerParam()
+	{
+		fileName = _fileName;
+	}
+
+	AsyncFileLoggerParam::~AsyncFileLoggerParam()
+	{
+	}
+
+
+	#define ASYNC_FILE_LOGGER_CHUNK_SIZE 0x10000
+	// count of the loggers remembered by each logging thread
+	#define ASYNC_FILE_LOGGER_THREAD_SLOTS 4
+	// segments passed to one `writev()` call (the minimum of `IOV_MAX` required by POSIX)
+	#define ASYNC_FILE_LOGGER_MAX_SEGMENTS_PER_CALL 1024
+
+	template <class T>
+	SLIB_INLINE static T _AsyncFileLogger_load(T volatile const* p)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<T>*)p)->load(std::memory_order_acquire);
+#else
+		return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	template <class T>
+	SLIB_INLINE static void _AsyncFileLogger_store(T volatile* p, T value)
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<T>*)p)->store(value, std::memory_order_release);
+#else
+		__atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+	}
+
+	struct _AsyncFileLogger_Chunk
+	{
+		// set by the producer when the chunk is full, after the last update of `size`
+		_AsyncFileLogger_Chunk* volatile next;
+		volatile sl_size size;
+		sl_size capacity;
+
+		// the data follows the header
+		SLIB_INLINE char* getData()
+		{
+			return (char*)(this + 1);
+		}
+
+		static _AsyncFileLogger_Chunk* create(sl_size capacity)
+		{
+			_AsyncFileLogger_Chunk* chunk = (_AsyncFileLogger_Chunk*)(Base::createMemory(sizeof(_AsyncFileLogger_Chunk) + capacity));
+			if (chunk) {
+				chunk->next = sl_null;
+				chunk->size = 0;
+				chunk->capacity = capacity;
+			}
+			return chunk;
+		}
+	};
+
+	/*
+		Single-producer single-consumer staging buffer of a logging thread.
+		The producer appends to the last chunk and publishes the new size;
+		the flusher reads from the first chunk and frees the chunks it has passed.
+	*/
+	class _AsyncFileLogger_Staging : public Referable
+	{
+	public:
+		// written by the producer
+		_AsyncFileLogger_Chunk* chunkWrite;
+		volatile sl_uint64 sizeLogged;
+		volatile sl_uint64 countDropped;
+
+		// written by the flusher
+		_AsyncFileLogger_Chunk* chunkRead;
+		sl_size offsetRead;
+		volatile sl_uint64 sizeWritten;
+
+	public:
+		_AsyncFileLogger_Staging()
+		{
+			chunkWrite = sl_null;
+			sizeLogged = 0;
+			countDropped = 0;
+			chunkRead = sl_null;
+			offsetRead = 0;
+			sizeWritten = 0;
+		}
+
+		~_AsyncFileLogger_Staging()
+		{
+			_AsyncFileLogger_Chunk* chunk = chunkRead;
+			while (chunk) {
+				_AsyncFileLogger_Chunk* next = chunk->next;
+				Base::freeMemory(chunk);
+				chunk = next;
+			}
+		}
+
+	public:
+		static Ref<_AsyncFileLogger_Staging> create()
+		{
+			_AsyncFileLogger_Chunk* chunk = _AsyncFileLogger_Chunk::create(ASYNC_FILE_LOGGER_CHUNK_SIZE);
+			if (chunk) {
+				Ref<_AsyncFileLogger_Staging> ret = new _AsyncFileLogger_Staging;
+				if (ret.isNotNull()) {
+					ret->chunkWrite = chunk;
+					ret->chunkRead = chunk;
+					return ret;
+				}
+				Base::freeMemory(chunk);
+			}
+			return sl_null;
+		}
+
+		SLIB_INLINE sl_uint64 getLoggedSize()
+		{
+			return _AsyncFileLogger_load(&sizeLogged);
+		}
+
+		// producer only
+		SLIB_INLINE sl_uint64 getPendingSize()
+		{
+			return sizeLogged - _AsyncFileLogger_load(&sizeWritten);
+		}
+
+		// producer only
+		sl_bool append(const char* data, sl_size len)
+		{
+			_AsyncFileLogger_Chunk* chunk = chunkWrite;
+			sl_size size = chunk->size;
+			if (chunk->capacity - size < len) {
+				_AsyncFileLogger_Chunk* chunkNew = _AsyncFileLogger_Chunk::create(SLIB_MAX(len, (sl_size)ASYNC_FILE_LOGGER_CHUNK_SIZE));
+				if (!chunkNew) {
+					return sl_false;
+				}
+				// the flusher frees `chunk` once it sees `next`: it is not touched after this
+				_AsyncFileLogger_store(&(chunk->next), chunkNew);
+				chunkWrite = chunkNew;
+				chunk = chunkNew;
+				size = 0;
+			}
+			Base::copyMemory(chunk->getData() + size, data, len);
+			_AsyncFileLogger_store(&(chunk->size), size + len);
+			_AsyncFileLogger_store(&sizeLogged, sizeLogged + len);
+			return sl_true;
+		}
+
+		// producer only
+		SLIB_INLINE void addDropped()
+		{
+			_AsyncFileLogger_store(&countDropped, countDropped + 1);
+		}
+
+		SLIB_INLINE sl_bool isDrained()
+		{
+			return _AsyncFileLogger_load(&sizeWritten) == _AsyncFileLogger_load(&sizeLogged);
+		}
+	};
+
+	struct _AsyncFileLogger_ThreadStagings
+	{
+		sl_uint64 ids[ASYNC_FILE_LOGGER_THREAD_SLOTS];
+		Ref<_AsyncFileLogger_Staging> stagings[ASYNC_FILE_LOGGER_THREAD_SLOTS];
+		sl_uint32 indexNext;
+
+		_AsyncFileLogger_ThreadStagings()
+		{
+			Base::zeroMemory(ids, sizeof(ids));
+			indexNext = 0;
+		}
+	};
+
+	// the stagings of the exited threads are released by the flusher when they are drained
+	static SLIB_THREAD _AsyncFileLogger_ThreadStagings _g_async_file_logger_thread_stagings;
+
+	static sl_int64 _g_async_file_logger_last_id = 0;
+
+	struct _AsyncFileLogger_Segment
+	{
+		const char* data;
+		sl_size size;
+	};
+
+	struct _AsyncFileLogger_Cursor
+	{
+		_AsyncFileLogger_Staging* staging;
+		_AsyncFileLogger_Chunk* chunk;
+		sl_size offset;
+		sl_size size;
+	};
+
+	struct _AsyncFileLogger_FlushTarget
+	{
+		Ref<_AsyncFileLogger_Staging> staging;
+		sl_uint64 size;
+	};
+
+
+	SLIB_DEFINE_OBJECT(AsyncFileLogger, Logger)
+
+	AsyncFileLogger::AsyncFileLogger()
+	{
+		m_id = Base::interlockedIncrement64(&_g_async_file_logger_last_id);
+		m_countDropped = 0;
+		m_flagRunning = sl_false;
+		m_sizeFile = 0;
+		m_timeFileOpened = 0;
+	}
+
+	AsyncFileLogger::~AsyncFileLogger()
+	{
+		release();
+	}
+
+	Ref<AsyncFileLogger> AsyncFileLogger::create(const AsyncFileLoggerParam& param)
+	{
+		if (param.fileName.isEmpty()) {
+			return sl_null;
+		}
+		Ref<AsyncFileLogger> ret = new AsyncFileLogger;
+		if (ret.isNotNull()) {
+			ret->m_param = param;
+			ret->m_eventWritten = Event::create(sl_false);
+			if (ret->m_eventWritten.isNotNull()) {
+				ret->m_flagRunning = sl_true;
+				ret->m_thread = Thread::start(SLIB_FUNCTION_CLASS(AsyncFileLogger, _run, ret.get()));
+				if (ret->m_thread.isNotNull()) {
+					return ret;
+				}
+				ret->m_flagRunning = sl_false;
+			}
+		}
+		return sl_null;
+	}
+
+	void AsyncFileLogger::log(const String& tag, const String& content)
+	{
+		String s = _Log_getLineString(tag, content) + "\r\n";
+		sl_size len = s.getLength();
+		if (!len) {
+			return;
+		}
+		if (!m_flagRunning) {
+			return;
+		}
+		_AsyncFileLogger_Staging* staging = _getStaging();
+		if (!staging) {
+			return;
+		}
+		for (;;) {
+			sl_uint64 sizePending = staging->getPendingSize();
+			if (sizePending + len <= m_param.maxPendingSize || sizePending == 0) {
+				if (staging->append(s.getData(), len)) {
+					// wakes the flusher once per crossing of the threshold
+					if (sizePending < m_param.flushThreshold && sizePending + len >= m_param.flushThreshold) {
+						m_thread->wake();
+					}
+				} else {
+					staging->addDropped();
+				}
+				return;
+			}
+			if (!(m_param.flagBlockWhenFull)) {
+				staging->addDropped();
+				return;
+			}
+			// back-pressure: wait until the flusher drains the pending lines
+			m_eventWritten->reset();
+			m_thread->wake();
+			m_eventWritten->wait(10);
+			if (!m_flagRunning) {
+				return;
+			}
+		}
+	}
+
+	void AsyncFileLogger::flush()
+	{
+		List<_AsyncFileLogger_FlushTarget> targets;
+		{
+			SpinLocker lock(&m_lockStagings);
+			ListElements< Ref<_AsyncFileLogger_Staging> > stagings(m_stagings);
+			for (sl_size i = 0; i < stagings.count; i++) {
+				_AsyncFileLogger_FlushTarget target;
+				target.size = stagings[i]->getLoggedSize();
+				target.staging = stagings[i];
+				targets.add_NoLock(target);
+			}
+		}
+		ListElements<_AsyncFileLogger_FlushTarget> items(targets);
+		sl_size index = 0;
+		while (index < items.count) {
+			if (_AsyncFileLogger_load(&(items[index].staging->sizeWritten)) >= items[index].size) {
+				index++;
+				continue;
+			}
+			Ref<Thread> thread = m_thread;
+			if (thread.isNull() || !(thread->isRunning())) {
+				return;
+			}
+			m_eventWritten->reset();
+			if (_AsyncFileLogger_load(&(items[index].staging->sizeWritten)) >= items[index].size) {
+				continue;
+			}
+			thread->wake();
+			m_eventWritten->wait(10);
+		}
+	}
+
+	void AsyncFileLogger::release()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagRunning) {
+			return;
+		}
+		// the lines logged after the last drain of the thread are discarded
+		m_flagRunning = sl_false;
+		Ref<Thread> thread = m_thread;
+		if (thread.isNotNull()) {
+			// the thread writes the remaining lines before exiting
+			thread->finishAndWait();
+		}
+		m_file.setNull();
+	}
+
+	sl_uint64 AsyncFileLogger::getDroppedLinesCount()
+	{
+		SpinLocker lock(&m_lockStagings);
+		sl_uint64 n = m_countDropped;
+		ListElements< Ref<_AsyncFileLogger_Staging> > stagings(m_stagings);
+		for (sl_size i = 0; i < stagings.count; i++) {
+			n += _AsyncFileLogger_load(&(stagings[i]->countDropped));
+		}
+		return n;
+	}
+
+	void AsyncFileLogger::_run()
+	{
+		while (Thread::isNotStoppingCurrent()) {
+			_processPending();
+			Thread::sleep(m_param.flushInterval);
+		}
+		_processPending();
+		m_eventWritten->set();
+	}
+
+	_AsyncFileLogger_Staging* AsyncFileLogger::_getStaging()
+	{
+		_AsyncFileLogger_ThreadStagings& local = _g_async_file_logger_thread_stagings;
+		sl_uint32 i;
+		for (i = 0; i < ASYNC_FILE_LOGGER_THREAD_SLOTS; i++) {
+			if (local.ids[i] == m_id) {
+				return local.stagings[i].get();
+			}
+		}
+		Ref<_AsyncFileLogger_Staging> staging = _AsyncFileLogger_Staging::create();
+		if (staging.isNull()) {
+			return sl_null;
+		}
+		{
+			SpinLocker lock(&m_lockStagings);
+			if (!(m_stagings.add_NoLock(staging))) {
+				return sl_null;
+			}
+		}
+		// a thread using more loggers than the slots replaces the oldest one:
+		// the replaced staging is still drained, and a new one is registered on the next use
+		i = local.indexNext % ASYNC_FILE_LOGGER_THREAD_SLOTS;
+		local.indexNext++;
+		local.ids[i] = m_id;
+		local.stagings[i] = staging;
+		return staging.get();
+	}
+
+	void AsyncFileLogger::_processPending()
+	{
+		List< Ref<_AsyncFileLogger_Staging> > stagings;
+		{
+			SpinLocker lock(&m_lockStagings);
+			// releases the drained stagings which are no longer used by any thread
+			sl_size n = m_stagings.getCount();
+			Ref<_AsyncFileLogger_Staging>* p = m_stagings.getData();
+			for (sl_size i = n; i > 0; i--) {
+				_AsyncFileLogger_Staging* staging = p[i - 1].get();
+				if (staging->getReferenceCount() == 1 && staging->isDrained()) {
+					m_countDropped += staging->countDropped;
+					m_stagings.removeAt_NoLock(i - 1);
+				}
+			}
+			stagings = m_stagings.duplicate_NoLock();
+		}
+		ListElements< Ref<_AsyncFileLogger_Staging> > items(stagings);
+		List<_AsyncFileLogger_Segment> segments;
+		List<_AsyncFileLogger_Cursor> cursors;
+		sl_size sizeTotal = 0;
+		for (sl_size i = 0; i < items.count; i++) {
+			_AsyncFileLogger_Staging* staging = items[i].get();
+			_AsyncFileLogger_Cursor cursor;
+			cursor.staging = staging;
+			cursor.chunk = staging->chunkRead;
+			cursor.offset = staging->offsetRead;
+			cursor.size = 0;
+			for (;;) {
+				// `next` is loaded first: the size of a full chunk is final once `next` is seen
+				_AsyncFileLogger_Chunk* next = _AsyncFileLogger_load(&(cursor.chunk->next));
+				sl_size size = _AsyncFileLogger_load(&(cursor.chunk->size));
+				if (cursor.offset < size) {
+					_AsyncFileLogger_Segment segment;
+					segment.data = cursor.chunk->getData() + cursor.offset;
+					segment.size = size - cursor.offset;
+					if (!(segments.add_NoLock(segment))) {
+						break;
+					}
+					cursor.size += segment.size;
+					cursor.offset = size;
+				}
+				if (!next) {
+					break;
+				}
+				cursor.chunk = next;
+				cursor.offset = 0;
+			}
+			if (cursor.size) {
+				cursors.add_NoLock(cursor);
+				sizeTotal += cursor.size;
+			}
+		}
+		if (sizeTotal) {
+			_write(segments.getData(), (sl_uint32)(segments.getCount()), sizeTotal);
+		}
+		ListElements<_AsyncFileLogger_Cursor> listCursors(cursors);
+		for (sl_size i = 0; i < listCursors.count; i++) {
+			_AsyncFileLogger_Cursor& cursor = listCursors[i];
+			_AsyncFileLogger_Staging* staging = cursor.staging;
+			_AsyncFileLogger_Chunk* chunk = staging->chunkRead;
+			while (chunk != cursor.chunk) {
+				_AsyncFileLogger_Chunk* next = chunk->next;
+				Base::freeMemory(chunk);
+				chunk = next;
+			}
+			staging->chunkRead = cursor.chunk;
+			staging->offsetRead = cursor.offset;
+			_AsyncFileLogger_store(&(staging->sizeWritten), staging->sizeWritten + cursor.size);
+		}
+		m_eventWritten->set();
+	}
+
+	void AsyncFileLogger::_write(const _AsyncFileLogger_Segment* segments, sl_uint32 countSegments, sl_size size)
+	{
+		if (m_file.isNotNull()) {
+			sl_bool flagRotate = sl_false;
+			if (m_param.maxFileSize && m_sizeFile + size > m_param.maxFileSize && m_sizeFile > 0) {
+				flagRotate = sl_true;
+			}
+			if (m_param.rotationInterval && Time::now().getMillisecondsCount() - m_timeFileOpened >= (sl_int64)(m_param.rotationInterval)) {
+				flagRotate = sl_true;
+			}
+			if (flagRotate) {
+				_rotate();
+			}
+		}
+		if (m_file.isNull()) {
+			if (!(_openFile())) {
+				return;
+			}
+		}
+		sl_size sizeWritten = 0;
+		sl_bool flagError = sl_false;
+#if defined(SLIB_PLATFORM_IS_UNIX)
+		int fd = (int)(m_file->getHandle());
+		struct iovec iov[ASYNC_FILE_LOGGER_MAX_SEGMENTS_PER_CALL];
+		sl_uint32 index = 0;
+		sl_size offset = 0;
+		while (index < countSegments) {
+			sl_uint32 n = 0;
+			while (n < ASYNC_FILE_LOGGER_MAX_SEGMENTS_PER_CALL && index + n < countSegments) {
+				const _AsyncFileLogger_Segment& segment = segments[index + n];
+				sl_size skip = n ? 0 : offset;
+				iov[n].iov_base = (void*)(segment.data + skip);
+				iov[n].iov_len = segment.size - skip;
+				n++;
+			}
+			ssize_t m = ::writev(fd, iov, n);
+			if (m <= 0) {
+				if (m < 0 && errno == EINTR) {
+					continue;
+				}
+				flagError = sl_true;
+				break;
+			}
+			sizeWritten += m;
+			// skips the written segments
+			sl_size k = (sl_size)m;
+			while (k) {
+				sl_size remain = segments[index].size - offset;
+				if (k < remain) {
+					offset += k;
+					break;
+				}
+				k -= remain;
+				index++;
+				offset = 0;
+			}
+		}
+#else
+		for (sl_uint32 i = 0; i < countSegments; i++) {
+			sl_reg m = m_file->writeFully(segments[i].data, segments[i].size);
+			if (m > 0) {
+				sizeWritten += m;
+			}
+			if (m != (sl_reg)(segments[i].size)) {
+				flagError = sl_true;
+				break;
+			}
+		}
+#endif
+		m_sizeFile += sizeWritten;
+		if (flagError) {
+			// reopens on the next batch
+			m_file.setNull();
+		}
+	}
+
+	sl_bool AsyncFileLogger::_openFile()
+	{
+		Ref<File> file = File::openForAppend(m_param.fileName);
+		if (file.isNull()) {
+			return sl_false;
+		}
+		m_file = file;
+		m_sizeFile = file->getSize();
+		m_timeFileOpened = Time::now().getMillisecondsCount();
+		return sl_true;
+	}
+
+	void AsyncFileLogger::_rotate()
+	{
+		m_file->close();
+		m_file.setNull();
+		const String& fileName = m_param.fileName;
+		sl_uint32 n = m_param.maxBackupFilesCount;
+		if (n) {
+			File::deleteFile(fileName + "." + String::fromUint32(n));
+			for (sl_uint32 i = n - 1; i > 0; i--) {
+				String path = fileName + "." + String::fromUint32(i);
+				if (File::exists(path)) {
+					File::rename(path, fileName + "." + String::fromUint32(i + 1));
+				}
+			}
+			File::rename(fileName, fileName + ".1");
+		} else {
+			File::deleteFile(fileName);
+		}
+	}
+
 	class ConsoleLogger : public Logger
 	{
 	public:
@@ -216,6 +800,11 @@ namespace slib
 		return new FileLogger(fileName);
 	}
 
+	Ref<Logger> Logger::createAsyncFileLogger(const String& fileName)
+	{
+		return AsyncFileLogger::create(AsyncFileLoggerParam(fileName));
+	}
+
 	void Logger::logGlobal(const String& tag, const String& content)
 	{
 		Ref<LoggerSet> log = global();
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/mapped_file.h"
+
+#define _MAPPED_FILE_MIN_MAPPING_SIZE 0x10000
+
+#ifdef SLIB_ARCH_IS_64BIT
+#define _MAPPED_FILE_DEFAULT_WINDOW_SIZE 0x40000000
+#else
+#define _MAPPED_FILE_DEFAULT_WINDOW_SIZE 0x4000000
+#endif
+
+namespace slib
+{
+
+	SLIB_DEFINE_OBJECT(MappedRegion, Referable)
+
+	MappedRegion::MappedRegion()
+	{
+		m_base = sl_null;
+		m_sizeBase = 0;
+		m_data = sl_null;
+		m_size = 0;
+		m_offset = 0;
+		m_flagWritable = sl_false;
+	}
+
+	MappedRegion::~MappedRegion()
+	{
+		if (m_base) {
+			MappedFile::_unmap(this);
+		}
+	}
+
+	void* MappedRegion::getData() const
+	{
+		return m_data;
+	}
+
+	sl_size MappedRegion::getSize() const
+	{
+		return m_size;
+	}
+
+	sl_uint64 MappedRegion::getOffset() const
+	{
+		return m_offset;
+	}
+
+	sl_bool MappedRegion::isWritable() const
+	{
+		return m_flagWritable;
+	}
+
+	Memory MappedRegion::getMemory()
+	{
+		return Memory::createStatic(m_data, m_size, this);
+	}
+
+
+	SLIB_DEFINE_OBJECT(MappedFile, Referable)
+
+	MappedFile::MappedFile()
+	{
+		m_size = 0;
+		m_flagWritable = sl_false;
+		m_handle = sl_null;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		_free();
+	}
+
+	Ref<MappedFile> MappedFile::open(const Ref<File>& file, sl_bool flagWritable)
+	{
+		if (file.isNotNull() && file->isOpened()) {
+			Ref<MappedFile> ret = new MappedFile;
+			if (ret.isNotNull()) {
+				ret->m_file = file;
+				ret->m_size = file->getSize();
+				ret->m_flagWritable = flagWritable;
+				if (ret->_initialize()) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<MappedFile> MappedFile::open(const String& filePath, sl_bool flagWritable)
+	{
+		Ref<File> file;
+		if (flagWritable) {
+			file = File::open(filePath, FileMode::ReadWrite | FileMode::NotCreate | FileMode::NotTruncate);
+		} else {
+			file = File::openForRead(filePath);
+		}
+		return open(file, flagWritable);
+	}
+
+	Ref<MappedFile> MappedFile::openForRead(const String& filePath)
+	{
+		return open(filePath, sl_false);
+	}
+
+	Ref<MappedFile> MappedFile::openForReadWrite(const String& filePath)
+	{
+		return open(filePath, sl_true);
+	}
+
+	Ref<File> MappedFile::getFile() const
+	{
+		return m_file;
+	}
+
+	sl_uint64 MappedFile::getSize() const
+	{
+		return m_size;
+	}
+
+	sl_bool MappedFile::isWritable() const
+	{
+		return m_flagWritable;
+	}
+
+	Ref<MappedRegion> MappedFile::map(sl_uint64 offset, sl_size size)
+	{
+		if (offset >= m_size || !size) {
+			return sl_null;
+		}
+		if (size > m_size - offset) {
+			size = (sl_size)(m_size - offset);
+		}
+		Ref<MappedRegion> region = new MappedRegion;
+		if (region.isNotNull()) {
+			if (_map(region.get(), offset, size)) {
+				return region;
+			}
+		}
+		return sl_null;
+	}
+
+	Ref<MappedRegion> MappedFile::mapAll()
+	{
+		if ((sl_uint64)((sl_size)m_size) != m_size) {
+			return sl_null;
+		}
+		return map(0, (sl_size)m_size);
+	}
+
+	sl_size MappedFile::getDefaultWindowSize()
+	{
+		return _MAPPED_FILE_DEFAULT_WINDOW_SIZE;
+	}
+
+	sl_size MappedFile::getMinimumMappingSize()
+	{
+		return _MAPPED_FILE_MIN_MAPPING_SIZE;
+	}
+
+	Memory MappedFile::mapAllBytes(const String& filePath, MappedFileAdvice advice)
+	{
+		Ref<File> file = File::openForRead(filePath);
+		if (file.isNull()) {
+			return sl_null;
+		}
+		// small and empty files are read by the fallback
+		if (file->getSize() >= _MAPPED_FILE_MIN_MAPPING_SIZE) {
+			Ref<MappedFile> mapped = open(file, sl_false);
+			if (mapped.isNotNull()) {
+				Ref<MappedRegion> region = mapped->mapAll();
+				if (region.isNotNull()) {
+					if (advice != MappedFileAdvice::Normal) {
+						region->advise(advice);
+					}
+					return region->getMemory();
+				}
+			}
+		}
+		return file->readAllBytes();
+	}
+
+}
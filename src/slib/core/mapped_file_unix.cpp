@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/definition.h"
+
+#ifdef SLIB_PLATFORM_IS_UNIX
+
+#include "slib/core/mapped_file.h"
+
+#define _FILE_OFFSET_BITS 64
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace slib
+{
+
+	sl_bool MappedRegion::advise(MappedFileAdvice advice)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		int flag;
+		switch (advice) {
+			case MappedFileAdvice::Normal:
+				flag = MADV_NORMAL;
+				break;
+			case MappedFileAdvice::Sequential:
+				flag = MADV_SEQUENTIAL;
+				break;
+			case MappedFileAdvice::Random:
+				flag = MADV_RANDOM;
+				break;
+			case MappedFileAdvice::WillNeed:
+				flag = MADV_WILLNEED;
+				break;
+			case MappedFileAdvice::DontNeed:
+				flag = MADV_DONTNEED;
+				break;
+			case MappedFileAdvice::HugePage:
+#if defined(MADV_HUGEPAGE)
+				flag = MADV_HUGEPAGE;
+				break;
+#else
+				return sl_false;
+#endif
+			default:
+				return sl_false;
+		}
+		return 0 == ::madvise(m_base, m_sizeBase, flag);
+	}
+
+	sl_bool MappedRegion::flush(sl_bool flagAsync)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		if (!m_flagWritable) {
+			return sl_true;
+		}
+		return 0 == ::msync(m_base, m_sizeBase, flagAsync ? MS_ASYNC : MS_SYNC);
+	}
+
+	sl_bool MappedFile::_initialize()
+	{
+		return sl_true;
+	}
+
+	void MappedFile::_free()
+	{
+	}
+
+	sl_bool MappedFile::_map(MappedRegion* region, sl_uint64 offset, sl_size size)
+	{
+		int fd = (int)(m_file->getHandle());
+		if (fd == -1) {
+			return sl_false;
+		}
+		sl_size granularity = getGranularity();
+		sl_size shift = (sl_size)(offset % granularity);
+		sl_uint64 offsetBase = offset - shift;
+		sl_size sizeBase = size + shift;
+		if (sizeBase < size) {
+			return sl_false;
+		}
+		int prot = PROT_READ;
+		if (m_flagWritable) {
+			prot |= PROT_WRITE;
+		}
+		void* base = ::mmap(sl_null, sizeBase, prot, MAP_SHARED, fd, (off_t)offsetBase);
+		if (base == MAP_FAILED) {
+			return sl_false;
+		}
+		region->m_base = base;
+		region->m_sizeBase = sizeBase;
+		region->m_data = (sl_uint8*)base + shift;
+		region->m_size = size;
+		region->m_offset = offset;
+		region->m_flagWritable = m_flagWritable;
+		return sl_true;
+	}
+
+	void MappedFile::_unmap(MappedRegion* region)
+	{
+		::munmap(region->m_base, region->m_sizeBase);
+	}
+
+	sl_size MappedFile::getGranularity()
+	{
+		static sl_size granularity = 0;
+		if (!granularity) {
+			long n = ::sysconf(_SC_PAGESIZE);
+			granularity = n > 0 ? (sl_size)n : 4096;
+		}
+		return granularity;
+	}
+
+}
+
+#endif
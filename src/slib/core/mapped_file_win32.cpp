@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/definition.h"
+
+#ifdef SLIB_PLATFORM_IS_WIN32
+
+#include "slib/core/mapped_file.h"
+
+#include <windows.h>
+
+namespace slib
+{
+
+	typedef struct _MappedFile_WIN32_MEMORY_RANGE_ENTRY {
+		PVOID VirtualAddress;
+		SIZE_T NumberOfBytes;
+	} _MappedFile_WIN32_MEMORY_RANGE_ENTRY;
+
+	typedef BOOL (WINAPI *_MappedFile_PrefetchVirtualMemory)(HANDLE hProcess, ULONG_PTR NumberOfEntries, _MappedFile_WIN32_MEMORY_RANGE_ENTRY* VirtualAddresses, ULONG Flags);
+
+	sl_bool MappedRegion::advise(MappedFileAdvice advice)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		switch (advice) {
+			case MappedFileAdvice::Normal:
+			case MappedFileAdvice::Sequential:
+			case MappedFileAdvice::Random:
+				// access pattern is chosen when the file is opened on Windows
+				return sl_true;
+			case MappedFileAdvice::WillNeed:
+				{
+					// available since Windows 8
+					static _MappedFile_PrefetchVirtualMemory func = (_MappedFile_PrefetchVirtualMemory)(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+					if (func) {
+						_MappedFile_WIN32_MEMORY_RANGE_ENTRY entry;
+						entry.VirtualAddress = m_base;
+						entry.NumberOfBytes = m_sizeBase;
+						return func(GetCurrentProcess(), 1, &entry, 0) != 0;
+					}
+					return sl_false;
+				}
+			case MappedFileAdvice::DontNeed:
+				// removes the pages from the working set of the process
+				return VirtualUnlock(m_base, m_sizeBase) != 0 || GetLastError() == ERROR_NOT_LOCKED;
+			default:
+				return sl_false;
+		}
+	}
+
+	sl_bool MappedRegion::flush(sl_bool flagAsync)
+	{
+		if (!m_base) {
+			return sl_false;
+		}
+		if (!m_flagWritable) {
+			return sl_true;
+		}
+		// FlushViewOfFile does not wait for the disk cache; use `File::flush` to wait for the device
+		return FlushViewOfFile(m_base, m_sizeBase) != 0;
+	}
+
+	sl_bool MappedFile::_initialize()
+	{
+		HANDLE hFile = (HANDLE)(m_file->getHandle());
+		if (hFile == INVALID_HANDLE_VALUE) {
+			return sl_false;
+		}
+		if (!m_size) {
+			// empty files can not be mapped
+			return sl_false;
+		}
+		HANDLE hMapping = CreateFileMappingW(hFile, NULL, m_flagWritable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+		if (!hMapping) {
+			return sl_false;
+		}
+		m_handle = hMapping;
+		return sl_true;
+	}
+
+	void MappedFile::_free()
+	{
+		if (m_handle) {
+			CloseHandle((HANDLE)m_handle);
+			m_handle = sl_null;
+		}
+	}
+
+	sl_bool MappedFile::_map(MappedRegion* region, sl_uint64 offset, sl_size size)
+	{
+		sl_size granularity = getGranularity();
+		sl_size shift = (sl_size)(offset % granularity);
+		sl_uint64 offsetBase = offset - shift;
+		sl_size sizeBase = size + shift;
+		if (sizeBase < size) {
+			return sl_false;
+		}
+		DWORD dwAccess = m_flagWritable ? (FILE_MAP_READ | FILE_MAP_WRITE) : FILE_MAP_READ;
+		void* base = MapViewOfFile((HANDLE)m_handle, dwAccess, (DWORD)(offsetBase >> 32), (DWORD)offsetBase, sizeBase);
+		if (!base) {
+			return sl_false;
+		}
+		region->m_base = base;
+		region->m_sizeBase = sizeBase;
+		region->m_data = (sl_uint8*)base + shift;
+		region->m_size = size;
+		region->m_offset = offset;
+		region->m_flagWritable = m_flagWritable;
+		return sl_true;
+	}
+
+	void MappedFile::_unmap(MappedRegion* region)
+	{
+		UnmapViewOfFile(region->m_base);
+	}
+
+	sl_size MappedFile::getGranularity()
+	{
+		static sl_size granularity = 0;
+		if (!granularity) {
+			SYSTEM_INFO si;
+			GetSystemInfo(&si);
+			granularity = si.dwAllocationGranularity;
+		}
+		return granularity;
+	}
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/mpsc_queue.h"
+
+#if defined(SLIB_PLATFORM_IS_WINDOWS)
+#define USE_CPP_ATOMIC
+#endif
+
+#if defined(USE_CPP_ATOMIC)
+#include <atomic>
+#endif
+
+namespace slib
+{
+
+	SLIB_INLINE static MpscQueueNode* _MpscQueue_load(MpscQueueNode* volatile const* p)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<MpscQueueNode*>*)p)->load(std::memory_order_acquire);
+#else
+		return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	SLIB_INLINE static void _MpscQueue_store(MpscQueueNode* volatile* p, MpscQueueNode* node)
+	{
+#if defined(USE_CPP_ATOMIC)
+		((std::atomic<MpscQueueNode*>*)p)->store(node, std::memory_order_release);
+#else
+		__atomic_store_n(p, node, __ATOMIC_RELEASE);
+#endif
+	}
+
+	SLIB_INLINE static MpscQueueNode* _MpscQueue_exchange(MpscQueueNode* volatile* p, MpscQueueNode* node)
+	{
+#if defined(USE_CPP_ATOMIC)
+		return ((std::atomic<MpscQueueNode*>*)p)->exchange(node, std::memory_order_acq_rel);
+#else
+		return __atomic_exchange_n(p, node, __ATOMIC_ACQ_REL);
+#endif
+	}
+
+	MpscQueueBase::MpscQueueBase() noexcept
+	{
+		m_head = &m_stub;
+		m_tail = &m_stub;
+	}
+
+	MpscQueueBase::~MpscQueueBase() noexcept
+	{
+	}
+
+	void MpscQueueBase::push(MpscQueueNode* node) noexcept
+	{
+		node->next = sl_null;
+		MpscQueueNode* prev = _MpscQueue_exchange(&m_head, node);
+		// the consumer can not see `node` until it is linked here
+		_MpscQueue_store(&(prev->next), node);
+	}
+
+	MpscQueueNode* MpscQueueBase::pop() noexcept
+	{
+		MpscQueueNode* tail = m_tail;
+		MpscQueueNode* next = _MpscQueue_load(&(tail->next));
+		if (tail == &m_stub) {
+			if (!next) {
+				return sl_null;
+			}
+			m_tail = next;
+			tail = next;
+			next = _MpscQueue_load(&(next->next));
+		}
+		if (next) {
+			m_tail = next;
+			return tail;
+		}
+		if (tail != _MpscQueue_load(&m_head)) {
+			// a producer is linking a new node
+			return sl_null;
+		}
+		push(&m_stub);
+		next = _MpscQueue_load(&(tail->next));
+		if (next) {
+			m_tail = next;
+			return tail;
+		}
+		return sl_null;
+	}
+
+	sl_bool MpscQueueBase::isEmpty() const noexcept
+	{
+		MpscQueueNode* tail = m_tail;
+		if (tail != &m_stub) {
+			return sl_false;
+		}
+		return !(_MpscQueue_load(&(tail->next)));
+	}
+
+}
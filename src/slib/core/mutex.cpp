@@ -10,6 +10,7 @@
 
 #include "slib/core/base.h"
 #include "slib/core/mutex.h"
+#include "slib/core/safe_static.h"
 
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
 #include <windows.h>
@@ -24,12 +25,12 @@ namespace slib
 
 	Mutex::Mutex()
 	{
-		_init();
+		m_pObject = sl_null;
 	}
 
 	Mutex::Mutex(const Mutex& other)
 	{
-		_init();
+		m_pObject = sl_null;
 	}
 
 	Mutex::~Mutex()
@@ -37,70 +38,106 @@ namespace slib
 		_free();
 	}
 
-	void Mutex::_init()
+	void* Mutex::_getObject() const
+	{
+		void* object = m_pObject;
+		if (object) {
+			return object;
+		}
+		// inflates on the first use; the loser of a racing inflation frees its own object
+		object = _create();
+		if (!object) {
+			return sl_null;
+		}
+		if (Base::interlockedCompareExchangePtr(&m_pObject, object, sl_null)) {
+			return object;
+		}
+		_destroy(object);
+		return m_pObject;
+	}
+
+	void* Mutex::_create()
 	{
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		m_pObject = Base::createMemory(sizeof(CRITICAL_SECTION));
+		void* object = Base::createMemory(sizeof(CRITICAL_SECTION));
+		if (!object) {
+			return sl_null;
+		}
 #	if defined(SLIB_PLATFORM_IS_DESKTOP)
-		InitializeCriticalSection((PCRITICAL_SECTION)m_pObject);
+		InitializeCriticalSection((PCRITICAL_SECTION)object);
 #	elif defined(SLIB_PLATFORM_IS_MOBILE)
-		InitializeCriticalSectionEx((PCRITICAL_SECTION)m_pObject, NULL, NULL);
+		InitializeCriticalSectionEx((PCRITICAL_SECTION)object, NULL, NULL);
 #	endif
+		return object;
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		m_pObject = Base::createMemory(sizeof(pthread_mutex_t));
+		void* object = Base::createMemory(sizeof(pthread_mutex_t));
+		if (!object) {
+			return sl_null;
+		}
 		pthread_mutexattr_t attr;
 		pthread_mutexattr_init(&attr);
 		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-		pthread_mutex_init((pthread_mutex_t*)(m_pObject), &attr);
+		pthread_mutex_init((pthread_mutex_t*)object, &attr);
 		pthread_mutexattr_destroy(&attr);
+		return object;
 #endif
 	}
 
-	void Mutex::_free()
+	void Mutex::_destroy(void* object)
 	{
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		DeleteCriticalSection((PCRITICAL_SECTION)m_pObject);
-		Base::freeMemory(m_pObject);
-		m_pObject = sl_null;
+		DeleteCriticalSection((PCRITICAL_SECTION)object);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_destroy((pthread_mutex_t*)(m_pObject));
-		Base::freeMemory(m_pObject);
+		pthread_mutex_destroy((pthread_mutex_t*)object);
 #endif
+		Base::freeMemory(object);
+	}
+
+	void Mutex::_free()
+	{
+		if (m_pObject) {
+			_destroy(m_pObject);
+			m_pObject = sl_null;
+		}
 	}
 
 	void Mutex::lock() const
 	{
-		if (!m_pObject) {
+		void* object = _getObject();
+		if (!object) {
 			return;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		EnterCriticalSection((PCRITICAL_SECTION)m_pObject);
+		EnterCriticalSection((PCRITICAL_SECTION)object);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_lock((pthread_mutex_t*)(m_pObject));
+		pthread_mutex_lock((pthread_mutex_t*)object);
 #endif
 	}
 
 	sl_bool Mutex::tryLock() const
 	{
-		if (!m_pObject) {
+		void* object = _getObject();
+		if (!object) {
 			return sl_false;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		return TryEnterCriticalSection((PCRITICAL_SECTION)m_pObject) != 0;
+		return TryEnterCriticalSection((PCRITICAL_SECTION)object) != 0;
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		return pthread_mutex_trylock((pthread_mutex_t*)(m_pObject)) == 0;
+		return pthread_mutex_trylock((pthread_mutex_t*)object) == 0;
 #endif
 	}
 
 	void Mutex::unlock() const
 	{
-		if (!m_pObject) {
+		// not inflated yet: never locked
+		void* object = m_pObject;
+		if (!object) {
 			return;
 		}
 #if defined(SLIB_PLATFORM_IS_WINDOWS)
-		LeaveCriticalSection((PCRITICAL_SECTION)m_pObject);
+		LeaveCriticalSection((PCRITICAL_SECTION)object);
 #elif defined(SLIB_PLATFORM_IS_UNIX)
-		pthread_mutex_unlock((pthread_mutex_t*)(m_pObject));
+		pthread_mutex_unlock((pthread_mutex_t*)object);
 #endif
 	}
 
@@ -110,6 +147,20 @@ namespace slib
 	}
 
 
+	static Mutex* _MutexPool_getMutexes()
+	{
+		// never destructed: the pooled mutexes may be locked by the destructors of the other static objects
+		SLIB_SAFE_STATIC(Mutex*, mutexes, new Mutex[SLIB_MUTEX_POOL_SIZE])
+		return mutexes;
+	}
+
+	Mutex* MutexPool::get(const void* ptr)
+	{
+		sl_size index = ((sl_size)(ptr)) % SLIB_MUTEX_POOL_SIZE;
+		return _MutexPool_getMutexes() + index;
+	}
+
+
 
 	MutexLocker::MutexLocker()
 	{
@@ -29,27 +29,31 @@ namespace slib
 
 	Mutex* Object::getLocker() const
 	{
+#if defined(SLIB_OBJECT_STRIPED_LOCK)
+		return MutexPool::get(this);
+#else
 		return (Mutex*)(&m_locker);
+#endif
 	}
 
 	void Object::lock() const
 	{
-		m_locker.lock();
+		getLocker()->lock();
 	}
 
 	void Object::unlock() const
 	{
-		m_locker.unlock();
+		getLocker()->unlock();
 	}
 
 	sl_bool Object::tryLock() const
 	{
-		return m_locker.tryLock();
+		return getLocker()->tryLock();
 	}
 	
 	Variant Object::getProperty(const String& name)
 	{
-		MutexLocker lock(&m_locker);
+		MutexLocker lock(getLocker());
 		if (m_properties.isNotNull()) {
 			HashMap<String, Variant>* map = static_cast<HashMap<String, Variant>*>(m_properties.get());
 			return map->getValue_NoLock(name);
@@ -59,7 +63,7 @@ namespace slib
 	
 	void Object::setProperty(const String& name, const Variant& value)
 	{
-		MutexLocker lock(&m_locker);
+		MutexLocker lock(getLocker());
 		HashMap<String, Variant>* map;
 		if (m_properties.isNotNull()) {
 			map = static_cast<HashMap<String, Variant>*>(m_properties.get());
@@ -76,12 +80,18 @@ namespace slib
 	
 	void Object::clearProperty(const String& name)
 	{
-		MutexLocker lock(&m_locker);
+		MutexLocker lock(getLocker());
 		if (m_properties.isNotNull()) {
 			HashMap<String, Variant>* map = static_cast<HashMap<String, Variant>*>(m_properties.get());
 			map->remove_NoLock(name);
 		}
 	}
+	
+	void Object::clearAllProperties()
+	{
+		MutexLocker lock(getLocker());
+		m_properties.setNull();
+	}
 
 	ObjectLocker::ObjectLocker()
 	{
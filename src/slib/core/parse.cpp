@@ -191,6 +191,16 @@ namespace slib
 		} else {
 			return sl_null;
 		}
+		// the decoded string is not longer than the quoted text, so don't allocate for the rest of the input
+		for (sl_size k = 1; k < n; k++) {
+			CT ch = sz[k];
+			if (ch == '\\') {
+				k++;
+			} else if (ch == chEnd) {
+				n = k + 1;
+				break;
+			}
+		}
 		SLIB_SCOPED_BUFFER(CT, 2048, buf, n);
 		if (buf == sl_null) {
 			return sl_null;
@@ -1674,15 +1674,15 @@ namespace slib
 		}
 		if (len >= 2) {
 			if (buf[0] == (sl_char8)0xFF && buf[1] == (sl_char8)0xFE) {
-				return String::fromUtf16LE(buf, (len - 2) >> 1);
+				return String::fromUtf16LE(buf + 2, (len - 2) >> 1);
 			}
 			if (buf[0] == (sl_char8)0xFE && buf[1] == (sl_char8)0xFF) {
-				return String::fromUtf16BE(buf, (len - 2) >> 1);
+				return String::fromUtf16BE(buf + 2, (len - 2) >> 1);
 			}
 		}
 		if (len >= 3) {
 			if (buf[0] == (sl_char8)0xEF && buf[1] == (sl_char8)0xBB && buf[2] == (sl_char8)0xBF) {
-				return String(buf, len - 3);
+				return String(buf + 3, len - 3);
 			}
 		}
 		return String(buf, len);
@@ -1704,15 +1704,15 @@ namespace slib
 		}
 		if (len >= 2) {
 			if (buf[0] == (sl_char8)0xFF && buf[1] == (sl_char8)0xFE) {
-				return String16::fromUtf16LE(buf, (len - 2) >> 1);
+				return String16::fromUtf16LE(buf + 2, (len - 2) >> 1);
 			}
 			if (buf[0] == (sl_char8)0xFE && buf[1] == (sl_char8)0xFF) {
-				return String16::fromUtf16BE(buf, (len - 2) >> 1);
+				return String16::fromUtf16BE(buf + 2, (len - 2) >> 1);
 			}
 		}
 		if (len >= 3) {
 			if (buf[0] == (sl_char8)0xEF && buf[1] == (sl_char8)0xBB && buf[2] == (sl_char8)0xBF) {
-				return String16(buf, len - 3);
+				return String16(buf + 3, len - 3);
 			}
 		}
 		return String16(buf, len);
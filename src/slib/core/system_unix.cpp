@@ -132,6 +132,15 @@ namespace slib
 #endif
 	}
 
+	sl_uint32 System::getProcessorsCount()
+	{
+		long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+		if (n > 0) {
+			return (sl_uint32)n;
+		}
+		return 1;
+	}
+
 #if !defined(SLIB_PLATFORM_IS_MOBILE)
 	sl_bool System::createProcess(const String& pathExecutable, const String* cmds, sl_uint32 nCmds)
 	{
@@ -10,6 +10,17 @@
 
 #include "slib/core/thread_pool.h"
 
+#include "slib/core/event.h"
+#include "slib/core/spin_lock.h"
+#include "slib/core/system.h"
+
+#include <atomic>
+
+#define _SLIB_WORK_STEALING_DEQUE_INITIAL_SIZE 256
+#define _SLIB_WORK_STEALING_WORKER_FREE_TASKS 1024
+#define _SLIB_WORK_STEALING_SHARED_FREE_TASKS 4096
+#define _SLIB_WORK_STEALING_SPIN_COUNT 64
+
 namespace slib
 {
 
@@ -115,6 +126,10 @@ namespace slib
 				task();
 			} else {
 				ObjectLocker lock(this);
+				// a task added after the pop must not be left without a worker
+				if (m_tasks.getCount()) {
+					continue;
+				}
 				sl_size nThreads = m_threadWorkers.getCount();
 				if (nThreads > getMinimumThreadsCount()) {
 					m_threadWorkers.removeValue_NoLock(Thread::getCurrent());
@@ -127,4 +142,550 @@ namespace slib
 		}
 	}
 
+
+	class _WorkStealingTask
+	{
+	public:
+		InlineFunction<void()> callback;
+		_WorkStealingTask* next;
+	};
+
+	/*
+		Chase-Lev deque, with the memory orderings of
+		"Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli, 2013)
+	*/
+	class _WorkStealingDeque
+	{
+	public:
+		struct Array
+		{
+			sl_int64 size;
+			std::atomic<_WorkStealingTask*>* buffer;
+			Array* before;
+		};
+
+	public:
+		std::atomic<sl_int64> top;
+		std::atomic<sl_int64> bottom;
+		std::atomic<Array*> array;
+
+	public:
+		_WorkStealingDeque(): top(0), bottom(0)
+		{
+			array.store(_createArray(_SLIB_WORK_STEALING_DEQUE_INITIAL_SIZE, sl_null), std::memory_order_relaxed);
+		}
+
+		~_WorkStealingDeque()
+		{
+			// the old arrays are kept until here, because they can be read by the thieves
+			Array* a = array.load(std::memory_order_relaxed);
+			while (a) {
+				Array* before = a->before;
+				delete[] a->buffer;
+				delete a;
+				a = before;
+			}
+		}
+
+	public:
+		// owner only
+		void push(_WorkStealingTask* task)
+		{
+			sl_int64 b = bottom.load(std::memory_order_relaxed);
+			sl_int64 t = top.load(std::memory_order_acquire);
+			Array* a = array.load(std::memory_order_relaxed);
+			if (b - t > a->size - 1) {
+				Array* n = _createArray(a->size << 1, a);
+				for (sl_int64 i = t; i < b; i++) {
+					n->buffer[i & (n->size - 1)].store(a->buffer[i & (a->size - 1)].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+				array.store(n, std::memory_order_release);
+				a = n;
+			}
+			a->buffer[b & (a->size - 1)].store(task, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		// owner only, takes the newest task
+		_WorkStealingTask* pop()
+		{
+			sl_int64 b = bottom.load(std::memory_order_relaxed) - 1;
+			Array* a = array.load(std::memory_order_relaxed);
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			sl_int64 t = top.load(std::memory_order_relaxed);
+			if (t <= b) {
+				_WorkStealingTask* task = a->buffer[b & (a->size - 1)].load(std::memory_order_relaxed);
+				if (t == b) {
+					// last item: races with the thieves
+					if (!(top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))) {
+						task = sl_null;
+					}
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+				return task;
+			} else {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return sl_null;
+			}
+		}
+
+		// any thread, takes the oldest task
+		_WorkStealingTask* steal()
+		{
+			sl_int64 t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			sl_int64 b = bottom.load(std::memory_order_acquire);
+			if (t < b) {
+				Array* a = array.load(std::memory_order_acquire);
+				_WorkStealingTask* task = a->buffer[t & (a->size - 1)].load(std::memory_order_relaxed);
+				if (!(top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))) {
+					return sl_null;
+				}
+				return task;
+			}
+			return sl_null;
+		}
+
+	private:
+		static Array* _createArray(sl_int64 size, Array* before)
+		{
+			Array* a = new Array;
+			a->size = size;
+			a->buffer = new std::atomic<_WorkStealingTask*>[(sl_size)size];
+			a->before = before;
+			return a;
+		}
+
+	};
+
+	class _WorkStealingWorker
+	{
+	public:
+		WorkStealingThreadPool* pool;
+		sl_uint32 index;
+		_WorkStealingDeque deque;
+		Ref<Event> event;
+		Ref<Thread> thread;
+		std::atomic<sl_bool> flagIdle;
+
+		_WorkStealingTask* freeTasks;
+		sl_uint32 countFreeTasks;
+		sl_uint32 random;
+
+	public:
+		_WorkStealingWorker(): flagIdle(sl_false)
+		{
+			pool = sl_null;
+			index = 0;
+			freeTasks = sl_null;
+			countFreeTasks = 0;
+			random = 0;
+		}
+
+		// the tasks left in the deque were not started before `release()`: they are discarded without running
+		~_WorkStealingWorker()
+		{
+			_WorkStealingTask* task = freeTasks;
+			while (task) {
+				_WorkStealingTask* next = task->next;
+				delete task;
+				task = next;
+			}
+			for (;;) {
+				task = deque.pop();
+				if (!task) {
+					break;
+				}
+				delete task;
+			}
+		}
+
+	public:
+		// xorshift
+		sl_uint32 getRandom()
+		{
+			sl_uint32 x = random;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			random = x;
+			return x;
+		}
+
+	};
+
+	class _WorkStealingShared
+	{
+	public:
+		// tasks added from the threads outside of the pool
+		SpinLock lockQueue;
+		_WorkStealingTask* queueFirst;
+		_WorkStealingTask* queueLast;
+		std::atomic<sl_size> countQueue;
+
+		SpinLock lockFreeTasks;
+		_WorkStealingTask* freeTasks;
+		sl_uint32 countFreeTasks;
+
+		std::atomic<sl_uint32> countIdle;
+
+	public:
+		_WorkStealingShared(): countQueue(0), countIdle(0)
+		{
+			queueFirst = sl_null;
+			queueLast = sl_null;
+			freeTasks = sl_null;
+			countFreeTasks = 0;
+		}
+
+		// like `~_WorkStealingWorker()`, the queued tasks are discarded without running
+		~_WorkStealingShared()
+		{
+			_WorkStealingTask* task = queueFirst;
+			while (task) {
+				_WorkStealingTask* next = task->next;
+				delete task;
+				task = next;
+			}
+			task = freeTasks;
+			while (task) {
+				_WorkStealingTask* next = task->next;
+				delete task;
+				task = next;
+			}
+		}
+
+	public:
+		void push(_WorkStealingTask* task)
+		{
+			task->next = sl_null;
+			SpinLocker lock(&lockQueue);
+			if (queueLast) {
+				queueLast->next = task;
+			} else {
+				queueFirst = task;
+			}
+			queueLast = task;
+			countQueue.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		_WorkStealingTask* pop()
+		{
+			if (!(countQueue.load(std::memory_order_relaxed))) {
+				return sl_null;
+			}
+			SpinLocker lock(&lockQueue);
+			_WorkStealingTask* task = queueFirst;
+			if (task) {
+				queueFirst = task->next;
+				if (!queueFirst) {
+					queueLast = sl_null;
+				}
+				countQueue.fetch_sub(1, std::memory_order_relaxed);
+			}
+			return task;
+		}
+
+	};
+
+	static SLIB_THREAD _WorkStealingWorker* _g_work_stealing_current_worker = sl_null;
+
+	SLIB_DEFINE_OBJECT(WorkStealingThreadPool, Dispatcher)
+
+	WorkStealingThreadPool::WorkStealingThreadPool()
+	{
+		m_workers = sl_null;
+		m_nWorkers = 0;
+		m_shared = sl_null;
+		m_flagRunning = sl_false;
+	}
+
+	WorkStealingThreadPool::~WorkStealingThreadPool()
+	{
+		release();
+		if (m_workers) {
+			for (sl_uint32 i = 0; i < m_nWorkers; i++) {
+				delete m_workers[i];
+			}
+			delete[] m_workers;
+		}
+		if (m_shared) {
+			delete m_shared;
+		}
+	}
+
+	Ref<WorkStealingThreadPool> WorkStealingThreadPool::create(sl_uint32 nThreads)
+	{
+		if (!nThreads) {
+			nThreads = System::getProcessorsCount();
+			if (!nThreads) {
+				nThreads = 1;
+			}
+		}
+		Ref<WorkStealingThreadPool> ret = new WorkStealingThreadPool;
+		if (ret.isNull()) {
+			return sl_null;
+		}
+		ret->m_shared = new _WorkStealingShared;
+		ret->m_workers = new _WorkStealingWorker*[nThreads];
+		if (!(ret->m_shared) || !(ret->m_workers)) {
+			return sl_null;
+		}
+		for (sl_uint32 i = 0; i < nThreads; i++) {
+			_WorkStealingWorker* worker = new _WorkStealingWorker;
+			worker->pool = ret.get();
+			worker->index = i;
+			worker->random = (i + 1) * 0x9E3779B9;
+			worker->event = Event::create();
+			if (worker->event.isNull()) {
+				delete worker;
+				return sl_null;
+			}
+			ret->m_workers[i] = worker;
+			ret->m_nWorkers = i + 1;
+		}
+		ret->m_flagRunning = sl_true;
+		for (sl_uint32 i = 0; i < nThreads; i++) {
+			_WorkStealingWorker* worker = ret->m_workers[i];
+			worker->thread = Thread::start(SLIB_BIND_CLASS(void(), WorkStealingThreadPool, onRunWorker, ret.get(), i));
+			if (worker->thread.isNull()) {
+				ret->release();
+				return sl_null;
+			}
+		}
+		return ret;
+	}
+
+	void WorkStealingThreadPool::release()
+	{
+		ObjectLocker lock(this);
+		if (!m_flagRunning) {
+			return;
+		}
+		m_flagRunning = sl_false;
+		sl_uint32 i;
+		for (i = 0; i < m_nWorkers; i++) {
+			_WorkStealingWorker* worker = m_workers[i];
+			if (worker->thread.isNotNull()) {
+				worker->thread->finish();
+			}
+			worker->event->set();
+		}
+		for (i = 0; i < m_nWorkers; i++) {
+			_WorkStealingWorker* worker = m_workers[i];
+			if (worker->thread.isNotNull()) {
+				worker->thread->finishAndWait();
+			}
+		}
+	}
+
+	sl_bool WorkStealingThreadPool::isRunning()
+	{
+		return m_flagRunning;
+	}
+
+	sl_uint32 WorkStealingThreadPool::getThreadsCount()
+	{
+		return m_nWorkers;
+	}
+
+	sl_bool WorkStealingThreadPool::addTask(const Function<void()>& callback)
+	{
+		return addTask(InlineFunction<void()>(callback));
+	}
+
+	sl_bool WorkStealingThreadPool::addTask(InlineFunction<void()>&& callback)
+	{
+		if (callback.isNull()) {
+			return sl_false;
+		}
+		if (!m_flagRunning) {
+			return sl_false;
+		}
+		_WorkStealingWorker* worker = _getCurrentWorker();
+		_WorkStealingTask* task = sl_null;
+		if (worker && worker->freeTasks) {
+			task = worker->freeTasks;
+			worker->freeTasks = task->next;
+			worker->countFreeTasks--;
+		} else {
+			_WorkStealingShared* shared = m_shared;
+			{
+				// `freeTasks` is written by the workers under the lock: it is not read before locking
+				SpinLocker lock(&(shared->lockFreeTasks));
+				task = shared->freeTasks;
+				if (task) {
+					shared->freeTasks = task->next;
+					shared->countFreeTasks--;
+				}
+			}
+			if (!task) {
+				task = new _WorkStealingTask;
+				if (!task) {
+					return sl_false;
+				}
+			}
+		}
+		task->callback = Move(callback);
+		if (worker) {
+			worker->deque.push(task);
+		} else {
+			m_shared->push(task);
+		}
+		_wakeWorker();
+		return sl_true;
+	}
+
+	sl_bool WorkStealingThreadPool::runTask()
+	{
+		_WorkStealingWorker* worker = _getCurrentWorker();
+		_WorkStealingTask* task = _findTask(worker);
+		if (task) {
+			_runTask(worker, task);
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool WorkStealingThreadPool::dispatch(const Function<void()>& callback, sl_uint64 delay_ms)
+	{
+		if (delay_ms) {
+			WeakRef<WorkStealingThreadPool> weak = this;
+			return Dispatch::setTimeout([weak, callback]() {
+				Ref<WorkStealingThreadPool> pool = weak;
+				if (pool.isNotNull()) {
+					pool->addTask(callback);
+				}
+			}, delay_ms);
+		}
+		return addTask(callback);
+	}
+
+	void WorkStealingThreadPool::onRunWorker(sl_uint32 index)
+	{
+		_WorkStealingWorker* worker = m_workers[index];
+		_WorkStealingShared* shared = m_shared;
+		_g_work_stealing_current_worker = worker;
+		sl_uint32 countSpin = 0;
+		while (m_flagRunning && Thread::isNotStoppingCurrent()) {
+			_WorkStealingTask* task = _findTask(worker);
+			if (task) {
+				_runTask(worker, task);
+				countSpin = 0;
+				continue;
+			}
+			if (countSpin < _SLIB_WORK_STEALING_SPIN_COUNT) {
+				System::yield(countSpin);
+				countSpin++;
+				continue;
+			}
+			countSpin = 0;
+			// park: publish the idle state before checking the queues again, so that `_wakeWorker()` can't miss this worker
+			worker->flagIdle.store(sl_true, std::memory_order_seq_cst);
+			shared->countIdle.fetch_add(1, std::memory_order_seq_cst);
+			// pairs with the fence in `_wakeWorker()`: the relaxed loads of the queues in `_findTask()` must not be reordered before the idle state
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			task = _findTask(worker);
+			if (!task && m_flagRunning) {
+				worker->event->wait();
+			}
+			sl_bool flagIdle = sl_true;
+			if (worker->flagIdle.compare_exchange_strong(flagIdle, sl_false, std::memory_order_seq_cst)) {
+				shared->countIdle.fetch_sub(1, std::memory_order_seq_cst);
+			}
+			if (task) {
+				_runTask(worker, task);
+			}
+		}
+		_g_work_stealing_current_worker = sl_null;
+	}
+
+	_WorkStealingWorker* WorkStealingThreadPool::_getCurrentWorker()
+	{
+		_WorkStealingWorker* worker = _g_work_stealing_current_worker;
+		if (worker && worker->pool == this) {
+			return worker;
+		}
+		return sl_null;
+	}
+
+	_WorkStealingTask* WorkStealingThreadPool::_findTask(_WorkStealingWorker* worker)
+	{
+		_WorkStealingTask* task;
+		if (worker) {
+			task = worker->deque.pop();
+			if (task) {
+				return task;
+			}
+		}
+		task = m_shared->pop();
+		if (task) {
+			return task;
+		}
+		sl_uint32 n = m_nWorkers;
+		sl_uint32 start;
+		if (worker) {
+			start = worker->getRandom();
+		} else {
+			start = (sl_uint32)(System::getTickCount());
+		}
+		for (sl_uint32 i = 0; i < n; i++) {
+			_WorkStealingWorker* victim = m_workers[(start + i) % n];
+			if (victim != worker) {
+				task = victim->deque.steal();
+				if (task) {
+					return task;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	void WorkStealingThreadPool::_runTask(_WorkStealingWorker* worker, _WorkStealingTask* task)
+	{
+		task->callback();
+		task->callback.setNull();
+		if (worker && worker->countFreeTasks < _SLIB_WORK_STEALING_WORKER_FREE_TASKS) {
+			task->next = worker->freeTasks;
+			worker->freeTasks = task;
+			worker->countFreeTasks++;
+			return;
+		}
+		_WorkStealingShared* shared = m_shared;
+		{
+			SpinLocker lock(&(shared->lockFreeTasks));
+			if (shared->countFreeTasks < _SLIB_WORK_STEALING_SHARED_FREE_TASKS) {
+				task->next = shared->freeTasks;
+				shared->freeTasks = task;
+				shared->countFreeTasks++;
+				return;
+			}
+		}
+		delete task;
+	}
+
+	void WorkStealingThreadPool::_wakeWorker()
+	{
+		_WorkStealingShared* shared = m_shared;
+		// pairs with the idle state published by the parking worker
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!(shared->countIdle.load(std::memory_order_relaxed))) {
+			return;
+		}
+		sl_uint32 n = m_nWorkers;
+		for (sl_uint32 i = 0; i < n; i++) {
+			_WorkStealingWorker* worker = m_workers[i];
+			if (worker->flagIdle.load(std::memory_order_relaxed)) {
+				sl_bool flagIdle = sl_true;
+				if (worker->flagIdle.compare_exchange_strong(flagIdle, sl_false, std::memory_order_seq_cst)) {
+					shared->countIdle.fetch_sub(1, std::memory_order_seq_cst);
+					worker->event->set();
+					return;
+				}
+			}
+		}
+	}
+
 }
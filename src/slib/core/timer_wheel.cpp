@@ -0,0 +1,323 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/timer_wheel.h"
+
+#include "slib/core/math.h"
+
+#define _SLIB_TIMER_WHEEL_SLOT_MASK (SLIB_TIMER_WHEEL_SLOTS - 1)
+#define _SLIB_TIMER_WHEEL_MAX_DELTA ((((sl_uint64)1) << (SLIB_TIMER_WHEEL_LEVELS * SLIB_TIMER_WHEEL_SLOT_BITS)) - 1)
+
+namespace slib
+{
+
+	SLIB_INLINE static sl_uint32 _TimerWheel_getLowestBitIndex(sl_uint64 n)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return (sl_uint32)(__builtin_ctzll(n));
+#else
+		return Math::getLeastSignificantBits(n);
+#endif
+	}
+
+	SLIB_INLINE static sl_uint32 _TimerWheel_getHighestBitIndex(sl_uint64 n)
+	{
+#if defined(SLIB_COMPILER_IS_GCC)
+		return 63 - (sl_uint32)(__builtin_clzll(n));
+#else
+		return Math::getMostSignificantBits(n) - 1;
+#endif
+	}
+
+	// distance from `start` to the next bit set in `bitmap`, wrapping around; `bitmap` must not be zero
+	SLIB_INLINE static sl_uint32 _TimerWheel_getDistanceToNextBit(sl_uint64 bitmap, sl_uint32 start)
+	{
+		sl_uint64 high = bitmap >> start;
+		if (high) {
+			return _TimerWheel_getLowestBitIndex(high);
+		}
+		return SLIB_TIMER_WHEEL_SLOTS - start + _TimerWheel_getLowestBitIndex(bitmap);
+	}
+
+
+	TimerWheelEntry::TimerWheelEntry(InlineFunction<void()>&& task): m_task(Move(task))
+	{
+		m_time = 0;
+		m_wheel = sl_null;
+		m_slot = 0;
+		m_prev = sl_null;
+		m_next = sl_null;
+	}
+
+	TimerWheelEntry::~TimerWheelEntry()
+	{
+	}
+
+	const InlineFunction<void()>& TimerWheelEntry::getTask()
+	{
+		return m_task;
+	}
+
+	sl_uint64 TimerWheelEntry::getTime()
+	{
+		return m_time;
+	}
+
+	sl_bool TimerWheelEntry::isScheduled()
+	{
+		return m_wheel != sl_null;
+	}
+
+
+	TimerWheel::TimerWheel(sl_uint64 timeStart)
+	{
+		Base::zeroMemory(m_slots, sizeof(m_slots));
+		Base::zeroMemory(m_bitmaps, sizeof(m_bitmaps));
+		m_current = timeStart;
+		m_count = 0;
+	}
+
+	TimerWheel::~TimerWheel()
+	{
+		removeAll();
+	}
+
+	sl_size TimerWheel::getCount()
+	{
+		return m_count;
+	}
+
+	sl_uint64 TimerWheel::getCurrentTime()
+	{
+		return m_current;
+	}
+
+	Ref<TimerWheelEntry> TimerWheel::add(sl_uint64 time, InlineFunction<void()>&& task)
+	{
+		if (task.isNull()) {
+			return sl_null;
+		}
+		Ref<TimerWheelEntry> entry = new TimerWheelEntry(Move(task));
+		if (entry.isNotNull()) {
+			add(entry.get(), time);
+			return entry;
+		}
+		return sl_null;
+	}
+
+	sl_bool TimerWheel::add(TimerWheelEntry* entry, sl_uint64 time)
+	{
+		if (!entry) {
+			return sl_false;
+		}
+		if (entry->m_wheel) {
+			if (entry->m_wheel != this) {
+				return sl_false;
+			}
+			_unlink(entry);
+		} else {
+			entry->increaseReference();
+			entry->m_wheel = this;
+			m_count++;
+		}
+		entry->m_time = time;
+		_insert(entry);
+		return sl_true;
+	}
+
+	sl_bool TimerWheel::remove(TimerWheelEntry* entry)
+	{
+		if (!entry) {
+			return sl_false;
+		}
+		if (entry->m_wheel != this) {
+			return sl_false;
+		}
+		_unlink(entry);
+		entry->m_wheel = sl_null;
+		m_count--;
+		entry->decreaseReference();
+		return sl_true;
+	}
+
+	void TimerWheel::removeAll()
+	{
+		for (sl_uint32 i = 0; i < SLIB_TIMER_WHEEL_LEVELS * SLIB_TIMER_WHEEL_SLOTS; i++) {
+			TimerWheelEntry* entry = m_slots[i];
+			m_slots[i] = sl_null;
+			while (entry) {
+				TimerWheelEntry* next = entry->m_next;
+				entry->m_wheel = sl_null;
+				entry->m_prev = sl_null;
+				entry->m_next = sl_null;
+				entry->decreaseReference();
+				entry = next;
+			}
+		}
+		Base::zeroMemory(m_bitmaps, sizeof(m_bitmaps));
+		m_count = 0;
+	}
+
+	void TimerWheel::advance(sl_uint64 now, List< Ref<TimerWheelEntry> >& expired)
+	{
+		while (m_current <= now) {
+			if (!m_count) {
+				m_current = now + 1;
+				return;
+			}
+			sl_uint32 index = (sl_uint32)(m_current & _SLIB_TIMER_WHEEL_SLOT_MASK);
+			if (!index) {
+				for (sl_uint32 level = 1; level < SLIB_TIMER_WHEEL_LEVELS; level++) {
+					sl_uint32 indexUpper = (sl_uint32)((m_current >> (level * SLIB_TIMER_WHEEL_SLOT_BITS)) & _SLIB_TIMER_WHEEL_SLOT_MASK);
+					_cascade(level, indexUpper);
+					if (indexUpper) {
+						break;
+					}
+				}
+			}
+			TimerWheelEntry* entry = m_slots[index];
+			if (entry) {
+				m_slots[index] = sl_null;
+				m_bitmaps[0] &= ~(((sl_uint64)1) << index);
+				while (entry) {
+					TimerWheelEntry* next = entry->m_next;
+					entry->m_prev = sl_null;
+					entry->m_next = sl_null;
+					if (entry->m_time > m_current) {
+						// clamped to the range of the wheel
+						_insert(entry);
+					} else {
+						entry->m_wheel = sl_null;
+						m_count--;
+						expired.add_NoLock(entry);
+						entry->decreaseReference();
+					}
+					entry = next;
+				}
+			}
+			// skip the empty slots, stopping at the end of this round to move down the upper levels
+			sl_uint64 bitmap = index < _SLIB_TIMER_WHEEL_SLOT_MASK ? (m_bitmaps[0] >> (index + 1)) : 0;
+			sl_uint64 next;
+			if (bitmap) {
+				next = m_current + 1 + _TimerWheel_getLowestBitIndex(bitmap);
+			} else {
+				next = (m_current | _SLIB_TIMER_WHEEL_SLOT_MASK) + 1;
+			}
+			if (next > now) {
+				m_current = now + 1;
+				return;
+			}
+			m_current = next;
+		}
+	}
+
+	sl_int64 TimerWheel::getTimeout(sl_uint64 now)
+	{
+		if (!m_count) {
+			return -1;
+		}
+		sl_uint64 timeNext = (sl_uint64)-1;
+		for (sl_uint32 level = 0; level < SLIB_TIMER_WHEEL_LEVELS; level++) {
+			sl_uint64 bitmap = m_bitmaps[level];
+			if (bitmap) {
+				sl_uint32 shift = level * SLIB_TIMER_WHEEL_SLOT_BITS;
+				sl_uint64 unit = m_current >> shift;
+				if (m_current & ((((sl_uint64)1) << shift) - 1)) {
+					// the slot of the current unit is moved down only on the next round
+					unit++;
+				}
+				sl_uint64 t = (unit + _TimerWheel_getDistanceToNextBit(bitmap, (sl_uint32)(unit & _SLIB_TIMER_WHEEL_SLOT_MASK))) << shift;
+				if (t < timeNext) {
+					timeNext = t;
+				}
+			}
+		}
+		if (timeNext <= now) {
+			return 0;
+		}
+		return (sl_int64)(timeNext - now);
+	}
+
+	void TimerWheel::_insert(TimerWheelEntry* entry)
+	{
+		sl_uint64 time = entry->m_time;
+		if (time < m_current) {
+			time = m_current;
+		}
+		sl_uint64 delta = time - m_current;
+		if (delta > _SLIB_TIMER_WHEEL_MAX_DELTA) {
+			delta = _SLIB_TIMER_WHEEL_MAX_DELTA;
+			time = m_current + delta;
+		}
+		sl_uint32 level = 0;
+		if (delta >= SLIB_TIMER_WHEEL_SLOTS) {
+			level = _TimerWheel_getHighestBitIndex(delta) / SLIB_TIMER_WHEEL_SLOT_BITS;
+		}
+		sl_uint32 index = (sl_uint32)((time >> (level * SLIB_TIMER_WHEEL_SLOT_BITS)) & _SLIB_TIMER_WHEEL_SLOT_MASK);
+		sl_uint32 slot = level * SLIB_TIMER_WHEEL_SLOTS + index;
+		entry->m_slot = slot;
+		entry->m_next = sl_null;
+		TimerWheelEntry* head = m_slots[slot];
+		if (head) {
+			// `prev` of the head is the tail
+			TimerWheelEntry* tail = head->m_prev;
+			tail->m_next = entry;
+			entry->m_prev = tail;
+			head->m_prev = entry;
+		} else {
+			entry->m_prev = entry;
+			m_slots[slot] = entry;
+			m_bitmaps[level] |= ((sl_uint64)1) << index;
+		}
+	}
+
+	void TimerWheel::_unlink(TimerWheelEntry* entry)
+	{
+		sl_uint32 slot = entry->m_slot;
+		TimerWheelEntry* head = m_slots[slot];
+		TimerWheelEntry* next = entry->m_next;
+		if (entry == head) {
+			if (next) {
+				next->m_prev = entry->m_prev;
+				m_slots[slot] = next;
+			} else {
+				m_slots[slot] = sl_null;
+				m_bitmaps[slot / SLIB_TIMER_WHEEL_SLOTS] &= ~(((sl_uint64)1) << (slot & _SLIB_TIMER_WHEEL_SLOT_MASK));
+			}
+		} else {
+			TimerWheelEntry* prev = entry->m_prev;
+			prev->m_next = next;
+			if (next) {
+				next->m_prev = prev;
+			} else {
+				head->m_prev = prev;
+			}
+		}
+		entry->m_prev = sl_null;
+		entry->m_next = sl_null;
+	}
+
+	void TimerWheel::_cascade(sl_uint32 level, sl_uint32 index)
+	{
+		sl_uint32 slot = level * SLIB_TIMER_WHEEL_SLOTS + index;
+		TimerWheelEntry* entry = m_slots[slot];
+		if (!entry) {
+			return;
+		}
+		m_slots[slot] = sl_null;
+		m_bitmaps[level] &= ~(((sl_uint64)1) << index);
+		while (entry) {
+			TimerWheelEntry* next = entry->m_next;
+			_insert(entry);
+			entry = next;
+		}
+	}
+
+}
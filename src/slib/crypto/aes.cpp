@@ -13,6 +13,8 @@
 #include "slib/crypto/sha2.h"
 #include "slib/core/mio.h"
 
+#include "aes_simd.h"
+
 /*
 	AES - Advanced Encryption Standard
 
@@ -35,6 +37,11 @@ namespace slib
 		return 16;
 	}
 
+	sl_bool AES::isHardwareAccelerated()
+	{
+		return _AES_getSIMDKernels() != sl_null;
+	}
+
 #define _BYTE(x) ((sl_uint8)(x))
 
 	// S-Box: substitution values for the byte xy
@@ -353,6 +360,13 @@ static const sl_uint32 _AES_RT3[256] = { RT };
 			W += 4;
 		}
 		Base::copyMemory(W, WE, 32);
+
+		// byte-order round keys for AES-NI
+		sl_uint32 nWords = (nRounds + 1) << 2;
+		for (i = 0; i < nWords; i++) {
+			MIO::writeUint32BE(m_roundKeyEncBytes + (i << 2), m_roundKeyEnc[i]);
+			MIO::writeUint32BE(m_roundKeyDecBytes + (i << 2), m_roundKeyDec[i]);
+		}
 		return sl_true;
 	}
 
@@ -434,6 +448,12 @@ Roundn (Last):
 	
 	void AES::encryptBlock(const void* _src, void *_dst) const
 	{
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->encryptBlocks(m_roundKeyEncBytes, m_nCountRounds, (const sl_uint8*)_src, (sl_uint8*)_dst, 1);
+			return;
+		}
+
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 
@@ -530,6 +550,12 @@ Roundn (Last):
 	
 	void AES::decryptBlock(const void* _src, void *_dst) const
 	{
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->decryptBlocks(m_roundKeyDecBytes, m_nCountRounds, (const sl_uint8*)_src, (sl_uint8*)_dst, 1);
+			return;
+		}
+
 		const sl_uint8* IN = (const sl_uint8*)_src;
 		sl_uint8* OUT = (sl_uint8*)_dst;
 		
@@ -546,6 +572,86 @@ Roundn (Last):
 		MIO::writeUint32BE(OUT + 12, d3);
 	}
 
+	void AES::encryptBlocks_ECB(const void* _src, void* _dst, sl_size nBlocks) const
+	{
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->encryptBlocks(m_roundKeyEncBytes, m_nCountRounds, src, dst, nBlocks);
+			return;
+		}
+		for (sl_size i = 0; i < nBlocks; i++) {
+			encryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+	}
+
+	void AES::decryptBlocks_ECB(const void* _src, void* _dst, sl_size nBlocks) const
+	{
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->decryptBlocks(m_roundKeyDecBytes, m_nCountRounds, src, dst, nBlocks);
+			return;
+		}
+		for (sl_size i = 0; i < nBlocks; i++) {
+			decryptBlock(src, dst);
+			src += 16;
+			dst += 16;
+		}
+	}
+
+	void AES::decryptBlocks_CBC(void* _iv, const void* _src, void* _dst, sl_size nBlocks) const
+	{
+		sl_uint8* iv = (sl_uint8*)_iv;
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->decryptCBC(m_roundKeyDecBytes, m_nCountRounds, iv, src, dst, nBlocks);
+			return;
+		}
+		sl_uint8 block[16];
+		for (sl_size i = 0; i < nBlocks; i++) {
+			Base::copyMemory(block, src, 16);
+			decryptBlock(block, dst);
+			for (sl_uint32 k = 0; k < 16; k++) {
+				dst[k] ^= iv[k];
+			}
+			Base::copyMemory(iv, block, 16);
+			src += 16;
+			dst += 16;
+		}
+	}
+
+	void AES::encryptBlocks_CTR(void* _counter, const void* _src, void* _dst, sl_size nBlocks, sl_uint32 sizeCounter) const
+	{
+		sl_uint8* counter = (sl_uint8*)_counter;
+		const sl_uint8* src = (const sl_uint8*)_src;
+		sl_uint8* dst = (sl_uint8*)_dst;
+		if (sizeCounter > 16) {
+			sizeCounter = 16;
+		}
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels && (sizeCounter == 16 || sizeCounter == 4)) {
+			kernels->encryptCTR(m_roundKeyEncBytes, m_nCountRounds, counter, sizeCounter, src, dst, nBlocks);
+			return;
+		}
+		sl_uint8 mask[16];
+		for (sl_size i = 0; i < nBlocks; i++) {
+			encryptBlock(counter, mask);
+			for (sl_uint32 k = 0; k < 16; k++) {
+				dst[k] = src[k] ^ mask[k];
+			}
+			MIO::increaseBE(counter + 16 - sizeCounter, sizeCounter);
+			src += 16;
+			dst += 16;
+		}
+	}
+
 	void AES::setKey_SHA256(const String& key)
 	{
 		char sig[32];
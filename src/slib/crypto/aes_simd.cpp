@@ -0,0 +1,429 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "aes_simd.h"
+
+#include "slib/core/mio.h"
+
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#		define _AES_SIMD_USE_AESNI
+#	endif
+#endif
+
+#if defined(_AES_SIMD_USE_AESNI)
+#	include <emmintrin.h>
+#	include <tmmintrin.h>
+#	include <smmintrin.h>
+#	include <wmmintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#endif
+
+namespace slib
+{
+
+#if defined(_AES_SIMD_USE_AESNI)
+
+#	if defined(__clang__)
+#		pragma clang attribute push (__attribute__((target("aes,pclmul,ssse3,sse4.1"))), apply_to = function)
+#	elif defined(__GNUC__)
+#		pragma GCC push_options
+#		pragma GCC target("aes,pclmul,ssse3,sse4.1")
+#	endif
+
+#define _AES_NI_X8(OP) OP(0) OP(1) OP(2) OP(3) OP(4) OP(5) OP(6) OP(7)
+
+	SLIB_INLINE static void _AES_NI_loadKeys(__m128i* k, const sl_uint8* keys, sl_uint32 nRounds)
+	{
+		for (sl_uint32 i = 0; i <= nRounds; i++) {
+			k[i] = _mm_loadu_si128((const __m128i*)(keys + (i << 4)));
+		}
+	}
+
+	SLIB_INLINE static __m128i _AES_NI_encrypt(const __m128i* k, sl_uint32 nRounds, __m128i b)
+	{
+		b = _mm_xor_si128(b, k[0]);
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			b = _mm_aesenc_si128(b, k[r]);
+		}
+		return _mm_aesenclast_si128(b, k[nRounds]);
+	}
+
+	SLIB_INLINE static __m128i _AES_NI_decrypt(const __m128i* k, sl_uint32 nRounds, __m128i b)
+	{
+		b = _mm_xor_si128(b, k[0]);
+		for (sl_uint32 r = 1; r < nRounds; r++) {
+			b = _mm_aesdec_si128(b, k[r]);
+		}
+		return _mm_aesdeclast_si128(b, k[nRounds]);
+	}
+
+#define _AES_NI_XOR_KEY0(i) b##i = _mm_xor_si128(b##i, k0);
+#define _AES_NI_ENC(i) b##i = _mm_aesenc_si128(b##i, key);
+#define _AES_NI_ENC_LAST(i) b##i = _mm_aesenclast_si128(b##i, key);
+#define _AES_NI_DEC(i) b##i = _mm_aesdec_si128(b##i, key);
+#define _AES_NI_DEC_LAST(i) b##i = _mm_aesdeclast_si128(b##i, key);
+
+#define _AES_NI_ROUNDS_X8(ROUND, ROUND_LAST) \
+	{ \
+		__m128i k0 = k[0]; \
+		_AES_NI_X8(_AES_NI_XOR_KEY0) \
+		for (sl_uint32 r = 1; r < nRounds; r++) { \
+			__m128i key = k[r]; \
+			_AES_NI_X8(ROUND) \
+		} \
+		__m128i key = k[nRounds]; \
+		_AES_NI_X8(ROUND_LAST) \
+	}
+
+#define _AES_NI_LOAD(i) __m128i b##i = _mm_loadu_si128((const __m128i*)(src + (i << 4)));
+#define _AES_NI_STORE(i) _mm_storeu_si128((__m128i*)(dst + (i << 4)), b##i);
+
+	static void _AES_NI_encryptBlocks(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i k[15];
+		_AES_NI_loadKeys(k, keys, nRounds);
+		while (nBlocks >= 8) {
+			_AES_NI_X8(_AES_NI_LOAD)
+			_AES_NI_ROUNDS_X8(_AES_NI_ENC, _AES_NI_ENC_LAST)
+			_AES_NI_X8(_AES_NI_STORE)
+			src += 128;
+			dst += 128;
+			nBlocks -= 8;
+		}
+		while (nBlocks) {
+			_mm_storeu_si128((__m128i*)dst, _AES_NI_encrypt(k, nRounds, _mm_loadu_si128((const __m128i*)src)));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+	}
+
+	static void _AES_NI_decryptBlocks(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i k[15];
+		_AES_NI_loadKeys(k, keys, nRounds);
+		while (nBlocks >= 8) {
+			_AES_NI_X8(_AES_NI_LOAD)
+			_AES_NI_ROUNDS_X8(_AES_NI_DEC, _AES_NI_DEC_LAST)
+			_AES_NI_X8(_AES_NI_STORE)
+			src += 128;
+			dst += 128;
+			nBlocks -= 8;
+		}
+		while (nBlocks) {
+			_mm_storeu_si128((__m128i*)dst, _AES_NI_decrypt(k, nRounds, _mm_loadu_si128((const __m128i*)src)));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+	}
+
+#define _AES_NI_CBC_LOAD(i) __m128i c##i = _mm_loadu_si128((const __m128i*)(src + (i << 4))); __m128i b##i = c##i;
+
+	static void _AES_NI_decryptCBC(const sl_uint8* keys, sl_uint32 nRounds, sl_uint8* _iv, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i k[15];
+		_AES_NI_loadKeys(k, keys, nRounds);
+		__m128i iv = _mm_loadu_si128((const __m128i*)_iv);
+		while (nBlocks >= 8) {
+			// cipher blocks stay in registers, so that `dst` may overwrite `src`
+			_AES_NI_X8(_AES_NI_CBC_LOAD)
+			_AES_NI_ROUNDS_X8(_AES_NI_DEC, _AES_NI_DEC_LAST)
+			b0 = _mm_xor_si128(b0, iv);
+			b1 = _mm_xor_si128(b1, c0);
+			b2 = _mm_xor_si128(b2, c1);
+			b3 = _mm_xor_si128(b3, c2);
+			b4 = _mm_xor_si128(b4, c3);
+			b5 = _mm_xor_si128(b5, c4);
+			b6 = _mm_xor_si128(b6, c5);
+			b7 = _mm_xor_si128(b7, c6);
+			iv = c7;
+			_AES_NI_X8(_AES_NI_STORE)
+			src += 128;
+			dst += 128;
+			nBlocks -= 8;
+		}
+		while (nBlocks) {
+			__m128i c = _mm_loadu_si128((const __m128i*)src);
+			_mm_storeu_si128((__m128i*)dst, _mm_xor_si128(_AES_NI_decrypt(k, nRounds, c), iv));
+			iv = c;
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+		_mm_storeu_si128((__m128i*)_iv, iv);
+	}
+
+	// 128-bit big-endian counter
+	class _AES_NI_Counter128
+	{
+	public:
+		sl_uint64 high;
+		sl_uint64 low;
+		__m128i swap;
+
+	public:
+		SLIB_INLINE _AES_NI_Counter128(const sl_uint8* counter)
+		{
+			high = MIO::readUint64BE(counter);
+			low = MIO::readUint64BE(counter + 8);
+			swap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+		}
+
+		SLIB_INLINE __m128i next()
+		{
+			__m128i ret = _mm_shuffle_epi8(_mm_set_epi64x((sl_int64)low, (sl_int64)high), swap);
+			low++;
+			high += (low == 0);
+			return ret;
+		}
+
+		SLIB_INLINE void save(sl_uint8* counter)
+		{
+			MIO::writeUint64BE(counter, high);
+			MIO::writeUint64BE(counter + 8, low);
+		}
+
+	};
+
+	// 32-bit big-endian counter in the last 4 bytes (inc32 of GCM)
+	class _AES_NI_Counter32
+	{
+	public:
+		__m128i base;
+		sl_uint32 value;
+
+	public:
+		SLIB_INLINE _AES_NI_Counter32(const sl_uint8* counter)
+		{
+			base = _mm_loadu_si128((const __m128i*)counter);
+			value = MIO::readUint32BE(counter + 12);
+		}
+
+		SLIB_INLINE __m128i next()
+		{
+			sl_uint32 v = value++;
+			v = (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+			return _mm_insert_epi32(base, (int)v, 3);
+		}
+
+		SLIB_INLINE void save(sl_uint8* counter)
+		{
+			MIO::writeUint32BE(counter + 12, value);
+		}
+
+	};
+
+#define _AES_NI_CTR_LOAD(i) __m128i b##i = ctr.next();
+#define _AES_NI_CTR_XOR(i) b##i = _mm_xor_si128(b##i, _mm_loadu_si128((const __m128i*)(src + (i << 4))));
+
+	template <class COUNTER>
+	SLIB_INLINE static void _AES_NI_runCTR(const __m128i* k, sl_uint32 nRounds, COUNTER& ctr, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		while (nBlocks >= 8) {
+			_AES_NI_X8(_AES_NI_CTR_LOAD)
+			_AES_NI_ROUNDS_X8(_AES_NI_ENC, _AES_NI_ENC_LAST)
+			_AES_NI_X8(_AES_NI_CTR_XOR)
+			_AES_NI_X8(_AES_NI_STORE)
+			src += 128;
+			dst += 128;
+			nBlocks -= 8;
+		}
+		while (nBlocks) {
+			__m128i b = _AES_NI_encrypt(k, nRounds, ctr.next());
+			_mm_storeu_si128((__m128i*)dst, _mm_xor_si128(b, _mm_loadu_si128((const __m128i*)src)));
+			src += 16;
+			dst += 16;
+			nBlocks--;
+		}
+	}
+
+	static void _AES_NI_encryptCTR(const sl_uint8* keys, sl_uint32 nRounds, sl_uint8* counter, sl_uint32 sizeCounter, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks)
+	{
+		__m128i k[15];
+		_AES_NI_loadKeys(k, keys, nRounds);
+		if (sizeCounter == 4) {
+			_AES_NI_Counter32 ctr(counter);
+			_AES_NI_runCTR(k, nRounds, ctr, src, dst, nBlocks);
+			ctr.save(counter);
+		} else {
+			_AES_NI_Counter128 ctr(counter);
+			_AES_NI_runCTR(k, nRounds, ctr, src, dst, nBlocks);
+			ctr.save(counter);
+		}
+	}
+
+/*
+	GHASH on byte-reflected blocks
+
+	Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode, Algorithm 5
+	The 256-bit products of 8 blocks are summed before a single reduction (aggregated reduction).
+*/
+
+	SLIB_INLINE static __m128i _GHash_reflect(__m128i x)
+	{
+		return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+
+	// (lo, hi) ^= a * b
+	SLIB_INLINE static void _GHash_mulAdd(__m128i a, __m128i b, __m128i& lo, __m128i& hi)
+	{
+		__m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+		__m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+		__m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+		__m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+		t1 = _mm_xor_si128(t1, t2);
+		lo = _mm_xor_si128(lo, _mm_xor_si128(t0, _mm_slli_si128(t1, 8)));
+		hi = _mm_xor_si128(hi, _mm_xor_si128(t3, _mm_srli_si128(t1, 8)));
+	}
+
+	// (hi:lo) mod (x^128 + x^7 + x^2 + x + 1), on reflected bits
+	SLIB_INLINE static __m128i _GHash_reduce(__m128i lo, __m128i hi)
+	{
+		// shift the product left by one bit
+		__m128i t7 = _mm_srli_epi32(lo, 31);
+		__m128i t8 = _mm_srli_epi32(hi, 31);
+		lo = _mm_slli_epi32(lo, 1);
+		hi = _mm_slli_epi32(hi, 1);
+		__m128i t9 = _mm_srli_si128(t7, 12);
+		t8 = _mm_slli_si128(t8, 4);
+		t7 = _mm_slli_si128(t7, 4);
+		lo = _mm_or_si128(lo, t7);
+		hi = _mm_or_si128(hi, t8);
+		hi = _mm_or_si128(hi, t9);
+		// first phase
+		t7 = _mm_slli_epi32(lo, 31);
+		t8 = _mm_slli_epi32(lo, 30);
+		t9 = _mm_slli_epi32(lo, 25);
+		t7 = _mm_xor_si128(t7, t8);
+		t7 = _mm_xor_si128(t7, t9);
+		t8 = _mm_srli_si128(t7, 4);
+		t7 = _mm_slli_si128(t7, 12);
+		lo = _mm_xor_si128(lo, t7);
+		// second phase
+		__m128i t2 = _mm_srli_epi32(lo, 1);
+		__m128i t4 = _mm_srli_epi32(lo, 2);
+		__m128i t5 = _mm_srli_epi32(lo, 7);
+		t2 = _mm_xor_si128(t2, t4);
+		t2 = _mm_xor_si128(t2, t5);
+		t2 = _mm_xor_si128(t2, t8);
+		lo = _mm_xor_si128(lo, t2);
+		return _mm_xor_si128(hi, lo);
+	}
+
+	SLIB_INLINE static __m128i _GHash_multiply(__m128i a, __m128i b)
+	{
+		__m128i lo = _mm_setzero_si128();
+		__m128i hi = _mm_setzero_si128();
+		_GHash_mulAdd(a, b, lo, hi);
+		return _GHash_reduce(lo, hi);
+	}
+
+	static void _GHash_generateTable(const sl_uint8* H, sl_uint8* table)
+	{
+		__m128i h = _GHash_reflect(_mm_loadu_si128((const __m128i*)H));
+		__m128i p = h;
+		_mm_storeu_si128((__m128i*)table, p);
+		for (sl_uint32 i = 1; i < 8; i++) {
+			p = _GHash_multiply(p, h);
+			_mm_storeu_si128((__m128i*)(table + (i << 4)), p);
+		}
+	}
+
+#define _GHASH_MULADD(i) _GHash_mulAdd(_GHash_reflect(_mm_loadu_si128((const __m128i*)(D + (i << 4)))), h[7 - i], lo, hi);
+
+	static void _GHash_multiplyData(const sl_uint8* table, sl_uint8* X, const sl_uint8* D, sl_size nBlocks)
+	{
+		__m128i h[8];
+		for (sl_uint32 i = 0; i < 8; i++) {
+			h[i] = _mm_loadu_si128((const __m128i*)(table + (i << 4)));
+		}
+		__m128i x = _GHash_reflect(_mm_loadu_si128((const __m128i*)X));
+		while (nBlocks >= 8) {
+			// X' = (X ^ D0) * H^8 ^ D1 * H^7 ^ ... ^ D7 * H
+			__m128i lo = _mm_setzero_si128();
+			__m128i hi = _mm_setzero_si128();
+			_GHash_mulAdd(_mm_xor_si128(x, _GHash_reflect(_mm_loadu_si128((const __m128i*)D))), h[7], lo, hi);
+			_GHASH_MULADD(1) _GHASH_MULADD(2) _GHASH_MULADD(3) _GHASH_MULADD(4) _GHASH_MULADD(5) _GHASH_MULADD(6) _GHASH_MULADD(7)
+			x = _GHash_reduce(lo, hi);
+			D += 128;
+			nBlocks -= 8;
+		}
+		while (nBlocks) {
+			x = _GHash_multiply(_mm_xor_si128(x, _GHash_reflect(_mm_loadu_si128((const __m128i*)D))), h[0]);
+			D += 16;
+			nBlocks--;
+		}
+		_mm_storeu_si128((__m128i*)X, _GHash_reflect(x));
+	}
+
+#	if defined(__clang__)
+#		pragma clang attribute pop
+#	elif defined(__GNUC__)
+#		pragma GCC pop_options
+#	endif
+
+	static sl_bool _AES_isSupportedAESNI()
+	{
+		// ECX of leaf 1: SSSE3(9), SSE4.1(19), AES(25), PCLMULQDQ(1)
+		const unsigned int flags = (1 << 9) | (1 << 19) | (1 << 25) | (1 << 1);
+#	if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 1) {
+			return sl_false;
+		}
+		__cpuid(info, 1);
+		return (((unsigned int)(info[2])) & flags) == flags;
+#	else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+			return sl_false;
+		}
+		return (ecx & flags) == flags;
+#	endif
+	}
+
+	static const _AES_SIMD_Kernels* _AES_createSIMDKernels()
+	{
+		if (!(_AES_isSupportedAESNI())) {
+			return sl_null;
+		}
+		static _AES_SIMD_Kernels kernels;
+		kernels.encryptBlocks = &_AES_NI_encryptBlocks;
+		kernels.decryptBlocks = &_AES_NI_decryptBlocks;
+		kernels.decryptCBC = &_AES_NI_decryptCBC;
+		kernels.encryptCTR = &_AES_NI_encryptCTR;
+		kernels.generateGHashTable = &_GHash_generateTable;
+		kernels.multiplyGHash = &_GHash_multiplyData;
+		return &kernels;
+	}
+
+	const _AES_SIMD_Kernels* _AES_getSIMDKernels()
+	{
+		static const _AES_SIMD_Kernels* kernels = _AES_createSIMDKernels();
+		return kernels;
+	}
+
+#else
+
+	const _AES_SIMD_Kernels* _AES_getSIMDKernels()
+	{
+		return sl_null;
+	}
+
+#endif
+
+}
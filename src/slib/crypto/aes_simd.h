@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_AES_SIMD
+#define CHECKHEADER_SLIB_CRYPTO_AES_SIMD
+
+#include "slib/core/definition.h"
+
+namespace slib
+{
+
+	/*
+		Hardware kernels for AES (AES-NI) and GHASH (PCLMULQDQ).
+
+		`keys` holds (nRounds + 1) round keys of 16 bytes in FIPS-197 byte order.
+		Decryption takes the round keys of the equivalent inverse cipher, in the order they are applied.
+		Multi-block kernels keep 8 blocks in flight, and `src` may be equal to `dst`.
+	*/
+	class _AES_SIMD_Kernels
+	{
+	public:
+		void (*encryptBlocks)(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks);
+
+		void (*decryptBlocks)(const sl_uint8* keys, sl_uint32 nRounds, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks);
+
+		// `iv` is updated to the last cipher block
+		void (*decryptCBC)(const sl_uint8* keys, sl_uint32 nRounds, sl_uint8* iv, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks);
+
+		// dst = src ^ E(counter++), incrementing the trailing `sizeCounter` bytes (16 or 4) as a big-endian number
+		void (*encryptCTR)(const sl_uint8* keys, sl_uint32 nRounds, sl_uint8* counter, sl_uint32 sizeCounter, const sl_uint8* src, sl_uint8* dst, sl_size nBlocks);
+
+		// table: H^1 ~ H^8 (128 bytes)
+		void (*generateGHashTable)(const sl_uint8* H, sl_uint8* table);
+
+		// X = (...((X ^ D[0]) * H ^ D[1]) * H ...) * H
+		void (*multiplyGHash)(const sl_uint8* table, sl_uint8* X, const sl_uint8* D, sl_size nBlocks);
+
+	};
+
+	// returns sl_null when the running CPU does not support AES-NI and PCLMULQDQ
+	const _AES_SIMD_Kernels* _AES_getSIMDKernels();
+
+}
+
+#endif
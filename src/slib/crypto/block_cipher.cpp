@@ -61,6 +61,77 @@ namespace slib
 	}
 
 
+/*
+	Multi-block helpers
+
+	Generic ciphers process one block per call, AES pipelines the blocks (AES-NI)
+*/
+
+	template <class BlockCipher>
+	SLIB_INLINE static void _BlockCipher_encryptBlocks(const BlockCipher* crypto, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		for (sl_size i = 0; i < n; i++) {
+			crypto->encryptBlock(src, dst);
+			src += block;
+			dst += block;
+		}
+	}
+
+	SLIB_INLINE static void _BlockCipher_encryptBlocks(const AES* crypto, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		crypto->encryptBlocks_ECB(src, dst, n);
+	}
+
+	template <class BlockCipher>
+	SLIB_INLINE static void _BlockCipher_decryptBlocks(const BlockCipher* crypto, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		for (sl_size i = 0; i < n; i++) {
+			crypto->decryptBlock(src, dst);
+			src += block;
+			dst += block;
+		}
+	}
+
+	SLIB_INLINE static void _BlockCipher_decryptBlocks(const AES* crypto, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		crypto->decryptBlocks_ECB(src, dst, n);
+	}
+
+	template <class BlockCipher>
+	SLIB_INLINE static void _BlockCipher_decryptCBC(const BlockCipher* crypto, const char* iv, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		for (sl_size i = 0; i < n; i++) {
+			crypto->decryptBlock(src, dst);
+			for (sl_uint32 k = 0; k < block; k++) {
+				dst[k] ^= iv[k];
+			}
+			iv = src;
+			src += block;
+			dst += block;
+		}
+	}
+
+	SLIB_INLINE static void _BlockCipher_decryptCBC(const AES* crypto, const char* iv, const char* src, char* dst, sl_size n, sl_uint32 block)
+	{
+		char IV[16];
+		Base::copyMemory(IV, iv, 16);
+		crypto->decryptBlocks_CBC(IV, src, dst, n);
+	}
+
+	// returns the count of processed blocks
+	template <class BlockCipher>
+	SLIB_INLINE static sl_size _BlockCipher_encryptCTR(const BlockCipher* crypto, sl_uint8* counter, const sl_uint8* input, sl_uint8* output, sl_size n)
+	{
+		return 0;
+	}
+
+	SLIB_INLINE static sl_size _BlockCipher_encryptCTR(const AES* crypto, sl_uint8* counter, const sl_uint8* input, sl_uint8* output, sl_size n)
+	{
+		crypto->encryptBlocks_CTR(counter, input, output, n);
+		return n;
+	}
+
+
 /**************************************
 			BlockCipher_Blocks
 ***************************************/
@@ -75,12 +146,7 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->encryptBlock(src, dst);
-			src += block;
-			dst += block;
-		}
+		_BlockCipher_encryptBlocks(crypto, src, dst, size / block, block);
 		return size;
 	}
 
@@ -94,12 +160,7 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->decryptBlock(src, dst);
-			src += block;
-			dst += block;
-		}
+		_BlockCipher_decryptBlocks(crypto, src, dst, size / block, block);
 		return size;
 	}
 
@@ -121,13 +182,11 @@ namespace slib
 			return 0;
 		}
 		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->encryptBlock(src, dst);
-			src += block;
-			dst += block;
-		}
-		char last[256];
 		sl_size p = n * block;
+		_BlockCipher_encryptBlocks(crypto, src, dst, n, block);
+		src += p;
+		dst += p;
+		char last[256];
 		sl_uint32 m = (sl_uint32)(size - p);
 		Base::copyMemory(last, src, m);
 		Padding::addPadding(last + m, block - m);
@@ -148,12 +207,8 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->decryptBlock(src, dst);
-			src += block;
-			dst += block;
-		}
+		_BlockCipher_decryptBlocks(crypto, src, dst, size / block, block);
+		dst += size;
 		sl_uint32 padding = Padding::removePadding(dst - block, block);
 		if (padding > 0) {
 			return size - padding;
@@ -242,16 +297,8 @@ namespace slib
 		if (size % block != 0) {
 			return 0;
 		}
-		sl_size n = size / block;
-		for (sl_size i = 0; i < n; i++) {
-			crypto->decryptBlock(src, dst);
-			for (sl_uint32 k = 0; k < block; k++) {
-				dst[k] ^= iv[k];
-			}
-			iv = src;
-			src += block;
-			dst += block;
-		}
+		_BlockCipher_decryptCBC(crypto, iv, src, dst, size / block, block);
+		dst += size;
 		sl_uint32 padding = Padding::removePadding(dst - block, block);
 		if (padding > 0) {
 			return size - padding;
@@ -328,6 +375,12 @@ namespace slib
 				return size;
 			}
 		}
+		if (size >= sizeBlock) {
+			n = _BlockCipher_encryptCTR(crypto, counter, input, output, size / sizeBlock) * sizeBlock;
+			size -= n;
+			input += n;
+			output += n;
+		}
 		while (size > 0) {
 			crypto->encryptBlock(counter, mask);
 			n = SLIB_MIN(sizeBlock, size);
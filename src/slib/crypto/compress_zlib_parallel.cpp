@@ -0,0 +1,586 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/crypto/parallel_zlib.h"
+
+#include "slib/core/mio.h"
+#include "slib/core/system.h"
+#include "slib/core/safe_static.h"
+
+#include "thirdparty/zlib/zlib.h"
+
+#define _PARALLEL_ZLIB_DEFAULT_BLOCK_SIZE 0x20000
+#define _PARALLEL_ZLIB_MIN_BLOCK_SIZE 0x8000
+#define _PARALLEL_ZLIB_MAX_BLOCK_SIZE 0x40000000
+#define _PARALLEL_ZLIB_DICT_SIZE 0x8000
+
+#define _PARALLEL_ZLIB_FORMAT_ZLIB 0
+#define _PARALLEL_ZLIB_FORMAT_RAW 1
+#define _PARALLEL_ZLIB_FORMAT_GZIP 2
+
+namespace slib
+{
+
+	SLIB_SAFE_STATIC_GETTER(Ref<ThreadPool>, _ParallelZlibCompress_getThreadPool, ThreadPool::create(0, System::getProcessorsCount()))
+
+	class _ParallelZlibCompress_Block : public Referable
+	{
+	public:
+		sl_uint32 format;
+		sl_int32 level;
+		sl_bool flagLast;
+
+		const sl_uint8* input;
+		sl_size sizeInput;
+		Memory memInput;
+		const sl_uint8* dict;
+		sl_uint32 sizeDict;
+		Memory memDict;
+
+		Memory memOutput;
+		sl_size sizeOutput;
+		sl_uint32 check;
+		sl_bool flagError;
+		sl_int32 flagDone;
+
+	public:
+		sl_bool isDone()
+		{
+			return Base::interlockedAdd32(&flagDone, 0) != 0;
+		}
+
+		void run()
+		{
+			flagError = !(_run());
+			// the dictionary and the input are not needed any more
+			memDict.setNull();
+			memInput.setNull();
+			Base::interlockedIncrement32(&flagDone);
+		}
+
+		sl_bool _run()
+		{
+			if (format == _PARALLEL_ZLIB_FORMAT_GZIP) {
+				check = (sl_uint32)(::crc32(0, (const Bytef*)input, (uInt)sizeInput));
+			} else if (format == _PARALLEL_ZLIB_FORMAT_ZLIB) {
+				check = (sl_uint32)(::adler32(1, (const Bytef*)input, (uInt)sizeInput));
+			} else {
+				check = 0;
+			}
+			z_stream stream;
+			Base::zeroMemory(&stream, sizeof(z_stream));
+			if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				return sl_false;
+			}
+			sl_bool flagSuccess = sl_false;
+			do {
+				if (sizeDict) {
+					if (deflateSetDictionary(&stream, (const Bytef*)dict, sizeDict) != Z_OK) {
+						break;
+					}
+				}
+				// the sync flush appends an empty stored block to the bound
+				sl_size sizeBuf = (sl_size)(deflateBound(&stream, (uLong)sizeInput)) + 16;
+				memOutput = Memory::create(sizeBuf);
+				if (memOutput.isNull()) {
+					break;
+				}
+				stream.next_in = (Bytef*)input;
+				stream.avail_in = (uInt)sizeInput;
+				stream.next_out = (Bytef*)(memOutput.getData());
+				stream.avail_out = (uInt)sizeBuf;
+				for (;;) {
+					int iRet = deflate(&stream, flagLast ? Z_FINISH : Z_SYNC_FLUSH);
+					if (iRet < 0 && iRet != Z_BUF_ERROR) {
+						break;
+					}
+					if (flagLast) {
+						if (iRet == Z_STREAM_END) {
+							flagSuccess = sl_true;
+							break;
+						}
+					} else {
+						if (!(stream.avail_in) && stream.avail_out) {
+							flagSuccess = sl_true;
+							break;
+						}
+					}
+					if (stream.avail_out) {
+						break;
+					}
+					Memory memNew = Memory::create(sizeBuf << 1);
+					if (memNew.isNull()) {
+						break;
+					}
+					Base::copyMemory(memNew.getData(), memOutput.getData(), sizeBuf);
+					memOutput = memNew;
+					stream.next_out = (Bytef*)(memOutput.getData()) + sizeBuf;
+					stream.avail_out = (uInt)sizeBuf;
+					sizeBuf <<= 1;
+				}
+				sizeOutput = sizeBuf - stream.avail_out;
+			} while (0);
+			deflateEnd(&stream);
+			return flagSuccess;
+		}
+
+	};
+
+
+	ParallelZlibCompress::ParallelZlibCompress()
+	{
+		m_flagStarted = sl_false;
+		m_flagError = sl_false;
+		m_format = _PARALLEL_ZLIB_FORMAT_ZLIB;
+		m_level = 6;
+		m_blockSize = _PARALLEL_ZLIB_DEFAULT_BLOCK_SIZE;
+		m_blockSizeCurrent = _PARALLEL_ZLIB_DEFAULT_BLOCK_SIZE;
+		m_nMaxPendingBlocks = 1;
+		m_sizeInput = 0;
+		m_dict = sl_null;
+		m_sizeDict = 0;
+		m_check = 0;
+		m_sizeTotal = 0;
+	}
+
+	ParallelZlibCompress::~ParallelZlibCompress()
+	{
+		abort();
+	}
+
+	sl_size ParallelZlibCompress::getDefaultBlockSize()
+	{
+		return _PARALLEL_ZLIB_DEFAULT_BLOCK_SIZE;
+	}
+
+	Memory ParallelZlibCompress::_compress(sl_uint32 format, const GzipParam* param, const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool)
+	{
+		Ref<MemoryWriter> writer = new MemoryWriter;
+		if (writer.isNull()) {
+			return sl_null;
+		}
+		ParallelZlibCompress compress;
+		if (blockSize) {
+			compress.setBlockSize(blockSize);
+		}
+		compress.setThreadPool(pool);
+		sl_bool flagSuccess = sl_false;
+		switch (format) {
+			case _PARALLEL_ZLIB_FORMAT_ZLIB:
+				flagSuccess = compress.start(writer, level);
+				break;
+			case _PARALLEL_ZLIB_FORMAT_RAW:
+				flagSuccess = compress.startRaw(writer, level);
+				break;
+			default:
+				flagSuccess = compress.startGzip(writer, *param, level);
+				break;
+		}
+		if (!flagSuccess) {
+			return sl_null;
+		}
+		// the caller keeps `data` alive until the blocks are finished, so the blocks refer to it without copying
+		if (compress._writeBlocks(data, size)) {
+			if (compress.finish()) {
+				return writer->getData();
+			}
+		}
+		return sl_null;
+	}
+
+	Memory ParallelZlibCompress::compress(const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool)
+	{
+		return _compress(_PARALLEL_ZLIB_FORMAT_ZLIB, sl_null, data, size, level, blockSize, pool);
+	}
+
+	Memory ParallelZlibCompress::compressRaw(const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool)
+	{
+		return _compress(_PARALLEL_ZLIB_FORMAT_RAW, sl_null, data, size, level, blockSize, pool);
+	}
+
+	Memory ParallelZlibCompress::compressGzip(const GzipParam& param, const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool)
+	{
+		return _compress(_PARALLEL_ZLIB_FORMAT_GZIP, &param, data, size, level, blockSize, pool);
+	}
+
+	Memory ParallelZlibCompress::compressGzip(const void* data, sl_size size, sl_int32 level, sl_size blockSize, const Ref<ThreadPool>& pool)
+	{
+		GzipParam param;
+		return _compress(_PARALLEL_ZLIB_FORMAT_GZIP, &param, data, size, level, blockSize, pool);
+	}
+
+	sl_size ParallelZlibCompress::getBlockSize()
+	{
+		return m_blockSize;
+	}
+
+	void ParallelZlibCompress::setBlockSize(sl_size size)
+	{
+		if (size < _PARALLEL_ZLIB_MIN_BLOCK_SIZE) {
+			size = _PARALLEL_ZLIB_MIN_BLOCK_SIZE;
+		}
+		if (size > _PARALLEL_ZLIB_MAX_BLOCK_SIZE) {
+			size = _PARALLEL_ZLIB_MAX_BLOCK_SIZE;
+		}
+		m_blockSize = size;
+	}
+
+	Ref<ThreadPool> ParallelZlibCompress::getThreadPool()
+	{
+		return m_pool;
+	}
+
+	void ParallelZlibCompress::setThreadPool(const Ref<ThreadPool>& pool)
+	{
+		m_pool = pool;
+	}
+
+	sl_bool ParallelZlibCompress::isStarted()
+	{
+		return m_flagStarted;
+	}
+
+	sl_bool ParallelZlibCompress::start(const Ptr<IWriter>& output, sl_int32 level)
+	{
+		return _start(output, _PARALLEL_ZLIB_FORMAT_ZLIB, sl_null, level);
+	}
+
+	sl_bool ParallelZlibCompress::startRaw(const Ptr<IWriter>& output, sl_int32 level)
+	{
+		return _start(output, _PARALLEL_ZLIB_FORMAT_RAW, sl_null, level);
+	}
+
+	sl_bool ParallelZlibCompress::startGzip(const Ptr<IWriter>& output, const GzipParam& param, sl_int32 level)
+	{
+		return _start(output, _PARALLEL_ZLIB_FORMAT_GZIP, &param, level);
+	}
+
+	sl_bool ParallelZlibCompress::startGzip(const Ptr<IWriter>& output, sl_int32 level)
+	{
+		GzipParam param;
+		return _start(output, _PARALLEL_ZLIB_FORMAT_GZIP, &param, level);
+	}
+
+	sl_bool ParallelZlibCompress::_start(const Ptr<IWriter>& output, sl_uint32 format, const GzipParam* param, sl_int32 level)
+	{
+		if (m_flagStarted) {
+			abort();
+		}
+		if (output.isNull()) {
+			return sl_false;
+		}
+		if (level < 0) {
+			level = Z_DEFAULT_COMPRESSION;
+		}
+		if (level > 9) {
+			level = 9;
+		}
+		m_output = output;
+		m_format = format;
+		m_level = level;
+		m_flagError = sl_false;
+		m_blockSizeCurrent = m_blockSize;
+		m_sizeInput = 0;
+		m_memInput.setNull();
+		m_dict = sl_null;
+		m_sizeDict = 0;
+		m_memDict.setNull();
+		m_sizeTotal = 0;
+		m_blocks.removeAll_NoLock();
+
+		m_poolCurrent.setNull();
+		m_eventDone.setNull();
+		m_nMaxPendingBlocks = 1;
+		sl_uint32 nProcessors = System::getProcessorsCount();
+		if (nProcessors > 1) {
+			Ref<ThreadPool> pool = m_pool;
+			if (pool.isNull()) {
+				Ref<ThreadPool>* p = _ParallelZlibCompress_getThreadPool();
+				if (p) {
+					pool = *p;
+				}
+			}
+			if (pool.isNotNull()) {
+				m_eventDone = Event::create();
+				if (m_eventDone.isNotNull()) {
+					m_poolCurrent = pool;
+					// keeps every worker busy while the finished blocks wait for their predecessors
+					m_nMaxPendingBlocks = nProcessors << 1;
+				}
+			}
+		}
+
+		sl_int32 levelHeader = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+		if (format == _PARALLEL_ZLIB_FORMAT_ZLIB) {
+			m_check = 1;
+			sl_uint32 flags;
+			if (levelHeader < 2) {
+				flags = 0;
+			} else if (levelHeader < 6) {
+				flags = 1;
+			} else if (levelHeader == 6) {
+				flags = 2;
+			} else {
+				flags = 3;
+			}
+			sl_uint32 header = (Z_DEFLATED + (7 << 4)) << 8;
+			header |= flags << 6;
+			header += 31 - (header % 31);
+			sl_uint8 h[2] = { (sl_uint8)(header >> 8), (sl_uint8)header };
+			m_flagStarted = _writeOutput(h, 2);
+		} else if (format == _PARALLEL_ZLIB_FORMAT_GZIP) {
+			m_check = 0;
+			sl_uint8 h[10];
+			h[0] = 0x1f;
+			h[1] = 0x8b;
+			h[2] = Z_DEFLATED;
+			h[3] = 0;
+			if (param->fileName.isNotEmpty()) {
+				h[3] |= 8;
+			}
+			if (param->comment.isNotEmpty()) {
+				h[3] |= 16;
+			}
+			// modification time is not stored
+			h[4] = h[5] = h[6] = h[7] = 0;
+			h[8] = levelHeader == 9 ? 2 : (levelHeader < 2 ? 4 : 0);
+			h[9] = 255;
+			m_flagStarted = _writeOutput(h, 10);
+			if (m_flagStarted && param->fileName.isNotEmpty()) {
+				m_flagStarted = _writeOutput(param->fileName.getData(), param->fileName.getLength() + 1);
+			}
+			if (m_flagStarted && param->comment.isNotEmpty()) {
+				m_flagStarted = _writeOutput(param->comment.getData(), param->comment.getLength() + 1);
+			}
+		} else {
+			m_check = 0;
+			m_flagStarted = sl_true;
+		}
+		if (!m_flagStarted) {
+			abort();
+		}
+		return m_flagStarted;
+	}
+
+	sl_reg ParallelZlibCompress::write(const void* _data, sl_size size)
+	{
+		if (!m_flagStarted || m_flagError) {
+			return -1;
+		}
+		const sl_uint8* data = (const sl_uint8*)_data;
+		sl_size sizeWritten = size;
+		while (size) {
+			// a full block is submitted when more input arrives, so that the last block can be finished by `finish()`
+			if (m_sizeInput == m_blockSizeCurrent) {
+				Memory mem = m_memInput;
+				m_memInput.setNull();
+				m_sizeInput = 0;
+				if (!(_submit((const sl_uint8*)(mem.getData()), m_blockSizeCurrent, mem, sl_false))) {
+					abort();
+					return -1;
+				}
+			}
+			if (m_memInput.isNull()) {
+				m_memInput = Memory::create(m_blockSizeCurrent);
+				if (m_memInput.isNull()) {
+					abort();
+					return -1;
+				}
+			}
+			sl_size n = m_blockSizeCurrent - m_sizeInput;
+			if (n > size) {
+				n = size;
+			}
+			Base::copyMemory((sl_uint8*)(m_memInput.getData()) + m_sizeInput, data, n);
+			m_sizeInput += n;
+			data += n;
+			size -= n;
+		}
+		return sizeWritten;
+	}
+
+	sl_bool ParallelZlibCompress::_writeBlocks(const void* _data, sl_size size)
+	{
+		if (!m_flagStarted || m_flagError || m_sizeInput) {
+			return sl_false;
+		}
+		const sl_uint8* data = (const sl_uint8*)_data;
+		while (size > m_blockSizeCurrent) {
+			if (!(_submit(data, m_blockSizeCurrent, sl_null, sl_false))) {
+				abort();
+				return sl_false;
+			}
+			data += m_blockSizeCurrent;
+			size -= m_blockSizeCurrent;
+		}
+		if (size) {
+			// the last block is copied, to be finished by `finish()`
+			return write(data, size) == (sl_reg)size;
+		}
+		return sl_true;
+	}
+
+	sl_bool ParallelZlibCompress::finish()
+	{
+		if (!m_flagStarted || m_flagError) {
+			return sl_false;
+		}
+		Memory mem = m_memInput;
+		m_memInput.setNull();
+		if (!(_submit((const sl_uint8*)(mem.getData()), m_sizeInput, mem, sl_true))) {
+			abort();
+			return sl_false;
+		}
+		m_sizeInput = 0;
+		while (m_blocks.getCount()) {
+			if (!(_waitFront())) {
+				abort();
+				return sl_false;
+			}
+		}
+		sl_bool flagSuccess = sl_true;
+		if (m_format == _PARALLEL_ZLIB_FORMAT_ZLIB) {
+			sl_uint8 t[4];
+			MIO::writeUint32BE(t, m_check);
+			flagSuccess = _writeOutput(t, 4);
+		} else if (m_format == _PARALLEL_ZLIB_FORMAT_GZIP) {
+			sl_uint8 t[8];
+			MIO::writeUint32LE(t, m_check);
+			MIO::writeUint32LE(t + 4, (sl_uint32)m_sizeTotal);
+			flagSuccess = _writeOutput(t, 8);
+		}
+		abort();
+		return flagSuccess;
+	}
+
+	void ParallelZlibCompress::abort()
+	{
+		// the blocks may refer to the input of the caller
+		Ref<_ParallelZlibCompress_Block> block;
+		while (m_blocks.pop_NoLock(&block)) {
+			while (!(block->isDone())) {
+				m_eventDone->wait();
+			}
+		}
+		m_memInput.setNull();
+		m_sizeInput = 0;
+		m_memDict.setNull();
+		m_dict = sl_null;
+		m_sizeDict = 0;
+		m_output.setNull();
+		m_poolCurrent.setNull();
+		m_eventDone.setNull();
+		m_flagStarted = sl_false;
+	}
+
+	sl_bool ParallelZlibCompress::_submit(const sl_uint8* data, sl_size size, const Memory& mem, sl_bool flagLast)
+	{
+		Ref<_ParallelZlibCompress_Block> block = new _ParallelZlibCompress_Block;
+		if (block.isNull()) {
+			return sl_false;
+		}
+		block->format = m_format;
+		block->level = m_level;
+		block->flagLast = flagLast;
+		block->input = data;
+		block->sizeInput = size;
+		block->memInput = mem;
+		block->dict = m_dict;
+		block->sizeDict = m_sizeDict;
+		block->memDict = m_memDict;
+		block->sizeOutput = 0;
+		block->check = 0;
+		block->flagError = sl_false;
+		block->flagDone = 0;
+
+		// the blocks other than the last one are not smaller than the dictionary
+		if (size >= _PARALLEL_ZLIB_DICT_SIZE) {
+			m_dict = data + size - _PARALLEL_ZLIB_DICT_SIZE;
+			m_sizeDict = _PARALLEL_ZLIB_DICT_SIZE;
+			m_memDict = mem;
+		}
+
+		if (m_poolCurrent.isNotNull()) {
+			while (m_blocks.getCount() >= m_nMaxPendingBlocks) {
+				if (!(_waitFront())) {
+					return sl_false;
+				}
+			}
+			Ref<Event> event = m_eventDone;
+			if (m_poolCurrent->addTask([block, event]() {
+				block->run();
+				event->set();
+			})) {
+				m_blocks.push_NoLock(block);
+				// writes out the blocks which are already finished
+				Ref<_ParallelZlibCompress_Block> front;
+				while (m_blocks.getFirstItem_NoLock(&front) && front->isDone()) {
+					m_blocks.pop_NoLock();
+					if (!(_writeBlock(front.get()))) {
+						return sl_false;
+					}
+				}
+				return sl_true;
+			}
+			while (m_blocks.getCount()) {
+				if (!(_waitFront())) {
+					return sl_false;
+				}
+			}
+		}
+		block->run();
+		return _writeBlock(block.get());
+	}
+
+	sl_bool ParallelZlibCompress::_waitFront()
+	{
+		Ref<_ParallelZlibCompress_Block> block;
+		if (!(m_blocks.pop_NoLock(&block))) {
+			return sl_false;
+		}
+		while (!(block->isDone())) {
+			m_eventDone->wait();
+		}
+		return _writeBlock(block.get());
+	}
+
+	sl_bool ParallelZlibCompress::_writeBlock(_ParallelZlibCompress_Block* block)
+	{
+		if (block->flagError) {
+			m_flagError = sl_true;
+			return sl_false;
+		}
+		if (m_format == _PARALLEL_ZLIB_FORMAT_GZIP) {
+			m_check = (sl_uint32)(crc32_combine(m_check, block->check, (z_off_t)(block->sizeInput)));
+		} else if (m_format == _PARALLEL_ZLIB_FORMAT_ZLIB) {
+			m_check = (sl_uint32)(adler32_combine(m_check, block->check, (z_off_t)(block->sizeInput)));
+		}
+		m_sizeTotal += block->sizeInput;
+		sl_bool flagSuccess = _writeOutput(block->memOutput.getData(), block->sizeOutput);
+		block->memOutput.setNull();
+		return flagSuccess;
+	}
+
+	sl_bool ParallelZlibCompress::_writeOutput(const void* data, sl_size size)
+	{
+		if (!size) {
+			return sl_true;
+		}
+		PtrLocker<IWriter> output(m_output);
+		if (output.isNotNull()) {
+			if (output->writeFully(data, size) == (sl_reg)size) {
+				return sl_true;
+			}
+		}
+		m_flagError = sl_true;
+		return sl_false;
+	}
+
+}
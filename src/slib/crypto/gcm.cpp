@@ -11,6 +11,13 @@
 #include "slib/crypto/gcm.h"
 
 #include "slib/crypto/aes.h"
+#include "slib/core/mio.h"
+#include "slib/core/math.h"
+
+#include "aes_simd.h"
+
+// count of blocks encrypted and hashed at once by the multi-block path
+#define _GCM_BULK_BLOCKS 64
 
 namespace slib
 {
@@ -20,6 +27,11 @@ namespace slib
 		sl_uint32 i, j;
 		Uint128 H;
 
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->generateGHashTable((const sl_uint8*)_H, HP);
+		}
+
 		H.setBytesBE(_H);
 
 /*
@@ -74,6 +86,14 @@ namespace slib
 
 	void GCM_Table::multiplyH(const void* _X, void* _O) const
 	{
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			sl_uint8 Y[16] = { 0 };
+			kernels->multiplyGHash(HP, Y, (const sl_uint8*)_X, 1);
+			Base::copyMemory(_O, Y, 16);
+			return;
+		}
+
 		const sl_uint8* X = (const sl_uint8*)_X;
 		sl_uint8* O = (sl_uint8*)_O;
 		Uint128 Z;
@@ -120,6 +140,12 @@ namespace slib
 		sl_size i, k, n;
 
 		n = lenD >> 4;
+		const _AES_SIMD_Kernels* kernels = _AES_getSIMDKernels();
+		if (kernels) {
+			kernels->multiplyGHash(HP, X, D, n);
+			D += (n << 4);
+			n = 0;
+		}
 		for (i = 0; i < n; i++) {
 			for (k = 0; k < 16; k++) {
 				X[k] ^= *D;
@@ -316,6 +342,24 @@ namespace slib
 		sl_size i, k, n;
 		const sl_uint8* P = (const sl_uint8*)src;
 		sl_uint8* C = (sl_uint8*)dst;
+
+		// whole blocks: counter mode over a chunk, then GHASH over its cipher text
+		sl_size nBlocks = len >> 4;
+		if (nBlocks) {
+			sl_uint32 c = MIO::readUint32BE(CIV + 12);
+			sl_uint8 counter[16];
+			Base::copyMemory(counter, CIV, 12);
+			MIO::writeUint32BE(counter + 12, c + 1);
+			for (i = 0; i < nBlocks; i += n) {
+				n = Math::min(nBlocks - i, (sl_size)_GCM_BULK_BLOCKS);
+				m_cipher->encryptBlocks_CTR(counter, P, C, n, 4);
+				multiplyData(GHASH_X, C, n << 4);
+				P += (n << 4);
+				C += (n << 4);
+			}
+			MIO::writeUint32BE(CIV + 12, c + (sl_uint32)nBlocks);
+			len &= 15;
+		}
 		
 		for (i = 0; i < len; i += 16) {
 			increaseCIV();
@@ -359,6 +403,24 @@ namespace slib
 		sl_size i, k, n;
 		const sl_uint8* C = (const sl_uint8*)src;
 		sl_uint8* P = (sl_uint8*)dst;
+
+		// whole blocks: GHASH over a chunk of cipher text, then counter mode over it
+		sl_size nBlocks = len >> 4;
+		if (nBlocks) {
+			sl_uint32 c = MIO::readUint32BE(CIV + 12);
+			sl_uint8 counter[16];
+			Base::copyMemory(counter, CIV, 12);
+			MIO::writeUint32BE(counter + 12, c + 1);
+			for (i = 0; i < nBlocks; i += n) {
+				n = Math::min(nBlocks - i, (sl_size)_GCM_BULK_BLOCKS);
+				multiplyData(GHASH_X, C, n << 4);
+				m_cipher->encryptBlocks_CTR(counter, C, P, n, 4);
+				C += (n << 4);
+				P += (n << 4);
+			}
+			MIO::writeUint32BE(CIV + 12, c + (sl_uint32)nBlocks);
+			len &= 15;
+		}
 		
 		for (i = 0; i < len; i += 16) {
 			increaseCIV();
@@ -0,0 +1,640 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "hash_simd.h"
+
+#include "slib/core/base.h"
+#include "slib/core/mio.h"
+
+#if defined(SLIB_ARCH_IS_X64) || defined(SLIB_ARCH_IS_X86)
+#	if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#		define _CRYPTO_HASH_SIMD_USE_X86
+#	endif
+#endif
+
+#if defined(_CRYPTO_HASH_SIMD_USE_X86)
+#	include <emmintrin.h>
+#	include <tmmintrin.h>
+#	include <smmintrin.h>
+#	include <immintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#endif
+
+#define _CRYPTO_HASH_LANES 8
+
+namespace slib
+{
+
+	static sl_uint32 _CryptoHash_padBlock(sl_uint8* tail, const sl_uint8* input, sl_size size, sl_bool flagBigEndian)
+	{
+		sl_uint32 nRemain = (sl_uint32)(size & 63);
+		Base::copyMemory(tail, input + (size & ~((sl_size)63)), nRemain);
+		tail[nRemain] = 0x80;
+		sl_uint32 nTailBlocks = nRemain < 56 ? 1 : 2;
+		sl_uint32 posLength = (nTailBlocks << 6) - 8;
+		Base::zeroMemory(tail + nRemain + 1, posLength - nRemain - 1);
+		if (flagBigEndian) {
+			MIO::writeUint64BE(tail + posLength, ((sl_uint64)size) << 3);
+		} else {
+			MIO::writeUint64LE(tail + posLength, ((sl_uint64)size) << 3);
+		}
+		return nTailBlocks;
+	}
+
+	static void _CryptoHash_writeState(sl_uint8* output, const sl_uint32* state, sl_uint32 nWords, sl_uint32 step, sl_bool flagBigEndian)
+	{
+		for (sl_uint32 k = 0; k < nWords; k++) {
+			if (flagBigEndian) {
+				MIO::writeUint32BE(output + (k << 2), state[k * step]);
+			} else {
+				MIO::writeUint32LE(output + (k << 2), state[k * step]);
+			}
+		}
+	}
+
+	void _CryptoHash_hashSequential(void (*kernel)(sl_uint32* h, const sl_uint8* data, sl_size nBlocks), const sl_uint32* iv, sl_uint32 nWords, sl_bool flagBigEndian, const void* const* inputs, const sl_size* sizes, sl_size count, void* _outputs)
+	{
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		sl_uint32 h[8];
+		sl_uint8 tail[128];
+		for (sl_size i = 0; i < count; i++) {
+			const sl_uint8* input = (const sl_uint8*)(inputs[i]);
+			sl_size size = sizes[i];
+			Base::copyMemory(h, iv, nWords << 2);
+			if (size >= 64) {
+				kernel(h, input, size >> 6);
+			}
+			kernel(h, tail, _CryptoHash_padBlock(tail, input, size, flagBigEndian));
+			_CryptoHash_writeState(outputs, h, nWords, 1, flagBigEndian);
+			outputs += (nWords << 2);
+		}
+	}
+
+	class _CryptoHash_Lane
+	{
+	public:
+		const sl_uint8* data;
+		sl_size nBlocks;
+		sl_size index;
+		sl_uint32 nTailBlocks;
+		sl_bool flagTail;
+		sl_uint8 tail[128];
+	};
+
+	void _CryptoHash_hashMultiBuffer(_CryptoHash_MultiBufferKernel kernel, const sl_uint32* iv, sl_uint32 nWords, sl_bool flagBigEndian, const void* const* inputs, const sl_size* sizes, sl_size count, void* _outputs)
+	{
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		_CryptoHash_Lane lanes[_CRYPTO_HASH_LANES];
+		sl_bool flagActive[_CRYPTO_HASH_LANES];
+		sl_uint32 state[8 * _CRYPTO_HASH_LANES];
+		const sl_uint8* data[_CRYPTO_HASH_LANES];
+		sl_uint32 iLane, k;
+		for (iLane = 0; iLane < _CRYPTO_HASH_LANES; iLane++) {
+			flagActive[iLane] = sl_false;
+		}
+		sl_size indexNext = 0;
+		for (;;) {
+			// assign the pending messages to the free lanes
+			sl_uint32 nActive = 0;
+			for (iLane = 0; iLane < _CRYPTO_HASH_LANES; iLane++) {
+				_CryptoHash_Lane& lane = lanes[iLane];
+				if (!(flagActive[iLane]) && indexNext < count) {
+					const sl_uint8* input = (const sl_uint8*)(inputs[indexNext]);
+					sl_size size = sizes[indexNext];
+					lane.index = indexNext;
+					lane.data = input;
+					lane.nBlocks = size >> 6;
+					lane.nTailBlocks = _CryptoHash_padBlock(lane.tail, input, size, flagBigEndian);
+					lane.flagTail = sl_false;
+					if (!(lane.nBlocks)) {
+						lane.data = lane.tail;
+						lane.nBlocks = lane.nTailBlocks;
+						lane.flagTail = sl_true;
+					}
+					for (k = 0; k < nWords; k++) {
+						state[k * _CRYPTO_HASH_LANES + iLane] = iv[k];
+					}
+					flagActive[iLane] = sl_true;
+					indexNext++;
+				}
+				if (flagActive[iLane]) {
+					nActive++;
+				}
+			}
+			if (!nActive) {
+				break;
+			}
+			// run the lanes until the shortest one reaches the end of its segment
+			sl_size nBlocks = 0;
+			const sl_uint8* dataIdle = sl_null;
+			for (iLane = 0; iLane < _CRYPTO_HASH_LANES; iLane++) {
+				if (flagActive[iLane]) {
+					if (!nBlocks || lanes[iLane].nBlocks < nBlocks) {
+						nBlocks = lanes[iLane].nBlocks;
+						dataIdle = lanes[iLane].data;
+					}
+				}
+			}
+			for (iLane = 0; iLane < _CRYPTO_HASH_LANES; iLane++) {
+				// idle lanes hash a copy of an active one, and their results are ignored
+				data[iLane] = flagActive[iLane] ? lanes[iLane].data : dataIdle;
+			}
+			kernel(state, data, nBlocks);
+			for (iLane = 0; iLane < _CRYPTO_HASH_LANES; iLane++) {
+				if (!(flagActive[iLane])) {
+					continue;
+				}
+				_CryptoHash_Lane& lane = lanes[iLane];
+				lane.data += (nBlocks << 6);
+				lane.nBlocks -= nBlocks;
+				if (lane.nBlocks) {
+					continue;
+				}
+				if (!(lane.flagTail)) {
+					lane.data = lane.tail;
+					lane.nBlocks = lane.nTailBlocks;
+					lane.flagTail = sl_true;
+					continue;
+				}
+				_CryptoHash_writeState(outputs + lane.index * (nWords << 2), state + iLane, nWords, _CRYPTO_HASH_LANES, flagBigEndian);
+				flagActive[iLane] = sl_false;
+			}
+		}
+	}
+
+#if defined(_CRYPTO_HASH_SIMD_USE_X86)
+
+	static const sl_uint32 _CryptoHash_SHA256_K[64] = {
+		0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul,
+		0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+		0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul,
+		0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+		0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
+		0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+		0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul,
+		0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+		0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul,
+		0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+		0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul,
+		0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+		0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul,
+		0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+		0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
+		0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+	};
+
+/*
+	SHA-1 and SHA-256 on the SHA extensions
+*/
+
+#	if defined(__clang__)
+#		pragma clang attribute push (__attribute__((target("sha,ssse3,sse4.1"))), apply_to = function)
+#	elif defined(__GNUC__)
+#		pragma GCC push_options
+#		pragma GCC target("sha,ssse3,sse4.1")
+#	endif
+
+	// four rounds of SHA-1 (G: index of the group). `m` holds the message words, m[G % 4] being the current ones
+	template <sl_uint32 G>
+	SLIB_INLINE static void _SHA1_NI_rounds(__m128i& abcd, __m128i& e0, __m128i& e1, __m128i* m)
+	{
+		__m128i& mCur = m[G & 3];
+		__m128i& mPrev = m[(G + 3) & 3];
+		__m128i& mPrev2 = m[(G + 2) & 3];
+		__m128i& mNext = m[(G + 1) & 3];
+		__m128i& ea = (G & 1) ? e1 : e0;
+		__m128i& eb = (G & 1) ? e0 : e1;
+		if (G == 0) {
+			ea = _mm_add_epi32(ea, mCur);
+		} else {
+			ea = _mm_sha1nexte_epu32(ea, mCur);
+		}
+		eb = abcd;
+		if (G >= 3 && G <= 18) {
+			mNext = _mm_sha1msg2_epu32(mNext, mCur);
+		}
+		abcd = _mm_sha1rnds4_epu32(abcd, ea, G / 5);
+		if (G >= 1 && G <= 16) {
+			mPrev = _mm_sha1msg1_epu32(mPrev, mCur);
+		}
+		if (G >= 2 && G <= 17) {
+			mPrev2 = _mm_xor_si128(mPrev2, mCur);
+		}
+	}
+
+	static void _SHA1_NI_blocks(sl_uint32* h, const sl_uint8* data, sl_size nBlocks)
+	{
+		const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)h), 0x1B);
+		__m128i e0 = _mm_set_epi32((int)(h[4]), 0, 0, 0);
+		__m128i e1;
+		__m128i m[4];
+		while (nBlocks) {
+			__m128i abcdSave = abcd;
+			__m128i e0Save = e0;
+			m[0] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask);
+			m[1] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+			m[2] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+			m[3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+			_SHA1_NI_rounds<0>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<1>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<2>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<3>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<4>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<5>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<6>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<7>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<8>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<9>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<10>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<11>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<12>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<13>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<14>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<15>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<16>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<17>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<18>(abcd, e0, e1, m);
+			_SHA1_NI_rounds<19>(abcd, e0, e1, m);
+			e0 = _mm_sha1nexte_epu32(e0, e0Save);
+			abcd = _mm_add_epi32(abcd, abcdSave);
+			data += 64;
+			nBlocks--;
+		}
+		_mm_storeu_si128((__m128i*)h, _mm_shuffle_epi32(abcd, 0x1B));
+		h[4] = (sl_uint32)(_mm_extract_epi32(e0, 3));
+	}
+
+	// four rounds of SHA-256 (G: index of the group). `m` holds the message words, m[G % 4] being the current ones
+	template <sl_uint32 G>
+	SLIB_INLINE static void _SHA256_NI_rounds(__m128i& state0, __m128i& state1, __m128i* m)
+	{
+		__m128i& mCur = m[G & 3];
+		__m128i& mPrev = m[(G + 3) & 3];
+		__m128i& mNext = m[(G + 1) & 3];
+		__m128i msg = _mm_add_epi32(mCur, _mm_loadu_si128((const __m128i*)(_CryptoHash_SHA256_K + (G << 2))));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		if (G >= 3 && G <= 14) {
+			mNext = _mm_add_epi32(mNext, _mm_alignr_epi8(mCur, mPrev, 4));
+			mNext = _mm_sha256msg2_epu32(mNext, mCur);
+		}
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		if (G >= 1 && G <= 12) {
+			mPrev = _mm_sha256msg1_epu32(mPrev, mCur);
+		}
+	}
+
+	static void _SHA256_NI_blocks(sl_uint32* h, const sl_uint8* data, sl_size nBlocks)
+	{
+		const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+		__m128i t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)h), 0xB1); // CDAB
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(h + 4)), 0x1B); // EFGH
+		__m128i state0 = _mm_alignr_epi8(t, state1, 8); // ABEF
+		state1 = _mm_blend_epi16(state1, t, 0xF0); // CDGH
+		__m128i m[4];
+		while (nBlocks) {
+			__m128i save0 = state0;
+			__m128i save1 = state1;
+			m[0] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask);
+			m[1] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+			m[2] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+			m[3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+			_SHA256_NI_rounds<0>(state0, state1, m);
+			_SHA256_NI_rounds<1>(state0, state1, m);
+			_SHA256_NI_rounds<2>(state0, state1, m);
+			_SHA256_NI_rounds<3>(state0, state1, m);
+			_SHA256_NI_rounds<4>(state0, state1, m);
+			_SHA256_NI_rounds<5>(state0, state1, m);
+			_SHA256_NI_rounds<6>(state0, state1, m);
+			_SHA256_NI_rounds<7>(state0, state1, m);
+			_SHA256_NI_rounds<8>(state0, state1, m);
+			_SHA256_NI_rounds<9>(state0, state1, m);
+			_SHA256_NI_rounds<10>(state0, state1, m);
+			_SHA256_NI_rounds<11>(state0, state1, m);
+			_SHA256_NI_rounds<12>(state0, state1, m);
+			_SHA256_NI_rounds<13>(state0, state1, m);
+			_SHA256_NI_rounds<14>(state0, state1, m);
+			_SHA256_NI_rounds<15>(state0, state1, m);
+			state0 = _mm_add_epi32(state0, save0);
+			state1 = _mm_add_epi32(state1, save1);
+			data += 64;
+			nBlocks--;
+		}
+		t = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+		state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+		_mm_storeu_si128((__m128i*)h, _mm_blend_epi16(t, state1, 0xF0)); // DCBA
+		_mm_storeu_si128((__m128i*)(h + 4), _mm_alignr_epi8(state1, t, 8)); // HGFE
+	}
+
+#	if defined(__clang__)
+#		pragma clang attribute pop
+#	elif defined(__GNUC__)
+#		pragma GCC pop_options
+#	endif
+
+/*
+	Multi-buffer SHA-256 and MD5 on AVX2, one message in each 32-bit lane
+*/
+
+#	if defined(__clang__)
+#		pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#	elif defined(__GNUC__)
+#		pragma GCC push_options
+#		pragma GCC target("avx2")
+#	endif
+
+#define _CRYPTO_HASH_ROTL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+#define _CRYPTO_HASH_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+	// loads the words [offset, offset + 8) of the current block of each lane, transposed to one register per word
+	SLIB_INLINE static void _CryptoHash_AVX2_loadWords(__m256i* w, const sl_uint8* const* data, sl_size offset)
+	{
+		__m256i r0 = _mm256_loadu_si256((const __m256i*)(data[0] + offset));
+		__m256i r1 = _mm256_loadu_si256((const __m256i*)(data[1] + offset));
+		__m256i r2 = _mm256_loadu_si256((const __m256i*)(data[2] + offset));
+		__m256i r3 = _mm256_loadu_si256((const __m256i*)(data[3] + offset));
+		__m256i r4 = _mm256_loadu_si256((const __m256i*)(data[4] + offset));
+		__m256i r5 = _mm256_loadu_si256((const __m256i*)(data[5] + offset));
+		__m256i r6 = _mm256_loadu_si256((const __m256i*)(data[6] + offset));
+		__m256i r7 = _mm256_loadu_si256((const __m256i*)(data[7] + offset));
+		__m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+		__m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+		__m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+		__m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+		__m256i t4 = _mm256_unpacklo_epi32(r4, r5);
+		__m256i t5 = _mm256_unpackhi_epi32(r4, r5);
+		__m256i t6 = _mm256_unpacklo_epi32(r6, r7);
+		__m256i t7 = _mm256_unpackhi_epi32(r6, r7);
+		r0 = _mm256_unpacklo_epi64(t0, t2);
+		r1 = _mm256_unpackhi_epi64(t0, t2);
+		r2 = _mm256_unpacklo_epi64(t1, t3);
+		r3 = _mm256_unpackhi_epi64(t1, t3);
+		r4 = _mm256_unpacklo_epi64(t4, t6);
+		r5 = _mm256_unpackhi_epi64(t4, t6);
+		r6 = _mm256_unpacklo_epi64(t5, t7);
+		r7 = _mm256_unpackhi_epi64(t5, t7);
+		w[0] = _mm256_permute2x128_si256(r0, r4, 0x20);
+		w[1] = _mm256_permute2x128_si256(r1, r5, 0x20);
+		w[2] = _mm256_permute2x128_si256(r2, r6, 0x20);
+		w[3] = _mm256_permute2x128_si256(r3, r7, 0x20);
+		w[4] = _mm256_permute2x128_si256(r0, r4, 0x31);
+		w[5] = _mm256_permute2x128_si256(r1, r5, 0x31);
+		w[6] = _mm256_permute2x128_si256(r2, r6, 0x31);
+		w[7] = _mm256_permute2x128_si256(r3, r7, 0x31);
+	}
+
+	static void _SHA256_AVX2_blocks_x8(sl_uint32* state, const sl_uint8* const* _data, sl_size nBlocks)
+	{
+		const __m256i mask = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+		const sl_uint8* data[_CRYPTO_HASH_LANES];
+		sl_uint32 i;
+		for (i = 0; i < _CRYPTO_HASH_LANES; i++) {
+			data[i] = _data[i];
+		}
+		__m256i h[8];
+		for (i = 0; i < 8; i++) {
+			h[i] = _mm256_loadu_si256((const __m256i*)(state + (i << 3)));
+		}
+		__m256i W[64];
+		while (nBlocks) {
+			_CryptoHash_AVX2_loadWords(W, data, 0);
+			_CryptoHash_AVX2_loadWords(W + 8, data, 32);
+			for (i = 0; i < 16; i++) {
+				W[i] = _mm256_shuffle_epi8(W[i], mask);
+			}
+			for (i = 16; i < 64; i++) {
+				__m256i w15 = W[i - 15];
+				__m256i w2 = W[i - 2];
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(_CRYPTO_HASH_ROTR(w15, 7), _CRYPTO_HASH_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(_CRYPTO_HASH_ROTR(w2, 17), _CRYPTO_HASH_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+				W[i] = _mm256_add_epi32(_mm256_add_epi32(W[i - 16], s0), _mm256_add_epi32(W[i - 7], s1));
+			}
+			__m256i a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+			for (i = 0; i < 64; i++) {
+				__m256i S1 = _mm256_xor_si256(_mm256_xor_si256(_CRYPTO_HASH_ROTR(e, 6), _CRYPTO_HASH_ROTR(e, 11)), _CRYPTO_HASH_ROTR(e, 25));
+				__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+				__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(hh, S1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32((int)(_CryptoHash_SHA256_K[i])), W[i])));
+				__m256i S0 = _mm256_xor_si256(_mm256_xor_si256(_CRYPTO_HASH_ROTR(a, 2), _CRYPTO_HASH_ROTR(a, 13)), _CRYPTO_HASH_ROTR(a, 22));
+				__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+				hh = g;
+				g = f;
+				f = e;
+				e = _mm256_add_epi32(d, temp1);
+				d = c;
+				c = b;
+				b = a;
+				a = _mm256_add_epi32(temp1, _mm256_add_epi32(S0, maj));
+			}
+			h[0] = _mm256_add_epi32(h[0], a);
+			h[1] = _mm256_add_epi32(h[1], b);
+			h[2] = _mm256_add_epi32(h[2], c);
+			h[3] = _mm256_add_epi32(h[3], d);
+			h[4] = _mm256_add_epi32(h[4], e);
+			h[5] = _mm256_add_epi32(h[5], f);
+			h[6] = _mm256_add_epi32(h[6], g);
+			h[7] = _mm256_add_epi32(h[7], hh);
+			for (i = 0; i < _CRYPTO_HASH_LANES; i++) {
+				data[i] += 64;
+			}
+			nBlocks--;
+		}
+		for (i = 0; i < 8; i++) {
+			_mm256_storeu_si256((__m256i*)(state + (i << 3)), h[i]);
+		}
+	}
+
+#define _MD5_AVX2_F(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define _MD5_AVX2_G(x, y, z) _mm256_or_si256(_mm256_and_si256(z, x), _mm256_andnot_si256(z, y))
+#define _MD5_AVX2_H(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define _MD5_AVX2_I(x, y, z) _mm256_xor_si256(y, _mm256_or_si256(x, _mm256_xor_si256(z, ones)))
+#define _MD5_AVX2_STEP(FUNC, a, b, c, d, g, k, s) \
+	a = _mm256_add_epi32(b, _CRYPTO_HASH_ROTL(_mm256_add_epi32(_mm256_add_epi32(a, FUNC(b, c, d)), _mm256_add_epi32(_mm256_set1_epi32((int)(k)), M[g])), s));
+
+	static void _MD5_AVX2_blocks_x8(sl_uint32* state, const sl_uint8* const* _data, sl_size nBlocks)
+	{
+		const __m256i ones = _mm256_set1_epi32(-1);
+		const sl_uint8* data[_CRYPTO_HASH_LANES];
+		sl_uint32 i;
+		for (i = 0; i < _CRYPTO_HASH_LANES; i++) {
+			data[i] = _data[i];
+		}
+		__m256i a = _mm256_loadu_si256((const __m256i*)state);
+		__m256i b = _mm256_loadu_si256((const __m256i*)(state + 8));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(state + 16));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(state + 24));
+		__m256i M[16];
+		while (nBlocks) {
+			_CryptoHash_AVX2_loadWords(M, data, 0);
+			_CryptoHash_AVX2_loadWords(M + 8, data, 32);
+			__m256i aa = a, bb = b, cc = c, dd = d;
+
+			_MD5_AVX2_STEP(_MD5_AVX2_F, a, b, c, d, 0, 0xd76aa478, 7)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, d, a, b, c, 1, 0xe8c7b756, 12)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, c, d, a, b, 2, 0x242070db, 17)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, b, c, d, a, 3, 0xc1bdceee, 22)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, a, b, c, d, 4, 0xf57c0faf, 7)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, d, a, b, c, 5, 0x4787c62a, 12)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, c, d, a, b, 6, 0xa8304613, 17)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, b, c, d, a, 7, 0xfd469501, 22)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, a, b, c, d, 8, 0x698098d8, 7)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, d, a, b, c, 9, 0x8b44f7af, 12)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, c, d, a, b, 10, 0xffff5bb1, 17)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, b, c, d, a, 11, 0x895cd7be, 22)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, a, b, c, d, 12, 0x6b901122, 7)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, d, a, b, c, 13, 0xfd987193, 12)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, c, d, a, b, 14, 0xa679438e, 17)
+			_MD5_AVX2_STEP(_MD5_AVX2_F, b, c, d, a, 15, 0x49b40821, 22)
+
+			_MD5_AVX2_STEP(_MD5_AVX2_G, a, b, c, d, 1, 0xf61e2562, 5)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, d, a, b, c, 6, 0xc040b340, 9)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, c, d, a, b, 11, 0x265e5a51, 14)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, b, c, d, a, 0, 0xe9b6c7aa, 20)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, a, b, c, d, 5, 0xd62f105d, 5)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, d, a, b, c, 10, 0x02441453, 9)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, c, d, a, b, 15, 0xd8a1e681, 14)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, b, c, d, a, 4, 0xe7d3fbc8, 20)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, a, b, c, d, 9, 0x21e1cde6, 5)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, d, a, b, c, 14, 0xc33707d6, 9)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, c, d, a, b, 3, 0xf4d50d87, 14)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, b, c, d, a, 8, 0x455a14ed, 20)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, a, b, c, d, 13, 0xa9e3e905, 5)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, d, a, b, c, 2, 0xfcefa3f8, 9)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, c, d, a, b, 7, 0x676f02d9, 14)
+			_MD5_AVX2_STEP(_MD5_AVX2_G, b, c, d, a, 12, 0x8d2a4c8a, 20)
+
+			_MD5_AVX2_STEP(_MD5_AVX2_H, a, b, c, d, 5, 0xfffa3942, 4)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, d, a, b, c, 8, 0x8771f681, 11)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, c, d, a, b, 11, 0x6d9d6122, 16)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, b, c, d, a, 14, 0xfde5380c, 23)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, a, b, c, d, 1, 0xa4beea44, 4)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, d, a, b, c, 4, 0x4bdecfa9, 11)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, c, d, a, b, 7, 0xf6bb4b60, 16)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, b, c, d, a, 10, 0xbebfbc70, 23)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, a, b, c, d, 13, 0x289b7ec6, 4)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, d, a, b, c, 0, 0xeaa127fa, 11)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, c, d, a, b, 3, 0xd4ef3085, 16)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, b, c, d, a, 6, 0x04881d05, 23)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, a, b, c, d, 9, 0xd9d4d039, 4)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, d, a, b, c, 12, 0xe6db99e5, 11)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, c, d, a, b, 15, 0x1fa27cf8, 16)
+			_MD5_AVX2_STEP(_MD5_AVX2_H, b, c, d, a, 2, 0xc4ac5665, 23)
+
+			_MD5_AVX2_STEP(_MD5_AVX2_I, a, b, c, d, 0, 0xf4292244, 6)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, d, a, b, c, 7, 0x432aff97, 10)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, c, d, a, b, 14, 0xab9423a7, 15)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, b, c, d, a, 5, 0xfc93a039, 21)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, a, b, c, d, 12, 0x655b59c3, 6)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, d, a, b, c, 3, 0x8f0ccc92, 10)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, c, d, a, b, 10, 0xffeff47d, 15)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, b, c, d, a, 1, 0x85845dd1, 21)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, a, b, c, d, 8, 0x6fa87e4f, 6)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, d, a, b, c, 15, 0xfe2ce6e0, 10)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, c, d, a, b, 6, 0xa3014314, 15)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, b, c, d, a, 13, 0x4e0811a1, 21)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, a, b, c, d, 4, 0xf7537e82, 6)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, d, a, b, c, 11, 0xbd3af235, 10)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, c, d, a, b, 2, 0x2ad7d2bb, 15)
+			_MD5_AVX2_STEP(_MD5_AVX2_I, b, c, d, a, 9, 0xeb86d391, 21)
+
+			a = _mm256_add_epi32(a, aa);
+			b = _mm256_add_epi32(b, bb);
+			c = _mm256_add_epi32(c, cc);
+			d = _mm256_add_epi32(d, dd);
+			for (i = 0; i < _CRYPTO_HASH_LANES; i++) {
+				data[i] += 64;
+			}
+			nBlocks--;
+		}
+		_mm256_storeu_si256((__m256i*)state, a);
+		_mm256_storeu_si256((__m256i*)(state + 8), b);
+		_mm256_storeu_si256((__m256i*)(state + 16), c);
+		_mm256_storeu_si256((__m256i*)(state + 24), d);
+	}
+
+#	if defined(__clang__)
+#		pragma clang attribute pop
+#	elif defined(__GNUC__)
+#		pragma GCC pop_options
+#	endif
+
+	static void _CryptoHash_getCPUFeatures(sl_bool& flagSHA, sl_bool& flagAVX2)
+	{
+		flagSHA = sl_false;
+		flagAVX2 = sl_false;
+#	if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return;
+		}
+		__cpuid(info, 1);
+		unsigned int ecx1 = (unsigned int)(info[2]);
+		sl_bool flagYMM = (ecx1 & 0x18000000) == 0x18000000 && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		unsigned int ebx7 = (unsigned int)(info[1]);
+#	else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+			return;
+		}
+		unsigned int ecx1 = ecx;
+		sl_bool flagYMM = sl_false;
+		if ((ecx1 & 0x18000000) == 0x18000000) {
+			// XGETBV: YMM state enabled by the OS
+			unsigned int xcr0, xcr0High;
+			__asm__ volatile ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+			flagYMM = (xcr0 & 6) == 6;
+		}
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+			return;
+		}
+		unsigned int ebx7 = ebx;
+#	endif
+		// ECX of leaf 1: SSSE3(9), SSE4.1(19); EBX of leaf 7: SHA(29), AVX2(5)
+		flagSHA = (ecx1 & ((1 << 9) | (1 << 19))) == ((1 << 9) | (1 << 19)) && (ebx7 & (1 << 29)) != 0;
+		flagAVX2 = flagYMM && (ebx7 & (1 << 5)) != 0;
+	}
+
+	static const _CryptoHash_SIMD_Kernels* _CryptoHash_createSIMDKernels()
+	{
+		sl_bool flagSHA, flagAVX2;
+		_CryptoHash_getCPUFeatures(flagSHA, flagAVX2);
+		if (!flagSHA && !flagAVX2) {
+			return sl_null;
+		}
+		static _CryptoHash_SIMD_Kernels kernels;
+		kernels.sha1Blocks = flagSHA ? &_SHA1_NI_blocks : sl_null;
+		kernels.sha256Blocks = flagSHA ? &_SHA256_NI_blocks : sl_null;
+		kernels.sha256Blocks_x8 = flagAVX2 ? &_SHA256_AVX2_blocks_x8 : sl_null;
+		kernels.md5Blocks_x8 = flagAVX2 ? &_MD5_AVX2_blocks_x8 : sl_null;
+		return &kernels;
+	}
+
+	const _CryptoHash_SIMD_Kernels* _CryptoHash_getSIMDKernels()
+	{
+		static const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_createSIMDKernels();
+		return kernels;
+	}
+
+#else
+
+	const _CryptoHash_SIMD_Kernels* _CryptoHash_getSIMDKernels()
+	{
+		return sl_null;
+	}
+
+#endif
+
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_CRYPTO_HASH_SIMD
+#define CHECKHEADER_SLIB_CRYPTO_HASH_SIMD
+
+#include "slib/core/definition.h"
+
+namespace slib
+{
+
+	// state: `nWords` words of each lane, laid out word by word (state[word * 8 + lane]); data[lane] points `nBlocks` blocks of 64 bytes
+	typedef void (*_CryptoHash_MultiBufferKernel)(sl_uint32* state, const sl_uint8* const* data, sl_size nBlocks);
+
+	/*
+		Hardware kernels for the hash functions.
+
+		Single-buffer kernels use the SHA extensions (SHA-NI) and update `h` in place over `nBlocks` blocks of 64 bytes.
+		Multi-buffer kernels hash 8 independent messages in the lanes of AVX2 registers.
+		A member is null when the running CPU does not support its instructions.
+	*/
+	class _CryptoHash_SIMD_Kernels
+	{
+	public:
+		void (*sha1Blocks)(sl_uint32* h, const sl_uint8* data, sl_size nBlocks);
+
+		void (*sha256Blocks)(sl_uint32* h, const sl_uint8* data, sl_size nBlocks);
+
+		_CryptoHash_MultiBufferKernel sha256Blocks_x8;
+
+		_CryptoHash_MultiBufferKernel md5Blocks_x8;
+
+	};
+
+	// returns sl_null when the running CPU supports none of the kernels
+	const _CryptoHash_SIMD_Kernels* _CryptoHash_getSIMDKernels();
+
+	/*
+		Hashes `count` messages of a Merkle-Damgard hash with 64-byte blocks, scheduling them on the 8 lanes of `kernel`.
+		`outputs` receives `nWords` words per message, big-endian (SHA) or little-endian (MD5).
+	*/
+	void _CryptoHash_hashMultiBuffer(_CryptoHash_MultiBufferKernel kernel, const sl_uint32* iv, sl_uint32 nWords, sl_bool flagBigEndian, const void* const* inputs, const sl_size* sizes, sl_size count, void* outputs);
+
+	// same as above, hashing the messages one after another on a single-buffer kernel
+	void _CryptoHash_hashSequential(void (*kernel)(sl_uint32* h, const sl_uint8* data, sl_size nBlocks), const sl_uint32* iv, sl_uint32 nWords, sl_bool flagBigEndian, const void* const* inputs, const sl_size* sizes, sl_size count, void* outputs);
+
+}
+
+#endif
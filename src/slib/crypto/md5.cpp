@@ -14,6 +14,8 @@
 #include "slib/core/io.h"
 #include "slib/core/math.h"
 
+#include "hash_simd.h"
+
 namespace slib
 {
 
@@ -100,6 +102,21 @@ namespace slib
 		MIO::writeUint32LE(output + 12, A[3]);
 	}
 
+	void MD5::hashBatch(const void* const* inputs, const sl_size* sizes, sl_size count, void* _outputs)
+	{
+		const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_getSIMDKernels();
+		if (kernels && kernels->md5Blocks_x8 && count > 1) {
+			static const sl_uint32 iv[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+			_CryptoHash_hashMultiBuffer(kernels->md5Blocks_x8, iv, 4, sl_false, inputs, sizes, count, _outputs);
+			return;
+		}
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		for (sl_size i = 0; i < count; i++) {
+			hash(inputs[i], sizes[i], outputs);
+			outputs += 16;
+		}
+	}
+
 	void MD5::_updateSection(const sl_uint8* input)
 	{
 		static sl_uint32 K[64] = {
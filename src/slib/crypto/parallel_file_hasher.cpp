@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/crypto/parallel_file_hasher.h"
+
+#include "slib/crypto/sha2.h"
+#include "slib/core/file.h"
+#include "slib/core/event.h"
+#include "slib/core/system.h"
+#include "slib/core/math.h"
+#include "slib/core/safe_static.h"
+
+#define _PARALLEL_FILE_HASHER_DEFAULT_CHUNK_SIZE 0x100000
+
+namespace slib
+{
+
+	SLIB_SAFE_STATIC_GETTER(Ref<ThreadPool>, _ParallelFileHasher_getThreadPool, ThreadPool::create(0, System::getProcessorsCount()))
+
+	/*
+		Chunks are claimed by the calling thread and the workers of the pool.
+		Every worker of a file opens its own handle, and the caller returns after all the workers are finished.
+	*/
+	class _ParallelFileHasher_Job : public Referable
+	{
+	public:
+		String path;
+		const sl_uint8* data;
+		sl_uint64 size;
+		sl_size chunkSize;
+		sl_reg nChunks;
+		sl_uint8* leaves;
+		sl_reg indexNext;
+		sl_int32 nWorkers;
+		sl_int32 nDone;
+		sl_bool flagError;
+		Ref<Event> eventDone;
+
+	public:
+		void run()
+		{
+			_run();
+			if (Base::interlockedIncrement32(&nDone) == nWorkers) {
+				if (eventDone.isNotNull()) {
+					eventDone->set();
+				}
+			}
+		}
+
+		void _run()
+		{
+			Ref<File> file;
+			Memory buf;
+			if (!data) {
+				file = File::openForRead(path);
+				if (file.isNull()) {
+					flagError = sl_true;
+					return;
+				}
+				buf = Memory::create(chunkSize);
+				if (buf.isNull()) {
+					flagError = sl_true;
+					return;
+				}
+			}
+			for (;;) {
+				sl_reg index = Base::interlockedIncrement(&indexNext) - 1;
+				if (index >= nChunks || flagError) {
+					return;
+				}
+				sl_uint64 offset = (sl_uint64)index * chunkSize;
+				sl_size n = (sl_size)(Math::min(size - offset, (sl_uint64)chunkSize));
+				const sl_uint8* chunk;
+				if (data) {
+					chunk = data + (sl_size)offset;
+				} else {
+					if (!(file->seek(offset, SeekPosition::Begin))) {
+						flagError = sl_true;
+						return;
+					}
+					if (file->readFully(buf.getData(), n) != (sl_reg)n) {
+						flagError = sl_true;
+						return;
+					}
+					chunk = (const sl_uint8*)(buf.getData());
+				}
+				sl_uint8 prefix = 0;
+				SHA256 hash;
+				hash.start();
+				hash.update(&prefix, 1);
+				hash.update(chunk, n);
+				hash.finish(leaves + (index << 5));
+			}
+		}
+
+	};
+
+	static sl_bool _ParallelFileHasher_run(const String& path, const void* data, sl_uint64 size, void* output, sl_size chunkSize, const Ref<ThreadPool>& _pool)
+	{
+		if (!chunkSize) {
+			chunkSize = _PARALLEL_FILE_HASHER_DEFAULT_CHUNK_SIZE;
+		}
+		sl_uint64 nChunks = (size + chunkSize - 1) / chunkSize;
+		if (nChunks > (sl_uint64)(SLIB_SIZE_MAX >> 6)) {
+			return sl_false;
+		}
+		Memory leaves = Memory::create((sl_size)nChunks << 5);
+		if (nChunks && leaves.isNull()) {
+			return sl_false;
+		}
+		Ref<_ParallelFileHasher_Job> job = new _ParallelFileHasher_Job;
+		if (job.isNull()) {
+			return sl_false;
+		}
+		job->path = path;
+		job->data = (const sl_uint8*)data;
+		job->size = size;
+		job->chunkSize = chunkSize;
+		job->nChunks = (sl_reg)nChunks;
+		job->leaves = (sl_uint8*)(leaves.getData());
+		job->indexNext = 0;
+		job->nDone = 0;
+		job->flagError = sl_false;
+
+		sl_uint32 nHelpers = 0;
+		Ref<ThreadPool> pool = _pool;
+		if (nChunks > 1 && System::getProcessorsCount() > 1) {
+			if (pool.isNull()) {
+				Ref<ThreadPool>* p = _ParallelFileHasher_getThreadPool();
+				if (p) {
+					pool = *p;
+				}
+			}
+			if (pool.isNotNull()) {
+				nHelpers = System::getProcessorsCount() - 1;
+				if (nHelpers > nChunks - 1) {
+					nHelpers = (sl_uint32)(nChunks - 1);
+				}
+				job->eventDone = Event::create();
+				if (job->eventDone.isNull()) {
+					nHelpers = 0;
+				}
+			}
+		}
+		job->nWorkers = (sl_int32)nHelpers + 1;
+		for (sl_uint32 i = 0; i < nHelpers; i++) {
+			if (!(pool->addTask([job]() {
+				job->run();
+			}))) {
+				// count the helper which could not be started as finished
+				Base::interlockedIncrement32(&(job->nDone));
+			}
+		}
+		job->run();
+		if (Base::interlockedAdd32(&(job->nDone), 0) != job->nWorkers) {
+			job->eventDone->wait();
+		}
+		if (job->flagError) {
+			return sl_false;
+		}
+		ParallelFileHasher::combine(leaves.getData(), (sl_size)nChunks, output);
+		return sl_true;
+	}
+
+	sl_uint32 ParallelFileHasher::getHashSize()
+	{
+		return 32;
+	}
+
+	sl_size ParallelFileHasher::getDefaultChunkSize()
+	{
+		return _PARALLEL_FILE_HASHER_DEFAULT_CHUNK_SIZE;
+	}
+
+	sl_bool ParallelFileHasher::hashFile(const String& path, void* output, sl_size chunkSize, const Ref<ThreadPool>& pool)
+	{
+		if (!(File::exists(path))) {
+			return sl_false;
+		}
+		return _ParallelFileHasher_run(path, sl_null, File::getSize(path), output, chunkSize, pool);
+	}
+
+	Memory ParallelFileHasher::hashFile(const String& path, sl_size chunkSize, const Ref<ThreadPool>& pool)
+	{
+		char v[32];
+		if (hashFile(path, v, chunkSize, pool)) {
+			return Memory::create(v, 32);
+		}
+		return sl_null;
+	}
+
+	void ParallelFileHasher::hash(const void* data, sl_size size, void* output, sl_size chunkSize, const Ref<ThreadPool>& pool)
+	{
+		if (!(_ParallelFileHasher_run(sl_null, data, size, output, chunkSize, pool))) {
+			Base::zeroMemory(output, 32);
+		}
+	}
+
+	Memory ParallelFileHasher::hash(const void* data, sl_size size, sl_size chunkSize, const Ref<ThreadPool>& pool)
+	{
+		char v[32];
+		if (_ParallelFileHasher_run(sl_null, data, size, v, chunkSize, pool)) {
+			return Memory::create(v, 32);
+		}
+		return sl_null;
+	}
+
+	void ParallelFileHasher::combine(const void* _leaves, sl_size nLeaves, void* output)
+	{
+		const sl_uint8* leaves = (const sl_uint8*)_leaves;
+		if (!nLeaves) {
+			SHA256::hash(sl_null, 0, output);
+			return;
+		}
+		if (nLeaves == 1) {
+			Base::copyMemory(output, leaves, 32);
+			return;
+		}
+		sl_size k = 1;
+		while ((k << 1) < nLeaves) {
+			k <<= 1;
+		}
+		sl_uint8 node[65];
+		node[0] = 1;
+		combine(leaves, k, node + 1);
+		combine(leaves + (k << 5), nLeaves - k, node + 33);
+		SHA256::hash(node, 65, output);
+	}
+
+}
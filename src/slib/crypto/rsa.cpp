@@ -53,7 +53,7 @@ namespace slib
 		if (T >= key.N) {
 			return sl_false;
 		}
-		T = T.pow_montgomery(key.E, key.N);
+		T = BigInt::pow_montgomery(T, key.E, key.N);
 		if (T.isNotNull()) {
 			if (T.getBytesBE(dst, n)) {
 				return sl_true;
@@ -70,10 +70,10 @@ namespace slib
 			return sl_false;
 		}
 		if (key.flagUseOnlyD) {
-			T = T.pow_montgomery(key.D, key.N);
+			T = BigInt::pow_montgomery(T, key.D, key.N, sl_true);
 		} else {
-			BigInt TP = T.pow_montgomery(key.DP, key.P);
-			BigInt TQ = T.pow_montgomery(key.DQ, key.Q);
+			BigInt TP = BigInt::pow_montgomery(T, key.DP, key.P, sl_true);
+			BigInt TQ = BigInt::pow_montgomery(T, key.DQ, key.Q, sl_true);
 			T = ((TP - TQ) * key.IQ) % key.P;
 			T = TQ + T * key.Q;
 		}
@@ -13,6 +13,8 @@
 #include "slib/core/mio.h"
 #include "slib/core/math.h"
 
+#include "hash_simd.h"
+
 namespace slib
 {
 
@@ -54,7 +56,7 @@ namespace slib
 				return;
 			} else {
 				Base::copyMemory(rdata + rdata_len, input, n);
-				_updateSection(rdata);
+				_updateSections(rdata, 1);
 				rdata_len = 0;
 				sizeInput -= n;
 				input += n;
@@ -63,10 +65,11 @@ namespace slib
 				}
 			}
 		}
-		while (sizeInput >= 64) {
-			_updateSection(input);
-			sizeInput -= 64;
-			input += 64;
+		sl_size nSections = sizeInput >> 6;
+		if (nSections) {
+			_updateSections(input, nSections);
+			sizeInput &= 63;
+			input += (nSections << 6);
 		}
 		if (sizeInput) {
 			Base::copyMemory(rdata, input, sizeInput);
@@ -83,13 +86,13 @@ namespace slib
 		if (rdata_len < 56) {
 			Base::zeroMemory(rdata + rdata_len + 1, 55 - rdata_len);
 			MIO::writeUint64BE(rdata + 56, sizeTotalInput << 3);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 		} else {
 			Base::zeroMemory(rdata + rdata_len + 1, 63 - rdata_len);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 			Base::zeroMemory(rdata, 56);
 			MIO::writeUint64BE(rdata + 56, sizeTotalInput << 3);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 		}
 		rdata_len = 0;
 
@@ -100,6 +103,34 @@ namespace slib
 		}
 	}
 
+	void SHA1::hashBatch(const void* const* inputs, const sl_size* sizes, sl_size count, void* _outputs)
+	{
+		const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_getSIMDKernels();
+		if (kernels && kernels->sha1Blocks) {
+			static const sl_uint32 iv[5] = { 0x67452301ul, 0xEFCDAB89ul, 0x98BADCFEul, 0x10325476ul, 0xC3D2E1F0ul };
+			_CryptoHash_hashSequential(kernels->sha1Blocks, iv, 5, sl_true, inputs, sizes, count, _outputs);
+			return;
+		}
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		for (sl_size i = 0; i < count; i++) {
+			hash(inputs[i], sizes[i], outputs);
+			outputs += 20;
+		}
+	}
+
+	void SHA1::_updateSections(const sl_uint8* input, sl_size nSections)
+	{
+		const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_getSIMDKernels();
+		if (kernels && kernels->sha1Blocks) {
+			kernels->sha1Blocks(h, input, nSections);
+			return;
+		}
+		for (sl_size i = 0; i < nSections; i++) {
+			_updateSection(input);
+			input += 64;
+		}
+	}
+
 	void SHA1::_updateSection(const sl_uint8* input)
 	{
 		static sl_uint32 K[4] = {
@@ -12,6 +12,8 @@
 #include "slib/core/mio.h"
 #include "slib/core/math.h"
 
+#include "hash_simd.h"
+
 namespace slib
 {
 
@@ -48,7 +50,7 @@ namespace slib
 				return;
 			} else {
 				Base::copyMemory(rdata + rdata_len, input, n);
-				_updateSection(rdata);
+				_updateSections(rdata, 1);
 				rdata_len = 0;
 				sizeInput -= n;
 				input += n;
@@ -57,10 +59,11 @@ namespace slib
 				}
 			}
 		}
-		while (sizeInput >= 64) {
-			_updateSection(input);
-			sizeInput -= 64;
-			input += 64;
+		sl_size nSections = sizeInput >> 6;
+		if (nSections) {
+			_updateSections(input, nSections);
+			sizeInput &= 63;
+			input += (nSections << 6);
 		}
 		if (sizeInput) {
 			Base::copyMemory(rdata, input, sizeInput);
@@ -77,17 +80,30 @@ namespace slib
 		if (rdata_len < 56) {
 			Base::zeroMemory(rdata + rdata_len + 1, 55 - rdata_len);
 			MIO::writeUint64BE(rdata + 56, sizeTotalInput << 3);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 		} else {
 			Base::zeroMemory(rdata + rdata_len + 1, 63 - rdata_len);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 			Base::zeroMemory(rdata, 56);
 			MIO::writeUint64BE(rdata + 56, sizeTotalInput << 3);
-			_updateSection(rdata);
+			_updateSections(rdata, 1);
 		}
 		rdata_len = 0;
 	}
 
+	void _SHA256Base::_updateSections(const sl_uint8* input, sl_size nSections)
+	{
+		const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_getSIMDKernels();
+		if (kernels && kernels->sha256Blocks) {
+			kernels->sha256Blocks(h, input, nSections);
+			return;
+		}
+		for (sl_size i = 0; i < nSections; i++) {
+			_updateSection(input);
+			input += 64;
+		}
+	}
+
 	void _SHA256Base::_updateSection(const sl_uint8* input)
 	{
 		static sl_uint32 K[64] = {
@@ -208,6 +224,28 @@ namespace slib
 		}
 	}
 
+	void SHA256::hashBatch(const void* const* inputs, const sl_size* sizes, sl_size count, void* _outputs)
+	{
+		static const sl_uint32 iv[8] = { 0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul };
+		const _CryptoHash_SIMD_Kernels* kernels = _CryptoHash_getSIMDKernels();
+		if (kernels) {
+			// SHA-NI outruns 8 lanes of AVX2, which serve the CPUs without it
+			if (kernels->sha256Blocks) {
+				_CryptoHash_hashSequential(kernels->sha256Blocks, iv, 8, sl_true, inputs, sizes, count, _outputs);
+				return;
+			}
+			if (kernels->sha256Blocks_x8 && count > 1) {
+				_CryptoHash_hashMultiBuffer(kernels->sha256Blocks_x8, iv, 8, sl_true, inputs, sizes, count, _outputs);
+				return;
+			}
+		}
+		sl_uint8* outputs = (sl_uint8*)_outputs;
+		for (sl_size i = 0; i < count; i++) {
+			hash(inputs[i], sizes[i], outputs);
+			outputs += 32;
+		}
+	}
+
 
 	_SHA512Base::_SHA512Base()
 	{
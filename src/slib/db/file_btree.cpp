@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/db/file_btree.h"
+
+namespace slib
+{
+
+	sl_uint32 FileBTreeSerializer<String>::getSize(sl_uint32 maxLength)
+	{
+		return 4 + maxLength;
+	}
+
+	sl_bool FileBTreeSerializer<String>::canWrite(const String& value, sl_uint32 maxLength)
+	{
+		return value.getLength() <= maxLength;
+	}
+
+	void FileBTreeSerializer<String>::write(sl_uint8* buf, const String& value, sl_uint32 maxLength)
+	{
+		sl_uint32 len = (sl_uint32)(value.getLength());
+		if (len > maxLength) {
+			// unreachable: `FileBTree::canStoreItem()` and the node hooks reject the longer values before they reach the pages
+			Base::zeroMemory(buf, 4 + maxLength);
+			return;
+		}
+		MIO::writeUint32LE(buf, len);
+		Base::copyMemory(buf + 4, value.getData(), len);
+		Base::zeroMemory(buf + 4 + len, maxLength - len);
+	}
+
+	void FileBTreeSerializer<String>::read(const sl_uint8* buf, String& value, sl_uint32 maxLength)
+	{
+		sl_uint32 len = MIO::readUint32LE(buf);
+		if (len > maxLength) {
+			len = maxLength;
+		}
+		value = String((const char*)(buf + 4), len);
+	}
+
+
+	sl_uint64 _FileBTreeLog::updateChecksum(sl_uint64 checksum, const void* data, sl_size size)
+	{
+		const sl_uint8* p = (const sl_uint8*)data;
+		for (sl_size i = 0; i < size; i++) {
+			checksum ^= p[i];
+			checksum *= SLIB_UINT64(0x100000001b3);
+		}
+		return checksum;
+	}
+
+
+	FileBTreeParam::FileBTreeParam()
+	{
+		maxKeyLength = 64;
+		maxValueLength = 64;
+		cacheSize = SLIB_FILE_BTREE_DEFAULT_CACHE_SIZE;
+	}
+
+	FileBTreeParam::FileBTreeParam(const String& _path) : path(_path)
+	{
+		maxKeyLength = 64;
+		maxValueLength = 64;
+		cacheSize = SLIB_FILE_BTREE_DEFAULT_CACHE_SIZE;
+	}
+
+	FileBTreeParam::~FileBTreeParam()
+	{
+	}
+
+}
@@ -11,6 +11,9 @@
 #include "slib/graphics/bitmap_data.h"
 
 #include "slib/graphics/yuv.h"
+#include "slib/core/base.h"
+
+#include "bitmap_data_simd.h"
 
 namespace slib
 {
@@ -784,8 +787,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = r >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (b >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (b >> 3);
 			p[0] = (sl_uint8)(s >> 8);
 			p[1] = (sl_uint8)(s);
 			p0 += 2;
@@ -811,8 +814,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = r >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (b >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (b >> 3);
 			p[1] = (sl_uint8)(s >> 8);
 			p[0] = (sl_uint8)(s);
 			p0 += 2;
@@ -838,8 +841,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = b >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (r >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (r >> 3);
 			p[0] = (sl_uint8)(s >> 8);
 			p[1] = (sl_uint8)(s);
 			p0 += 2;
@@ -865,8 +868,8 @@ namespace slib
 		{
 			sl_uint8* p = p0;
 			sl_uint32 s = b >> 3;
-			s = (s << 5) | (g >> 2);
-			s = (s << 6) | (r >> 3);
+			s = (s << 6) | (g >> 2);
+			s = (s << 5) | (r >> 3);
 			p[1] = (sl_uint8)(s >> 8);
 			p[0] = (sl_uint8)(s);
 			p0 += 2;
@@ -1143,6 +1146,46 @@ namespace slib
 		}
 	};
 
+	static sl_uint32 _BitmapData_getRGB32Layout(BitmapFormat format)
+	{
+		switch (format) {
+			case BitmapFormat::RGBA:
+			case BitmapFormat::RGBA_PA:
+				return _BITMAP_DATA_LAYOUT_RGBA;
+			case BitmapFormat::BGRA:
+			case BitmapFormat::BGRA_PA:
+				return _BITMAP_DATA_LAYOUT_BGRA;
+			case BitmapFormat::ARGB:
+			case BitmapFormat::ARGB_PA:
+				return _BITMAP_DATA_LAYOUT_ARGB;
+			case BitmapFormat::ABGR:
+			case BitmapFormat::ABGR_PA:
+				return _BITMAP_DATA_LAYOUT_ABGR;
+			default:
+				break;
+		}
+		return 0;
+	}
+
+	// converts the leading pixels of a Y row with the vector kernels, returns the count of the converted pixels
+	static sl_uint32 _BitmapData_copyPixels_YUV420ToOther_Row(const _BitmapData_RowKernels* kernels, BitmapFormat format, const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 width)
+	{
+		switch (format) {
+			case BitmapFormat::RGB565LE:
+				return kernels->convertYUV420ToRGB565(y, u, v, strideUV, (sl_uint16*)dst, sl_false, width);
+			case BitmapFormat::BGR565LE:
+				return kernels->convertYUV420ToRGB565(y, u, v, strideUV, (sl_uint16*)dst, sl_true, width);
+			default:
+				break;
+		}
+		// opaque pixels are not changed by premultiplying
+		sl_uint32 layout = _BitmapData_getRGB32Layout(format);
+		if (layout) {
+			return kernels->convertYUV420ToRGB32(y, u, v, strideUV, dst, layout, width);
+		}
+		return 0;
+	}
+
 	template<class SourceProc, class TargetProc>
 	void _BitmapData_copyPixels_Normal_Step2(sl_uint32 width, sl_uint32 height, sl_uint8** src_planes, sl_int32* src_pitches, sl_uint8** dst_planes, sl_int32* dst_pitches)
 	{
@@ -1419,7 +1462,7 @@ namespace slib
 	}
 
 	template<class TargetProc>
-	void _BitmapData_copyPixels_YUV420ToOther_Step1(sl_uint32 width, sl_uint32 height, BitmapData& src, sl_uint8** dst_planes, sl_int32* dst_pitches)
+	void _BitmapData_copyPixels_YUV420ToOther_Step1(sl_uint32 width, sl_uint32 height, BitmapData& src, BitmapFormat dst_format, sl_uint8** dst_planes, sl_int32* dst_pitches)
 	{
 		ColorComponentBuffer src_cb[3];
 		if (src.getColorComponentBuffers(src_cb) != 3) {
@@ -1435,6 +1478,8 @@ namespace slib
 		sl_uint8* dr2 = (sl_uint8*)(dst_planes[2]);
 		sl_uint8* dr3 = (sl_uint8*)(dst_planes[3]);
 		sl_int32 strideUV = src_cb[1].sample_stride;
+		const _BitmapData_RowKernels* kernels = _BitmapData_getRowKernels();
+		sl_uint32 bytesPerSample = BitmapFormats::getBitsPerSample(dst_format) >> 3;
 		sl_uint8 r, g, b;
 		for (sl_uint32 i = 0; i < H2; i++) {
 			sl_uint8* ssy_u = sry;
@@ -1449,7 +1494,21 @@ namespace slib
 			sl_uint8* ds1_d = dr1 + dst_pitches[1];
 			sl_uint8* ds2_d = dr2 + dst_pitches[2];
 			sl_uint8* ds3_d = dr3 + dst_pitches[3];
-			for (sl_uint32 j = 0; j < W2; j++) {
+			sl_uint32 j = 0;
+			if (kernels) {
+				sl_uint32 n = _BitmapData_copyPixels_YUV420ToOther_Row(kernels, dst_format, ssy_u, ssu, ssv, strideUV, ds0_u, W2 << 1);
+				if (n) {
+					_BitmapData_copyPixels_YUV420ToOther_Row(kernels, dst_format, ssy_d, ssu, ssv, strideUV, ds0_d, n);
+					ssy_u += n;
+					ssy_d += n;
+					ds0_u += n * bytesPerSample;
+					ds0_d += n * bytesPerSample;
+					j = n >> 1;
+					ssu += j * strideUV;
+					ssv += j * strideUV;
+				}
+			}
+			for (; j < W2; j++) {
 				YUV::convertYUVToRGB(*ssy_u, *ssu, *ssv, r, g, b);
 				TargetProc::writeSample(ds0_u, ds1_u, ds2_u, ds3_u, r, g, b, 255);
 				ssy_u++;
@@ -1479,58 +1538,58 @@ namespace slib
 	{
 		switch (dst_format) {
 			case BitmapFormat::RGBA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGBA_PA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::BGRA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<BGRA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<BGRA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::BGRA_PA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<BGRA_PA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<BGRA_PA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::ARGB:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<ARGB_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<ARGB_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::ARGB_PA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<ARGB_PA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<ARGB_PA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::ABGR:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<ABGR_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<ABGR_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::ABGR_PA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<ABGR_PA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<ABGR_PA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGB:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::BGR:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGB565BE:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB565BE_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB565BE_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGB565LE:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB565LE_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB565LE_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::BGR565BE:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR565BE_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR565BE_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::BGR565LE:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR565LE_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<BGR565LE_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::GRAY8:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<GRAY8_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<GRAY8_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGBA_PLANAR:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PLANAR_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PLANAR_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGBA_PLANAR_PA:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PLANAR_PA_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGBA_PLANAR_PA_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			case BitmapFormat::RGB_PLANAR:
-				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB_PLANAR_PROC>(width, height, src, dst_planes, dst_pitches);
+				_BitmapData_copyPixels_YUV420ToOther_Step1<RGB_PLANAR_PROC>(width, height, src, dst_format, dst_planes, dst_pitches);
 				break;
 			default:
 				break;
@@ -1629,7 +1688,7 @@ namespace slib
 	}
 
 	template<class SourceProc>
-	void _BitmapData_copyPixels_OtherToYUV420_Step1(sl_uint32 width, sl_uint32 height, sl_uint8** src_planes, sl_int32* src_pitches, BitmapData& dst)
+	void _BitmapData_copyPixels_OtherToYUV420_Step1(sl_uint32 width, sl_uint32 height, BitmapFormat src_format, sl_uint8** src_planes, sl_int32* src_pitches, BitmapData& dst)
 	{
 		ColorComponentBuffer dst_cb[3];
 		if (dst.getColorComponentBuffers(dst_cb) != 3) {
@@ -1645,6 +1704,14 @@ namespace slib
 		sl_uint8* dru = (sl_uint8*)(dst_cb[1].data);
 		sl_uint8* drv = (sl_uint8*)(dst_cb[2].data);
 		sl_int32 strideUV = dst_cb[1].sample_stride;
+		const _BitmapData_RowKernels* kernels = sl_null;
+		sl_uint32 layout = 0;
+		if (!(BitmapFormats::isPrecomputedAlpha(src_format))) {
+			layout = _BitmapData_getRGB32Layout(src_format);
+			if (layout) {
+				kernels = _BitmapData_getRowKernels();
+			}
+		}
 		sl_uint8 R, G, B, A;
 		sl_uint8 U, V;
 		sl_uint32 TU, TV;
@@ -1661,7 +1728,18 @@ namespace slib
 			sl_uint8* dsy_d = dry + dst_cb[0].pitch;
 			sl_uint8* dsu = dru;
 			sl_uint8* dsv = drv;
-			for (sl_uint32 j = 0; j < W2; j++) {
+			sl_uint32 j = 0;
+			if (kernels) {
+				sl_uint32 n = kernels->convertRGB32ToYUV420(ss0_u, ss0_d, layout, dsy_u, dsy_d, dsu, dsv, strideUV, W2 << 1);
+				ss0_u += n << 2;
+				ss0_d += n << 2;
+				dsy_u += n;
+				dsy_d += n;
+				j = n >> 1;
+				dsu += j * strideUV;
+				dsv += j * strideUV;
+			}
+			for (; j < W2; j++) {
 				SourceProc::readSample(ss0_u, ss1_u, ss2_u, ss3_u, R, G, B, A);
 				YUV::convertRGBToYUV(R, G, B, *dsy_u, U, V);
 				dsy_u++;
@@ -1701,58 +1779,58 @@ namespace slib
 	{
 		switch (src_format) {
 			case BitmapFormat::RGBA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGBA_PA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::BGRA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<BGRA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<BGRA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::BGRA_PA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<BGRA_PA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<BGRA_PA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::ARGB:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<ARGB_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<ARGB_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::ARGB_PA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<ARGB_PA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<ARGB_PA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::ABGR:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<ABGR_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<ABGR_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::ABGR_PA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<ABGR_PA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<ABGR_PA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGB:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::BGR:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGB565BE:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB565BE_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB565BE_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGB565LE:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB565LE_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB565LE_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::BGR565BE:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR565BE_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR565BE_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::BGR565LE:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR565LE_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<BGR565LE_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::GRAY8:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<GRAY8_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<GRAY8_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGBA_PLANAR:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PLANAR_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PLANAR_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGBA_PLANAR_PA:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PLANAR_PA_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGBA_PLANAR_PA_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			case BitmapFormat::RGB_PLANAR:
-				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB_PLANAR_PROC>(width, height, src_planes, src_pitches, dst);
+				_BitmapData_copyPixels_OtherToYUV420_Step1<RGB_PLANAR_PROC>(width, height, src_format, src_planes, src_pitches, dst);
 				break;
 			default:
 				break;
@@ -1808,7 +1886,7 @@ namespace slib
 			sl_uint32 n = BitmapFormats::getPlanesCount(src.format);
 			sl_uint32 i = 0;
 			for (; i < n; i++) {
-				if (src_planes[i] != dst_planes[i] || src_pitches[i] == dst_pitches[i]) {
+				if (src_planes[i] != dst_planes[i] || src_pitches[i] != dst_pitches[i]) {
 					break;
 				}
 			}
@@ -1842,6 +1920,31 @@ namespace slib
 					sl_int32 dst_stride = dst_cb[iPlane].sample_stride;
 					sl_uint8* sr = (sl_uint8*)(src_cb[iPlane].data);
 					sl_uint8* dr = (sl_uint8*)(dst_cb[iPlane].data);
+					sl_uint32 row_size = 0;
+					if (src_stride == 1 && dst_stride == 1) {
+						row_size = w;
+					} else if (iPlane == 1 && src_stride == 2 && dst_stride == 2) {
+						// same interleaved chroma order: copies U and V together
+						sl_uint8* src_v = (sl_uint8*)(src_cb[2].data);
+						sl_uint8* dst_v = (sl_uint8*)(dst_cb[2].data);
+						if (src_v == sr + 1 && dst_v == dr + 1) {
+							row_size = w << 1;
+							iPlane++;
+						} else if (sr == src_v + 1 && dr == dst_v + 1) {
+							sr = src_v;
+							dr = dst_v;
+							row_size = w << 1;
+							iPlane++;
+						}
+					}
+					if (row_size) {
+						for (sl_uint32 i = 0; i < h; i++) {
+							Base::copyMemory(dr, sr, row_size);
+							sr += src_cb[iPlane].pitch;
+							dr += dst_cb[iPlane].pitch;
+						}
+						continue;
+					}
 					for (sl_uint32 i = 0; i < h; i++) {
 						sl_uint8* ss = sr;
 						sl_uint8* ds = dr;
@@ -1889,20 +1992,44 @@ namespace slib
 					for (sl_uint32 iPlane = 0; iPlane < nPlanes; iPlane++) {
 						sl_uint8* sr = (sl_uint8*)(src_planes[iPlane]);
 						sl_uint8* dr = (sl_uint8*)(dst_planes[iPlane]);
+						if (src_pitches[iPlane] == (sl_int32)row_size && dst_pitches[iPlane] == (sl_int32)row_size) {
+							Base::copyMemory(dr, sr, (sl_size)row_size * height);
+							continue;
+						}
 						for (sl_uint32 i = 0; i < height; i++) {
-							sl_uint8* ss = sr;
-							sl_uint8* ds = dr;
-							for (sl_uint32 j = 0; j < row_size; j++) {
-								*ds = *ss;
-								ss++;
-								ds++;
-							}
+							Base::copyMemory(dr, sr, row_size);
 							sr += src_pitches[iPlane];
 							dr += dst_pitches[iPlane];
 						}
 					}
 				} else {
-					_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					sl_uint32 src_layout = _BitmapData_getRGB32Layout(src.format);
+					sl_uint32 dst_layout = _BitmapData_getRGB32Layout(dst.format);
+					const _BitmapData_RowKernels* kernels = (src_layout && dst_layout) ? _BitmapData_getRowKernels() : sl_null;
+					if (kernels) {
+						sl_uint32 alphaMode = _BITMAP_DATA_ALPHA_KEEP;
+						if (BitmapFormats::isPrecomputedAlpha(src.format)) {
+							if (!(BitmapFormats::isPrecomputedAlpha(dst.format))) {
+								alphaMode = _BITMAP_DATA_ALPHA_UNPREMULTIPLY;
+							}
+						} else {
+							if (BitmapFormats::isPrecomputedAlpha(dst.format)) {
+								alphaMode = _BITMAP_DATA_ALPHA_PREMULTIPLY;
+							}
+						}
+						for (sl_uint32 i = 0; i < height; i++) {
+							sl_uint32 n = kernels->convertRGB32(src_planes[0], src_layout, dst_planes[0], dst_layout, alphaMode, width);
+							if (n < width) {
+								sl_uint8* src_rest[4] = { src_planes[0] + (n << 2), src_planes[1], src_planes[2], src_planes[3] };
+								sl_uint8* dst_rest[4] = { dst_planes[0] + (n << 2), dst_planes[1], dst_planes[2], dst_planes[3] };
+								_BitmapData_copyPixels_Normal(width - n, 1, src.format, src_rest, src_pitches, dst.format, dst_rest, dst_pitches);
+							}
+							src_planes[0] += src_pitches[0];
+							dst_planes[0] += dst_pitches[0];
+						}
+					} else {
+						_BitmapData_copyPixels_Normal(width, height, src.format, src_planes, src_pitches, dst.format, dst_planes, dst_pitches);
+					}
 				}
 			}
 		}
@@ -0,0 +1,316 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "bitmap_data_simd.h"
+
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define _BITMAP_DATA_SIMD_USE_SSE2
+#	if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#		define _BITMAP_DATA_SIMD_USE_AVX2
+#	endif
+#endif
+
+#if defined(_BITMAP_DATA_SIMD_USE_SSE2)
+#	include <emmintrin.h>
+#endif
+#if defined(_BITMAP_DATA_SIMD_USE_AVX2)
+#	include <immintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#endif
+
+namespace slib
+{
+
+#if defined(_BITMAP_DATA_SIMD_USE_SSE2)
+
+	class _BitmapData_SSE2
+	{
+	public:
+		typedef __m128i V;
+		typedef __m128i Count;
+		enum { N = 16 };
+
+		struct Shuffle
+		{
+			Count shifts[4];
+		};
+
+		static V load(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+		static void store(void* p, V v) { _mm_storeu_si128((__m128i*)p, v); }
+		static V loadExpand(const void* p) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128()); }
+		static void storeHalf(void* p, V v) { _mm_storel_epi64((__m128i*)p, v); }
+
+		static V set16(sl_uint16 n) { return _mm_set1_epi16((short)n); }
+		static V set32(sl_uint32 n) { return _mm_set1_epi32((int)n); }
+		static V setf32(float f) { return _mm_castps_si128(_mm_set1_ps(f)); }
+		static Count count32(sl_uint32 n) { return _mm_cvtsi32_si128((int)n); }
+
+		static V and_(V a, V b) { return _mm_and_si128(a, b); }
+		static V andnot(V a, V b) { return _mm_andnot_si128(a, b); }
+		static V or_(V a, V b) { return _mm_or_si128(a, b); }
+		static V add16(V a, V b) { return _mm_add_epi16(a, b); }
+		static V sub16(V a, V b) { return _mm_sub_epi16(a, b); }
+		static V subs16(V a, V b) { return _mm_subs_epu16(a, b); }
+		static V mulhi16(V a, V b) { return _mm_mulhi_epu16(a, b); }
+		static V mullo16(V a, V b) { return _mm_mullo_epi16(a, b); }
+		static V madd16(V a, V b) { return _mm_madd_epi16(a, b); }
+		static V add32(V a, V b) { return _mm_add_epi32(a, b); }
+		static V slli16(V a, int n) { return _mm_slli_epi16(a, n); }
+		static V srli16(V a, int n) { return _mm_srli_epi16(a, n); }
+		static V slli32(V a, int n) { return _mm_slli_epi32(a, n); }
+		static V srli32(V a, int n) { return _mm_srli_epi32(a, n); }
+		static V srl32(V a, Count n) { return _mm_srl_epi32(a, n); }
+		static V srli64(V a, int n) { return _mm_srli_epi64(a, n); }
+
+		static V cvtf32(V a) { return _mm_castps_si128(_mm_cvtepi32_ps(a)); }
+		static V cvti32(V a) { return _mm_cvttps_epi32(_mm_castsi128_ps(a)); }
+		static V divf32(V a, V b) { return _mm_castps_si128(_mm_div_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+		static V minf32(V a, V b) { return _mm_castps_si128(_mm_min_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+
+		static V packs32(V a, V b) { return _mm_packs_epi32(a, b); }
+		static V packus16(V a, V b) { return _mm_packus_epi16(a, b); }
+
+		static V packEven32(V a, V b)
+		{
+			return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+
+		static void store4(void* p, V c0, V c1, V c2, V c3)
+		{
+			V t0 = _mm_unpacklo_epi8(c0, c1);
+			V t1 = _mm_unpackhi_epi8(c0, c1);
+			V t2 = _mm_unpacklo_epi8(c2, c3);
+			V t3 = _mm_unpackhi_epi8(c2, c3);
+			V* d = (V*)p;
+			_mm_storeu_si128(d, _mm_unpacklo_epi16(t0, t2));
+			_mm_storeu_si128(d + 1, _mm_unpackhi_epi16(t0, t2));
+			_mm_storeu_si128(d + 2, _mm_unpacklo_epi16(t1, t3));
+			_mm_storeu_si128(d + 3, _mm_unpackhi_epi16(t1, t3));
+		}
+
+		static void storeInterleave16(void* p, V even, V odd)
+		{
+			V* d = (V*)p;
+			_mm_storeu_si128(d, _mm_unpacklo_epi16(even, odd));
+			_mm_storeu_si128(d + 1, _mm_unpackhi_epi16(even, odd));
+		}
+
+		static void prepareShuffle(Shuffle& shuffle, const sl_uint8* map)
+		{
+			for (sl_uint32 k = 0; k < 4; k++) {
+				shuffle.shifts[k] = count32(map[k] << 3);
+			}
+		}
+
+		static V shuffle32(V x, const Shuffle& shuffle)
+		{
+			V mask = _mm_set1_epi32(0xFF);
+			V c0 = _mm_and_si128(_mm_srl_epi32(x, shuffle.shifts[0]), mask);
+			V c1 = _mm_and_si128(_mm_srl_epi32(x, shuffle.shifts[1]), mask);
+			V c2 = _mm_and_si128(_mm_srl_epi32(x, shuffle.shifts[2]), mask);
+			V c3 = _mm_and_si128(_mm_srl_epi32(x, shuffle.shifts[3]), mask);
+			return _mm_or_si128(_mm_or_si128(c0, _mm_slli_epi32(c1, 8)), _mm_or_si128(_mm_slli_epi32(c2, 16), _mm_slli_epi32(c3, 24)));
+		}
+
+	};
+
+#	define _BITMAP_DATA_SIMD_OPS _BitmapData_SSE2
+#	define _BITMAP_DATA_SIMD_KERNELS _BitmapData_Kernels_SSE2
+#	include "bitmap_data_simd.inc"
+#	undef _BITMAP_DATA_SIMD_OPS
+#	undef _BITMAP_DATA_SIMD_KERNELS
+
+#endif
+
+#if defined(_BITMAP_DATA_SIMD_USE_AVX2)
+
+#	if defined(__clang__)
+#		pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#	elif defined(__GNUC__)
+#		pragma GCC push_options
+#		pragma GCC target("avx2")
+#	endif
+
+	class _BitmapData_AVX2
+	{
+	public:
+		typedef __m256i V;
+		typedef __m128i Count;
+		enum { N = 32 };
+
+		struct Shuffle
+		{
+			V mask;
+		};
+
+		static V load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+		static void store(void* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+		static V loadExpand(const void* p) { return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p)); }
+		static void storeHalf(void* p, V v) { _mm_storeu_si128((__m128i*)p, _mm256_castsi256_si128(v)); }
+
+		static V set16(sl_uint16 n) { return _mm256_set1_epi16((short)n); }
+		static V set32(sl_uint32 n) { return _mm256_set1_epi32((int)n); }
+		static V setf32(float f) { return _mm256_castps_si256(_mm256_set1_ps(f)); }
+		static Count count32(sl_uint32 n) { return _mm_cvtsi32_si128((int)n); }
+
+		static V and_(V a, V b) { return _mm256_and_si256(a, b); }
+		static V andnot(V a, V b) { return _mm256_andnot_si256(a, b); }
+		static V or_(V a, V b) { return _mm256_or_si256(a, b); }
+		static V add16(V a, V b) { return _mm256_add_epi16(a, b); }
+		static V sub16(V a, V b) { return _mm256_sub_epi16(a, b); }
+		static V subs16(V a, V b) { return _mm256_subs_epu16(a, b); }
+		static V mulhi16(V a, V b) { return _mm256_mulhi_epu16(a, b); }
+		static V mullo16(V a, V b) { return _mm256_mullo_epi16(a, b); }
+		static V madd16(V a, V b) { return _mm256_madd_epi16(a, b); }
+		static V add32(V a, V b) { return _mm256_add_epi32(a, b); }
+		static V slli16(V a, int n) { return _mm256_slli_epi16(a, n); }
+		static V srli16(V a, int n) { return _mm256_srli_epi16(a, n); }
+		static V slli32(V a, int n) { return _mm256_slli_epi32(a, n); }
+		static V srli32(V a, int n) { return _mm256_srli_epi32(a, n); }
+		static V srl32(V a, Count n) { return _mm256_srl_epi32(a, n); }
+		static V srli64(V a, int n) { return _mm256_srli_epi64(a, n); }
+
+		static V cvtf32(V a) { return _mm256_castps_si256(_mm256_cvtepi32_ps(a)); }
+		static V cvti32(V a) { return _mm256_cvttps_epi32(_mm256_castsi256_ps(a)); }
+		static V divf32(V a, V b) { return _mm256_castps_si256(_mm256_div_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); }
+		static V minf32(V a, V b) { return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); }
+
+		// AVX2 packs within 128-bit lanes, so the 64-bit quarters are put back in order
+		static V packs32(V a, V b) { return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8); }
+		static V packus16(V a, V b) { return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8); }
+
+		static V packEven32(V a, V b)
+		{
+			return _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0))), 0xD8);
+		}
+
+		static void store4(void* p, V c0, V c1, V c2, V c3)
+		{
+			V t0 = _mm256_unpacklo_epi8(c0, c1);
+			V t1 = _mm256_unpackhi_epi8(c0, c1);
+			V t2 = _mm256_unpacklo_epi8(c2, c3);
+			V t3 = _mm256_unpackhi_epi8(c2, c3);
+			V x0 = _mm256_unpacklo_epi16(t0, t2);
+			V x1 = _mm256_unpackhi_epi16(t0, t2);
+			V x2 = _mm256_unpacklo_epi16(t1, t3);
+			V x3 = _mm256_unpackhi_epi16(t1, t3);
+			V* d = (V*)p;
+			_mm256_storeu_si256(d, _mm256_permute2x128_si256(x0, x1, 0x20));
+			_mm256_storeu_si256(d + 1, _mm256_permute2x128_si256(x2, x3, 0x20));
+			_mm256_storeu_si256(d + 2, _mm256_permute2x128_si256(x0, x1, 0x31));
+			_mm256_storeu_si256(d + 3, _mm256_permute2x128_si256(x2, x3, 0x31));
+		}
+
+		static void storeInterleave16(void* p, V even, V odd)
+		{
+			V lo = _mm256_unpacklo_epi16(even, odd);
+			V hi = _mm256_unpackhi_epi16(even, odd);
+			V* d = (V*)p;
+			_mm256_storeu_si256(d, _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256(d + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+
+		static void prepareShuffle(Shuffle& shuffle, const sl_uint8* map)
+		{
+			sl_uint32 m = 0;
+			for (sl_uint32 k = 0; k < 4; k++) {
+				m |= (sl_uint32)(map[k]) << (k << 3);
+			}
+			shuffle.mask = _mm256_add_epi8(_mm256_set1_epi32((int)m), _mm256_setr_epi32(0, 0x04040404, 0x08080808, 0x0C0C0C0C, 0, 0x04040404, 0x08080808, 0x0C0C0C0C));
+		}
+
+		static V shuffle32(V x, const Shuffle& shuffle)
+		{
+			return _mm256_shuffle_epi8(x, shuffle.mask);
+		}
+
+	};
+
+#	define _BITMAP_DATA_SIMD_OPS _BitmapData_AVX2
+#	define _BITMAP_DATA_SIMD_KERNELS _BitmapData_Kernels_AVX2
+#	include "bitmap_data_simd.inc"
+#	undef _BITMAP_DATA_SIMD_OPS
+#	undef _BITMAP_DATA_SIMD_KERNELS
+
+#	if defined(__clang__)
+#		pragma clang attribute pop
+#	elif defined(__GNUC__)
+#		pragma GCC pop_options
+#	endif
+
+	static sl_bool _BitmapData_isSupportedAVX2()
+	{
+#	if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return sl_false;
+		}
+		__cpuid(info, 1);
+		// OSXSAVE and AVX
+		if ((info[2] & 0x18000000) != 0x18000000) {
+			return sl_false;
+		}
+		// YMM state enabled by the OS
+		if ((_xgetbv(0) & 6) != 6) {
+			return sl_false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & 0x20) != 0;
+#	else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#	endif
+	}
+
+#endif
+
+#if defined(_BITMAP_DATA_SIMD_USE_SSE2)
+
+	template <class KERNELS>
+	static void _BitmapData_setRowKernels(_BitmapData_RowKernels& kernels)
+	{
+		kernels.convertYUV420ToRGB32 = &(KERNELS::convertYUV420ToRGB32);
+		kernels.convertYUV420ToRGB565 = &(KERNELS::convertYUV420ToRGB565);
+		kernels.convertRGB32ToYUV420 = &(KERNELS::convertRGB32ToYUV420);
+		kernels.convertRGB32 = &(KERNELS::convertRGB32);
+	}
+
+	static _BitmapData_RowKernels _BitmapData_createRowKernels()
+	{
+		_BitmapData_RowKernels kernels;
+#	if defined(_BITMAP_DATA_SIMD_USE_AVX2)
+		if (_BitmapData_isSupportedAVX2()) {
+			_BitmapData_setRowKernels<_BitmapData_Kernels_AVX2>(kernels);
+			return kernels;
+		}
+#	endif
+		_BitmapData_setRowKernels<_BitmapData_Kernels_SSE2>(kernels);
+		return kernels;
+	}
+
+	const _BitmapData_RowKernels* _BitmapData_getRowKernels()
+	{
+		static _BitmapData_RowKernels kernels = _BitmapData_createRowKernels();
+		return &kernels;
+	}
+
+#else
+
+	const _BitmapData_RowKernels* _BitmapData_getRowKernels()
+	{
+		return sl_null;
+	}
+
+#endif
+
+}
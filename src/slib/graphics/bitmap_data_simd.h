@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_GRAPHICS_BITMAP_DATA_SIMD
+#define CHECKHEADER_SLIB_GRAPHICS_BITMAP_DATA_SIMD
+
+#include "slib/core/definition.h"
+
+/*
+	32-bit pixel layouts, described by the byte offsets of R, G, B, A components
+*/
+#define _BITMAP_DATA_LAYOUT(R, G, B, A) ((R) | ((G) << 2) | ((B) << 4) | ((A) << 6))
+#define _BITMAP_DATA_LAYOUT_RGBA _BITMAP_DATA_LAYOUT(0, 1, 2, 3)
+#define _BITMAP_DATA_LAYOUT_BGRA _BITMAP_DATA_LAYOUT(2, 1, 0, 3)
+#define _BITMAP_DATA_LAYOUT_ARGB _BITMAP_DATA_LAYOUT(1, 2, 3, 0)
+#define _BITMAP_DATA_LAYOUT_ABGR _BITMAP_DATA_LAYOUT(3, 2, 1, 0)
+
+#define _BITMAP_DATA_ALPHA_KEEP 0
+#define _BITMAP_DATA_ALPHA_PREMULTIPLY 1
+#define _BITMAP_DATA_ALPHA_UNPREMULTIPLY 2
+
+namespace slib
+{
+
+	/*
+		Vectorized row kernels used by BitmapData::copyPixelsFrom.
+
+		Each kernel converts the leading pixels of a row and returns how many pixels it converted (0 for unsupported arguments).
+		The caller converts the remaining pixels with the per-sample code, and the results are identical to it.
+		`strideUV` is 1 for planar chroma and 2 for interleaved chroma (NV12, NV21).
+	*/
+	class _BitmapData_RowKernels
+	{
+	public:
+		// one row of Y with the shared chroma row, into 32-bit pixels with opaque alpha
+		sl_uint32 (*convertYUV420ToRGB32)(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint8* dst, sl_uint32 layout, sl_uint32 width);
+
+		// one row of Y with the shared chroma row, into native-endian RGB565 (or BGR565) pixels
+		sl_uint32 (*convertYUV420ToRGB565)(const sl_uint8* y, const sl_uint8* u, const sl_uint8* v, sl_uint32 strideUV, sl_uint16* dst, sl_bool flagBGR, sl_uint32 width);
+
+		// two rows of 32-bit pixels into two rows of Y and one row of averaged chroma
+		sl_uint32 (*convertRGB32ToYUV420)(const sl_uint8* src0, const sl_uint8* src1, sl_uint32 layout, sl_uint8* y0, sl_uint8* y1, sl_uint8* u, sl_uint8* v, sl_uint32 strideUV, sl_uint32 width);
+
+		// reorders the components of 32-bit pixels, premultiplying or unpremultiplying the color by alpha on the way
+		sl_uint32 (*convertRGB32)(const sl_uint8* src, sl_uint32 srcLayout, sl_uint8* dst, sl_uint32 dstLayout, sl_uint32 alphaMode, sl_uint32 width);
+
+	};
+
+	// returns sl_null when the running CPU has no supported vector unit
+	const _BitmapData_RowKernels* _BitmapData_getRowKernels();
+
+}
+
+#endif
@@ -11,11 +11,27 @@
 #include "slib/graphics/image.h"
 
 #include "slib/core/file.h"
+#include "slib/core/mapped_file.h"
 #include "slib/core/asset.h"
 #include "slib/core/scoped.h"
+#include "slib/core/thread_pool.h"
+#include "slib/core/event.h"
+#include "slib/core/system.h"
+#include "slib/core/safe_static.h"
 
 #include "image_stb.h"
 
+#if defined(SLIB_ARCH_IS_X64) || (defined(SLIB_ARCH_IS_X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#	define _IMAGE_STRETCH_USE_SSE2
+#	include <emmintrin.h>
+#endif
+
+// minimum count of the source and destination pixels to split the stretching into the threads
+#define _IMAGE_STRETCH_MIN_PARALLEL_WORK 0x40000
+#define _IMAGE_STRETCH_BANDS_PER_THREAD 4
+// fraction bits of the convolution weights
+#define _IMAGE_STRETCH_WEIGHT_BITS 14
+
 namespace slib
 {
 
@@ -331,178 +347,347 @@ namespace slib
 		}
 	}
 
+	class _ImageBlend_Copy
+	{
+	public:
+		// the stretch ops can write the results directly into the destination rows
+		enum { DirectWrite = 1 };
+
+		SLIB_INLINE static void blendRow(Color* dst, const Color* src, sl_uint32 count)
+		{
+			if (dst != src) {
+				Base::copyMemory(dst, src, count << 2);
+			}
+		}
+
+	};
+
+	class _ImageBlend_SrcAlpha
+	{
+	public:
+		enum { DirectWrite = 0 };
+
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+		// blends two pixels expanded to 16-bit components, same as `Color::blend_PA_NPA`
+		SLIB_INLINE static __m128i blend2(__m128i o, __m128i s, __m128i maskAlpha, __m128i c255, __m128i c1)
+		{
+			__m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+			s = _mm_or_si128(_mm_andnot_si128(maskAlpha, s), maskAlpha);
+			__m128i x = _mm_add_epi16(_mm_mullo_epi16(o, _mm_sub_epi16(c255, sa)), _mm_mullo_epi16(s, sa));
+			// x / 255 for 0 <= x <= 255 * 255
+			return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, c1), _mm_srli_epi16(x, 8)), 8);
+		}
+#endif
+
+		static void blendRow(Color* dst, const Color* src, sl_uint32 count)
+		{
+			sl_uint32 i = 0;
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+			__m128i zero = _mm_setzero_si128();
+			__m128i maskAlpha = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+			__m128i c255 = _mm_set1_epi16(255);
+			__m128i c1 = _mm_set1_epi16(1);
+			for (; i + 4 <= count; i += 4) {
+				__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i o = _mm_loadu_si128((const __m128i*)(dst + i));
+				__m128i lo = blend2(_mm_unpacklo_epi8(o, zero), _mm_unpacklo_epi8(s, zero), maskAlpha, c255, c1);
+				__m128i hi = blend2(_mm_unpackhi_epi8(o, zero), _mm_unpackhi_epi8(s, zero), maskAlpha, c255, c1);
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+			}
+#endif
+			for (; i < count; i++) {
+				dst[i].blend_PA_NPA(src[i]);
+			}
+		}
+
+	};
+
+	/*
+		Rows buffer used by the stretch ops: points to the destination row when the blending is a plain copy,
+		otherwise to a temporary row which is blended into the destination by `end()`
+	*/
+	template <class BLEND_OP>
+	class _ImageStretch_RowWriter
+	{
+	public:
+		_ImageStretch_RowWriter(sl_uint32 width): m_buf(BLEND_OP::DirectWrite ? 0 : width), m_width(width)
+		{
+		}
+
+	public:
+		SLIB_INLINE Color* begin(Color* rowDst)
+		{
+			return BLEND_OP::DirectWrite ? rowDst : m_buf.data;
+		}
+
+		SLIB_INLINE void end(Color* rowDst)
+		{
+			if (!(BLEND_OP::DirectWrite)) {
+				BLEND_OP::blendRow(rowDst, m_buf.data, m_width);
+			}
+		}
+
+	private:
+		ScopedBuffer<Color, 1024> m_buf;
+		sl_uint32 m_width;
+
+	};
+
 	class _ImageStretch_FillColor
 	{
+	public:
+		_ImageStretch_FillColor(const ImageDesc& dst, const ImageDesc& src)
+		{
+		}
+
 	public:
 		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
-			Color* colorsDst = dst.colors;
+			sl_uint32 dw = dst.width;
 			Color color = *(src.colors);
-			for (sl_uint32 y = 0; y < dst.height; y++) {
-				for (sl_uint32 x = 0; x < dst.width; x++) {
-					BLEND_OP::blend(colorsDst[x], color);
+			SLIB_SCOPED_BUFFER(Color, 1024, row, BLEND_OP::DirectWrite ? 0 : dw);
+			if (!(BLEND_OP::DirectWrite)) {
+				for (sl_uint32 x = 0; x < dw; x++) {
+					row[x] = color;
+				}
+			}
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			for (sl_uint32 y = dyStart; y < dyEnd; y++) {
+				if (BLEND_OP::DirectWrite) {
+					for (sl_uint32 x = 0; x < dw; x++) {
+						colorsDst[x] = color;
+					}
+				} else {
+					BLEND_OP::blendRow(colorsDst, row, dw);
 				}
 				colorsDst += dst.stride;
 			}
 		}
+
 	};
 
 	class _ImageStretch_Copy
 	{
+	public:
+		_ImageStretch_Copy(const ImageDesc& dst, const ImageDesc& src)
+		{
+		}
+
 	public:
 		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
-			Color* colorsDst = dst.colors;
-			const Color* colorsSrc = src.colors;
-			for (sl_uint32 y = 0; y < dst.height; y++) {
-				for (sl_uint32 x = 0; x < dst.width; x++) {
-					BLEND_OP::blend(colorsDst[x], colorsSrc[x]);
-				}
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			const Color* colorsSrc = src.colors + dyStart * src.stride;
+			for (sl_uint32 y = dyStart; y < dyEnd; y++) {
+				BLEND_OP::blendRow(colorsDst, colorsSrc, dst.width);
 				colorsDst += dst.stride;
 				colorsSrc += src.stride;
 			}
 		}
+
 	};
 
 	class _ImageStretch_Nearest
 	{
 	public:
-		template <class BLEND_OP>
-		static void stretchX(ImageDesc& dst, const ImageDesc& src)
-		{
-			sl_uint32 dx, dy;
-			
-			SLIB_SCOPED_BUFFER(sl_uint32, 1024, mapx, dst.width);
-			sl_uint32 tx = 0;
-			for (dx = 0; dx < dst.width; dx++) {
-				mapx[dx] = tx / dst.width;
-				tx += src.width;
-			}
-			
-			Color* colorsDst = dst.colors;
-			const Color* colorsSrc = src.colors;
-			for (dy = 0; dy < dst.height; dy++) {
-				for (dx = 0; dx < dst.width; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[mapx[dx]]);
-				}
-				colorsDst += dst.stride;
-				colorsSrc += src.stride;
-			}
-		}
-		
-		template <class BLEND_OP>
-		static void stretchY(ImageDesc& dst, const ImageDesc& src)
+		_ImageStretch_Nearest(const ImageDesc& dst, const ImageDesc& src)
 		{
-			sl_uint32 dx, dy;
-			
-			Color* colorsDst = dst.colors;
-			for (dy = 0; dy < dst.height; dy++) {
-				const Color* colorsSrc = src.colors + ((dy * src.height) / dst.height) * src.stride;
-				for (dx = 0; dx < dst.width; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[dx]);
+			if (src.width != dst.width) {
+				m_mapx = Array<sl_uint32>::create(dst.width);
+				sl_uint32* mapx = m_mapx.getData();
+				if (mapx) {
+					sl_uint32 tx = 0;
+					for (sl_uint32 dx = 0; dx < dst.width; dx++) {
+						mapx[dx] = tx / dst.width;
+						tx += src.width;
+					}
 				}
-				colorsDst += dst.stride;
 			}
 		}
-		
+
+	public:
 		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
-			if (src.width == dst.width) {
-				stretchX<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.height == dst.height) {
-				stretchY<BLEND_OP>(dst, src);
+			sl_uint32 dw = dst.width;
+			const sl_uint32* mapx = m_mapx.getData();
+			if (src.width != dw && !mapx) {
 				return;
 			}
-			
-			sl_uint32 dx, dy;
-			
-			SLIB_SCOPED_BUFFER(sl_uint32, 1024, mapx, dst.width);
-			sl_uint32 tx = 0;
-			for (dx = 0; dx < dst.width; dx++) {
-				mapx[dx] = tx / dst.width;
-				tx += src.width;
-			}
-			
-			Color* colorsDst = dst.colors;
-			for (dy = 0; dy < dst.height; dy++) {
-				const Color* colorsSrc = src.colors + ((dy * src.height) / dst.height) * src.stride;
-				for (dx = 0; dx < dst.width; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[mapx[dx]]);
+			_ImageStretch_RowWriter<BLEND_OP> writer(dw);
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			for (sl_uint32 dy = dyStart; dy < dyEnd; dy++) {
+				const Color* colorsSrc;
+				if (src.height == dst.height) {
+					colorsSrc = src.colors + dy * src.stride;
+				} else {
+					colorsSrc = src.colors + ((dy * src.height) / dst.height) * src.stride;
+				}
+				if (mapx) {
+					Color* row = writer.begin(colorsDst);
+					for (sl_uint32 dx = 0; dx < dw; dx++) {
+						row[dx] = colorsSrc[mapx[dx]];
+					}
+					writer.end(colorsDst);
+				} else {
+					BLEND_OP::blendRow(colorsDst, colorsSrc, dw);
 				}
 				colorsDst += dst.stride;
 			}
 		}
-		
+
+	private:
+		Array<sl_uint32> m_mapx;
+
 	};
 
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+
+	typedef __m128 _ImageStretch_Color4f;
+
+	SLIB_INLINE static __m128 _ImageStretch_load(const Color& c)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i v = _mm_cvtsi32_si128(*((const sl_int32*)&c));
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero));
+	}
+
+	SLIB_INLINE static void _ImageStretch_store(Color& c, __m128 f)
+	{
+		__m128i v = _mm_cvttps_epi32(f);
+		v = _mm_packs_epi32(v, v);
+		v = _mm_packus_epi16(v, v);
+		*((sl_int32*)&c) = _mm_cvtsi128_si32(v);
+	}
+
+	SLIB_INLINE static __m128 _ImageStretch_set(float f)
+	{
+		return _mm_set1_ps(f);
+	}
+
+	SLIB_INLINE static __m128 _ImageStretch_add(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(a, b);
+	}
+
+	SLIB_INLINE static __m128 _ImageStretch_mul(__m128 a, __m128 b)
+	{
+		return _mm_mul_ps(a, b);
+	}
+
+	SLIB_INLINE static __m128 _ImageStretch_div(__m128 a, __m128 b)
+	{
+		return _mm_div_ps(a, b);
+	}
+
+#else
+
+	struct _ImageStretch_Color4f
+	{
+		float r;
+		float g;
+		float b;
+		float a;
+	};
+
+	SLIB_INLINE static _ImageStretch_Color4f _ImageStretch_load(const Color& c)
+	{
+		_ImageStretch_Color4f ret = { (float)(c.r), (float)(c.g), (float)(c.b), (float)(c.a) };
+		return ret;
+	}
+
+	SLIB_INLINE static void _ImageStretch_store(Color& c, const _ImageStretch_Color4f& f)
+	{
+		c.r = (sl_uint8)(f.r);
+		c.g = (sl_uint8)(f.g);
+		c.b = (sl_uint8)(f.b);
+		c.a = (sl_uint8)(f.a);
+	}
+
+	SLIB_INLINE static _ImageStretch_Color4f _ImageStretch_set(float f)
+	{
+		_ImageStretch_Color4f ret = { f, f, f, f };
+		return ret;
+	}
+
+	SLIB_INLINE static _ImageStretch_Color4f _ImageStretch_add(const _ImageStretch_Color4f& x, const _ImageStretch_Color4f& y)
+	{
+		_ImageStretch_Color4f ret = { x.r + y.r, x.g + y.g, x.b + y.b, x.a + y.a };
+		return ret;
+	}
+
+	SLIB_INLINE static _ImageStretch_Color4f _ImageStretch_mul(const _ImageStretch_Color4f& x, const _ImageStretch_Color4f& y)
+	{
+		_ImageStretch_Color4f ret = { x.r * y.r, x.g * y.g, x.b * y.b, x.a * y.a };
+		return ret;
+	}
+
+	SLIB_INLINE static _ImageStretch_Color4f _ImageStretch_div(const _ImageStretch_Color4f& x, const _ImageStretch_Color4f& y)
+	{
+		_ImageStretch_Color4f ret = { x.r / y.r, x.g / y.g, x.b / y.b, x.a / y.a };
+		return ret;
+	}
+
+#endif
+
 	struct _ImageStretch_FilterParam
 	{
 		sl_bool flagBox;
 		float filterSize;
 	};
 
+	// sampling position of a destination column (or row) in the source
+	struct _ImageStretch_Sample
+	{
+		sl_int32 index;
+		float s;
+		float e;
+		int n;
+		float area;
+	};
+
+	/*
+		The filters compute the four components with the same sequence of the single-precision operations,
+		so the vectorized and the scalar builds produce the same colors.
+	*/
 	class _ImageStretch_Smooth_LinearFilter
 	{
 	public:
-		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, float fx, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& px, const _ImageStretch_FilterParam& py)
+		SLIB_INLINE static void prepareSample(_ImageStretch_Sample& sample, float f, const _ImageStretch_FilterParam& p)
 		{
-			const Color& c00 = *colors;
-			const Color& c01 = colors[1];
-			const Color& c10 = colors[stride];
-			const Color& c11 = colors[stride + 1];
-			float sx = 1 - fx;
-			float ex = fx;
-			float sy = 1 - fy;
-			float ey = fy;
-			float f00 = sx * sy;
-			float f01 = ex * sy;
-			float f10 = sx * ey;
-			float f11 = ex * ey;
-			float r = (float)(c00.r) * f00 + (float)(c01.r) * f01 + (float)(c10.r) * f10 + (float)(c11.r) * f11;
-			float g = (float)(c00.g) * f00 + (float)(c01.g) * f01 + (float)(c10.g) * f10 + (float)(c11.g) * f11;
-			float b = (float)(c00.b) * f00 + (float)(c01.b) * f01 + (float)(c10.b) * f10 + (float)(c11.b) * f11;
-			float a = (float)(c00.a) * f00 + (float)(c01.a) * f01 + (float)(c10.a) * f10 + (float)(c11.a) * f11;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
-		}
-		
-		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, float fx, const _ImageStretch_FilterParam& px)
+			sample.s = 1 - f;
+			sample.e = f;
+			sample.n = 0;
+			sample.area = 1;
+		}
+
+		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, sl_uint32 stride, const _ImageStretch_Sample& x, const _ImageStretch_Sample& y)
 		{
-			const Color& c0 = *colors;
-			const Color& c1 = colors[1];
-			float f0 = 1 - fx;
-			float f1 = fx;
-			float r = (float)(c0.r) * f0 + (float)(c1.r) * f1;
-			float g = (float)(c0.g) * f0 + (float)(c1.g) * f1;
-			float b = (float)(c0.b) * f0 + (float)(c1.b) * f1;
-			float a = (float)(c0.a) * f0 + (float)(c1.a) * f1;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
-		}
-		
-		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& py)
+			float f00 = x.s * y.s;
+			float f01 = x.e * y.s;
+			float f10 = x.s * y.e;
+			float f11 = x.e * y.e;
+			_ImageStretch_Color4f c = _ImageStretch_mul(_ImageStretch_load(colors[0]), _ImageStretch_set(f00));
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_load(colors[1]), _ImageStretch_set(f01)));
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_load(colors[stride]), _ImageStretch_set(f10)));
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_load(colors[stride + 1]), _ImageStretch_set(f11)));
+			_ImageStretch_store(_out, c);
+		}
+
+		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, const _ImageStretch_Sample& x)
 		{
-			const Color& c0 = *colors;
-			const Color& c1 = colors[stride];
-			float f0 = 1 - fy;
-			float f1 = fy;
-			float r = (float)(c0.r) * f0 + (float)(c1.r) * f1;
-			float g = (float)(c0.g) * f0 + (float)(c1.g) * f1;
-			float b = (float)(c0.b) * f0 + (float)(c1.b) * f1;
-			float a = (float)(c0.a) * f0 + (float)(c1.a) * f1;
-			_out.r = (sl_uint8)(r);
-			_out.g = (sl_uint8)(g);
-			_out.b = (sl_uint8)(b);
-			_out.a = (sl_uint8)(a);
+			_ImageStretch_Color4f c = _ImageStretch_mul(_ImageStretch_load(colors[0]), _ImageStretch_set(x.s));
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_load(colors[1]), _ImageStretch_set(x.e)));
+			_ImageStretch_store(_out, c);
+		}
+
+		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, sl_uint32 stride, const _ImageStretch_Sample& y)
+		{
+			_ImageStretch_Color4f c = _ImageStretch_mul(_ImageStretch_load(colors[0]), _ImageStretch_set(y.s));
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_load(colors[stride]), _ImageStretch_set(y.e)));
+			_ImageStretch_store(_out, c);
 		}
 
 	};
@@ -510,123 +695,72 @@ namespace slib
 	class _ImageStretch_Smooth_BoxFilter
 	{
 	public:
-		SLIB_INLINE static void prepareFilter(float f, const _ImageStretch_FilterParam& p, float& s, float& e, int& n, float& area)
+		SLIB_INLINE static void prepareSample(_ImageStretch_Sample& sample, float f, const _ImageStretch_FilterParam& p)
 		{
 			if (p.flagBox) {
-				s = 1 - f;
-				e = f + p.filterSize; // p.filterSize > 1
-				n = (int)(e - 0.0001);
-				e -= (float)n;
-				n -= 1;
-				area = p.filterSize;
+				sample.s = 1 - f;
+				float e = f + p.filterSize; // p.filterSize > 1
+				int n = (int)(e - 0.0001);
+				sample.e = e - (float)n;
+				sample.n = n - 1;
+				sample.area = p.filterSize;
 			} else {
-				s = 1 - f;
-				e = f;
-				n = 0;
-				area = 1;
+				sample.s = 1 - f;
+				sample.e = f;
+				sample.n = 0;
+				sample.area = 1;
 			}
 		}
-		
-		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, float fx, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& px, const _ImageStretch_FilterParam& py)
+
+		// sx * colors[0] + (colors[1] + ... + colors[nx]) + ex * colors[nx + 1]
+		SLIB_INLINE static _ImageStretch_Color4f getRowSum(const Color* colors, const _ImageStretch_Sample& x)
 		{
-			float sx, ex, ax; int nx;
-			prepareFilter(fx, px, sx, ex, nx, ax);
-			float sy, ey, ay; int ny;
-			prepareFilter(fy, py, sy, ey, ny, ay);
-			int ix, iy;
-			float r = sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-			float g = sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-			float b = sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-			float a = sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-			for (ix = 0; ix < nx; ix++) {
-				r += (float)(colors[1 + ix].r);
-				g += (float)(colors[1 + ix].g);
-				b += (float)(colors[1 + ix].b);
-				a += (float)(colors[1 + ix].a);
+			_ImageStretch_Color4f c = _ImageStretch_add(_ImageStretch_mul(_ImageStretch_set(x.s), _ImageStretch_load(colors[0])), _ImageStretch_mul(_ImageStretch_set(x.e), _ImageStretch_load(colors[x.n + 1])));
+			for (int ix = 0; ix < x.n; ix++) {
+				c = _ImageStretch_add(c, _ImageStretch_load(colors[1 + ix]));
 			}
-			r *= sy;
-			g *= sy;
-			b *= sy;
-			a *= sy;
+			return c;
+		}
+
+		SLIB_INLINE static void getColorAt(Color& _out, const Color* colors, sl_uint32 stride, const _ImageStretch_Sample& x, const _ImageStretch_Sample& y)
+		{
+			int nx = x.n;
+			_ImageStretch_Color4f c = _ImageStretch_mul(getRowSum(colors, x), _ImageStretch_set(y.s));
 			colors += stride;
-			for (iy = 0; iy < ny; iy++) {
-				r += sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-				g += sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-				b += sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-				a += sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-				for (ix = 0; ix < nx; ix++) {
-					r += (float)(colors[1 + ix].r);
-					g += (float)(colors[1 + ix].g);
-					b += (float)(colors[1 + ix].b);
-					a += (float)(colors[1 + ix].a);
+			_ImageStretch_Color4f sx = _ImageStretch_set(x.s);
+			_ImageStretch_Color4f ex = _ImageStretch_set(x.e);
+			for (int iy = 0; iy < y.n; iy++) {
+				c = _ImageStretch_add(c, _ImageStretch_add(_ImageStretch_mul(sx, _ImageStretch_load(colors[0])), _ImageStretch_mul(ex, _ImageStretch_load(colors[nx + 1]))));
+				for (int ix = 0; ix < nx; ix++) {
+					c = _ImageStretch_add(c, _ImageStretch_load(colors[1 + ix]));
 				}
 				colors += stride;
 			}
-			r += ey * (sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r));
-			g += ey * (sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g));
-			b += ey * (sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b));
-			a += ey * (sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a));
-			for (ix = 0; ix < nx; ix++) {
-				r += ey * (float)(colors[1 + ix].r);
-				g += ey * (float)(colors[1 + ix].g);
-				b += ey * (float)(colors[1 + ix].b);
-				a += ey * (float)(colors[1 + ix].a);
+			_ImageStretch_Color4f ey = _ImageStretch_set(y.e);
+			c = _ImageStretch_add(c, _ImageStretch_mul(ey, _ImageStretch_add(_ImageStretch_mul(sx, _ImageStretch_load(colors[0])), _ImageStretch_mul(ex, _ImageStretch_load(colors[nx + 1])))));
+			for (int ix = 0; ix < nx; ix++) {
+				c = _ImageStretch_add(c, _ImageStretch_mul(ey, _ImageStretch_load(colors[1 + ix])));
 			}
-			float area = ax * ay;
-			_out.r = (sl_uint8)(r / area);
-			_out.g = (sl_uint8)(g / area);
-			_out.b = (sl_uint8)(b / area);
-			_out.a = (sl_uint8)(a / area);
-		}
-		
-		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, float fx, const _ImageStretch_FilterParam& px)
+			_ImageStretch_store(_out, _ImageStretch_div(c, _ImageStretch_set(x.area * y.area)));
+		}
+
+		SLIB_INLINE static void getColorAtX(Color& _out, const Color* colors, const _ImageStretch_Sample& x)
 		{
-			float sx, ex, ax; int nx;
-			prepareFilter(fx, px, sx, ex, nx, ax);
-			int ix;
-			float r = sx * (float)(colors[0].r) + ex * (float)(colors[nx + 1].r);
-			float g = sx * (float)(colors[0].g) + ex * (float)(colors[nx + 1].g);
-			float b = sx * (float)(colors[0].b) + ex * (float)(colors[nx + 1].b);
-			float a = sx * (float)(colors[0].a) + ex * (float)(colors[nx + 1].a);
-			for (ix = 0; ix < nx; ix++) {
-				r += (float)(colors[1 + ix].r);
-				g += (float)(colors[1 + ix].g);
-				b += (float)(colors[1 + ix].b);
-				a += (float)(colors[1 + ix].a);
-			}
-			_out.r = (sl_uint8)(r / ax);
-			_out.g = (sl_uint8)(g / ax);
-			_out.b = (sl_uint8)(b / ax);
-			_out.a = (sl_uint8)(a / ax);
+			_ImageStretch_store(_out, _ImageStretch_div(getRowSum(colors, x), _ImageStretch_set(x.area)));
 		}
-		
-		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, float fy, sl_uint32 stride, const _ImageStretch_FilterParam& py)
+
+		SLIB_INLINE static void getColorAtY(Color& _out, const Color* colors, sl_uint32 stride, const _ImageStretch_Sample& y)
 		{
-			float sy, ey, ay; int ny;
-			prepareFilter(fy, py, sy, ey, ny, ay);
-			int iy;
-			float r = sy * (float)(colors[0].r);
-			float g = sy * (float)(colors[0].g);
-			float b = sy * (float)(colors[0].b);
-			float a = sy * (float)(colors[0].a);
+			_ImageStretch_Color4f c = _ImageStretch_mul(_ImageStretch_set(y.s), _ImageStretch_load(colors[0]));
 			colors += stride;
-			for (iy = 0; iy < ny; iy++) {
-				r += (float)(colors[0].r);
-				g += (float)(colors[0].g);
-				b += (float)(colors[0].b);
-				a += (float)(colors[0].a);
+			for (int iy = 0; iy < y.n; iy++) {
+				c = _ImageStretch_add(c, _ImageStretch_load(colors[0]));
 				colors += stride;
 			}
-			r += ey * (float)(colors[0].r);
-			g += ey * (float)(colors[0].g);
-			b += ey * (float)(colors[0].b);
-			a += ey * (float)(colors[0].a);
-			_out.r = (sl_uint8)(r / ay);
-			_out.g = (sl_uint8)(g / ay);
-			_out.b = (sl_uint8)(b / ay);
-			_out.a = (sl_uint8)(a / ay);
-		}
-		
+			c = _ImageStretch_add(c, _ImageStretch_mul(_ImageStretch_set(y.e), _ImageStretch_load(colors[0])));
+			_ImageStretch_store(_out, _ImageStretch_div(c, _ImageStretch_set(y.area)));
+		}
+
 	};
 
 	SLIB_INLINE static void _ImageStretch_Smooth_Prepare(sl_int32 sw, sl_int32 dw, float& step, float& sx_start, sl_int32& dx_start, sl_int32& dx_end, _ImageStretch_FilterParam& param)
@@ -649,430 +783,690 @@ namespace slib
 	}
 
 	template <class FILTER>
-	class _ImageStretch_Smooth
+	class _ImageStretch_Smooth_Axis
 	{
 	public:
-		template <class BLEND_OP>
-		static void stretchX(ImageDesc& dst, const ImageDesc& src)
+		sl_int32 d_start;
+		sl_int32 d_end;
+		Array<_ImageStretch_Sample> samples;
+
+	public:
+		_ImageStretch_Smooth_Axis(): d_start(0), d_end(0)
 		{
-			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
-			sl_int32 dx, dy;
-			sl_int32 dh = dst.height;
-			float sx;
-			
-			Color* colorsDst;
-			const Color* colorsSrc;
-			Color color;
-			
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, *colorsSrc);
-					colorsDst += dst.stride;
-					colorsSrc += src.stride;
-				}
-				// right
-				colorsDst = dst.colors + (dw - 1);
-				colorsSrc = src.colors + (sw - 1);
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, *colorsSrc);
-					colorsDst += dst.stride;
-					colorsSrc += src.stride;
-				}
-			}
-			
-			colorsDst = dst.colors;
-			colorsSrc = src.colors;
-			for (dy = 0; dy < dh; dy++) {
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
-				colorsSrc += src.stride;
-			}
 		}
-		
-		template <class BLEND_OP>
-		static void stretchY(ImageDesc& dst, const ImageDesc& src)
+
+	public:
+		void prepare(sl_int32 sw, sl_int32 dw)
 		{
-			sl_int32 sh = src.height;
-			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
-			sl_int32 dw = dst.width;
-			float sy;
-			
-			Color* colorsDst;
-			const Color* colorsSrc;
-			Color color;
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[dx]);
-				}
-				// bottom
-				colorsDst = dst.colors + (sl_uint32)(dh - 1) * dst.stride;
-				colorsSrc = src.colors + (sl_uint32)(sh - 1) * src.stride;
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], colorsSrc[dx]);
-				}
-			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			colorsSrc = src.colors;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				const Color* lineSrc = colorsSrc + (sl_uint32)isy * src.stride;
-				for (dx = 0; dx < dw; dx++) {
-					FILTER::getColorAtY(color, lineSrc + dx, fsy, src.stride, py);
-					BLEND_OP::blend(colorsDst[dx], color);
+			float step, s_start;
+			_ImageStretch_FilterParam param;
+			_ImageStretch_Smooth_Prepare(sw, dw, step, s_start, d_start, d_end, param);
+			samples = Array<_ImageStretch_Sample>::create(dw);
+			_ImageStretch_Sample* p = samples.getData();
+			if (p) {
+				for (sl_int32 d = d_start; d < d_end; d++) {
+					float s = s_start + (float)(d) * step;
+					sl_int32 is = (sl_int32)s;
+					p[d].index = is;
+					FILTER::prepareSample(p[d], s - (float)is, param);
 				}
-				colorsDst += dst.stride;
 			}
 		}
-		
-		template <class BLEND_OP>
-		static void stretchOneRowSrc(ImageDesc& dst, const ImageDesc& src)
+
+	};
+
+	template <class FILTER>
+	class _ImageStretch_Smooth
+	{
+	public:
+		_ImageStretch_Smooth(const ImageDesc& dst, const ImageDesc& src)
 		{
-			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
-			sl_int32 dx, dy;
-			sl_int32 dh = dst.height;
-			float sx;
-			
-			Color* colorsDst;
-			Color color;
-			
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors;
-				color = *(src.colors);
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
-				// right
-				colorsDst = dst.colors + (dw - 1);
-				color = *(src.colors + (sw - 1));
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
-				}
+			if (src.width != dst.width) {
+				m_x.prepare(src.width, dst.width);
 			}
-			
-			for (dx = dx_start; dx < dx_end; dx++) {
-				sx = sx_start + (float)(dx) * sx_step;
-				isx = (sl_int32)sx;
-				FILTER::getColorAtX(color, src.colors + isx, sx - (float)isx, px);
-				colorsDst = dst.colors + dx;
-				for (dy = 0; dy < dh; dy++) {
-					BLEND_OP::blend(*(colorsDst), color);
-					colorsDst += dst.stride;
-				}
+			if (src.height != dst.height) {
+				m_y.prepare(src.height, dst.height);
 			}
 		}
-		
-		template <class BLEND_OP>
-		static void stretchOneColSrc(ImageDesc& dst, const ImageDesc& src)
+
+	public:
+		// interpolates the row `colorsSrc` horizontally
+		void stretchRowX(Color* row, const ImageDesc& dst, const ImageDesc& src, const Color* colorsSrc) const
 		{
-			sl_int32 sh = src.height;
-			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
+			const _ImageStretch_Sample* samples = m_x.samples.getData();
 			sl_int32 dw = dst.width;
-			float sy;
-			
-			Color* colorsDst;
-			Color color;
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				color = *(src.colors);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				// bottom
-				colorsDst = dst.colors + (dh - 1) * dst.stride;
-				color = *(src.colors + (sh - 1) * src.stride);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
+			if (m_x.d_start) {
+				row[0] = colorsSrc[0];
+				row[dw - 1] = colorsSrc[src.width - 1];
 			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				FILTER::getColorAtY(color, src.colors + isy * src.stride, fsy, src.stride, py);
-				for (dx = 0; dx < dw; dx++) {
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				colorsDst += dst.stride;
+			for (sl_int32 dx = m_x.d_start; dx < m_x.d_end; dx++) {
+				const _ImageStretch_Sample& x = samples[dx];
+				FILTER::getColorAtX(row[dx], colorsSrc + x.index, x);
 			}
 		}
-		
+
 		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
-			if (src.width == dst.width) {
-				stretchY<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.height == dst.height) {
-				stretchX<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.width == 1) {
-				stretchOneColSrc<BLEND_OP>(dst, src);
-				return;
-			}
-			if (src.height == 1) {
-				stretchOneRowSrc<BLEND_OP>(dst, src);
-				return;
-			}
-
 			sl_int32 sw = src.width;
-			sl_int32 dw = dst.width;
-			float sx_step, sx_start;
-			sl_int32 isx, dx_start, dx_end;
-			_ImageStretch_FilterParam px;
-			_ImageStretch_Smooth_Prepare(sw, dw, sx_step, sx_start, dx_start, dx_end, px);
-			
 			sl_int32 sh = src.height;
+			sl_int32 dw = dst.width;
 			sl_int32 dh = dst.height;
-			float sy_step, sy_start;
-			sl_int32 isy, dy_start, dy_end;
-			_ImageStretch_FilterParam py;
-			_ImageStretch_Smooth_Prepare(sh, dh, sy_step, sy_start, dy_start, dy_end, py);
-			
-			sl_int32 dx, dy;
-			float sx, sy;
-			
-			Color color;
-			Color* colorsDst;
-			const Color* colorsSrc;
-			
-			// 4-corners
-			if (dx_start && dy_start) {
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				BLEND_OP::blend(colorsDst[0], colorsSrc[0]);
-				BLEND_OP::blend(colorsDst[dw - 1], colorsSrc[sw - 1]);
-				BLEND_OP::blend(colorsDst[(dh - 1) * dst.stride], colorsSrc[(sh - 1) * src.stride]);
-				BLEND_OP::blend(colorsDst[(dh - 1) * dst.stride + dw - 1], colorsSrc[(sh - 1) * src.stride + sw - 1]);
+			const _ImageStretch_Sample* samplesX = m_x.samples.getData();
+			const _ImageStretch_Sample* samplesY = m_y.samples.getData();
+			if ((sw != dw && !samplesX) || (sh != dh && !samplesY)) {
+				return;
 			}
-			
-			if (dy_start) {
-				// top
-				colorsDst = dst.colors;
-				colorsSrc = src.colors;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
-				}
-				// bottom
-				colorsDst = dst.colors + (dh - 1) * dst.stride;
-				colorsSrc = src.colors + (sh - 1) * src.stride;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAtX(color, colorsSrc + isx, sx - (float)isx, px);
-					BLEND_OP::blend(colorsDst[dx], color);
+
+			_ImageStretch_RowWriter<BLEND_OP> writer(dw);
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			sl_int32 dx, dy;
+
+			if (sh == dh || sh == 1) {
+				// horizontal only, or the same row for all destination rows
+				if (sw == dw) {
+					for (dy = dyStart; dy < (sl_int32)dyEnd; dy++) {
+						BLEND_OP::blendRow(colorsDst, src.colors, dw);
+						colorsDst += dst.stride;
+					}
+					return;
 				}
-			}
-			if (dx_start) {
-				// left
-				colorsDst = dst.colors + dy_start * dst.stride;
-				colorsSrc = src.colors;
-				for (dy = dy_start; dy < dy_end; dy++) {
-					sy = sy_start + (float)(dy) * sy_step;
-					isy = (sl_int32)sy;
-					FILTER::getColorAtY(color, colorsSrc + isy * src.stride, sy - (float)isy, src.stride, py);
-					BLEND_OP::blend(*colorsDst, color);
-					colorsDst += dst.stride;
+				if (sh == 1 && !(BLEND_OP::DirectWrite)) {
+					SLIB_SCOPED_BUFFER(Color, 1024, row, dw);
+					stretchRowX(row, dst, src, src.colors);
+					for (dy = dyStart; dy < (sl_int32)dyEnd; dy++) {
+						BLEND_OP::blendRow(colorsDst, row, dw);
+						colorsDst += dst.stride;
+					}
+					return;
 				}
-				// right
-				colorsDst = dst.colors + (dy_start * dst.stride + dw - 1);
-				colorsSrc = src.colors + (sw - 1);
-				for (dy = dy_start; dy < dy_end; dy++) {
-					sy = sy_start + (float)(dy) * sy_step;
-					isy = (sl_int32)sy;
-					FILTER::getColorAtY(color, colorsSrc + isy * src.stride, sy - (float)isy, src.stride, py);
-					BLEND_OP::blend(*colorsDst, color);
+				for (dy = dyStart; dy < (sl_int32)dyEnd; dy++) {
+					stretchRowX(writer.begin(colorsDst), dst, src, sh == 1 ? src.colors : src.colors + dy * src.stride);
+					writer.end(colorsDst);
 					colorsDst += dst.stride;
 				}
+				return;
 			}
-			
-			colorsDst = dst.colors + dy_start * dst.stride;
-			colorsSrc = src.colors;
-			for (dy = dy_start; dy < dy_end; dy++) {
-				sy = sy_start + (float)(dy) * sy_step;
-				isy = (sl_int32)sy;
-				float fsy = sy - (float)isy;
-				const Color* lineSrc = colorsSrc + isy * src.stride;
-				for (dx = dx_start; dx < dx_end; dx++) {
-					sx = sx_start + (float)(dx) * sx_step;
-					isx = (sl_int32)sx;
-					FILTER::getColorAt(color, lineSrc + isx, sx - (float)isx, fsy, src.stride, px, py);
-					BLEND_OP::blend(colorsDst[dx], color);
+
+			for (dy = dyStart; dy < (sl_int32)dyEnd; dy++) {
+				sl_bool flagEdge = m_y.d_start && (dy == 0 || dy == dh - 1);
+				const Color* colorsSrc = src.colors;
+				if (flagEdge) {
+					if (dy) {
+						colorsSrc += (sh - 1) * src.stride;
+					}
+				} else {
+					colorsSrc += samplesY[dy].index * src.stride;
+				}
+				if (sw == dw) {
+					if (flagEdge) {
+						BLEND_OP::blendRow(colorsDst, colorsSrc, dw);
+					} else {
+						Color* row = writer.begin(colorsDst);
+						const _ImageStretch_Sample& y = samplesY[dy];
+						for (dx = 0; dx < dw; dx++) {
+							FILTER::getColorAtY(row[dx], colorsSrc + dx, src.stride, y);
+						}
+						writer.end(colorsDst);
+					}
+				} else if (sw == 1) {
+					Color color;
+					if (flagEdge) {
+						color = *colorsSrc;
+					} else {
+						FILTER::getColorAtY(color, colorsSrc, src.stride, samplesY[dy]);
+					}
+					Color* row = writer.begin(colorsDst);
+					for (dx = 0; dx < dw; dx++) {
+						row[dx] = color;
+					}
+					writer.end(colorsDst);
+				} else {
+					Color* row = writer.begin(colorsDst);
+					if (flagEdge) {
+						stretchRowX(row, dst, src, colorsSrc);
+					} else {
+						const _ImageStretch_Sample& y = samplesY[dy];
+						if (m_x.d_start) {
+							FILTER::getColorAtY(row[0], colorsSrc, src.stride, y);
+							FILTER::getColorAtY(row[dw - 1], colorsSrc + (sw - 1), src.stride, y);
+						}
+						for (dx = m_x.d_start; dx < m_x.d_end; dx++) {
+							const _ImageStretch_Sample& x = samplesX[dx];
+							FILTER::getColorAt(row[dx], colorsSrc + x.index, src.stride, x, y);
+						}
+					}
+					writer.end(colorsDst);
 				}
 				colorsDst += dst.stride;
 			}
 		}
+
+	private:
+		_ImageStretch_Smooth_Axis<FILTER> m_x;
+		_ImageStretch_Smooth_Axis<FILTER> m_y;
+
 	};
 
 	class _ImageStretch_Smooth_IntBox
 	{
+	public:
+		_ImageStretch_Smooth_IntBox(const ImageDesc& dst, const ImageDesc& src)
+		{
+		}
+
 	public:
 		template <class BLEND_OP>
-		static void stretch(ImageDesc& dst, const ImageDesc& src)
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
 			sl_uint32 dw = dst.width;
-			sl_uint32 sw = src.width;
-			sl_uint32 fx = sw / dw;
+			sl_uint32 fx = src.width / dw;
 			if (fx == 0) {
 				return;
 			}
-			sl_uint32 dx, sx;
-			
-			sl_uint32 dh = dst.height;
-			sl_uint32 sh = src.height;
-			sl_uint32 fy = sh / dh;
+			sl_uint32 fy = src.height / dst.height;
 			if (fy == 0) {
 				return;
 			}
-			sl_uint32 dy, sy;
-			
-			Color* colorsDst = dst.colors;
-			const Color* colorsSrc = src.colors;
-			sl_uint32 ly = fy * src.stride;
-			
 			sl_uint32 area = fx * fy;
 			sl_uint32 n = Math::getMostSignificantBits(area) - 1;
-			if (area == (1U << n)) {
-				for (dy = 0; dy < dst.height; dy++) {
-					const Color* cs = colorsSrc;
-					for (dx = 0; dx < dst.width; dx++) {
-						sl_uint32 r = 0;
-						sl_uint32 g = 0;
-						sl_uint32 b = 0;
-						sl_uint32 a = 0;
-						const Color* c = cs;
-						for (sy = 0; sy < fy; sy++) {
-							for (sx = 0; sx < fx; sx++) {
-								r += c[sx].r;
-								g += c[sx].g;
-								b += c[sx].b;
-								a += c[sx].a;
-							}
-							c += src.stride;
+			sl_bool flagShift = area == (1U << n);
+
+			_ImageStretch_RowWriter<BLEND_OP> writer(dw);
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			const Color* colorsSrc = src.colors + dyStart * fy * src.stride;
+
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+			// column sums of the `fy` source rows, 4 components per source pixel
+			sl_uint32 sw = fx * dw;
+			SLIB_SCOPED_BUFFER(sl_uint32, 4096, sums, sw << 2);
+			__m128i zero = _mm_setzero_si128();
+			__m128i count = _mm_cvtsi32_si128((int)n);
+#endif
+
+			for (sl_uint32 dy = dyStart; dy < dyEnd; dy++) {
+				Color* row = writer.begin(colorsDst);
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+				sl_uint32 sx = 0;
+				for (; sx + 4 <= sw; sx += 4) {
+					__m128i s0 = zero;
+					__m128i s1 = zero;
+					__m128i s2 = zero;
+					__m128i s3 = zero;
+					const Color* c = colorsSrc + sx;
+					for (sl_uint32 sy = 0; sy < fy; sy++) {
+						__m128i v = _mm_loadu_si128((const __m128i*)c);
+						__m128i lo = _mm_unpacklo_epi8(v, zero);
+						__m128i hi = _mm_unpackhi_epi8(v, zero);
+						s0 = _mm_add_epi32(s0, _mm_unpacklo_epi16(lo, zero));
+						s1 = _mm_add_epi32(s1, _mm_unpackhi_epi16(lo, zero));
+						s2 = _mm_add_epi32(s2, _mm_unpacklo_epi16(hi, zero));
+						s3 = _mm_add_epi32(s3, _mm_unpackhi_epi16(hi, zero));
+						c += src.stride;
+					}
+					__m128i* s = (__m128i*)(sums + (sx << 2));
+					_mm_storeu_si128(s, s0);
+					_mm_storeu_si128(s + 1, s1);
+					_mm_storeu_si128(s + 2, s2);
+					_mm_storeu_si128(s + 3, s3);
+				}
+				for (; sx < sw; sx++) {
+					__m128i t = zero;
+					const Color* c = colorsSrc + sx;
+					for (sl_uint32 sy = 0; sy < fy; sy++) {
+						t = _mm_add_epi32(t, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*((const sl_int32*)c)), zero), zero));
+						c += src.stride;
+					}
+					_mm_storeu_si128((__m128i*)(sums + (sx << 2)), t);
+				}
+				const sl_uint32* s = sums;
+				for (sl_uint32 dx = 0; dx < dw; dx++) {
+					__m128i t = _mm_loadu_si128((const __m128i*)s);
+					s += 4;
+					for (sl_uint32 k = 1; k < fx; k++) {
+						t = _mm_add_epi32(t, _mm_loadu_si128((const __m128i*)s));
+						s += 4;
+					}
+					if (flagShift) {
+						t = _mm_srl_epi32(t, count);
+						t = _mm_packs_epi32(t, t);
+						*((sl_int32*)(row + dx)) = _mm_cvtsi128_si32(_mm_packus_epi16(t, t));
+					} else {
+						sl_uint32 c[4];
+						_mm_storeu_si128((__m128i*)c, t);
+						Color& o = row[dx];
+						o.r = (sl_uint8)(c[0] / area);
+						o.g = (sl_uint8)(c[1] / area);
+						o.b = (sl_uint8)(c[2] / area);
+						o.a = (sl_uint8)(c[3] / area);
+					}
+				}
+#else
+				const Color* cs = colorsSrc;
+				for (sl_uint32 dx = 0; dx < dw; dx++) {
+					sl_uint32 r = 0;
+					sl_uint32 g = 0;
+					sl_uint32 b = 0;
+					sl_uint32 a = 0;
+					const Color* c = cs;
+					for (sl_uint32 sy = 0; sy < fy; sy++) {
+						for (sl_uint32 sx = 0; sx < fx; sx++) {
+							r += c[sx].r;
+							g += c[sx].g;
+							b += c[sx].b;
+							a += c[sx].a;
 						}
-						cs += fx;
-						Color& t = colorsDst[dx];
+						c += src.stride;
+					}
+					cs += fx;
+					Color& t = row[dx];
+					if (flagShift) {
 						t.r = (sl_uint8)(r >> n);
 						t.g = (sl_uint8)(g >> n);
 						t.b = (sl_uint8)(b >> n);
 						t.a = (sl_uint8)(a >> n);
-					}
-					colorsDst += dst.stride;
-					colorsSrc += ly;
-				}
-			} else {
-				for (dy = 0; dy < dst.height; dy++) {
-					const Color* cs = colorsSrc;
-					for (dx = 0; dx < dst.width; dx++) {
-						sl_uint32 r = 0;
-						sl_uint32 g = 0;
-						sl_uint32 b = 0;
-						sl_uint32 a = 0;
-						const Color* c = cs;
-						for (sy = 0; sy < fy; sy++) {
-							for (sx = 0; sx < fx; sx++) {
-								r += c[sx].r;
-								g += c[sx].g;
-								b += c[sx].b;
-								a += c[sx].a;
-							}
-							c += src.stride;
-						}
-						cs += fx;
-						Color& t = colorsDst[dx];
+					} else {
 						t.r = (sl_uint8)(r / area);
 						t.g = (sl_uint8)(g / area);
 						t.b = (sl_uint8)(b / area);
 						t.a = (sl_uint8)(a / area);
 					}
-					colorsDst += dst.stride;
-					colorsSrc += ly;
 				}
+#endif
+				writer.end(colorsDst);
+				colorsDst += dst.stride;
+				colorsSrc += fy * src.stride;
 			}
 		}
-		
+
 	};
 
-	class _ImageBlend_Copy
+	/*
+		Separable convolution with fixed-point weights (Cubic, Lanczos)
+	*/
+	class _ImageStretch_Convolution_Axis
+	{
+	public:
+		sl_uint32 nTaps;
+		Array<sl_uint32> starts;
+		Array<sl_uint32> counts;
+		Array<sl_int16> weights;
+
+	public:
+		sl_bool prepare(sl_uint32 sizeSrc, sl_uint32 sizeDst, double (*kernel)(double), double support)
+		{
+			double scale = (double)sizeSrc / (double)sizeDst;
+			double filterScale = scale > 1 ? scale : 1;
+			support *= filterScale;
+			nTaps = (sl_uint32)(Math::ceil(support)) * 2 + 1;
+			starts = Array<sl_uint32>::create(sizeDst);
+			counts = Array<sl_uint32>::create(sizeDst);
+			weights = Array<sl_int16>::create(sizeDst * nTaps);
+			if (starts.isNull() || counts.isNull() || weights.isNull()) {
+				return sl_false;
+			}
+			SLIB_SCOPED_BUFFER(double, 64, w, nTaps);
+			for (sl_uint32 d = 0; d < sizeDst; d++) {
+				double center = ((double)d + 0.5) * scale;
+				sl_int32 start = (sl_int32)(center - support + 0.5);
+				if (start < 0) {
+					start = 0;
+				}
+				sl_int32 end = (sl_int32)(center + support + 0.5);
+				if (end > (sl_int32)sizeSrc) {
+					end = sizeSrc;
+				}
+				sl_uint32 n = end - start;
+				if (n > nTaps) {
+					n = nTaps;
+				}
+				double sum = 0;
+				sl_uint32 k;
+				for (k = 0; k < n; k++) {
+					w[k] = kernel(((double)(start + k) - center + 0.5) / filterScale);
+					sum += w[k];
+				}
+				sl_int16* wd = weights.getData() + d * nTaps;
+				for (k = 0; k < n; k++) {
+					double f = sum != 0 ? w[k] / sum * (double)(1 << _IMAGE_STRETCH_WEIGHT_BITS) : 0;
+					wd[k] = (sl_int16)(f < 0 ? f - 0.5 : f + 0.5);
+				}
+				for (; k < nTaps; k++) {
+					wd[k] = 0;
+				}
+				starts[d] = start;
+				counts[d] = n;
+			}
+			return sl_true;
+		}
+
+	};
+
+	// `count` taps of `colors` into one pixel
+	SLIB_INLINE static void _ImageStretch_Convolution_Pixel(Color& _out, const Color* colors, const sl_int16* w, sl_uint32 count)
 	{
+		sl_uint32 k = 0;
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i acc = _mm_set1_epi32(1 << (_IMAGE_STRETCH_WEIGHT_BITS - 1));
+		for (; k + 2 <= count; k += 2) {
+			__m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(colors + k)), zero);
+			// r0 r1 g0 g1 b0 b1 a0 a1
+			v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(v, _mm_set1_epi32((sl_int32)(((sl_uint32)(sl_uint16)(w[k + 1]) << 16) | (sl_uint16)(w[k])))));
+		}
+		if (k < count) {
+			__m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*((const sl_int32*)(colors + k))), zero), zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(v, _mm_set1_epi32((sl_uint16)(w[k]))));
+		}
+		acc = _mm_srai_epi32(acc, _IMAGE_STRETCH_WEIGHT_BITS);
+		acc = _mm_packs_epi32(acc, acc);
+		*((sl_int32*)&_out) = _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
+#else
+		sl_int32 r = 1 << (_IMAGE_STRETCH_WEIGHT_BITS - 1);
+		sl_int32 g = r;
+		sl_int32 b = r;
+		sl_int32 a = r;
+		for (; k < count; k++) {
+			const Color& c = colors[k];
+			sl_int32 f = w[k];
+			r += c.r * f;
+			g += c.g * f;
+			b += c.b * f;
+			a += c.a * f;
+		}
+		_out.r = (sl_uint8)(Math::clamp0_255(r >> _IMAGE_STRETCH_WEIGHT_BITS));
+		_out.g = (sl_uint8)(Math::clamp0_255(g >> _IMAGE_STRETCH_WEIGHT_BITS));
+		_out.b = (sl_uint8)(Math::clamp0_255(b >> _IMAGE_STRETCH_WEIGHT_BITS));
+		_out.a = (sl_uint8)(Math::clamp0_255(a >> _IMAGE_STRETCH_WEIGHT_BITS));
+#endif
+	}
+
+	// combines `count` rows into `_out`
+	static void _ImageStretch_Convolution_Rows(Color* _out, const Color* const* rows, const sl_int16* w, sl_uint32 count, sl_uint32 width)
+	{
+		sl_uint32 x = 0;
+#if defined(_IMAGE_STRETCH_USE_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		__m128i round = _mm_set1_epi32(1 << (_IMAGE_STRETCH_WEIGHT_BITS - 1));
+		for (; x + 4 <= width; x += 4) {
+			__m128i acc0 = round;
+			__m128i acc1 = round;
+			__m128i acc2 = round;
+			__m128i acc3 = round;
+			sl_uint32 k = 0;
+			for (; k + 2 <= count; k += 2) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i b = _mm_loadu_si128((const __m128i*)(rows[k + 1] + x));
+				__m128i f = _mm_set1_epi32((sl_int32)(((sl_uint32)(sl_uint16)(w[k + 1]) << 16) | (sl_uint16)(w[k])));
+				__m128i t = _mm_unpacklo_epi8(a, b);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(t, zero), f));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(t, zero), f));
+				t = _mm_unpackhi_epi8(a, b);
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(t, zero), f));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(t, zero), f));
+			}
+			if (k < count) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(rows[k] + x));
+				__m128i f = _mm_set1_epi32((sl_uint16)(w[k]));
+				__m128i t = _mm_unpacklo_epi8(a, zero);
+				acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(t, zero), f));
+				acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(t, zero), f));
+				t = _mm_unpackhi_epi8(a, zero);
+				acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(t, zero), f));
+				acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(t, zero), f));
+			}
+			__m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, _IMAGE_STRETCH_WEIGHT_BITS), _mm_srai_epi32(acc1, _IMAGE_STRETCH_WEIGHT_BITS));
+			__m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, _IMAGE_STRETCH_WEIGHT_BITS), _mm_srai_epi32(acc3, _IMAGE_STRETCH_WEIGHT_BITS));
+			_mm_storeu_si128((__m128i*)(_out + x), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; x < width; x++) {
+			sl_int32 r = 1 << (_IMAGE_STRETCH_WEIGHT_BITS - 1);
+			sl_int32 g = r;
+			sl_int32 b = r;
+			sl_int32 a = r;
+			for (sl_uint32 k = 0; k < count; k++) {
+				const Color& c = rows[k][x];
+				sl_int32 f = w[k];
+				r += c.r * f;
+				g += c.g * f;
+				b += c.b * f;
+				a += c.a * f;
+			}
+			Color& t = _out[x];
+			t.r = (sl_uint8)(Math::clamp0_255(r >> _IMAGE_STRETCH_WEIGHT_BITS));
+			t.g = (sl_uint8)(Math::clamp0_255(g >> _IMAGE_STRETCH_WEIGHT_BITS));
+			t.b = (sl_uint8)(Math::clamp0_255(b >> _IMAGE_STRETCH_WEIGHT_BITS));
+			t.a = (sl_uint8)(Math::clamp0_255(a >> _IMAGE_STRETCH_WEIGHT_BITS));
+		}
+	}
+
+	template <class KERNEL>
+	class _ImageStretch_Convolution
+	{
+	public:
+		_ImageStretch_Convolution(const ImageDesc& dst, const ImageDesc& src)
+		{
+			m_flagValid = m_x.prepare(src.width, dst.width, KERNEL::getValue, KERNEL::getSupport()) && m_y.prepare(src.height, dst.height, KERNEL::getValue, KERNEL::getSupport());
+		}
+
 	public:
-		SLIB_INLINE static void blend(Color& dst, const Color& src)
+		template <class BLEND_OP>
+		void stretchRows(ImageDesc& dst, const ImageDesc& src, sl_uint32 dyStart, sl_uint32 dyEnd) const
 		{
-			dst = src;
+			if (!m_flagValid) {
+				return;
+			}
+			sl_uint32 dw = dst.width;
+			const sl_uint32* startsX = m_x.starts.getData();
+			const sl_uint32* countsX = m_x.counts.getData();
+			const sl_int16* weightsX = m_x.weights.getData();
+			const sl_uint32* startsY = m_y.starts.getData();
+			const sl_uint32* countsY = m_y.counts.getData();
+			const sl_int16* weightsY = m_y.weights.getData();
+			sl_uint32 nTapsX = m_x.nTaps;
+			sl_uint32 nTapsY = m_y.nTaps;
+
+			// horizontally filtered source rows, kept in a ring indexed by the source row
+			SLIB_SCOPED_BUFFER(Color, 4096, ring, nTapsY * dw);
+			SLIB_SCOPED_BUFFER(const Color*, 64, rows, nTapsY);
+			sl_uint32 syNext = startsY[dyStart];
+
+			_ImageStretch_RowWriter<BLEND_OP> writer(dw);
+			Color* colorsDst = dst.colors + dyStart * dst.stride;
+			for (sl_uint32 dy = dyStart; dy < dyEnd; dy++) {
+				sl_uint32 syStart = startsY[dy];
+				sl_uint32 n = countsY[dy];
+				if (syNext < syStart) {
+					syNext = syStart;
+				}
+				for (; syNext < syStart + n; syNext++) {
+					Color* row = ring + (syNext % nTapsY) * dw;
+					const Color* colorsSrc = src.colors + syNext * src.stride;
+					for (sl_uint32 dx = 0; dx < dw; dx++) {
+						_ImageStretch_Convolution_Pixel(row[dx], colorsSrc + startsX[dx], weightsX + dx * nTapsX, countsX[dx]);
+					}
+				}
+				for (sl_uint32 k = 0; k < n; k++) {
+					rows[k] = ring + ((syStart + k) % nTapsY) * dw;
+				}
+				_ImageStretch_Convolution_Rows(writer.begin(colorsDst), rows, weightsY + dy * nTapsY, n, dw);
+				writer.end(colorsDst);
+				colorsDst += dst.stride;
+			}
 		}
+
+	private:
+		_ImageStretch_Convolution_Axis m_x;
+		_ImageStretch_Convolution_Axis m_y;
+		sl_bool m_flagValid;
+
 	};
 
-	class _ImageBlend_SrcAlpha
+	// Keys cubic convolution with a = -0.5
+	class _ImageStretch_CubicKernel
 	{
 	public:
-		SLIB_INLINE static void blend(Color& dst, const Color& src)
+		static double getValue(double x)
+		{
+			const double a = -0.5;
+			if (x < 0) {
+				x = -x;
+			}
+			if (x < 1) {
+				return ((a + 2) * x - (a + 3)) * x * x + 1;
+			}
+			if (x < 2) {
+				return (((x - 5) * x + 8) * x - 4) * a;
+			}
+			return 0;
+		}
+
+		static double getSupport()
 		{
-			dst.blend_PA_NPA(src);
+			return 2;
 		}
+
+	};
+
+	// Lanczos window of 3 lobes
+	class _ImageStretch_LanczosKernel
+	{
+	public:
+		static double getValue(double x)
+		{
+			if (x < 0) {
+				x = -x;
+			}
+			if (x >= 3) {
+				return 0;
+			}
+			if (x < 1e-8) {
+				return 1;
+			}
+			double t = x * MathContants<double>::PI;
+			return Math::sin(t) / t * Math::sin(t / 3) / (t / 3);
+		}
+
+		static double getSupport()
+		{
+			return 3;
+		}
+
 	};
 
+	/*
+		Destination rows are split into bands, which are claimed by the calling thread and the workers of a shared pool.
+		The caller returns after all bands are finished; the workers starting late find no band and exit.
+	*/
+	class _ImageStretch_Bands : public Referable
+	{
+	public:
+		Function<void(sl_uint32, sl_uint32)> process;
+		sl_uint32 height;
+		sl_int32 nBands;
+		sl_int32 indexNext;
+		sl_int32 nDone;
+		Ref<Event> eventDone;
+
+	public:
+		void run()
+		{
+			for (;;) {
+				sl_int32 index = Base::interlockedIncrement32(&indexNext) - 1;
+				if (index >= nBands) {
+					return;
+				}
+				sl_uint32 yStart = (sl_uint32)((sl_uint64)height * (sl_uint32)index / (sl_uint32)nBands);
+				sl_uint32 yEnd = (sl_uint32)((sl_uint64)height * (sl_uint32)(index + 1) / (sl_uint32)nBands);
+				process(yStart, yEnd);
+				if (Base::interlockedIncrement32(&nDone) == nBands) {
+					eventDone->set();
+				}
+			}
+		}
+
+	};
+
+	SLIB_SAFE_STATIC_GETTER(Ref<WorkStealingThreadPool>, _ImageStretch_getThreadPool, WorkStealingThreadPool::create())
+
+	static sl_uint32 _ImageStretch_getBandsCount(const ImageDesc& dst, const ImageDesc& src, Ref<WorkStealingThreadPool>& pool)
+	{
+		sl_uint64 work = (sl_uint64)(dst.width) * dst.height + (sl_uint64)(src.width) * src.height;
+		if (work < _IMAGE_STRETCH_MIN_PARALLEL_WORK || dst.height < 2) {
+			return 1;
+		}
+		if (System::getProcessorsCount() < 2) {
+			return 1;
+		}
+		Ref<WorkStealingThreadPool>* p = _ImageStretch_getThreadPool();
+		if (!p) {
+			return 1;
+		}
+		pool = *p;
+		if (pool.isNull()) {
+			return 1;
+		}
+		sl_uint32 n = pool->getThreadsCount() * _IMAGE_STRETCH_BANDS_PER_THREAD;
+		if (n > dst.height) {
+			n = dst.height;
+		}
+		return n;
+	}
+
 	class _ImageStretch
 	{
 	public:
+		template <class STRETCH_OP, class BLEND_OP>
+		static void run(ImageDesc& dst, const ImageDesc& src)
+		{
+			STRETCH_OP op(dst, src);
+			Ref<WorkStealingThreadPool> pool;
+			sl_uint32 nBands = _ImageStretch_getBandsCount(dst, src, pool);
+			if (nBands > 1) {
+				Ref<_ImageStretch_Bands> bands = new _ImageStretch_Bands;
+				Ref<Event> event = Event::create();
+				if (bands.isNotNull() && event.isNotNull()) {
+					ImageDesc* pDst = &dst;
+					const ImageDesc* pSrc = &src;
+					const STRETCH_OP* pOp = &op;
+					bands->process = [pDst, pSrc, pOp](sl_uint32 yStart, sl_uint32 yEnd) {
+						pOp->template stretchRows<BLEND_OP>(*pDst, *pSrc, yStart, yEnd);
+					};
+					bands->height = dst.height;
+					bands->nBands = nBands;
+					bands->indexNext = 0;
+					bands->nDone = 0;
+					bands->eventDone = event;
+					sl_uint32 nHelpers = pool->getThreadsCount();
+					if (nHelpers > nBands - 1) {
+						nHelpers = nBands - 1;
+					}
+					for (sl_uint32 i = 0; i < nHelpers; i++) {
+						pool->addTask([bands]() {
+							bands->run();
+						});
+					}
+					bands->run();
+					if (Base::interlockedAdd32(&(bands->nDone), 0) != (sl_int32)nBands) {
+						event->wait();
+					}
+					return;
+				}
+			}
+			op.template stretchRows<BLEND_OP>(dst, src, 0, dst.height);
+		}
+
 		template <class STRETCH_OP>
 		static void stretch(ImageDesc& dst, const ImageDesc& src, BlendMode blend)
 		{
 			switch (blend) {
 				case BlendMode::Copy:
-					STRETCH_OP::template stretch<_ImageBlend_Copy>(dst, src);
+					run<STRETCH_OP, _ImageBlend_Copy>(dst, src);
 					break;
 				case BlendMode::SrcAlpha:
-					STRETCH_OP::template stretch<_ImageBlend_SrcAlpha>(dst, src);
+					run<STRETCH_OP, _ImageBlend_SrcAlpha>(dst, src);
 					break;
 			}
 		}
@@ -1098,6 +1492,10 @@ namespace slib
 			_ImageStretch::template stretch<_ImageStretch_Nearest>(dst, src, blend);
 		} else if (stretch == StretchMode::Linear) {
 			_ImageStretch::template stretch< _ImageStretch_Smooth<_ImageStretch_Smooth_LinearFilter> >(dst, src, blend);
+		} else if (stretch == StretchMode::Cubic) {
+			_ImageStretch::template stretch< _ImageStretch_Convolution<_ImageStretch_CubicKernel> >(dst, src, blend);
+		} else if (stretch == StretchMode::Lanczos) {
+			_ImageStretch::template stretch< _ImageStretch_Convolution<_ImageStretch_LanczosKernel> >(dst, src, blend);
 		} else {
 			if (src.width <= dst.width && src.height <= dst.height) {
 				_ImageStretch::template stretch< _ImageStretch_Smooth<_ImageStretch_Smooth_LinearFilter> >(dst, src, blend);
@@ -1302,7 +1700,7 @@ namespace slib
 	Ref<Image> Image::loadFromFile(const String& filePath, sl_uint32 width, sl_uint32 height)
 	{
 		Ref<Image> ret;
-		Memory mem = File::readAllBytes(filePath);
+		Memory mem = MappedFile::mapAllBytes(filePath);
 		if (mem.isNotEmpty()) {
 			ret = loadFromMemory(mem, width, height);
 		}
@@ -1312,7 +1710,7 @@ namespace slib
 	Ref<Image> Image::loadFromAsset(const String& path, sl_uint32 width, sl_uint32 height)
 	{
 		Ref<Image> ret;
-		Memory mem = Assets::readAllBytes(path);
+		Memory mem = Assets::mapAllBytes(path);
 		if (mem.isNotEmpty()) {
 			ret = loadFromMemory(mem, width, height);
 		}
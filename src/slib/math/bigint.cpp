@@ -167,37 +167,6 @@ namespace slib
 	}
 
 
-	// c = c + a * b
-	SLIB_INLINE static sl_uint32 _cbigint_muladd_uint32(sl_uint32* c, const sl_uint32* s, sl_size m, const sl_uint32* a, sl_size n, sl_uint32 b, sl_uint32 o)
-	{
-		n = Math::min(m, n);
-		sl_uint32 of = o;
-		sl_size i;
-		for (i = 0; i < n; i++) {
-			sl_uint64 k = a[i];
-			k *= b;
-			k += of;
-			k += s[i];
-			c[i] = (sl_uint32)k;
-			of = (sl_uint32)(k >> 32);
-		}
-		if (c == s) {
-			for (i = n; i < m && of; i++) {
-				sl_uint32 sum = s[i] + of;
-				of = sum < of ? 1 : 0;
-				c[i] = sum;
-			}
-		} else {
-			for (i = n; i < m; i++) {
-				sl_uint32 sum = s[i] + of;
-				of = sum < of ? 1 : 0;
-				c[i] = sum;
-			}
-		}
-		return of;
-	}
-
-
 	// returns remainder
 	SLIB_INLINE static sl_uint32 _cbigint_div_uint32(sl_uint32* q, const sl_uint32* a, sl_size n, sl_uint32 b, sl_uint32 o)
 	{
@@ -336,6 +305,334 @@ namespace slib
 	}
 
 
+/*
+	64-bit limb arithmetic
+
+	Multiplication and Montgomery exponentiation work on 64-bit limbs packed from the
+	32-bit elements, using 128-bit intermediate products.
+	None of the routines below branch on limb values, so they can be used for the
+	constant-time exponentiation of private keys.
+*/
+
+#if defined(SLIB_COMPILER_IS_GCC) && defined(__SIZEOF_INT128__)
+#	define _CBIGINT64_USE_INT128
+#endif
+
+	// returns low 64 bits of (a * b + c + d), high 64 bits in `o_high`
+	SLIB_INLINE static sl_uint64 _cbigint64_mac(sl_uint64 a, sl_uint64 b, sl_uint64 c, sl_uint64 d, sl_uint64& o_high)
+	{
+#if defined(_CBIGINT64_USE_INT128)
+		unsigned __int128 m = ((unsigned __int128)a) * b + c + d;
+		o_high = (sl_uint64)(m >> 64);
+		return (sl_uint64)m;
+#else
+		sl_uint64 h, l;
+		Math::mul64(a, b, h, l);
+		l += c;
+		h += (l < c);
+		l += d;
+		h += (l < d);
+		o_high = h;
+		return l;
+#endif
+	}
+
+	static void _cbigint64_pack(sl_uint64* c, sl_size nc, const sl_uint32* a, sl_size na)
+	{
+		for (sl_size i = 0; i < nc; i++) {
+			sl_size k = i << 1;
+			sl_uint64 l = k < na ? a[k] : 0;
+			sl_uint64 h = k + 1 < na ? a[k + 1] : 0;
+			c[i] = l | (h << 32);
+		}
+	}
+
+	static void _cbigint64_unpack(sl_uint32* c, const sl_uint64* a, sl_size na)
+	{
+		for (sl_size i = 0; i < na; i++) {
+			c[i << 1] = (sl_uint32)(a[i]);
+			c[(i << 1) + 1] = (sl_uint32)(a[i] >> 32);
+		}
+	}
+
+	// c = a + b, returns carry
+	SLIB_INLINE static sl_uint64 _cbigint64_add(sl_uint64* c, const sl_uint64* a, const sl_uint64* b, sl_size n)
+	{
+		sl_uint64 of = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 s = a[i] + of;
+			of = s < of;
+			sl_uint64 t = s + b[i];
+			of += t < s;
+			c[i] = t;
+		}
+		return of;
+	}
+
+	// c = a - b, returns borrow
+	SLIB_INLINE static sl_uint64 _cbigint64_sub(sl_uint64* c, const sl_uint64* a, const sl_uint64* b, sl_size n)
+	{
+		sl_uint64 of = 0;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 x = a[i];
+			sl_uint64 y = b[i];
+			sl_uint64 t = x - y - of;
+			of = (x < y) | ((x == y) & of);
+			c[i] = t;
+		}
+		return of;
+	}
+
+	// c[0~nc) += a[0~na) (na <= nc), returns carry
+	SLIB_INLINE static sl_uint64 _cbigint64_add_into(sl_uint64* c, sl_size nc, const sl_uint64* a, sl_size na)
+	{
+		sl_uint64 of = _cbigint64_add(c, c, a, na);
+		for (sl_size i = na; i < nc; i++) {
+			sl_uint64 t = c[i] + of;
+			of = t < of;
+			c[i] = t;
+		}
+		return of;
+	}
+
+	// c = c + (a ^ mask) + (mask & 1): adds `a` when mask is 0, subtracts `a` when mask is all ones
+	SLIB_INLINE static void _cbigint64_add_masked(sl_uint64* c, const sl_uint64* a, sl_size n, sl_uint64 mask)
+	{
+		sl_uint64 of = mask & 1;
+		for (sl_size i = 0; i < n; i++) {
+			sl_uint64 s = (a[i] ^ mask) + of;
+			of = s < of;
+			sl_uint64 t = c[i] + s;
+			of += t < s;
+			c[i] = t;
+		}
+	}
+
+	// c = |a - b| (a: na limbs, b: nb limbs, nb <= na), returns 1 if a < b
+	SLIB_INLINE static sl_uint64 _cbigint64_abs_diff(sl_uint64* c, const sl_uint64* a, sl_size na, const sl_uint64* b, sl_size nb)
+	{
+		sl_uint64 of = _cbigint64_sub(c, a, b, nb);
+		sl_size i;
+		for (i = nb; i < na; i++) {
+			sl_uint64 x = a[i];
+			c[i] = x - of;
+			of = (x < of);
+		}
+		sl_uint64 mask = 0 - of;
+		sl_uint64 o = of;
+		for (i = 0; i < na; i++) {
+			sl_uint64 t = (c[i] ^ mask) + o;
+			o = t < o;
+			c[i] = t;
+		}
+		return of;
+	}
+
+	// c[0~n) += a[0~n) * b, returns carry
+	SLIB_INLINE static sl_uint64 _cbigint64_muladd_uint64(sl_uint64* c, const sl_uint64* a, sl_size n, sl_uint64 b)
+	{
+		sl_uint64 of = 0;
+		for (sl_size i = 0; i < n; i++) {
+			c[i] = _cbigint64_mac(a[i], b, c[i], of, of);
+		}
+		return of;
+	}
+
+	// c[0~na+nb) = a * b
+	static void _cbigint64_mul_school(sl_uint64* c, const sl_uint64* a, sl_size na, const sl_uint64* b, sl_size nb)
+	{
+		Base::zeroMemory(c, na * 8);
+		for (sl_size i = 0; i < nb; i++) {
+			c[na + i] = _cbigint64_muladd_uint64(c + i, a, na, b[i]);
+		}
+	}
+
+#define _CBIGINT64_KARATSUBA_THRESHOLD 32
+#define _CBIGINT64_KARATSUBA_SCRATCH(n) (8 * (n) + 64)
+
+	// c[0~2n) = a * b, `t` needs _CBIGINT64_KARATSUBA_SCRATCH(n) limbs
+	static void _cbigint64_mul_karatsuba(sl_uint64* c, const sl_uint64* a, const sl_uint64* b, sl_size n, sl_uint64* t)
+	{
+		if (n < _CBIGINT64_KARATSUBA_THRESHOLD) {
+			_cbigint64_mul_school(c, a, n, b, n);
+			return;
+		}
+		sl_size k = (n + 1) >> 1;
+		sl_size h = n - k;
+		sl_uint64* da = t;
+		sl_uint64* db = t + k;
+		sl_uint64* m = t + 2 * k;
+		sl_uint64* mid = m + 2 * k + 1;
+		sl_uint64* next = mid + 2 * k + 1;
+		// z0 = a0 * b0, z2 = a1 * b1
+		_cbigint64_mul_karatsuba(c, a, b, k, next);
+		_cbigint64_mul_karatsuba(c + 2 * k, a + k, b + k, h, next);
+		// m = |a0 - a1| * |b0 - b1|
+		sl_uint64 sa = _cbigint64_abs_diff(da, a, k, a + k, h);
+		sl_uint64 sb = _cbigint64_abs_diff(db, b, k, b + k, h);
+		_cbigint64_mul_karatsuba(m, da, db, k, next);
+		// z1 = z0 + z2 - (a0 - a1) * (b0 - b1)
+		Base::copyMemory(mid, c, 16 * k);
+		mid[2 * k] = _cbigint64_add_into(mid, 2 * k, c + 2 * k, 2 * h);
+		m[2 * k] = 0;
+		_cbigint64_add_masked(mid, m, 2 * k + 1, 0 - (1 ^ sa ^ sb));
+		_cbigint64_add_into(c + k, 2 * n - k, mid, Math::min(2 * k + 1, 2 * n - k));
+	}
+
+	// c[0~na+nb) = a * b, `t` needs (3 * nb + _CBIGINT64_KARATSUBA_SCRATCH(nb)) limbs
+	static void _cbigint64_mul(sl_uint64* c, const sl_uint64* a, sl_size na, const sl_uint64* b, sl_size nb, sl_uint64* t)
+	{
+		if (na < nb) {
+			_cbigint64_mul(c, b, nb, a, na, t);
+			return;
+		}
+		if (nb < _CBIGINT64_KARATSUBA_THRESHOLD) {
+			_cbigint64_mul_school(c, a, na, b, nb);
+			return;
+		}
+		if (na == nb) {
+			_cbigint64_mul_karatsuba(c, a, b, nb, t);
+			return;
+		}
+		// multiply by chunks of `nb` limbs
+		sl_uint64* p = t;
+		sl_uint64* pad = t + 2 * nb;
+		sl_uint64* next = pad + nb;
+		Base::zeroMemory(c, (na + nb) * 8);
+		for (sl_size i = 0; i < na; i += nb) {
+			sl_size n = Math::min(nb, na - i);
+			const sl_uint64* chunk = a + i;
+			if (n < nb) {
+				Base::copyMemory(pad, chunk, n * 8);
+				Base::zeroMemory(pad + n, (nb - n) * 8);
+				chunk = pad;
+			}
+			_cbigint64_mul_karatsuba(p, chunk, b, nb, next);
+			_cbigint64_add_into(c + i, na + nb - i, p, n + nb);
+		}
+	}
+
+#define _CBIGINT64_MUL_SCRATCH(n) (3 * (n) + _CBIGINT64_KARATSUBA_SCRATCH(n))
+
+	// c = (a >= m) ? a - m : a, where a = top * 2^(64n) + a[0~n), a < 2m
+	SLIB_INLINE static void _cbigint64_mont_final_sub(sl_uint64* c, const sl_uint64* a, sl_uint64 top, const sl_uint64* m, sl_size n, sl_uint64* t)
+	{
+		sl_uint64 borrow = _cbigint64_sub(t, a, m, n);
+		// keep `a` only when a - m underflows
+		sl_uint64 mask = (borrow & (top ^ 1)) - 1;
+		for (sl_size i = 0; i < n; i++) {
+			c[i] = (t[i] & mask) | (a[i] & ~mask);
+		}
+	}
+
+#define _CBIGINT64_MONT_KARATSUBA_THRESHOLD 48
+#define _CBIGINT64_MONT_SCRATCH(n) (3 * (n) + 2 + _CBIGINT64_KARATSUBA_SCRATCH(n))
+
+	/*
+		Montgomery multiplication: c = a * b * R^-1 mod m (R = 2^(64n))
+		a, b < m; `c` may alias `a` or `b`; `t` needs _CBIGINT64_MONT_SCRATCH(n) limbs
+	*/
+	static void _cbigint64_mont_mul(sl_uint64* c, const sl_uint64* a, const sl_uint64* b, const sl_uint64* m, sl_size n, sl_uint64 mi, sl_uint64* t)
+	{
+		sl_uint64* r;
+		sl_uint64 top;
+		if (n < _CBIGINT64_MONT_KARATSUBA_THRESHOLD) {
+			// CIOS: interleaves multiplication and reduction word by word
+			r = t;
+			Base::zeroMemory(r, (n + 1) * 8);
+			for (sl_size i = 0; i < n; i++) {
+				sl_uint64 bi = b[i];
+				sl_uint64 c1, c2;
+				sl_uint64 x = _cbigint64_mac(a[0], bi, r[0], 0, c1);
+				sl_uint64 u = x * mi;
+				_cbigint64_mac(u, m[0], x, 0, c2);
+				for (sl_size j = 1; j < n; j++) {
+					x = _cbigint64_mac(a[j], bi, r[j], c1, c1);
+					r[j - 1] = _cbigint64_mac(u, m[j], x, c2, c2);
+				}
+				sl_uint64 s = r[n] + c1;
+				sl_uint64 o = s < c1;
+				s += c2;
+				o += s < c2;
+				r[n - 1] = s;
+				r[n] = o;
+			}
+			top = r[n];
+		} else {
+			// Karatsuba product followed by separated reduction
+			sl_uint64* p = t;
+			_cbigint64_mul_karatsuba(p, a, b, n, t + 2 * n + 1);
+			top = 0;
+			for (sl_size i = 0; i < n; i++) {
+				sl_uint64 u = p[i] * mi;
+				sl_uint64 of = _cbigint64_muladd_uint64(p + i, m, n, u);
+				sl_uint64 s = p[i + n] + of;
+				sl_uint64 o = s < of;
+				s += top;
+				o += s < top;
+				p[i + n] = s;
+				top = o;
+			}
+			r = p + n;
+		}
+		_cbigint64_mont_final_sub(c, r, top, m, n, t + 2 * n + 1);
+	}
+
+	// returns -(m^-1) mod 2^64, m: odd
+	SLIB_INLINE static sl_uint64 _cbigint64_mont_inverse(sl_uint64 m)
+	{
+		// m * m = 1 mod 8, each Newton step doubles the correct bits
+		sl_uint64 k = m;
+		for (int i = 0; i < 5; i++) {
+			k *= 2 - m * k;
+		}
+		return 0 - k;
+	}
+
+	// c = table[index], scanning every entry
+	SLIB_INLINE static void _cbigint64_select(sl_uint64* c, const sl_uint64* table, sl_size count, sl_size n, sl_size index)
+	{
+		Base::zeroMemory(c, n * 8);
+		for (sl_size i = 0; i < count; i++) {
+			sl_uint64 d = (sl_uint64)(i ^ index);
+			// all ones when d is zero
+			sl_uint64 mask = ((d | (0 - d)) >> 63) - 1;
+			const sl_uint64* e = table + i * n;
+			for (sl_size k = 0; k < n; k++) {
+				c[k] |= e[k] & mask;
+			}
+		}
+	}
+
+	SLIB_INLINE static sl_uint32 _cbigint64_get_bits(const sl_uint32* e, sl_size ne, sl_size pos, sl_uint32 count)
+	{
+		sl_uint32 ret = 0;
+		for (sl_uint32 i = 0; i < count; i++) {
+			sl_size k = pos + i;
+			sl_size ke = k >> 5;
+			if (ke < ne) {
+				ret |= ((e[ke] >> (k & 31)) & 1) << i;
+			}
+		}
+		return ret;
+	}
+
+	SLIB_INLINE static sl_uint32 _cbigint64_get_window_size(sl_size nBits)
+	{
+		if (nBits > 671) {
+			return 6;
+		} else if (nBits > 239) {
+			return 5;
+		} else if (nBits > 79) {
+			return 4;
+		} else if (nBits > 23) {
+			return 3;
+		} else {
+			return 1;
+		}
+	}
+
+
 	SLIB_DEFINE_ROOT_OBJECT(CBigInt)
 
 	SLIB_INLINE void CBigInt::_free()
@@ -1427,35 +1724,35 @@ namespace slib
 		} else {
 			nd = getMostSignificantElements();
 		}
+		sl_size na64 = (na + 1) >> 1;
+		sl_size nb64 = (nb + 1) >> 1;
+		sl_size n64 = na64 + nb64;
+		SLIB_SCOPED_BUFFER(sl_uint64, STACK_BUFFER_SIZE, buf, n64 * 2 + _CBIGINT64_MUL_SCRATCH(Math::min(na64, nb64)));
+		if (!buf) {
+			return sl_false;
+		}
+		sl_uint64* a64 = buf;
+		sl_uint64* b64 = a64 + na64;
+		sl_uint64* out64 = b64 + nb64;
+		_cbigint64_pack(a64, na64, a.elements, na);
+		_cbigint64_pack(b64, nb64, b.elements, nb);
+		_cbigint64_mul(out64, a64, na64, b64, nb64, out64 + n64);
 		sl_size n = na + nb;
-		SLIB_SCOPED_BUFFER(sl_uint64, STACK_BUFFER_SIZE, out, n);
+		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, out, n64 * 2);
 		if (!out) {
 			return sl_false;
 		}
-		Base::zeroMemory(out, 8 * n);
-		for (sl_size ib = 0; ib < nb; ib++) {
-			for (sl_size ia = 0; ia < na; ia++) {
-				sl_uint64 c = a.elements[ia];
-				c *= b.elements[ib];
-				out[ia + ib] += (sl_uint32)c;
-				out[ia + ib + 1] += (sl_uint32)(c >> 32);
-			}
-		}
-		sl_uint32 o = 0;
+		_cbigint64_unpack(out, out64, n64);
 		sl_size i;
 		sl_size m = 0;
 		for (i = 0; i < n; i++) {
-			sl_uint64 c = out[i] + o;
-			sl_uint32 t = (sl_uint32)c;
-			out[i] = t;
-			if (t) {
+			if (out[i]) {
 				m = i;
 			}
-			o = (sl_uint32)(c >> 32);
 		}
 		if (growLength(m + 1)) {
 			for (i = 0; i <= m; i++) {
-				elements[i] = (sl_uint32)(out[i]);
+				elements[i] = out[i];
 			}
 			for (; i < nd; i++) {
 				elements[i] = 0;
@@ -2002,51 +2299,7 @@ namespace slib
 		return pow(*this, E);
 	}
 
-/*
-	Montgomery multiplication: A = A * B * R^-1 mod M
-*/
-	static sl_bool _cbigint_mont_mul(CBigInt& A, const CBigInt& B, const CBigInt& M, sl_uint32 MI)
-	{
-		sl_size nM = M.length;
-		sl_size nB = Math::min(nM, B.length);
-		
-		sl_size nOut = nM * 2 + 1;
-		SLIB_SCOPED_BUFFER(sl_uint32, STACK_BUFFER_SIZE, out, nOut);
-		if (!out) {
-			return sl_false;
-		}
-		Base::zeroMemory(out, nOut * 4);
-		for (sl_size i = 0; i < nM; i++) {
-			// T = (T + cB*B + cM*M) / 2^(32*nM)
-			sl_uint32 cB = i < A.length ? A.elements[i] : 0;
-			sl_uint32 cM = (out[0] + cB * B.elements[0]) * MI;
-			_cbigint_muladd_uint32(out, out, nOut, B.elements, nB, cB, 0);
-			_cbigint_muladd_uint32(out, out, nOut, M.elements, nM, cM, 0);
-			*out = cB;
-			nOut--;
-			out++;
-		}
-		if (!A.setValueFromElements(out, nM + 1)) {
-			return sl_false;
-		}
-		if (A.compareAbs(M) >= 0) {
-			if (!A.subAbs(A, M)) {
-				return sl_false;
-			}
-		}
-		return sl_true;
-	}
-
-/*
-	Montgomery reduction: A = A * R^-1 mod M
-*/
-	SLIB_INLINE static sl_bool _cbigint_mont_reduction(CBigInt& A, const CBigInt& M, sl_uint32 MI)
-	{
-		CBIGINT_UINT32(o, 1);
-		return _cbigint_mont_mul(A, o, M, MI);
-	}
-
-	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& _E, const CBigInt& _M)
+	sl_bool CBigInt::pow_montgomery(const CBigInt& A, const CBigInt& _E, const CBigInt& _M, sl_bool flagConstantTime)
 	{
 		CBigInt M;
 		M.copyFrom(_M);
@@ -2087,28 +2340,25 @@ namespace slib
 			setZero();
 			return sl_true;
 		}
-
-		// MI = -(M0^-1) mod (2^32)
-		sl_uint32 MI;
-		// initialize montgomery
-		{
-			sl_uint32 M0 = M.elements[0];
-			sl_uint32 K = M0;
-			K += ((M0 + 2) & 4) << 1;
-			for (sl_uint32 i = 32; i >= 8; i /= 2) {
-				K *= (2 - (M0 * K));
-			}
-			MI = 0 - K;
+		if (!(M.elements[0] & 1)) {
+			return pow(A, E, &M);
 		}
 
+		// montgomery domain works on 64-bit limbs, R = 2^(n*64)
+		sl_size n = (nM + 1) >> 1;
+		sl_size nbE = E.getMostSignificantBits();
+		// constant-time mode scans the exponent over the full modulus length
+		sl_size nbExp = flagConstantTime ? Math::max(nbE, n << 6) : nbE;
+		sl_uint32 nbWindow = _cbigint64_get_window_size(nbExp);
+		sl_size nTable = flagConstantTime ? ((sl_size)1 << nbWindow) : ((sl_size)1 << (nbWindow - 1));
+
 		// pre-compute R^2 mod M
-		// R = 2^(nM*32)
 		CBigInt R2;
 		{
 			if (!R2.setValue((sl_uint32)1)) {
 				return sl_false;
 			}
-			if (!R2.shiftLeft(nM * 64)) {
+			if (!R2.shiftLeft(n * 128)) {
 				return sl_false;
 			}
 			if (!CBigInt::divAbs(R2, M, sl_null, &R2)) {
@@ -2117,39 +2367,100 @@ namespace slib
 		}
 
 		sl_bool flagNegative = A.sign < 0;
-		// T = A * R^2 * R^-1 mod M = A * R mod M
 		CBigInt T;
 		if (!CBigInt::divAbs(A, M, sl_null, &T)) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_mul(T, R2, M, MI)) {
-			return sl_false;
-		}
 
-		// C = R^2 * R^-1 mod M = R mod M
-		if (!copyFrom(R2)) {
+		SLIB_SCOPED_BUFFER(sl_uint64, 1024, buf, n * (nTable + 5) + _CBIGINT64_MONT_SCRATCH(n));
+		if (!buf) {
 			return sl_false;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
-			return sl_false;
-		}
-
-		sl_size nbE = E.getMostSignificantBits();
-		for (sl_size ib = 0; ib < nbE; ib++) {
-			sl_size ke = ib >> 5;
-			sl_uint32 kb = (sl_uint32)(ib & 31);
-			if (((E.elements[ke]) >> kb) & 1) {
-				// C = C * T * R^-1 mod M
-				if (!_cbigint_mont_mul(*this, T, M, MI)) {
-					return sl_false;
+		sl_uint64* m = buf;
+		sl_uint64* r2 = m + n;
+		sl_uint64* x = r2 + n;
+		sl_uint64* c = x + n;
+		sl_uint64* s = c + n;
+		sl_uint64* table = s + n;
+		sl_uint64* t = table + n * nTable;
+		_cbigint64_pack(m, n, M.elements, nM);
+		_cbigint64_pack(r2, n, R2.elements, R2.getMostSignificantElements());
+		_cbigint64_pack(x, n, T.elements, T.getMostSignificantElements());
+
+		// MI = -(M0^-1) mod (2^64)
+		sl_uint64 MI = _cbigint64_mont_inverse(m[0]);
+
+		// X = A * R^2 * R^-1 mod M = A * R mod M
+		_cbigint64_mont_mul(x, x, r2, m, n, MI, t);
+
+		if (flagConstantTime) {
+			// fixed window: table[i] = X^i (i = 0 ~ 2^w-1), every window does w squarings and one multiplication
+			Base::zeroMemory(s, n * 8);
+			s[0] = 1;
+			_cbigint64_mont_mul(table, r2, s, m, n, MI, t);
+			Base::copyMemory(table + n, x, n * 8);
+			for (sl_size i = 2; i < nTable; i++) {
+				_cbigint64_mont_mul(table + i * n, table + (i - 1) * n, x, m, n, MI, t);
+			}
+			sl_size nWindows = (nbExp + nbWindow - 1) / nbWindow;
+			sl_size pos = (nWindows - 1) * nbWindow;
+			_cbigint64_select(c, table, nTable, n, _cbigint64_get_bits(E.elements, nE, pos, nbWindow));
+			while (pos > 0) {
+				pos -= nbWindow;
+				for (sl_uint32 k = 0; k < nbWindow; k++) {
+					_cbigint64_mont_mul(c, c, c, m, n, MI, t);
 				}
+				_cbigint64_select(s, table, nTable, n, _cbigint64_get_bits(E.elements, nE, pos, nbWindow));
+				_cbigint64_mont_mul(c, c, s, m, n, MI, t);
 			}
-			// T = T * T * R^-1 mod M
-			if (!_cbigint_mont_mul(T, T, M, MI)) {
-				return sl_false;
+		} else {
+			// sliding window: table[i] = X^(2i+1)
+			Base::copyMemory(table, x, n * 8);
+			if (nTable > 1) {
+				_cbigint64_mont_mul(s, x, x, m, n, MI, t);
+				for (sl_size i = 1; i < nTable; i++) {
+					_cbigint64_mont_mul(table + i * n, table + (i - 1) * n, s, m, n, MI, t);
+				}
 			}
+			sl_bool flagInit = sl_false;
+			sl_size ib = nbE;
+			while (ib > 0) {
+				sl_size high = ib - 1;
+				if (!((E.elements[high >> 5] >> (high & 31)) & 1)) {
+					_cbigint64_mont_mul(c, c, c, m, n, MI, t);
+					ib = high;
+					continue;
+				}
+				sl_size low = high + 1 > nbWindow ? high + 1 - nbWindow : 0;
+				while (!((E.elements[low >> 5] >> (low & 31)) & 1)) {
+					low++;
+				}
+				sl_uint32 len = (sl_uint32)(high - low + 1);
+				const sl_uint64* e = table + (_cbigint64_get_bits(E.elements, nE, low, len) >> 1) * n;
+				if (flagInit) {
+					for (sl_uint32 k = 0; k < len; k++) {
+						_cbigint64_mont_mul(c, c, c, m, n, MI, t);
+					}
+					_cbigint64_mont_mul(c, c, e, m, n, MI, t);
+				} else {
+					Base::copyMemory(c, e, n * 8);
+					flagInit = sl_true;
+				}
+				ib = low;
+			}
+		}
+
+		// C = C * 1 * R^-1 mod M
+		Base::zeroMemory(s, n * 8);
+		s[0] = 1;
+		_cbigint64_mont_mul(c, c, s, m, n, MI, t);
+
+		SLIB_SCOPED_BUFFER(sl_uint32, 1024, out, n * 2);
+		if (!out) {
+			return sl_false;
 		}
-		if (!_cbigint_mont_reduction(*this, M, MI)) {
+		_cbigint64_unpack(out, c, n);
+		if (!setValueFromElements(out, n * 2)) {
 			return sl_false;
 		}
 		if (flagNegative && (E.elements[0] & 1) != 0) {
@@ -2163,9 +2474,9 @@ namespace slib
 		return sl_true;
 	}
 
-	sl_bool CBigInt::pow_montgomery(const CBigInt& E, const CBigInt& M)
+	sl_bool CBigInt::pow_montgomery(const CBigInt& E, const CBigInt& M, sl_bool flagConstantTime)
 	{
-		return pow_montgomery(*this, E, M);
+		return pow_montgomery(*this, E, M, flagConstantTime);
 	}
 
 	sl_bool CBigInt::inverseMod(const CBigInt& A, const CBigInt& M)
@@ -3795,7 +4106,7 @@ namespace slib
 		return pow(E, &M);
 	}
 
-	BigInt BigInt::pow_montgomery(const BigInt& A, const BigInt& E, const BigInt& M)
+	BigInt BigInt::pow_montgomery(const BigInt& A, const BigInt& E, const BigInt& M, sl_bool flagConstantTime)
 	{
 		CBigInt* a = A.ref._ptr;
 		CBigInt* e = E.ref._ptr;
@@ -3807,7 +4118,7 @@ namespace slib
 				if (a) {
 					CBigInt* r = new CBigInt;
 					if (r) {
-						if (r->pow_montgomery(*a, *e, *m)) {
+						if (r->pow_montgomery(*a, *e, *m, flagConstantTime)) {
 							return r;
 						}
 						delete r;
@@ -3818,7 +4129,7 @@ namespace slib
 		return sl_null;
 	}
 
-	sl_bool BigInt::pow_montgomery(const BigInt& E, const BigInt& M)
+	sl_bool BigInt::pow_montgomery(const BigInt& E, const BigInt& M, sl_bool flagConstantTime)
 	{
 		CBigInt* a = ref._ptr;
 		CBigInt* e = E.ref._ptr;
@@ -3838,7 +4149,7 @@ namespace slib
 		} else {
 			if (m) {
 				if (a) {
-					return a->pow_montgomery(*a, *e, *m);
+					return a->pow_montgomery(*a, *e, *m, flagConstantTime);
 				} else {
 					return sl_true;
 				}
@@ -149,6 +149,8 @@ namespace slib
 	DEFINE_HTTP_HEADER(AcceptEncoding, "Accept-Encoding")
 	DEFINE_HTTP_HEADER(TransferEncoding, "Transfer-Encoding")
 	DEFINE_HTTP_HEADER(ContentEncoding, "Content-Encoding")
+	DEFINE_HTTP_HEADER(Connection, "Connection")
+	DEFINE_HTTP_HEADER(Vary, "Vary")
 
 	DEFINE_HTTP_HEADER(Range, "Range")
 	DEFINE_HTTP_HEADER(ContentRange, "Content-Range")
@@ -387,6 +389,16 @@ namespace slib
 		setRequestHeader(HttpHeaders::ContentEncoding, type);
 	}
 
+	String HttpRequest::getRequestAcceptEncoding() const
+	{
+		return getRequestHeader(HttpHeaders::AcceptEncoding);
+	}
+
+	void HttpRequest::setRequestAcceptEncoding(const String& type)
+	{
+		setRequestHeader(HttpHeaders::AcceptEncoding, type);
+	}
+
 	String HttpRequest::getRequestTransferEncoding() const
 	{
 		return getRequestHeader(HttpHeaders::TransferEncoding);
@@ -511,6 +523,27 @@ namespace slib
 		return m_postParameters.contains_NoLock(name);
 	}
 
+	const Map<String, String>& HttpRequest::getPathParameters() const
+	{
+		return m_pathParameters;
+	}
+
+	String HttpRequest::getPathParameter(const String& name) const
+	{
+		return m_pathParameters.getValue_NoLock(name, String::null());
+	}
+
+	sl_bool HttpRequest::containsPathParameter(const String& name) const
+	{
+		return m_pathParameters.contains_NoLock(name);
+	}
+
+	void HttpRequest::setPathParameter(const String& name, const String& value)
+	{
+		m_pathParameters.put_NoLock(name, value);
+		m_parameters.put_NoLock(name, value);
+	}
+
 	void HttpRequest::applyPostParameters(const void* data, sl_size size)
 	{
 		Map<String, String> params = parseParameters(data, size);
@@ -10,6 +10,8 @@
 
 #include "slib/network/http_io.h"
 
+#include "slib/core/json_writer.h"
+
 namespace slib
 {
 
@@ -44,6 +46,19 @@ namespace slib
 		m_bufferOutput.write(mem);
 	}
 
+	sl_bool HttpOutputBuffer::writeJson(const Json& json)
+	{
+		JsonWriter writer;
+		if (!(writer.writeValue(json))) {
+			return sl_false;
+		}
+		ListElements<Memory> chunks(writer.getOutputChunks());
+		for (sl_size i = 0; i < chunks.count; i++) {
+			m_bufferOutput.write(chunks[i]);
+		}
+		return sl_true;
+	}
+
 	void HttpOutputBuffer::copyFrom(AsyncStream* stream, sl_uint64 size)
 	{
 		m_bufferOutput.copyFrom(stream, size);
@@ -64,6 +79,11 @@ namespace slib
 		return m_bufferOutput.getOutputLength();
 	}
 
+	sl_bool HttpOutputBuffer::getMemoryOutput(List<Memory>& output)
+	{
+		return m_bufferOutput.getMemoryOutput(output);
+	}
+
 /***********************************************************************
 						HttpHeaderReader
 ***********************************************************************/
@@ -89,15 +109,16 @@ namespace slib
 			posBody = 1;
 			flagFound = sl_true;
 		}
-		if (size > 1 && m_last[1] == '\r' && m_last[2] == '\n' && buf[0] == '\r' && buf[1] == '\n') {
+		if (!flagFound && size > 1 && m_last[1] == '\r' && m_last[2] == '\n' && buf[0] == '\r' && buf[1] == '\n') {
 			posBody = 2;
 			flagFound = sl_true;
 		}
-		if (size > 2 && m_last[2] == '\r' && buf[0] == '\n' && buf[1] == '\r' && buf[2] == '\n') {
+		if (!flagFound && size > 2 && m_last[2] == '\r' && buf[0] == '\n' && buf[1] == '\r' && buf[2] == '\n') {
 			posBody = 3;
 			flagFound = sl_true;
 		}
-		if (size > 3) {
+		// the first terminator wins: pipelined requests may follow in the same buffer
+		if (!flagFound && size > 3) {
 			for (sl_size i = 0; i <= size - 4; i++) {
 				if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
 					posBody = 4 + i;
@@ -207,17 +228,16 @@ namespace slib
 															   sl_bool flagDecompress)
 	{
 		Ref<_HttpContentReader_Persistent> ret = new _HttpContentReader_Persistent;
-		if (io.isNull()) {
-			return ret;
-		}
-		if (contentLength == 0 || bufferSize == 0) {
+		if (contentLength == 0) {
 			return ret;
 		}
 		if (ret.isNotNull()) {
 			ret->m_sizeTotal = contentLength;
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull() && bufferSize > 0) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -375,16 +395,12 @@ namespace slib
 															sl_bool flagDecompress)
 	{
 		Ref<_HttpContentReader_Chunked> ret = new _HttpContentReader_Chunked;
-		if (io.isNull()) {
-			return ret;
-		}
-		if (bufferSize == 0) {
-			return ret;
-		}
 		if (ret.isNotNull()) {
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull() && bufferSize > 0) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -409,16 +425,12 @@ namespace slib
 															 sl_bool flagDecompress)
 	{
 		Ref<_HttpContentReader_TearDown> ret = new _HttpContentReader_TearDown;
-		if (io.isNull()) {
-			return ret;
-		}
-		if (bufferSize == 0) {
-			return ret;
-		}
 		if (ret.isNotNull()) {
 			ret->m_listener = listener;
-			ret->setReadingBufferSize(bufferSize);
-			ret->setSourceStream(io);
+			if (io.isNotNull() && bufferSize > 0) {
+				ret->setReadingBufferSize(bufferSize);
+				ret->setSourceStream(io);
+			}
 			if (flagDecompress) {
 				if (!(ret->setDecompressing())) {
 					ret.setNull();
@@ -433,6 +445,15 @@ namespace slib
 		return m_flagDecompressing;
 	}
 
+	Memory HttpContentReader::decodeData(void* data, sl_uint32 size, Referable* refData)
+	{
+		if (size == 0) {
+			return sl_null;
+		}
+		MutexLocker lock(&m_lockReading);
+		return filterRead(data, size, refData);
+	}
+
 	void HttpContentReader::onReadStream(AsyncStreamResult* result)
 	{
 		if (result->flagError) {
@@ -13,9 +13,11 @@
 #include "slib/network/url.h"
 #include "slib/core/asset.h"
 #include "slib/core/file.h"
+#include "slib/core/mapped_file.h"
 #include "slib/core/log.h"
 #include "slib/core/json.h"
 #include "slib/core/content_type.h"
+#include "slib/crypto/zlib.h"
 
 #define SERVICE_TAG "HTTP SERVICE"
 
@@ -103,6 +105,10 @@ namespace slib
 
 	Ref<AsyncIoLoop> HttpServiceContext::getAsyncIoLoop()
 	{
+		Ref<AsyncStream> io = getIO();
+		if (io.isNotNull()) {
+			return io->getIoLoop();
+		}
 		Ref<HttpService> service = getService();
 		if (service.isNotNull()) {
 			return service->getAsyncIoLoop();
@@ -149,16 +155,56 @@ namespace slib
 		}
 	}
 
+	void HttpServiceContext::_reset()
+	{
+		SLIB_STATIC_STRING(sVersion, "HTTP/1.1");
+		SLIB_STATIC_STRING(sMethod, "GET");
+		SLIB_STATIC_STRING(sOK, "OK");
+		
+		m_method = HttpMethod::GET;
+		m_methodText = sMethod;
+		m_methodTextUpper = sMethod;
+		m_path.setNull();
+		m_query.setNull();
+		m_requestVersion = sVersion;
+		m_requestHeaders.removeAll_NoLock();
+		m_parameters.setNull();
+		m_queryParameters.setNull();
+		m_postParameters.setNull();
+		m_pathParameters.setNull();
+		
+		m_responseCode = HttpStatus::OK;
+		m_responseMessage = sOK;
+		m_responseVersion = sVersion;
+		m_responseHeaders.removeAll_NoLock();
+		clearOutput();
+		
+		m_requestHeaderReader.clear();
+		m_requestHeader.setNull();
+		m_requestContentLength = 0;
+		m_requestBodyBuffer.clear();
+		m_requestBody.setNull();
+		m_flagAsynchronousResponse = sl_false;
+		setClosingConnection(sl_false);
+		clearAllProperties();
+	}
+
 /******************************************************
 			HttpServiceConnection
 ******************************************************/
 #define SIZE_READ_BUF 0x10000
 #define SIZE_COPY_BUF 0x10000
+#define MAX_QUEUED_CONTEXTS 32
+#define MAX_FREE_CONTEXTS 8
 
 	HttpServiceConnection::HttpServiceConnection()
 	{
 		m_flagClosed = sl_true;
 		m_flagReading = sl_false;
+		m_flagInputSuspended = sl_false;
+		m_flagProcessing = sl_false;
+		m_flagDispatching = sl_false;
+		m_flagPreprocessingDeferred = sl_false;
 	}
 
 	HttpServiceConnection::~HttpServiceConnection()
@@ -206,16 +252,28 @@ namespace slib
 		}
 		m_io->close();
 		m_output->close();
+		m_contextsQueued.removeAll_NoLock();
+		m_contextPreprocessing.setNull();
+		m_inputPreprocessing.setNull();
 	}
 
 	void HttpServiceConnection::start(const void* data, sl_uint32 size)
 	{
 		m_contextCurrent.setNull();
+		m_flagInputSuspended = sl_false;
+		{
+			ObjectLocker lock(this);
+			m_flagPreprocessingDeferred = sl_false;
+			m_contextPreprocessing.setNull();
+			m_inputPreprocessing.setNull();
+		}
 		if (data && size > 0) {
-			_processInput(data, size);
-		} else {
-			_read();
+			if (!(_processInput(data, size, sl_null))) {
+				return;
+			}
+			_processQueue(sl_false);
 		}
+		_read();
 	}
 
 	Ref<AsyncStream> HttpServiceConnection::getIO()
@@ -239,9 +297,26 @@ namespace slib
 		if (m_flagClosed) {
 			return;
 		}
-		if (m_flagReading) {
+		if (m_flagReading || m_flagInputSuspended) {
 			return;
 		}
+		// back-pressure: the pipelined requests are not read any more until the queued ones are answered
+		if (m_contextsQueued.getCount() >= MAX_QUEUED_CONTEXTS) {
+			return;
+		}
+		if (m_bufRead.isNull()) {
+			// the last buffer is still referenced by the header/body views of the living contexts
+			if (m_bufReadBusy.isNotNull() && m_bufReadBusy.ref->getReferenceCount() == 1) {
+				m_bufRead = m_bufReadBusy;
+				m_bufReadBusy.setNull();
+			} else {
+				m_bufRead = Memory::create(SIZE_READ_BUF);
+				if (m_bufRead.isNull()) {
+					close();
+					return;
+				}
+			}
+		}
 		m_flagReading = sl_true;
 		if (!(m_io->readToMemory(m_bufRead, SLIB_FUNCTION_WEAKREF(HttpServiceConnection, onReadStream, this)))) {
 			m_flagReading = sl_false;
@@ -249,14 +324,14 @@ namespace slib
 		}
 	}
 
-	void HttpServiceConnection::_processInput(const void* _data, sl_uint32 size)
+	sl_bool HttpServiceConnection::_processInput(const void* _data, sl_uint32 size, Referable* refData)
 	{
 		Ref<HttpService> service = m_service;
 		if (service.isNull()) {
-			return;
+			return sl_false;
 		}
 		if (m_flagClosed) {
-			return;
+			return sl_false;
 		}
 		
 		const HttpServiceParam& param = service->getParam();
@@ -264,95 +339,225 @@ namespace slib
 		sl_uint64 maxRequestBodySize = param.maxRequestBodySize;
 
 		char* data = (char*)_data;
-		Ref<HttpServiceContext> _context = m_contextCurrent;
-		if (_context.isNull()) {
-			_context = HttpServiceContext::create(this);
+		sl_uint32 offset = 0;
+		
+		// all the complete requests in the input are parsed up front, and queued to be answered in order
+		while (offset < size) {
+			
+			Ref<HttpServiceContext> _context = m_contextCurrent;
 			if (_context.isNull()) {
-				sendResponse_ServerError();
-				return;
-			}
-			m_contextCurrent = _context;
-			_context->setProcessingByThread(param.flagProcessByThreads);
-		}
-		HttpServiceContext* context = _context.get();
-		if (context->m_requestHeader.isEmpty()) {
-			sl_size posBody;
-			if (context->m_requestHeaderReader.add(data, size, posBody)) {
-				context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
-				if (context->m_requestHeader.isEmpty()) {
+				_context = _createContext(param);
+				if (_context.isNull()) {
 					sendResponse_ServerError();
-					return;
+					return sl_false;
 				}
-				if (posBody > size) {
-					sendResponse_ServerError();
-					return;
+				m_contextCurrent = _context;
+			}
+			HttpServiceContext* context = _context.get();
+			
+			char* input = data + offset;
+			sl_uint32 sizeInput = size - offset;
+			
+			if (context->m_requestHeader.isEmpty()) {
+				sl_size sizeHeader = 0;
+				if (context->m_requestHeaderReader.getHeaderSize() == 0) {
+					// fast path: the whole header is in the input, so the header is viewed without copying
+					if (sizeInput > 3) {
+						for (sl_uint32 i = 0; i <= sizeInput - 4; i++) {
+							if (input[i] == '\r' && input[i + 1] == '\n' && input[i + 2] == '\r' && input[i + 3] == '\n') {
+								sizeHeader = i + 4;
+								break;
+							}
+						}
+					}
+					if (sizeHeader) {
+						if (refData) {
+							context->m_requestHeader = Memory::createStatic(input, sizeHeader, refData);
+						} else {
+							context->m_requestHeader = Memory::create(input, sizeHeader);
+						}
+					}
+				}
+				if (!sizeHeader) {
+					if (context->m_requestHeaderReader.add(input, sizeInput, sizeHeader)) {
+						if (sizeHeader > sizeInput) {
+							sendResponse_ServerError();
+							return sl_false;
+						}
+						context->m_requestHeader = context->m_requestHeaderReader.mergeHeader();
+						context->m_requestHeaderReader.clear();
+					} else {
+						if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
+							sendResponse_BadRequest();
+							return sl_false;
+						}
+						break;
+					}
 				}
-				context->m_requestHeaderReader.clear();
 				Memory header = context->getRawRequestHeader();
+				if (header.isEmpty()) {
+					sendResponse_ServerError();
+					return sl_false;
+				}
+				if (header.getSize() > maxRequestHeadersSize) {
+					sendResponse_BadRequest();
+					return sl_false;
+				}
+				offset += (sl_uint32)sizeHeader;
+				input += sizeHeader;
+				sizeInput -= (sl_uint32)sizeHeader;
 				sl_reg iRet = context->parseRequestPacket(header.getData(), header.getSize());
-				if (iRet != (sl_reg)(context->m_requestHeader.getSize())) {
+				if (iRet != (sl_reg)(header.getSize())) {
 					sendResponse_BadRequest();
-					return;
+					return sl_false;
 				}
 				context->m_requestContentLength = context->getRequestContentLengthHeader();
 				if (context->m_requestContentLength > maxRequestBodySize) {
 					sendResponse_BadRequest();
-					return;
-				}
-				context->m_requestBody = Memory::create(data + posBody, size - (sl_uint32)posBody);
-				if (!(context->m_requestBodyBuffer.add(context->m_requestBody))) {
-					sendResponse_ServerError();
-					return;
+					return sl_false;
 				}
 				context->applyQueryToParameters();
+				sl_bool flagBusy;
+				{
+					ObjectLocker lock(this);
+					flagBusy = m_flagProcessing || m_contextsQueued.isNotEmpty();
+				}
+				if (flagBusy || m_output->isWriting()) {
+					// the service may take over the connection, so `preprocessRequest()` is called
+					// after the previous requests are answered and their responses are written (see `_resumePreprocessing()`)
+					ObjectLocker lock(this);
+					m_contextPreprocessing = _context;
+					m_inputPreprocessing = Memory::create(input, sizeInput);
+					if (sizeInput && m_inputPreprocessing.isNull()) {
+						lock.unlock();
+						sendResponse_ServerError();
+						return sl_false;
+					}
+					m_flagInputSuspended = sl_true;
+					m_flagPreprocessingDeferred = sl_true;
+					return sl_true;
+				}
 				if (service->preprocessRequest(context)) {
-					return;
+					// the service is processing the connection itself, starting with the rest of the input
+					m_contextCurrent.setNull();
+					m_flagInputSuspended = sl_true;
+					context->m_requestBody = Memory::create(input, sizeInput);
+					return sl_false;
 				}
-			} else {
-				if (context->m_requestHeaderReader.getHeaderSize() > maxRequestHeadersSize) {
-					sendResponse_BadRequest();
-					return;
+			}
+			
+			sl_uint64 sizeBody = context->m_requestContentLength;
+			if (sizeBody > 0) {
+				sl_uint64 sizeReceived = context->m_requestBodyBuffer.getSize();
+				if (sizeReceived == 0 && sizeBody <= sizeInput) {
+					// fast path: the whole body is in the input
+					if (refData) {
+						context->m_requestBody = Memory::createStatic(input, (sl_size)sizeBody, refData);
+					} else {
+						context->m_requestBody = Memory::create(input, (sl_size)sizeBody);
+					}
+					if (context->m_requestBody.isNull()) {
+						sendResponse_ServerError();
+						return sl_false;
+					}
+					offset += (sl_uint32)sizeBody;
+				} else {
+					sl_uint32 n = sizeInput;
+					if (sizeBody - sizeReceived < n) {
+						n = (sl_uint32)(sizeBody - sizeReceived);
+					}
+					if (n > 0) {
+						if (!(context->m_requestBodyBuffer.add(Memory::create(input, n)))) {
+							sendResponse_ServerError();
+							return sl_false;
+						}
+						offset += n;
+					}
+					if (context->m_requestBodyBuffer.getSize() < sizeBody) {
+						break;
+					}
+					context->m_requestBody = context->m_requestBodyBuffer.merge();
+					if (context->m_requestBody.isEmpty()) {
+						sendResponse_ServerError();
+						return sl_false;
+					}
+					context->m_requestBodyBuffer.clear();
 				}
 			}
-		} else {
-			if (!(context->m_requestBodyBuffer.add(Memory::create(data, size)))) {
-				sendResponse_ServerError();
-				return;
+			
+			m_contextCurrent.setNull();
+			
+			if (context->getMethod() == HttpMethod::POST) {
+				String reqContentType = context->getRequestContentTypeNoParams();
+				if (reqContentType == ContentTypes::WebForm) {
+					Memory body = context->getRequestBody();
+					context->applyPostParameters(body.getData(), body.getSize());
+				}
 			}
+			
+			ObjectLocker lock(this);
+			m_contextsQueued.pushBack_NoLock(_context);
 		}
-		if (context->m_requestHeader.isNotEmpty()) {
-			if (context->m_requestBodyBuffer.getSize() >= context->m_requestContentLength) {
+		return sl_true;
+	}
 
-				m_contextCurrent.setNull();
+	Ref<HttpServiceContext> HttpServiceConnection::_createContext(const HttpServiceParam& param)
+	{
+		Ref<HttpServiceContext> context;
+		{
+			ObjectLocker lock(this);
+			m_contextsFree.popFront_NoLock(&context);
+		}
+		if (context.isNull()) {
+			context = HttpServiceContext::create(this);
+			if (context.isNull()) {
+				return sl_null;
+			}
+		}
+		context->setProcessingByThread(param.flagProcessByThreads);
+		return context;
+	}
 
-				context->m_requestBody = context->m_requestBodyBuffer.merge();
-				if (context->m_requestContentLength > 0 && context->m_requestBody.isEmpty()) {
-					sendResponse_ServerError();
-					return;
+	void HttpServiceConnection::_processQueue(sl_bool flagCurrentThread)
+	{
+		{
+			ObjectLocker lock(this);
+			if (m_flagDispatching) {
+				return;
+			}
+			m_flagDispatching = sl_true;
+		}
+		// only one context is processed at a time, so that the responses are written in the order of the requests
+		for (;;) {
+			Ref<HttpServiceContext> context;
+			{
+				ObjectLocker lock(this);
+				if (m_flagClosed || m_flagProcessing || !(m_contextsQueued.popFront_NoLock(&context))) {
+					m_flagDispatching = sl_false;
+					break;
 				}
-				context->m_requestBodyBuffer.clear();
-
-				if (context->getMethod() == HttpMethod::POST) {
-					String reqContentType = context->getRequestContentTypeNoParams();
-					if (reqContentType == ContentTypes::WebForm) {
-						Memory body = context->getRequestBody();
-						context->applyPostParameters(body.getData(), body.getSize());
-					}
+				m_flagProcessing = sl_true;
+			}
+			if (context->isProcessingByThread() && !flagCurrentThread) {
+				Ref<HttpService> service = getService();
+				Ref<ThreadPool> threadPool;
+				if (service.isNotNull()) {
+					threadPool = service->getThreadPool();
 				}
-				
-				if (context->isProcessingByThread()) {
-					Ref<ThreadPool> threadPool = service->getThreadPool();
-					if (threadPool.isNotNull()) {
-						threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, _context));
-					} else {
-						sendResponse_ServerError();
-						return;
+				if (threadPool.isNull() || !(threadPool->addTask(SLIB_BIND_WEAKREF(void(), HttpServiceConnection, _processContext, this, context)))) {
+					{
+						ObjectLocker lock(this);
+						m_flagDispatching = sl_false;
+						m_flagProcessing = sl_false;
 					}
-				} else {
-					_processContext(context);
+					sendResponse_ServerError();
+					return;
 				}
+			} else {
+				_processContext(context);
 			}
 		}
+		_resumePreprocessing();
 		_read();
 	}
 
@@ -374,11 +579,15 @@ namespace slib
 
 	void HttpServiceConnection::_completeResponse(HttpServiceContext* context)
 	{
-		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
 		String oldResponseContentType = context->getResponseContentType();
 		if (oldResponseContentType.isEmpty()) {
 			context->setResponseContentType(ContentTypes::TextHtml_Utf8);
 		}
+		Ref<HttpService> service = m_service;
+		if (service.isNotNull()) {
+			service->compressResponse(context);
+		}
+		context->setResponseHeader(HttpHeaders::ContentLength, String::fromUint64(context->getResponseContentLength()));
 		Memory header = context->makeResponsePacket();
 		if (header.isEmpty()) {
 			close();
@@ -390,21 +599,134 @@ namespace slib
 		}
 		m_output->mergeBuffer(&(context->m_bufferOutput));
 		m_output->startWriting();
-		start();
+		
+		sl_bool flagDispatch;
+		{
+			ObjectLocker lock(this);
+			m_flagProcessing = sl_false;
+			if (m_contextsFinished.getCount() < MAX_FREE_CONTEXTS) {
+				m_contextsFinished.pushBack_NoLock(context);
+			}
+			flagDispatch = !m_flagDispatching;
+		}
+		if (flagDispatch) {
+			// completed outside of the dispatching loop
+			if (context->isProcessingByThread()) {
+				// the pipelined requests are processed on the current thread, without passing through the thread pool again
+				_processQueue(sl_true);
+			} else {
+				Ref<AsyncIoLoop> loop = m_io->getIoLoop();
+				if (loop.isNotNull()) {
+					loop->addTask(SLIB_INLINE_BIND_WEAKREF(void(), HttpServiceConnection, _processQueue, this, sl_false));
+				}
+			}
+		}
+	}
+
+	void HttpServiceConnection::_recycleContexts()
+	{
+		ObjectLocker lock(this);
+		Link< Ref<HttpServiceContext> >* link = m_contextsFinished.getFront();
+		while (link) {
+			Link< Ref<HttpServiceContext> >* next = link->next;
+			HttpServiceContext* context = link->value.get();
+			// recycled only when nobody else is holding the finished context
+			if (context->getReferenceCount() == 1) {
+				if (m_contextsFree.getCount() < MAX_FREE_CONTEXTS) {
+					context->_reset();
+					m_contextsFree.pushBack_NoLock(link->value);
+				}
+				m_contextsFinished.removeItem_NoLock(link);
+			}
+			link = next;
+		}
+	}
+
+	void HttpServiceConnection::_resumePreprocessing()
+	{
+		if (!m_flagPreprocessingDeferred) {
+			return;
+		}
+		// checked outside of the connection lock: `close()` locks the output while holding it
+		if (m_output->isWriting()) {
+			// resumed by `onAsyncOutputComplete()`
+			return;
+		}
+		Ref<HttpServiceContext> context;
+		Memory input;
+		{
+			ObjectLocker lock(this);
+			if (m_flagClosed || m_flagProcessing || m_contextsQueued.isNotEmpty() || m_contextPreprocessing.isNull()) {
+				return;
+			}
+			context = m_contextPreprocessing;
+			input = m_inputPreprocessing;
+			m_contextPreprocessing.setNull();
+			m_inputPreprocessing.setNull();
+			m_flagPreprocessingDeferred = sl_false;
+		}
+		Ref<HttpService> service = m_service;
+		if (service.isNull()) {
+			return;
+		}
+		if (service->preprocessRequest(context)) {
+			// the service is processing the connection itself, starting with the rest of the input
+			m_contextCurrent.setNull();
+			context->m_requestBody = input;
+			return;
+		}
+		m_flagInputSuspended = sl_false;
+		if (input.isNotNull()) {
+			if (!(_processInput(input.getData(), (sl_uint32)(input.getSize()), input.ref.get()))) {
+				return;
+			}
+			_processQueue(sl_false);
+		}
+		_read();
 	}
 
 	void HttpServiceConnection::onReadStream(AsyncStreamResult* result)
 	{
-		m_flagReading = sl_false;
 		if (result->flagError) {
+			m_flagReading = sl_false;
 			close();
-		} else {
-			_processInput(result->data, result->size);
+			return;
 		}
+		Memory buf;
+		{
+			ObjectLocker lock(this);
+			buf = m_bufRead;
+			m_bufRead.setNull();
+		}
+		sl_reg nRefsBuf = buf.ref->getReferenceCount();
+		if (_processInput(result->data, result->size, buf.ref.get())) {
+			_processQueue(sl_false);
+		}
+		_recycleContexts();
+		{
+			ObjectLocker lock(this);
+			// the buffer is reused only when no view into it has survived the processing
+			if (m_bufRead.isNull()) {
+				if (buf.ref->getReferenceCount() == nRefsBuf) {
+					m_bufRead = buf;
+				} else {
+					m_bufReadBusy = buf;
+				}
+			}
+			m_flagReading = sl_false;
+		}
+		_read();
 	}
 
 	void HttpServiceConnection::onAsyncOutputComplete(AsyncOutput* output)
 	{
+		// called while the output is locked; a deferral missed here is resumed by `_processQueue()`
+		if (m_flagPreprocessingDeferred) {
+			Ref<AsyncIoLoop> loop = m_io->getIoLoop();
+			if (loop.isNotNull()) {
+				loop->addTask(SLIB_INLINE_BIND_WEAKREF(void(), HttpServiceConnection, _resumePreprocessing, this));
+			}
+		}
 	}
 
 	void HttpServiceConnection::onAsyncOutputError(AsyncOutput* output)
@@ -497,6 +819,12 @@ namespace slib
 			HttpServiceConnectionProvider
 ******************************************************/
 
+// SO_REUSEPORT distributes the connections over the listeners only on Linux;
+// elsewhere it is mapped to SO_REUSEADDR (Windows, Android, Tizen) or the last listener gets all the connections (BSD, macOS)
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID) && !defined(SLIB_PLATFORM_IS_TIZEN)
+#define HTTP_SERVICE_SHARDED_LISTEN
+#endif
+
 	HttpServiceConnectionProvider::HttpServiceConnectionProvider()
 	{
 	}
@@ -518,12 +846,14 @@ namespace slib
 	class _DefaultHttpServiceConnectionProvider : public HttpServiceConnectionProvider, public IAsyncTcpServerListener
 	{
 	public:
-		Ref<AsyncTcpServer> m_server;
-		Ref<AsyncIoLoop> m_loop;
+		List< Ref<AsyncTcpServer> > m_servers;
+		Ref<AsyncIoLoopGroup> m_loops;
+		sl_bool m_flagShardedListen;
 
 	public:
 		_DefaultHttpServiceConnectionProvider()
 		{
+			m_flagShardedListen = sl_false;
 		}
 
 		~_DefaultHttpServiceConnectionProvider()
@@ -534,19 +864,39 @@ namespace slib
 	public:
 		static Ref<HttpServiceConnectionProvider> create(HttpService* service, const SocketAddress& addressListen)
 		{
-			Ref<AsyncIoLoop> loop = service->getAsyncIoLoop();
-			if (loop.isNotNull()) {
+			Ref<AsyncIoLoopGroup> loops = service->getAsyncIoLoopGroup();
+			if (loops.isNotNull()) {
+				sl_uint32 nLoops = loops->getLoopsCount();
+				if (nLoops == 0) {
+					return sl_null;
+				}
 				Ref<_DefaultHttpServiceConnectionProvider> ret = new _DefaultHttpServiceConnectionProvider;
 				if (ret.isNotNull()) {
-					ret->m_loop = loop;
+					ret->m_loops = loops;
 					ret->setService(service);
 					AsyncTcpServerParam sp;
 					sp.bindAddress = addressListen;
 					sp.listener.setWeak(ret);
-					sp.ioLoop = loop;
-					Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
-					if (server.isNotNull()) {
-						ret->m_server = server;
+#ifdef HTTP_SERVICE_SHARDED_LISTEN
+					sp.flagReusePort = nLoops > 1;
+					sl_uint32 nListeners = nLoops;
+#else
+					// one listener distributes the accepted connections over the loops
+					sl_uint32 nListeners = 1;
+#endif
+					for (sl_uint32 i = 0; i < nListeners; i++) {
+						sp.ioLoop = loops->getLoop(i);
+						// the following listeners are optional: if the kernel rejects SO_REUSEPORT, the first listener distributes the connections
+						sp.flagLogError = i == 0;
+						Ref<AsyncTcpServer> server = AsyncTcpServer::create(sp);
+						if (server.isNull()) {
+							break;
+						}
+						ret->m_servers.add_NoLock(server);
+					}
+					sl_size nServers = ret->m_servers.getCount();
+					if (nServers > 0) {
+						ret->m_flagShardedListen = nLoops > 1 && nServers == nLoops;
 						return ret;
 					}
 				}
@@ -557,8 +907,9 @@ namespace slib
 		void release()
 		{
 			ObjectLocker lock(this);
-			if (m_server.isNotNull()) {
-				m_server->close();
+			ListElements< Ref<AsyncTcpServer> > servers(m_servers);
+			for (sl_size i = 0; i < servers.count; i++) {
+				servers[i]->close();
 			}
 		}
 
@@ -566,10 +917,21 @@ namespace slib
 		{
 			Ref<HttpService> service = getService();
 			if (service.isNotNull()) {
-				Ref<AsyncIoLoop> loop = m_loop;
+				// the accepted socket is pinned to the loop of its listener, so the connection is processed on the single thread
+				Ref<AsyncIoLoop> loop;
+				if (m_flagShardedListen) {
+					loop = socketListen->getIoLoop();
+				} else {
+					Ref<AsyncIoLoopGroup> loops = m_loops;
+					if (loops.isNotNull()) {
+						loop = loops->getNextLoop();
+					}
+				}
 				if (loop.isNull()) {
 					return;
 				}
+				// the response header and the content are written separately, and should not wait for the delayed ACK of the kept-alive clients
+				socketAccept->setOption_TcpNoDelay(sl_true);
 				AsyncTcpSocketParam cp;
 				cp.socket = socketAccept;
 				cp.ioLoop = loop;
@@ -607,6 +969,8 @@ namespace slib
 		maxThreadsCount = 32;
 		flagProcessByThreads = sl_true;
 		
+		ioLoopsCount = 1;
+		
 		flagUseAsset = sl_false;
 		
 		maxRequestHeadersSize = 0x10000; // 64KB
@@ -615,6 +979,12 @@ namespace slib
 		flagAllowCrossOrigin = sl_false;
 		flagAlwaysRespondAcceptRangesHeader = sl_true;
 		
+		flagUseCompression = sl_false;
+		compressionLevel = 6;
+		compressionThreshold = 1024; // 1KB
+		maxCompressedFileSize = 0x800000; // 8MB
+		maxCompressionCacheSize = 0x2000000; // 32MB
+		
 		flagLogDebug = sl_false;
 	}
 
@@ -625,11 +995,247 @@ namespace slib
 	}
 
 
+	HttpServiceCompressionStatistics::HttpServiceCompressionStatistics()
+	{
+		countCompressedResponses = 0;
+		sizeOriginal = 0;
+		sizeCompressed = 0;
+		countCacheHits = 0;
+		countCacheMisses = 0;
+	}
+
+	sl_uint64 HttpServiceCompressionStatistics::getSavedSize() const
+	{
+		if (sizeOriginal > sizeCompressed) {
+			return sizeOriginal - sizeCompressed;
+		}
+		return 0;
+	}
+
+	float HttpServiceCompressionStatistics::getCacheHitRate() const
+	{
+		sl_uint64 total = countCacheHits + countCacheMisses;
+		if (total) {
+			return (float)((double)countCacheHits / (double)total);
+		}
+		return 0;
+	}
+
+
+	enum class _HttpService_ContentEncoding
+	{
+		None = 0,
+		Gzip = 1,
+		Deflate = 2
+	};
+
+	static _HttpService_ContentEncoding _HttpService_getAcceptedEncoding(const String& acceptEncoding)
+	{
+		if (acceptEncoding.isEmpty()) {
+			return _HttpService_ContentEncoding::None;
+		}
+		sl_bool flagGzip = sl_false;
+		sl_bool flagDeflate = sl_false;
+		sl_bool flagAny = sl_false;
+		ListElements<String> codings(acceptEncoding.split(","));
+		for (sl_size i = 0; i < codings.count; i++) {
+			String name = codings[i];
+			sl_bool flagAccept = sl_true;
+			sl_reg index = name.indexOf(';');
+			if (index >= 0) {
+				String q = name.substring(index + 1).trim();
+				if (q.startsWith("q=") || q.startsWith("Q=")) {
+					flagAccept = q.substring(2).parseDouble(1) > 0;
+				}
+				name = name.substring(0, index);
+			}
+			name = name.trim().toLower();
+			if (name == "gzip" || name == "x-gzip") {
+				flagGzip = flagAccept;
+			} else if (name == "deflate") {
+				flagDeflate = flagAccept;
+			} else if (name == "*") {
+				flagAny = flagAccept;
+			}
+		}
+		if (flagGzip) {
+			return _HttpService_ContentEncoding::Gzip;
+		}
+		if (flagDeflate) {
+			return _HttpService_ContentEncoding::Deflate;
+		}
+		if (flagAny) {
+			return _HttpService_ContentEncoding::Gzip;
+		}
+		return _HttpService_ContentEncoding::None;
+	}
+
+	static const String& _HttpService_getEncodingName(_HttpService_ContentEncoding encoding)
+	{
+		SLIB_STATIC_STRING(gzip, "gzip");
+		SLIB_STATIC_STRING(deflate, "deflate");
+		if (encoding == _HttpService_ContentEncoding::Gzip) {
+			return gzip;
+		}
+		return deflate;
+	}
+
+	static sl_bool _HttpService_startCompress(ZlibCompress& zlib, _HttpService_ContentEncoding encoding, sl_int32 level)
+	{
+		if (encoding == _HttpService_ContentEncoding::Gzip) {
+			return zlib.startGzip(level);
+		} else {
+			// `deflate` content-coding is the zlib format (RFC 7230)
+			return zlib.start(level);
+		}
+	}
+
+	static sl_bool _HttpService_isCompressibleContentType(const String& _contentType)
+	{
+		String contentType = _contentType;
+		sl_reg index = contentType.indexOf(';');
+		if (index >= 0) {
+			contentType = contentType.substring(0, index);
+		}
+		contentType = contentType.trim().toLower();
+		if (contentType.startsWith("text/")) {
+			return sl_true;
+		}
+		if (contentType.startsWith("application/") || contentType.startsWith("image/svg")) {
+			return contentType.contains("json") || contentType.contains("javascript") || contentType.contains("xml") || contentType.contains("ecmascript");
+		}
+		return sl_false;
+	}
+
+	static void _HttpService_setVaryHeader(HttpServiceContext* context)
+	{
+		// the caches between should not serve a compressed response to the clients not accepting it
+		if (context->getResponseHeader(HttpHeaders::Vary).isEmpty()) {
+			context->setResponseHeader(HttpHeaders::Vary, HttpHeaders::AcceptEncoding);
+		}
+	}
+
+	class _HttpService_CompressedContent : public Referable
+	{
+	public:
+		String key;
+		Time modifiedTime;
+		Memory contentGzip;
+		Memory contentDeflate;
+		Link< Ref<_HttpService_CompressedContent> >* link;
+
+	public:
+		Memory& getContent(_HttpService_ContentEncoding encoding)
+		{
+			if (encoding == _HttpService_ContentEncoding::Gzip) {
+				return contentGzip;
+			}
+			return contentDeflate;
+		}
+
+		sl_size getSize()
+		{
+			return contentGzip.getSize() + contentDeflate.getSize();
+		}
+
+	};
+
+	// bounded LRU cache of the precompressed static contents, keyed by the path and the modified time
+	class _HttpService_CompressionCache : public Object
+	{
+	public:
+		HashMap< String, Ref<_HttpService_CompressedContent> > m_map;
+		CLinkedList< Ref<_HttpService_CompressedContent> > m_listRecent;
+		sl_uint64 m_sizeTotal;
+		sl_uint64 m_sizeMax;
+
+	public:
+		_HttpService_CompressionCache(sl_uint64 sizeMax)
+		{
+			m_sizeTotal = 0;
+			m_sizeMax = sizeMax;
+		}
+
+	public:
+		Memory get(const String& key, const Time& modifiedTime, _HttpService_ContentEncoding encoding)
+		{
+			ObjectLocker lock(this);
+			Ref<_HttpService_CompressedContent> item = m_map.getValue_NoLock(key, Ref<_HttpService_CompressedContent>::null());
+			if (item.isNull()) {
+				return sl_null;
+			}
+			if (item->modifiedTime != modifiedTime) {
+				_remove(item.get());
+				return sl_null;
+			}
+			if (item->link != m_listRecent.getFront()) {
+				m_listRecent.removeItem_NoLock(item->link);
+				item->link = m_listRecent.pushFront_NoLock(item);
+			}
+			return item->getContent(encoding);
+		}
+
+		void put(const String& key, const Time& modifiedTime, _HttpService_ContentEncoding encoding, const Memory& content)
+		{
+			sl_size size = content.getSize();
+			if (!size || size > m_sizeMax) {
+				return;
+			}
+			ObjectLocker lock(this);
+			Ref<_HttpService_CompressedContent> item = m_map.getValue_NoLock(key, Ref<_HttpService_CompressedContent>::null());
+			if (item.isNotNull() && item->modifiedTime != modifiedTime) {
+				_remove(item.get());
+				item.setNull();
+			}
+			if (item.isNull()) {
+				item = new _HttpService_CompressedContent;
+				if (item.isNull()) {
+					return;
+				}
+				item->key = key;
+				item->modifiedTime = modifiedTime;
+				item->link = m_listRecent.pushFront_NoLock(item);
+				if (!(item->link)) {
+					return;
+				}
+				m_map.put_NoLock(key, item);
+			}
+			Memory& memory = item->getContent(encoding);
+			m_sizeTotal -= memory.getSize();
+			memory = content;
+			m_sizeTotal += size;
+			while (m_sizeTotal > m_sizeMax) {
+				Link< Ref<_HttpService_CompressedContent> >* back = m_listRecent.getBack();
+				if (!back || back->value == item) {
+					break;
+				}
+				_remove(back->value.get());
+			}
+		}
+
+	private:
+		void _remove(_HttpService_CompressedContent* item)
+		{
+			Ref<_HttpService_CompressedContent> ref = item;
+			m_sizeTotal -= item->getSize();
+			m_listRecent.removeItem_NoLock(item->link);
+			m_map.remove_NoLock(item->key);
+		}
+
+	};
+
+
 	SLIB_DEFINE_OBJECT(HttpService, Object)
 
 	HttpService::HttpService()
 	{
 		m_flagRunning = sl_true;
+		
+		m_countCompressedResponses = 0;
+		m_sizeCompressionOriginal = 0;
+		m_sizeCompressionResult = 0;
+		m_countCompressionCacheHits = 0;
+		m_countCompressionCacheMisses = 0;
 	}
 
 	HttpService::~HttpService()
@@ -639,15 +1245,19 @@ namespace slib
 
 	sl_bool HttpService::_init(const HttpServiceParam& param)
 	{
-		Ref<AsyncIoLoop> ioLoop = AsyncIoLoop::create(sl_false);
-		if (ioLoop.isNotNull()) {
+		Ref<AsyncIoLoopGroup> ioLoopGroup = AsyncIoLoopGroup::create(param.ioLoopsCount, sl_false);
+		if (ioLoopGroup.isNotNull()) {
 			Ref<ThreadPool> threadPool = ThreadPool::create();
 			if (threadPool.isNotNull()) {
 				threadPool->setMaximumThreadsCount(param.maxThreadsCount);
 				
-				m_ioLoop = ioLoop;
+				m_ioLoop = ioLoopGroup->getLoop(0);
+				m_ioLoopGroup = ioLoopGroup;
 				m_threadPool = threadPool;
 				m_param = param;
+				if (param.flagUseCompression && param.maxCompressionCacheSize) {
+					m_compressionCache = new _HttpService_CompressionCache(param.maxCompressionCacheSize);
+				}
 				if (param.port) {
 					if (! (addHttpService(param.addressBind, param.port))) {
 						return sl_false;
@@ -657,10 +1267,11 @@ namespace slib
 					addProcessor(param.processor);
 				}
 				
-				ioLoop->start();
+				ioLoopGroup->start();
 
 				return sl_true;
 			}
+			ioLoopGroup->release();
 		}
 		return sl_false;
 	}
@@ -694,11 +1305,12 @@ namespace slib
 		}
 		m_connectionProviders.removeAll();
 		
-		Ref<AsyncIoLoop> ioLoop = m_ioLoop;
-		if (ioLoop.isNotNull()) {
-			ioLoop->release();
-			m_ioLoop.setNull();
+		Ref<AsyncIoLoopGroup> ioLoopGroup = m_ioLoopGroup;
+		if (ioLoopGroup.isNotNull()) {
+			ioLoopGroup->release();
+			m_ioLoopGroup.setNull();
 		}
+		m_ioLoop.setNull();
 		Ref<ThreadPool> threadPool = m_threadPool;
 		if (threadPool.isNotNull()) {
 			threadPool->release();
@@ -718,6 +1330,11 @@ namespace slib
 		return m_ioLoop;
 	}
 
+	Ref<AsyncIoLoopGroup> HttpService::getAsyncIoLoopGroup()
+	{
+		return m_ioLoopGroup;
+	}
+
 	Ref<ThreadPool> HttpService::getThreadPool()
 	{
 		return m_threadPool;
@@ -811,7 +1428,7 @@ namespace slib
 				String filePath = Assets::getFilePath(path);
 				return processFile(context, filePath);
 			} else {
-				Memory mem = Assets::readAllBytes(path);
+				Memory mem = Assets::mapAllBytes(path);
 				if (mem.isNotEmpty()) {
 					String oldResponseContentType = context->getResponseContentType();
 					if (oldResponseContentType.isEmpty()) {
@@ -821,6 +1438,9 @@ namespace slib
 						}
 						context->setResponseContentType(contentType);
 					}
+					if (_processCompressedContent(context, "asset:" + path, Time::zero(), String::null(), mem, mem.getSize())) {
+						return sl_true;
+					}
 					context->write(mem);
 					return sl_true;
 				}
@@ -873,11 +1493,16 @@ namespace slib
 				}
 				
 			} else {
+				if (_processCompressedContent(context, path, File::getModifiedTime(path), path, sl_null, totalSize)) {
+					return sl_true;
+				}
+				// the small files are written from memory with the response header;
+				// the larger ones are sent by sendfile() from the I/O loop when the connection is a raw TCP socket
 				if (totalSize > 100000) {
 					context->copyFromFile(path, m_threadPool);
 					return sl_true;
 				} else {
-					Memory mem = File::readAllBytes(path);
+					Memory mem = MappedFile::mapAllBytes(path);
 					if (mem.isNotEmpty()) {
 						context->write(mem);
 						return sl_true;
@@ -918,7 +1543,7 @@ namespace slib
 				return sl_false;
 			}
 		}
-		if (indexSplit == 0) {
+		if (s1.isEmpty()) {
 			if (n2 == 0) {
 				context->setResponseCode(HttpStatus::NoContent);
 				return sl_false;
@@ -929,7 +1554,7 @@ namespace slib
 				return sl_false;
 			}
 			outStart = totalLength - n2;
-			outLength = totalLength - 1;
+			outLength = n2;
 		} else {
 			if (n1 >= totalLength) {
 				context->setResponseCode(HttpStatus::RequestRangeNotSatisfiable);
@@ -953,6 +1578,129 @@ namespace slib
 		return sl_true;
 	}
 
+	sl_bool HttpService::compressResponse(const Ref<HttpServiceContext>& context)
+	{
+		if (!(m_param.flagUseCompression)) {
+			return sl_false;
+		}
+		if (context->getMethod() == HttpMethod::HEAD) {
+			return sl_false;
+		}
+		HttpStatus status = context->getResponseCode();
+		if ((sl_uint32)status < 200 || (sl_uint32)status >= 300 || status == HttpStatus::NoContent || status == HttpStatus::PartialContent) {
+			return sl_false;
+		}
+		if (context->getResponseContentEncoding().isNotEmpty()) {
+			return sl_false;
+		}
+		sl_uint64 sizeOriginal = context->getResponseContentLength();
+		if (!sizeOriginal || sizeOriginal < m_param.compressionThreshold) {
+			return sl_false;
+		}
+		if (!(_HttpService_isCompressibleContentType(context->getResponseContentType()))) {
+			return sl_false;
+		}
+		_HttpService_setVaryHeader(context.get());
+		_HttpService_ContentEncoding encoding = _HttpService_getAcceptedEncoding(context->getRequestAcceptEncoding());
+		if (encoding == _HttpService_ContentEncoding::None) {
+			return sl_false;
+		}
+		List<Memory> output;
+		if (!(context->getMemoryOutput(output))) {
+			return sl_false;
+		}
+		// the chunks written by the handler are streamed through a single deflate session
+		ZlibCompress zlib;
+		if (!(_HttpService_startCompress(zlib, encoding, m_param.compressionLevel))) {
+			return sl_false;
+		}
+		List<Memory> result;
+		sl_uint64 sizeCompressed = 0;
+		ListElements<Memory> chunks(output);
+		for (sl_size i = 0; i < chunks.count; i++) {
+			Memory mem = zlib.compress(chunks[i].getData(), chunks[i].getSize(), i + 1 == chunks.count);
+			if (mem.isNotEmpty()) {
+				sizeCompressed += mem.getSize();
+				result.add_NoLock(mem);
+			}
+		}
+		// the session is closed by the end of the stream, otherwise the content is broken
+		if (zlib.isStarted() || !sizeCompressed || sizeCompressed >= sizeOriginal) {
+			return sl_false;
+		}
+		context->clearOutput();
+		ListElements<Memory> compressed(result);
+		for (sl_size i = 0; i < compressed.count; i++) {
+			context->write(compressed[i]);
+		}
+		context->setResponseContentEncoding(_HttpService_getEncodingName(encoding));
+		Base::interlockedIncrement64(&m_countCompressedResponses);
+		Base::interlockedAdd64(&m_sizeCompressionOriginal, sizeOriginal);
+		Base::interlockedAdd64(&m_sizeCompressionResult, sizeCompressed);
+		return sl_true;
+	}
+
+	sl_bool HttpService::_processCompressedContent(const Ref<HttpServiceContext>& context, const String& key, const Time& modifiedTime, const String& filePath, const Memory& _content, sl_uint64 size)
+	{
+		_HttpService_CompressionCache* cache = (_HttpService_CompressionCache*)(m_compressionCache.get());
+		if (!cache) {
+			return sl_false;
+		}
+		if (!size || size < m_param.compressionThreshold || size > m_param.maxCompressedFileSize) {
+			return sl_false;
+		}
+		if (!(_HttpService_isCompressibleContentType(context->getResponseContentType()))) {
+			return sl_false;
+		}
+		_HttpService_setVaryHeader(context.get());
+		_HttpService_ContentEncoding encoding = _HttpService_getAcceptedEncoding(context->getRequestAcceptEncoding());
+		if (encoding == _HttpService_ContentEncoding::None) {
+			return sl_false;
+		}
+		Memory compressed = cache->get(key, modifiedTime, encoding);
+		if (compressed.isNotNull()) {
+			Base::interlockedIncrement64(&m_countCompressionCacheHits);
+		} else {
+			Base::interlockedIncrement64(&m_countCompressionCacheMisses);
+			Memory content = _content;
+			if (content.isNull()) {
+				content = MappedFile::mapAllBytes(filePath);
+				if (content.getSize() != size) {
+					return sl_false;
+				}
+			}
+			ZlibCompress zlib;
+			if (!(_HttpService_startCompress(zlib, encoding, m_param.compressionLevel))) {
+				return sl_false;
+			}
+			compressed = zlib.compress(content.getData(), content.getSize(), sl_true);
+			if (compressed.isNull() || zlib.isStarted()) {
+				return sl_false;
+			}
+			cache->put(key, modifiedTime, encoding, compressed);
+		}
+		if (compressed.getSize() >= size) {
+			return sl_false;
+		}
+		context->setResponseContentEncoding(_HttpService_getEncodingName(encoding));
+		context->write(compressed);
+		Base::interlockedIncrement64(&m_countCompressedResponses);
+		Base::interlockedAdd64(&m_sizeCompressionOriginal, size);
+		Base::interlockedAdd64(&m_sizeCompressionResult, compressed.getSize());
+		return sl_true;
+	}
+
+	HttpServiceCompressionStatistics HttpService::getCompressionStatistics()
+	{
+		HttpServiceCompressionStatistics ret;
+		ret.countCompressedResponses = m_countCompressedResponses;
+		ret.sizeOriginal = m_sizeCompressionOriginal;
+		ret.sizeCompressed = m_sizeCompressionResult;
+		ret.countCacheHits = m_countCompressionCacheHits;
+		ret.countCacheMisses = m_countCompressionCacheMisses;
+		return ret;
+	}
+
 	void HttpService::onPostProcessRequest(const Ref<HttpServiceContext>& context, sl_bool flagProcessed)
 	{
 		if (m_param.flagAlwaysRespondAcceptRangesHeader) {
@@ -343,6 +343,7 @@ namespace slib
 	AsyncTcpServerParam::AsyncTcpServerParam()
 	{
 		flagIPv6 = sl_false;
+		flagReusePort = sl_false;
 		
 		flagAutoStart = sl_true;
 		flagLogError = sl_true;
@@ -391,6 +392,13 @@ namespace slib
 			 */
 			socket->setOption_ReuseAddress(sl_true);
 #endif
+			if (param.flagReusePort) {
+				/*
+				 * SO_REUSEPORT lets every loop own its listening socket on the same port,
+				 * and the kernel distributes the incoming connections between them.
+				 */
+				socket->setOption_ReusePort(sl_true);
+			}
 
 			if (!(socket->bind(param.bindAddress))) {
 				if (param.flagLogError) {
@@ -560,6 +568,14 @@ namespace slib
 		}
 	}
 
+	void AsyncUdpSocketInstance::_onReceiveBatch(AsyncUdpPacket* packets, sl_uint32 count)
+	{
+		Ref<AsyncUdpSocket> object = Ref<AsyncUdpSocket>::from(getObject());
+		if (object.isNotNull()) {
+			object->_onReceiveBatch(packets, count);
+		}
+	}
+
 
 	IAsyncUdpSocketListener::IAsyncUdpSocketListener()
 	{
@@ -569,6 +585,13 @@ namespace slib
 	{
 	}
 
+	void IAsyncUdpSocketListener::onReceiveBatch(AsyncUdpSocket* socket, AsyncUdpPacket* packets, sl_uint32 count)
+	{
+		for (sl_uint32 i = 0; i < count; i++) {
+			onReceiveFrom(socket, packets[i].address, packets[i].data, packets[i].size);
+		}
+	}
+
 	AsyncUdpSocketParam::AsyncUdpSocketParam()
 	{
 		flagIPv6 = sl_false;
@@ -576,6 +599,9 @@ namespace slib
 		flagAutoStart = sl_false;
 		flagLogError = sl_false;
 		packetSize = 65536;
+		batchCount = 16;
+		flagGSO = sl_false;
+		flagGRO = sl_false;
 	}
 
 	AsyncUdpSocketParam::~AsyncUdpSocketParam()
@@ -595,7 +621,7 @@ namespace slib
 
 	Ref<AsyncUdpSocket> AsyncUdpSocket::create(const AsyncUdpSocketParam& param)
 	{
-		if (param.packetSize < 1) {
+		if (param.packetSize < 1 || param.batchCount < 1) {
 			return sl_null;
 		}
 		
@@ -635,7 +661,7 @@ namespace slib
 			socket->setOption_Broadcast(sl_true);
 		}
 		
-		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param.packetSize);
+		Ref<AsyncUdpSocketInstance> instance = _createInstance(socket, param);
 		if (instance.isNotNull()) {
 			Ref<AsyncIoLoop> loop = param.ioLoop;
 			if (loop.isNull()) {
@@ -648,6 +674,7 @@ namespace slib
 			if (ret.isNotNull()) {
 				ret->m_listener = param.listener;
 				ret->m_onReceiveFrom = param.onReceiveFrom;
+				ret->m_onReceiveBatch = param.onReceiveBatch;
 				instance->setObject(ret.get());
 				ret->setIoInstance(instance.get());
 				ret->setIoLoop(loop);
@@ -750,12 +777,27 @@ namespace slib
 	}
 
 	void AsyncUdpSocket::_onReceive(const SocketAddress& address, void* data, sl_uint32 sizeReceived)
+	{
+		AsyncUdpPacket packet;
+		packet.address = address;
+		packet.data = data;
+		packet.size = sizeReceived;
+		_onReceiveBatch(&packet, 1);
+	}
+
+	void AsyncUdpSocket::_onReceiveBatch(AsyncUdpPacket* packets, sl_uint32 count)
 	{
 		PtrLocker<IAsyncUdpSocketListener> listener(m_listener);
 		if (listener.isNotNull()) {
-			listener->onReceiveFrom(this, address, data, sizeReceived);
+			listener->onReceiveBatch(this, packets, count);
+		}
+		if (m_onReceiveBatch.isNotNull()) {
+			m_onReceiveBatch(this, packets, count);
+		} else if (m_onReceiveFrom.isNotNull()) {
+			for (sl_uint32 i = 0; i < count; i++) {
+				m_onReceiveFrom(this, packets[i].address, packets[i].data, packets[i].size);
+			}
 		}
-		m_onReceiveFrom(this, address, data, sizeReceived);
 	}
 
 }
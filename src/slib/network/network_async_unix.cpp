@@ -14,9 +14,58 @@
 
 #include "network_async.h"
 
+#include <errno.h>
+#if defined(SLIB_PLATFORM_IS_APPLE)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#else
+#include <sys/sendfile.h>
+#include <signal.h>
+#endif
+
+#if defined(SLIB_PLATFORM_IS_LINUX)
+#	define _UNIX_ASYNC_UDP_USE_MMSG
+#	include <sys/socket.h>
+#	include <netinet/in.h>
+#	include <netinet/udp.h>
+#	ifndef SOL_UDP
+#		define SOL_UDP 17
+#	endif
+#	ifndef UDP_SEGMENT
+#		define UDP_SEGMENT 103
+#	endif
+#	ifndef UDP_GRO
+#		define UDP_GRO 104
+#	endif
+#	define _UNIX_ASYNC_UDP_MAX_BATCH_COUNT 1024
+#	define _UNIX_ASYNC_UDP_MAX_DATAGRAM_SIZE 65535
+#	define _UNIX_ASYNC_UDP_GSO_MAX_SEGMENTS 64
+#	define _UNIX_ASYNC_UDP_GSO_MAX_SIZE 65000
+#	define _UNIX_ASYNC_UDP_CONTROL_SIZE 64
+#endif
+
 namespace slib
 {
 
+#if !defined(SLIB_PLATFORM_IS_APPLE)
+	/*
+		sendfile() has no MSG_NOSIGNAL flag (Apple sockets are opened with SO_NOSIGPIPE instead),
+		so SIGPIPE is ignored process-wide, once, before the first TCP socket can send a file.
+		A handler installed by the application is kept.
+	*/
+	static sl_bool _Unix_AsyncTcpSocket_ignoreSigPipe()
+	{
+		struct sigaction sa;
+		if (::sigaction(SIGPIPE, sl_null, &sa) == 0) {
+			if (!(sa.sa_flags & SA_SIGINFO) && sa.sa_handler == SIG_DFL) {
+				::signal(SIGPIPE, SIG_IGN);
+			}
+		}
+		return sl_true;
+	}
+#endif
+
 	class _Unix_AsyncTcpSocketInstance : public AsyncTcpSocketInstance
 	{
 	public:
@@ -46,6 +95,10 @@ namespace slib
 				if (socket->setNonBlockingMode(sl_true)) {
 					sl_file handle = (sl_file)(socket->getHandle());
 					if (handle != SLIB_FILE_INVALID_HANDLE) {
+#if !defined(SLIB_PLATFORM_IS_APPLE)
+						static sl_bool flagIgnoredSigPipe = _Unix_AsyncTcpSocket_ignoreSigPipe();
+						SLIB_UNUSED(flagIgnoredSigPipe)
+#endif
 						ret = new _Unix_AsyncTcpSocketInstance();
 						if (ret.isNotNull()) {
 							ret->m_socket = socket;
@@ -64,6 +117,46 @@ namespace slib
 			m_socket.setNull();
 		}
 		
+		// override
+		sl_bool isSupportingSendFile()
+		{
+			return sl_true;
+		}
+		
+		// returns the sent size, 0 when the socket would block, and negative value on error
+		static sl_int32 _sendFile(Socket* socket, File* file, sl_uint64 offset, sl_uint32 size)
+		{
+			int fdSocket = (int)(socket->getHandle());
+			int fdFile = (int)(file->getHandle());
+#if defined(SLIB_PLATFORM_IS_APPLE)
+			off_t len = size;
+			int ret = ::sendfile(fdFile, fdSocket, (off_t)offset, &len, sl_null, 0);
+			if (len > 0) {
+				return (sl_int32)len;
+			}
+			if (ret == 0) {
+				return -1;
+			}
+			int err = errno;
+#else
+			// SIGPIPE is ignored by `_Unix_AsyncTcpSocket_ignoreSigPipe()`: the broken pipe is reported as EPIPE
+			off_t off = (off_t)offset;
+			ssize_t ret = ::sendfile(fdSocket, fdFile, &off, size);
+			int err = errno;
+			if (ret > 0) {
+				return (sl_int32)ret;
+			}
+			if (ret == 0) {
+				// end of file
+				return -1;
+			}
+#endif
+			if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+				return 0;
+			}
+			return -1;
+		}
+		
 		void processRead(sl_bool flagError)
 		{
 			Ref<Socket> socket = m_socket;
@@ -127,7 +220,12 @@ namespace slib
 					}
 				}
 				sl_uint32 size = request->size - m_sizeWritten;
-				sl_int32 n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				sl_int32 n;
+				if (request->file.isNotNull()) {
+					n = _sendFile(socket.get(), request->file.get(), request->offsetFile + m_sizeWritten, size);
+				} else {
+					n = socket->send((char*)(request->data) + m_sizeWritten, size);
+				}
 				if (n > 0) {
 					m_sizeWritten += n;
 					if (m_sizeWritten >= request->size) {
@@ -294,6 +392,22 @@ namespace slib
 
 	class _Unix_AsyncUdpSocketInstance : public AsyncUdpSocketInstance
 	{
+	public:
+		sl_uint32 m_sizePacket;
+		sl_uint32 m_nBatch;
+#if defined(_UNIX_ASYNC_UDP_USE_MMSG)
+		sl_bool m_flagIPv6;
+		sl_bool m_flagGSO;
+		sl_bool m_flagGRO;
+		Memory m_memMessages;
+		mmsghdr* m_messages;
+		iovec* m_iovecs;
+		sockaddr_storage* m_addresses;
+		sl_uint8* m_controls;
+		Array<AsyncUdpPacket> m_packets;
+		Array<SendRequest> m_requests;
+#endif
+		
 	public:
 		_Unix_AsyncUdpSocketInstance()
 		{
@@ -305,7 +419,7 @@ namespace slib
 		}
 		
 	public:
-		static Ref<_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const Memory& buffer)
+		static Ref<_Unix_AsyncUdpSocketInstance> create(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 		{
 			Ref<_Unix_AsyncUdpSocketInstance> ret;
 			if (socket.isNotNull()) {
@@ -314,10 +428,12 @@ namespace slib
 					if (handle != SLIB_FILE_INVALID_HANDLE) {
 						ret = new _Unix_AsyncUdpSocketInstance();
 						if (ret.isNotNull()) {
-							ret->m_socket = socket;
-							ret->setHandle(handle);
-							ret->m_buffer = buffer;
-							return ret;
+							if (ret->initialize(socket, param)) {
+								ret->m_socket = socket;
+								ret->setHandle(handle);
+								return ret;
+							}
+							ret.setNull();
 						}
 					}
 				}
@@ -325,6 +441,57 @@ namespace slib
 			return ret;
 		}
 		
+		sl_bool initialize(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
+		{
+			m_sizePacket = param.packetSize;
+			m_nBatch = 1;
+#if defined(_UNIX_ASYNC_UDP_USE_MMSG)
+			int fd = (int)(socket->getHandle());
+			SocketType type = socket->getType();
+			m_flagIPv6 = type == SocketType::UdpIPv6 || type == SocketType::RawIPv6;
+			m_flagGSO = sl_false;
+			m_flagGRO = sl_false;
+			if (type == SocketType::Udp || type == SocketType::UdpIPv6) {
+				int v = 0;
+				// setting the segment size to 0 fails on the kernels without UDP GSO
+				if (param.flagGSO && !(setsockopt(fd, SOL_UDP, UDP_SEGMENT, &v, sizeof(v)))) {
+					m_flagGSO = sl_true;
+				}
+				v = 1;
+				if (param.flagGRO && !(setsockopt(fd, SOL_UDP, UDP_GRO, &v, sizeof(v)))) {
+					m_flagGRO = sl_true;
+					// a coalesced datagram can be as large as the maximum size of the datagrams
+					if (m_sizePacket < _UNIX_ASYNC_UDP_MAX_DATAGRAM_SIZE) {
+						m_sizePacket = _UNIX_ASYNC_UDP_MAX_DATAGRAM_SIZE;
+					}
+				}
+			}
+			m_nBatch = param.batchCount;
+			if (m_nBatch > _UNIX_ASYNC_UDP_MAX_BATCH_COUNT) {
+				m_nBatch = _UNIX_ASYNC_UDP_MAX_BATCH_COUNT;
+			}
+			m_memMessages = Memory::create((sizeof(mmsghdr) + sizeof(iovec) + sizeof(sockaddr_storage) + _UNIX_ASYNC_UDP_CONTROL_SIZE) * m_nBatch);
+			if (m_memMessages.isNull()) {
+				return sl_false;
+			}
+			Base::zeroMemory(m_memMessages.getData(), m_memMessages.getSize());
+			m_addresses = (sockaddr_storage*)(m_memMessages.getData());
+			m_messages = (mmsghdr*)(m_addresses + m_nBatch);
+			m_iovecs = (iovec*)(m_messages + m_nBatch);
+			m_controls = (sl_uint8*)(m_iovecs + m_nBatch);
+			m_packets = Array<AsyncUdpPacket>::create(m_nBatch);
+			if (m_packets.isNull()) {
+				return sl_false;
+			}
+			m_requests = Array<SendRequest>::create(m_nBatch);
+			if (m_requests.isNull()) {
+				return sl_false;
+			}
+#endif
+			m_buffer = Memory::create((sl_size)m_sizePacket * m_nBatch);
+			return m_buffer.isNotNull();
+		}
+		
 		void close()
 		{
 			AsyncUdpSocketInstance::close();
@@ -354,6 +521,12 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(_UNIX_ASYNC_UDP_USE_MMSG)
+			if (m_nBatch > 1) {
+				processSendBatch(socket.get());
+				return;
+			}
+#endif
 			while (Thread::isNotStoppingCurrent()) {
 				SendRequest request;
 				if (m_queueSendRequests.pop(&request)) {
@@ -373,6 +546,12 @@ namespace slib
 			if (!(socket->isOpened())) {
 				return;
 			}
+#if defined(_UNIX_ASYNC_UDP_USE_MMSG)
+			if (m_nBatch > 1 || m_flagGRO) {
+				processReceiveBatch(socket.get());
+				return;
+			}
+#endif
 			void* buf = m_buffer.getData();
 			sl_uint32 sizeBuf = (sl_uint32)(m_buffer.getSize());
 			while (Thread::isNotStoppingCurrent()) {
@@ -385,16 +564,195 @@ namespace slib
 				}
 			}
 		}
+		
+#if defined(_UNIX_ASYNC_UDP_USE_MMSG)
+		void processReceiveBatch(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			sl_uint8* buf = (sl_uint8*)(m_buffer.getData());
+			AsyncUdpPacket* packets = m_packets.getData();
+			sl_uint32 i;
+			while (Thread::isNotStoppingCurrent()) {
+				for (i = 0; i < m_nBatch; i++) {
+					m_iovecs[i].iov_base = buf + (sl_size)m_sizePacket * i;
+					m_iovecs[i].iov_len = m_sizePacket;
+					msghdr& msg = m_messages[i].msg_hdr;
+					msg.msg_name = m_addresses + i;
+					msg.msg_namelen = sizeof(sockaddr_storage);
+					msg.msg_iov = m_iovecs + i;
+					msg.msg_iovlen = 1;
+					if (m_flagGRO) {
+						msg.msg_control = m_controls + _UNIX_ASYNC_UDP_CONTROL_SIZE * i;
+						msg.msg_controllen = _UNIX_ASYNC_UDP_CONTROL_SIZE;
+					} else {
+						msg.msg_control = sl_null;
+						msg.msg_controllen = 0;
+					}
+					msg.msg_flags = 0;
+				}
+				int nMessages = recvmmsg(fd, m_messages, m_nBatch, 0, sl_null);
+				if (nMessages <= 0) {
+					if (nMessages < 0 && errno == EINTR) {
+						continue;
+					}
+					break;
+				}
+				sl_uint32 nPackets = 0;
+				for (i = 0; i < (sl_uint32)nMessages; i++) {
+					msghdr& msg = m_messages[i].msg_hdr;
+					sl_uint32 size = m_messages[i].msg_len;
+					if (!size) {
+						continue;
+					}
+					if (size > m_sizePacket) {
+						size = m_sizePacket;
+					}
+					sl_uint32 sizeSegment = size;
+					if (m_flagGRO) {
+						for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+							if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+								int n;
+								Base::copyMemory(&n, CMSG_DATA(cmsg), sizeof(int));
+								if (n > 0) {
+									sizeSegment = (sl_uint32)n;
+								}
+							}
+						}
+					}
+					SocketAddress address;
+					address.setSystemSocketAddress(m_addresses + i);
+					sl_uint8* data = (sl_uint8*)(m_iovecs[i].iov_base);
+					// a coalesced datagram is split into the original datagrams
+					for (sl_uint32 offset = 0; offset < size; offset += sizeSegment) {
+						AsyncUdpPacket& packet = packets[nPackets];
+						packet.address = address;
+						packet.data = data + offset;
+						packet.size = Math::min(sizeSegment, size - offset);
+						nPackets++;
+						if (nPackets == m_nBatch) {
+							_onReceiveBatch(packets, nPackets);
+							nPackets = 0;
+						}
+					}
+				}
+				if (nPackets) {
+					_onReceiveBatch(packets, nPackets);
+				}
+				// the receive queue is empty, and the next datagram will trigger a new event
+				if ((sl_uint32)nMessages < m_nBatch) {
+					break;
+				}
+			}
+		}
+		
+		sl_uint32 popSendRequests()
+		{
+			SendRequest* requests = m_requests.getData();
+			sl_uint32 n = 0;
+			ObjectLocker lock(&m_queueSendRequests);
+			while (n < m_nBatch && m_queueSendRequests.pop_NoLock(requests + n)) {
+				n++;
+			}
+			return n;
+		}
+		
+		void processSendBatch(Socket* socket)
+		{
+			int fd = (int)(socket->getHandle());
+			SendRequest* requests = m_requests.getData();
+			while (Thread::isNotStoppingCurrent()) {
+				sl_uint32 nRequests = popSendRequests();
+				if (!nRequests) {
+					break;
+				}
+				sl_uint32 nMessages = 0;
+				sl_uint32 i = 0;
+				while (i < nRequests) {
+					SendRequest& request = requests[i];
+					SocketAddress address = request.addressTo;
+					if (m_flagIPv6 && address.ip.isIPv4()) {
+						address.ip = IPv6Address(address.ip.getIPv4());
+					}
+					sl_uint32 sizeAddress = address.getSystemSocketAddress(m_addresses + nMessages);
+					if (!sizeAddress) {
+						i++;
+						continue;
+					}
+					sl_uint32 size = (sl_uint32)(request.data.getSize());
+					// following datagrams of same size and destination are sent as one GSO super-datagram
+					sl_uint32 nSegments = 1;
+					if (m_flagGSO) {
+						sl_uint32 sizeTotal = size;
+						while (i + nSegments < nRequests && nSegments < _UNIX_ASYNC_UDP_GSO_MAX_SEGMENTS) {
+							SendRequest& next = requests[i + nSegments];
+							if (next.data.getSize() != size || sizeTotal + size > _UNIX_ASYNC_UDP_GSO_MAX_SIZE || !(next.addressTo == request.addressTo)) {
+								break;
+							}
+							sizeTotal += size;
+							nSegments++;
+						}
+					}
+					msghdr& msg = m_messages[nMessages].msg_hdr;
+					msg.msg_name = m_addresses + nMessages;
+					msg.msg_namelen = sizeAddress;
+					msg.msg_iov = m_iovecs + i;
+					msg.msg_iovlen = nSegments;
+					msg.msg_control = sl_null;
+					msg.msg_controllen = 0;
+					msg.msg_flags = 0;
+					for (sl_uint32 k = 0; k < nSegments; k++) {
+						m_iovecs[i + k].iov_base = requests[i + k].data.getData();
+						m_iovecs[i + k].iov_len = size;
+					}
+					if (nSegments > 1) {
+						msg.msg_control = m_controls + _UNIX_ASYNC_UDP_CONTROL_SIZE * nMessages;
+						msg.msg_controllen = CMSG_SPACE(sizeof(sl_uint16));
+						cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+						cmsg->cmsg_level = SOL_UDP;
+						cmsg->cmsg_type = UDP_SEGMENT;
+						cmsg->cmsg_len = CMSG_LEN(sizeof(sl_uint16));
+						sl_uint16 sizeSegment = (sl_uint16)size;
+						Base::copyMemory(CMSG_DATA(cmsg), &sizeSegment, sizeof(sl_uint16));
+					}
+					nMessages++;
+					i += nSegments;
+				}
+				sl_uint32 nSent = 0;
+				while (nSent < nMessages) {
+					int n = sendmmsg(fd, m_messages + nSent, nMessages - nSent, 0);
+					if (n > 0) {
+						nSent += n;
+					} else {
+						if (n < 0 && errno == EINTR) {
+							continue;
+						}
+						if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+							// the send buffer is full: the rest are dropped, as `sendTo` does
+							break;
+						}
+						msghdr& msg = m_messages[nSent].msg_hdr;
+						if (msg.msg_iovlen > 1) {
+							// the path refused the segmentation (e.g. larger than MTU): the datagrams are sent one by one
+							for (sl_size k = 0; k < (sl_size)(msg.msg_iovlen); k++) {
+								sendto(fd, msg.msg_iov[k].iov_base, msg.msg_iov[k].iov_len, 0, (sockaddr*)(msg.msg_name), msg.msg_namelen);
+							}
+						}
+						// skips the failing datagram
+						nSent++;
+					}
+				}
+				for (i = 0; i < nRequests; i++) {
+					requests[i].data.setNull();
+				}
+			}
+		}
+#endif
 
 	};
 
-	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, sl_uint32 packetSize)
+	Ref<AsyncUdpSocketInstance> AsyncUdpSocket::_createInstance(const Ref<Socket>& socket, const AsyncUdpSocketParam& param)
 	{
-		Memory buffer = Memory::create(packetSize);
-		if (buffer.isNotEmpty()) {
-			return _Unix_AsyncUdpSocketInstance::create(socket, buffer);
-		}
-		return sl_null;
+		return _Unix_AsyncUdpSocketInstance::create(socket, param);
 	}
 }
 
@@ -12,6 +12,7 @@
 
 #include "slib/network/url.h"
 #include "slib/core/json.h"
+#include "slib/core/json_writer.h"
 #include "slib/core/string_buffer.h"
 #include "slib/core/thread_pool.h"
 #include "slib/core/safe_static.h"
@@ -56,6 +57,8 @@ namespace slib
 		flagSelfAlive = sl_true;
 		flagStoreResponseContent = sl_true;
 		flagSynchronous = sl_false;
+		timeout = 0;
+		flagAllowPipelining = sl_false;
 	}
 	
 	UrlRequestParam::UrlRequestParam(const UrlRequestParam& other) = default;
@@ -71,7 +74,7 @@ namespace slib
 	
 	void UrlRequestParam::setRequestBodyAsJson(const Json& json)
 	{
-		requestBody = json.toJsonString().toMemory();
+		requestBody = JsonWriter::serialize(json);
 	}
 	
 	void UrlRequestParam::setRequestBodyAsXml(const Ref<XmlDocument>& xml)
@@ -102,6 +105,8 @@ namespace slib
 		m_flagSelfAlive = sl_false;
 		m_flagStoreResponseContent = sl_true;
 		m_flagUseBackgroundSession = sl_false;
+		m_timeout = 0;
+		m_flagAllowPipelining = sl_false;
 
 	}
 	
@@ -230,7 +235,7 @@ namespace slib
 		rp.url = url;
 		rp.method = method;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		return send(rp);
 	}
@@ -241,7 +246,7 @@ namespace slib
 		rp.url = url;
 		rp.method = method;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		rp.dispatcher = dispatcher;
 		return send(rp);
@@ -296,7 +301,7 @@ namespace slib
 		UrlRequestParam rp;
 		rp.url = url;
 		rp.method = HttpMethod::POST;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		return send(rp);
 	}
@@ -306,7 +311,7 @@ namespace slib
 		UrlRequestParam rp;
 		rp.url = url;
 		rp.method = HttpMethod::POST;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		rp.dispatcher = dispatcher;
 		return send(rp);
@@ -318,7 +323,7 @@ namespace slib
 		rp.url = url;
 		rp.method = HttpMethod::POST;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		return send(rp);
 	}
@@ -329,7 +334,7 @@ namespace slib
 		rp.url = url;
 		rp.method = HttpMethod::POST;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.onComplete = onComplete;
 		rp.dispatcher = dispatcher;
 		return send(rp);
@@ -380,7 +385,7 @@ namespace slib
 		rp.url = url;
 		rp.method = method;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.flagSynchronous = sl_true;
 		return send(rp);
 	}
@@ -411,7 +416,7 @@ namespace slib
 		UrlRequestParam rp;
 		rp.url = url;
 		rp.method = HttpMethod::POST;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.flagSynchronous = sl_true;
 		return send(rp);
 	}
@@ -422,7 +427,7 @@ namespace slib
 		rp.url = url;
 		rp.method = HttpMethod::POST;
 		rp.parameters = params;
-		rp.requestBody = json.toJsonString().toMemory();
+		rp.requestBody = JsonWriter::serialize(json);
 		rp.flagSynchronous = sl_true;
 		return send(rp);
 	}
@@ -546,6 +551,16 @@ namespace slib
 		return m_flagStoreResponseContent;
 	}
 	
+	sl_uint32 UrlRequest::getTimeout()
+	{
+		return m_timeout;
+	}
+	
+	sl_bool UrlRequest::isAllowingPipelining()
+	{
+		return m_flagAllowPipelining;
+	}
+	
 	sl_uint64 UrlRequest::getSentRequestBodySize()
 	{
 		return m_sizeBodySent;
@@ -583,6 +598,11 @@ namespace slib
 		return m_flagError;
 	}
 	
+	String UrlRequest::getLastErrorMessage()
+	{
+		return m_lastErrorMessage;
+	}
+	
 	sl_bool UrlRequest::isClosed()
 	{
 		return m_flagClosed;
@@ -649,6 +669,8 @@ namespace slib
 		m_flagUseBackgroundSession = param.flagUseBackgroundSession;
 		m_flagSelfAlive = param.flagSelfAlive && !(param.flagSynchronous);
 		m_flagStoreResponseContent = param.flagStoreResponseContent;
+		m_timeout = param.timeout;
+		m_flagAllowPipelining = param.flagAllowPipelining;
 		
 		if (m_flagSelfAlive) {
 			_UrlRequestMap* map = _getUrlRequestMap();
@@ -0,0 +1,1055 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/definition.h"
+
+#if defined(SLIB_PLATFORM_IS_LINUX) && !defined(SLIB_PLATFORM_IS_ANDROID) && !defined(SLIB_PLATFORM_IS_TIZEN)
+
+#include "slib/network/url_request.h"
+
+#include "slib/network/url.h"
+#include "slib/network/async.h"
+#include "slib/network/http_io.h"
+#include "slib/network/os.h"
+#include "slib/core/async.h"
+#include "slib/core/timer_wheel.h"
+#include "slib/core/mpsc_queue.h"
+#include "slib/core/linked_list.h"
+#include "slib/core/thread_pool.h"
+#include "slib/core/file.h"
+#include "slib/core/safe_static.h"
+#include "slib/core/log.h"
+
+#define TAG "UrlRequest"
+
+#define _SLIB_URL_REQUEST_MAX_CONNECTIONS_PER_HOST 32
+#define _SLIB_URL_REQUEST_MAX_PIPELINE_DEPTH 8
+#define _SLIB_URL_REQUEST_MAX_RETRY 1
+#define _SLIB_URL_REQUEST_IDLE_TIMEOUT 30000
+#define _SLIB_URL_REQUEST_MAX_HEADER_SIZE 65536
+#define _SLIB_URL_REQUEST_READ_BUFFER_SIZE 65536
+
+namespace slib
+{
+
+	class UrlRequest_Impl;
+	class _UrlRequest_HttpHost;
+
+	/*
+		Keep-alive connection to a host.
+		All the methods are called on the I/O loop of the client.
+	*/
+	class _UrlRequest_HttpConnection : public Referable, public IHttpContentReaderListener
+	{
+	public:
+		WeakRef<_UrlRequest_HttpHost> m_host;
+		Ref<AsyncIoLoop> m_loop;
+		Ref<AsyncTcpSocket> m_socket;
+
+		sl_bool m_flagConnected;
+		sl_bool m_flagClosed;
+		sl_bool m_flagKeepAlive;
+		sl_uint32 m_nResponses;
+
+		// requests sent (or to be sent on connecting) in order
+		CLinkedList< Ref<UrlRequest_Impl> > m_requests;
+		sl_uint32 m_nRequestsNotPipelining;
+
+		Memory m_bufRead;
+		HttpHeaderReader m_headerReader;
+		Ref<HttpContentReader> m_contentReader;
+		sl_bool m_flagReadingContent;
+		sl_bool m_flagReadingUntilClose;
+		sl_bool m_flagContentEnded;
+		sl_bool m_flagContentError;
+		void* m_dataRemained;
+		sl_uint32 m_sizeRemained;
+
+		Ref<TimerWheelEntry> m_timerIdle;
+
+	public:
+		_UrlRequest_HttpConnection();
+
+		~_UrlRequest_HttpConnection();
+
+	public:
+		static Ref<_UrlRequest_HttpConnection> create(_UrlRequest_HttpHost* host, const SocketAddress& address);
+
+		sl_bool isIdle();
+
+		sl_bool isPipelining();
+
+		sl_bool isFront(UrlRequest_Impl* request);
+
+		sl_uint32 getRequestsCount();
+
+		void sendRequest(UrlRequest_Impl* request);
+
+		void close(const String& error);
+
+		// closes the connection because the front request is failed by the client
+		void abort();
+
+		// override
+		void onCompleteReadHttpContent(void* dataRemained, sl_uint32 sizeRemained, sl_bool flagError);
+
+	protected:
+		void _close(const String& error, sl_bool flagAborted);
+
+		void _send(UrlRequest_Impl* request);
+
+		void _read();
+
+		void _processData(sl_uint8* data, sl_uint32 size);
+
+		sl_bool _startContent(UrlRequest_Impl* request, const Memory& header);
+
+		void _completeResponse();
+
+		void _startIdleTimer();
+
+		void _stopIdleTimer();
+
+		void _onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError);
+
+		void _onSend(AsyncStreamResult* result);
+
+		void _onReceive(AsyncStreamResult* result);
+
+		void _onIdleTimeout();
+
+	};
+
+	/*
+		Connection pool and the waiting requests of a host.
+		`add()` may be called from any thread, the others are called on the I/O loop.
+	*/
+	class _UrlRequest_HttpHost : public Referable
+	{
+	public:
+		Ref<AsyncIoLoop> m_loop;
+		Ref<ThreadPool> m_threadPool;
+		String m_name;
+		sl_uint16 m_port;
+
+		MpscQueue< Ref<UrlRequest_Impl> > m_queueIncoming;
+		sl_int32 m_flagIncomingPending;
+
+		SocketAddress m_address;
+		sl_bool m_flagIPAddress;
+		sl_bool m_flagResolved;
+		sl_bool m_flagResolving;
+		CLinkedList< Ref<UrlRequest_Impl> > m_queueWaiting;
+		CLinkedList< Ref<_UrlRequest_HttpConnection> > m_connections;
+		sl_bool m_flagProcessing;
+		sl_bool m_flagProcessAgain;
+
+	public:
+		_UrlRequest_HttpHost(const Ref<AsyncIoLoop>& loop, const Ref<ThreadPool>& threadPool, const String& name, sl_uint16 port);
+
+		~_UrlRequest_HttpHost();
+
+	public:
+		void add(UrlRequest_Impl* request);
+
+		void process();
+
+		void onConnectionIdle(_UrlRequest_HttpConnection* connection);
+
+		void onConnectionClosed(_UrlRequest_HttpConnection* connection, CLinkedList< Ref<UrlRequest_Impl> >& requestsRetry, sl_bool flagConnected);
+
+	protected:
+		Ref<_UrlRequest_HttpConnection> _getConnection(UrlRequest_Impl* request);
+
+		void _failWaitingRequests(const String& error);
+
+		// removes the host from the client when it has no connection and no request
+		void _removeIfUnused();
+
+		void _onIncoming();
+
+		void _resolve();
+
+		void _onResolved(const IPAddress& ip);
+
+	};
+
+	class _UrlRequest_HttpClient
+	{
+	public:
+		Ref<AsyncIoLoop> loop;
+		Ref<ThreadPool> threadPool;
+		Mutex lock;
+		Map< String, Ref<_UrlRequest_HttpHost> > hosts;
+
+	public:
+		_UrlRequest_HttpClient()
+		{
+			loop = AsyncIoLoop::create();
+			// resolving the host names
+			threadPool = ThreadPool::create(0, 4);
+			hosts.initHash();
+		}
+
+		~_UrlRequest_HttpClient()
+		{
+			if (loop.isNotNull()) {
+				loop->release();
+			}
+			if (threadPool.isNotNull()) {
+				threadPool->release();
+			}
+		}
+
+	public:
+		static String getHostKey(const String& name, sl_uint16 port)
+		{
+			return String::format("%s:%d", name, port);
+		}
+
+		Ref<_UrlRequest_HttpHost> getHost(const String& name, sl_uint16 port)
+		{
+			String key = getHostKey(name, port);
+			MutexLocker locker(&lock);
+			Ref<_UrlRequest_HttpHost> host = hosts.getValue_NoLock(key, sl_null);
+			if (host.isNull()) {
+				host = new _UrlRequest_HttpHost(loop, threadPool, name, port);
+				if (host.isNotNull()) {
+					hosts.put_NoLock(key, host);
+				}
+			}
+			return host;
+		}
+
+		void removeHost(_UrlRequest_HttpHost* host)
+		{
+			String key = getHostKey(host->m_name, host->m_port);
+			MutexLocker locker(&lock);
+			// the host may be replaced already
+			if (hosts.getValue_NoLock(key, sl_null) == host) {
+				hosts.remove_NoLock(key);
+			}
+		}
+
+	};
+
+	SLIB_SAFE_STATIC_GETTER(_UrlRequest_HttpClient, _UrlRequest_getHttpClient)
+
+	class UrlRequest_Impl : public UrlRequest
+	{
+	public:
+		Ref<AsyncIoLoop> m_loop;
+		Memory m_packet;
+		sl_bool m_flagIdempotent;
+		sl_bool m_flagPipelining;
+
+		// accessed on the I/O loop
+		Ref<TimerWheelEntry> m_timer;
+		WeakRef<_UrlRequest_HttpConnection> m_connection;
+		sl_bool m_flagResponseStarted;
+		sl_uint32 m_nRetry;
+		Ref<File> m_fileDownload;
+
+	public:
+		UrlRequest_Impl()
+		{
+			m_flagIdempotent = sl_false;
+			m_flagPipelining = sl_false;
+			m_flagResponseStarted = sl_false;
+			m_nRetry = 0;
+		}
+
+		~UrlRequest_Impl()
+		{
+		}
+
+	public:
+		static Ref<UrlRequest_Impl> create(const UrlRequestParam& param, const String& url)
+		{
+			Ref<UrlRequest_Impl> ret = new UrlRequest_Impl;
+			if (ret.isNotNull()) {
+				ret->_init(param, url);
+				return ret;
+			}
+			return sl_null;
+		}
+
+		// override
+		void _sendAsync()
+		{
+			_UrlRequest_HttpClient* client = _UrlRequest_getHttpClient();
+			if (!client || client->loop.isNull()) {
+				fail("HTTP client is not available");
+				return;
+			}
+
+			Url url;
+			url.parse(m_url);
+			String scheme = url.scheme;
+			if (!(scheme.equalsIgnoreCase("http"))) {
+				fail("Not supported scheme: " + scheme);
+				return;
+			}
+			String hostAddress = url.host;
+			String hostName;
+			sl_uint16 port = 80;
+			sl_reg indexPort;
+			if (hostAddress.startsWith('[')) {
+				// IPv6 literal
+				sl_reg indexEnd = hostAddress.indexOf(']');
+				if (indexEnd < 0) {
+					fail("Invalid host: " + hostAddress);
+					return;
+				}
+				hostName = hostAddress.substring(1, indexEnd);
+				indexPort = hostAddress.indexOf(':', indexEnd);
+			} else {
+				indexPort = hostAddress.indexOf(':');
+				if (indexPort >= 0) {
+					hostName = hostAddress.substring(0, indexPort);
+				} else {
+					hostName = hostAddress;
+				}
+			}
+			if (indexPort >= 0) {
+				sl_uint32 n;
+				if (!(hostAddress.substring(indexPort + 1).parseUint32(10, &n)) || n == 0 || n > 65535) {
+					fail("Invalid host: " + hostAddress);
+					return;
+				}
+				port = (sl_uint16)n;
+			}
+			if (hostName.isEmpty()) {
+				fail("Invalid host: " + hostAddress);
+				return;
+			}
+
+			HttpRequest request;
+			request.setMethod(m_method);
+			request.setPath(url.path);
+			request.setQuery(url.query);
+			request.setHost(hostAddress);
+			for (auto pair : m_requestHeaders) {
+				request.setRequestHeader(pair.key, pair.value);
+			}
+			for (auto pair : m_additionalRequestHeaders) {
+				request.addRequestHeader(pair.key, pair.value);
+			}
+			if (!(request.containsRequestHeader(HttpHeaders::AcceptEncoding))) {
+				SLIB_STATIC_STRING(s, "gzip, deflate");
+				request.setRequestHeader(HttpHeaders::AcceptEncoding, s);
+			}
+			Memory body = m_requestBody;
+			if (body.isNotEmpty() || m_method == HttpMethod::POST || m_method == HttpMethod::PUT) {
+				request.setRequestContentLengthHeader(body.getSize());
+			}
+			Memory header = request.makeRequestPacket();
+			if (body.isNotEmpty()) {
+				MemoryBuffer buf;
+				buf.add(header);
+				buf.add(body);
+				m_packet = buf.merge();
+			} else {
+				m_packet = header;
+			}
+			if (m_packet.isEmpty()) {
+				fail("Failed to create the request packet");
+				return;
+			}
+			switch (m_method) {
+				case HttpMethod::GET:
+				case HttpMethod::HEAD:
+					m_flagIdempotent = sl_true;
+					m_flagPipelining = m_flagAllowPipelining;
+					break;
+				case HttpMethod::PUT:
+				case HttpMethod::DELETE:
+				case HttpMethod::OPTIONS:
+				case HttpMethod::TRACE:
+					m_flagIdempotent = sl_true;
+					break;
+				default:
+					break;
+			}
+
+			Ref<_UrlRequest_HttpHost> host = client->getHost(hostName, port);
+			if (host.isNull()) {
+				fail("Failed to create the host pool");
+				return;
+			}
+			m_loop = client->loop;
+			host->add(this);
+		}
+
+		// override
+		void _cancel()
+		{
+			Ref<AsyncIoLoop> loop = m_loop;
+			if (loop.isNotNull()) {
+				loop->addTask(SLIB_INLINE_BIND_REF(void(), UrlRequest_Impl, _clearTimer, this));
+			}
+		}
+
+		void fail(const String& error)
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			LogError(TAG, "%s, %s", error, m_url);
+			m_lastErrorMessage = error;
+			_clearTimer();
+			m_fileDownload.setNull();
+			onError();
+		}
+
+		void setResponse(HttpResponse& response)
+		{
+			m_responseStatus = response.getResponseCode();
+			m_responseMessage = response.getResponseMessage();
+			m_responseHeaders = response.getResponseHeaders();
+			m_sizeContentTotal = response.getResponseContentLengthHeader();
+			if (m_flagClosed) {
+				return;
+			}
+			if (m_downloadFilePath.isNotEmpty()) {
+				m_fileDownload = File::openForWrite(m_downloadFilePath);
+			}
+			onResponse();
+		}
+
+		void receiveContent(const Memory& content, sl_bool flagOwned)
+		{
+			if (m_flagClosed) {
+				return;
+			}
+			if (m_downloadFilePath.isNotEmpty()) {
+				Ref<File> file = m_fileDownload;
+				if (file.isNotNull()) {
+					sl_reg n = file->write(content.getData(), content.getSize());
+					if (n > 0) {
+						onDownloadContent(n);
+					}
+				}
+			} else if (flagOwned) {
+				onReceiveContent(content.getData(), content.getSize(), content);
+			} else {
+				// in the reading buffer of the connection
+				onReceiveContent(content.getData(), content.getSize(), sl_null);
+			}
+		}
+
+		void startTimer()
+		{
+			if (m_timeout && m_timer.isNull() && !m_flagClosed) {
+				m_timer = m_loop->setTimeout(SLIB_INLINE_BIND_WEAKREF(void(), UrlRequest_Impl, _onTimeout, this), m_timeout);
+			}
+		}
+
+		void finish()
+		{
+			_clearTimer();
+			m_fileDownload.setNull();
+			onComplete();
+		}
+
+		void _clearTimer()
+		{
+			Ref<TimerWheelEntry> timer = m_timer;
+			if (timer.isNotNull()) {
+				m_timer.setNull();
+				m_loop->clearTimeout(timer);
+			}
+		}
+
+		void _onTimeout()
+		{
+			m_timer.setNull();
+			if (m_flagClosed) {
+				return;
+			}
+			Ref<_UrlRequest_HttpConnection> connection = m_connection;
+			fail("Request timed out");
+			if (connection.isNotNull()) {
+				// the response of the pipelined requests in front is still useful, so the response of this request is discarded later
+				if (connection->isFront(this)) {
+					connection->abort();
+				}
+			}
+		}
+
+	};
+
+
+	_UrlRequest_HttpConnection::_UrlRequest_HttpConnection()
+	{
+		m_flagConnected = sl_false;
+		m_flagClosed = sl_false;
+		m_flagKeepAlive = sl_true;
+		m_nResponses = 0;
+		m_nRequestsNotPipelining = 0;
+		m_flagReadingContent = sl_false;
+		m_flagReadingUntilClose = sl_false;
+		m_flagContentEnded = sl_false;
+		m_flagContentError = sl_false;
+		m_dataRemained = sl_null;
+		m_sizeRemained = 0;
+	}
+
+	_UrlRequest_HttpConnection::~_UrlRequest_HttpConnection()
+	{
+		if (m_socket.isNotNull()) {
+			m_socket->close();
+		}
+	}
+
+	Ref<_UrlRequest_HttpConnection> _UrlRequest_HttpConnection::create(_UrlRequest_HttpHost* host, const SocketAddress& address)
+	{
+		Ref<_UrlRequest_HttpConnection> ret = new _UrlRequest_HttpConnection;
+		if (ret.isNotNull()) {
+			ret->m_host = host;
+			ret->m_loop = host->m_loop;
+			ret->m_bufRead = Memory::create(_SLIB_URL_REQUEST_READ_BUFFER_SIZE);
+			if (ret->m_bufRead.isNull()) {
+				return sl_null;
+			}
+			AsyncTcpSocketParam param;
+			param.ioLoop = host->m_loop;
+			param.flagIPv6 = address.ip.isIPv6();
+			param.flagLogError = sl_false;
+			param.onConnect = SLIB_FUNCTION_WEAKREF(_UrlRequest_HttpConnection, _onConnect, ret.get());
+			Ref<AsyncTcpSocket> socket = AsyncTcpSocket::create(param);
+			if (socket.isNotNull()) {
+				ret->m_socket = socket;
+				Ref<Socket> s = socket->getSocket();
+				if (s.isNotNull()) {
+					// pipelined requests should not wait for the ACK of the previous ones
+					s->setOption_TcpNoDelay(sl_true);
+				}
+				if (socket->connect(address)) {
+					return ret;
+				}
+			}
+		}
+		return sl_null;
+	}
+
+	sl_bool _UrlRequest_HttpConnection::isIdle()
+	{
+		return !m_flagClosed && m_requests.isEmpty();
+	}
+
+	sl_bool _UrlRequest_HttpConnection::isPipelining()
+	{
+		// pipelining is started only on the connection which is proved to be kept alive
+		return !m_flagClosed && m_flagConnected && m_flagKeepAlive && m_nResponses > 0 && !m_nRequestsNotPipelining;
+	}
+
+	sl_bool _UrlRequest_HttpConnection::isFront(UrlRequest_Impl* request)
+	{
+		Link< Ref<UrlRequest_Impl> >* link = m_requests.getFront();
+		return link && link->value == request;
+	}
+
+	sl_uint32 _UrlRequest_HttpConnection::getRequestsCount()
+	{
+		return (sl_uint32)(m_requests.getCount());
+	}
+
+	void _UrlRequest_HttpConnection::sendRequest(UrlRequest_Impl* request)
+	{
+		request->m_connection = this;
+		request->m_flagResponseStarted = sl_false;
+		m_requests.pushBack_NoLock(request);
+		if (!(request->m_flagPipelining)) {
+			m_nRequestsNotPipelining++;
+		}
+		_stopIdleTimer();
+		if (m_flagConnected) {
+			_send(request);
+		}
+	}
+
+	void _UrlRequest_HttpConnection::close(const String& error)
+	{
+		_close(error, sl_false);
+	}
+
+	void _UrlRequest_HttpConnection::abort()
+	{
+		_close("Connection aborted", sl_true);
+	}
+
+	void _UrlRequest_HttpConnection::_close(const String& error, sl_bool flagAborted)
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		m_flagClosed = sl_true;
+		Ref<_UrlRequest_HttpConnection> thiz = this;
+		_stopIdleTimer();
+		m_socket->close();
+		m_contentReader.setNull();
+		CLinkedList< Ref<UrlRequest_Impl> > requestsRetry;
+		Ref<UrlRequest_Impl> request;
+		while (m_requests.popFront_NoLock(&request)) {
+			request->m_connection.setNull();
+			if (request->isClosed()) {
+				continue;
+			}
+			if (flagAborted) {
+				// the requests queued behind the aborted one are not at fault: send them again without counting the retry
+				if (!m_flagConnected || (request->m_flagIdempotent && !(request->m_flagResponseStarted))) {
+					requestsRetry.pushBack_NoLock(request);
+				} else {
+					request->fail(error);
+				}
+				continue;
+			}
+			// the server may close the kept-alive connection at any time, so the requests not answered yet are sent again
+			if (m_flagConnected && request->m_flagIdempotent && !(request->m_flagResponseStarted) && request->m_nRetry < _SLIB_URL_REQUEST_MAX_RETRY) {
+				request->m_nRetry++;
+				requestsRetry.pushBack_NoLock(request);
+			} else {
+				request->fail(error);
+			}
+		}
+		m_nRequestsNotPipelining = 0;
+		Ref<_UrlRequest_HttpHost> host = m_host;
+		if (host.isNotNull()) {
+			host->onConnectionClosed(this, requestsRetry, m_flagConnected);
+		}
+	}
+
+	void _UrlRequest_HttpConnection::onCompleteReadHttpContent(void* dataRemained, sl_uint32 sizeRemained, sl_bool flagError)
+	{
+		// called in `HttpContentReader::decodeData()`
+		m_flagContentEnded = sl_true;
+		m_flagContentError = flagError;
+		m_dataRemained = dataRemained;
+		m_sizeRemained = sizeRemained;
+	}
+
+	void _UrlRequest_HttpConnection::_send(UrlRequest_Impl* request)
+	{
+		if (!(m_socket->send(request->m_packet, SLIB_FUNCTION_WEAKREF(_UrlRequest_HttpConnection, _onSend, this)))) {
+			close("Failed to send the request");
+		}
+	}
+
+	void _UrlRequest_HttpConnection::_read()
+	{
+		if (!(m_socket->receive(m_bufRead, SLIB_FUNCTION_WEAKREF(_UrlRequest_HttpConnection, _onReceive, this)))) {
+			close("Failed to receive the response");
+		}
+	}
+
+	void _UrlRequest_HttpConnection::_processData(sl_uint8* data, sl_uint32 size)
+	{
+		while (size > 0) {
+			if (m_flagClosed) {
+				return;
+			}
+			Link< Ref<UrlRequest_Impl> >* link = m_requests.getFront();
+			if (!link) {
+				close("Unexpected data from the server");
+				return;
+			}
+			UrlRequest_Impl* request = link->value.get();
+			request->m_flagResponseStarted = sl_true;
+			if (m_flagReadingContent) {
+				m_flagContentEnded = sl_false;
+				m_flagContentError = sl_false;
+				m_dataRemained = sl_null;
+				m_sizeRemained = 0;
+				Memory content = m_contentReader->decodeData(data, size);
+				if (m_flagContentError) {
+					close("Invalid response content");
+					return;
+				}
+				if (content.isNotEmpty()) {
+					request->receiveContent(content, m_contentReader->isDecompressing());
+				}
+				if (!m_flagContentEnded) {
+					return;
+				}
+				data = (sl_uint8*)m_dataRemained;
+				size = m_sizeRemained;
+				_completeResponse();
+			} else {
+				sl_size posBody = 0;
+				if (!(m_headerReader.add(data, size, posBody))) {
+					if (m_headerReader.getHeaderSize() > _SLIB_URL_REQUEST_MAX_HEADER_SIZE) {
+						close("Too large response header");
+					}
+					return;
+				}
+				Memory header = m_headerReader.mergeHeader();
+				m_headerReader.clear();
+				data += posBody;
+				size -= (sl_uint32)posBody;
+				if (!(_startContent(request, header))) {
+					return;
+				}
+			}
+		}
+	}
+
+	sl_bool _UrlRequest_HttpConnection::_startContent(UrlRequest_Impl* request, const Memory& header)
+	{
+		HttpResponse response;
+		sl_reg iRet = response.parseResponsePacket(header.getData(), header.getSize());
+		if (iRet != (sl_reg)(header.getSize())) {
+			close("Invalid response header");
+			return sl_false;
+		}
+		sl_uint32 code = (sl_uint32)(response.getResponseCode());
+		if (code >= 100 && code < 200) {
+			// interim response: the final response follows
+			return sl_true;
+		}
+		String connection = response.getResponseHeader(HttpHeaders::Connection).toLower();
+		if (response.getResponseVersion() == "HTTP/1.0") {
+			m_flagKeepAlive = connection.contains("keep-alive");
+		} else {
+			m_flagKeepAlive = !(connection.contains("close"));
+		}
+		request->setResponse(response);
+		if (request->getMethod() == HttpMethod::HEAD || code == 204 || code == 304) {
+			_completeResponse();
+			return sl_true;
+		}
+		String encoding = response.getResponseContentEncoding().toLower();
+		sl_bool flagDecompress = encoding == "gzip" || encoding == "x-gzip" || encoding == "deflate";
+		Ptr<IHttpContentReaderListener> listener(this);
+		Ref<HttpContentReader> reader;
+		if (response.isChunkedResponse()) {
+			reader = HttpContentReader::createChunked(sl_null, listener, 0, flagDecompress);
+		} else if (response.containsResponseHeader(HttpHeaders::ContentLength)) {
+			sl_uint64 length = response.getResponseContentLengthHeader();
+			if (!length) {
+				_completeResponse();
+				return sl_true;
+			}
+			reader = HttpContentReader::createPersistent(sl_null, listener, length, 0, flagDecompress);
+		} else {
+			// the content ends with the connection
+			m_flagKeepAlive = sl_false;
+			m_flagReadingUntilClose = sl_true;
+			reader = HttpContentReader::createTearDown(sl_null, listener, 0, flagDecompress);
+		}
+		if (reader.isNull()) {
+			close("Failed to create the content reader");
+			return sl_false;
+		}
+		m_contentReader = reader;
+		m_flagReadingContent = sl_true;
+		return sl_true;
+	}
+
+	void _UrlRequest_HttpConnection::_completeResponse()
+	{
+		Ref<UrlRequest_Impl> request;
+		if (!(m_requests.popFront_NoLock(&request))) {
+			return;
+		}
+		request->m_connection.setNull();
+		if (!(request->m_flagPipelining)) {
+			m_nRequestsNotPipelining--;
+		}
+		m_contentReader.setNull();
+		m_flagReadingContent = sl_false;
+		m_flagReadingUntilClose = sl_false;
+		m_nResponses++;
+		request->finish();
+		if (!m_flagKeepAlive) {
+			close("Connection closed by the server");
+			return;
+		}
+		if (m_requests.isEmpty()) {
+			_startIdleTimer();
+			Ref<_UrlRequest_HttpHost> host = m_host;
+			if (host.isNotNull()) {
+				host->onConnectionIdle(this);
+			}
+		}
+	}
+
+	void _UrlRequest_HttpConnection::_startIdleTimer()
+	{
+		_stopIdleTimer();
+		m_timerIdle = m_loop->setTimeout(SLIB_INLINE_BIND_WEAKREF(void(), _UrlRequest_HttpConnection, _onIdleTimeout, this), _SLIB_URL_REQUEST_IDLE_TIMEOUT);
+	}
+
+	void _UrlRequest_HttpConnection::_stopIdleTimer()
+	{
+		if (m_timerIdle.isNotNull()) {
+			m_loop->clearTimeout(m_timerIdle);
+			m_timerIdle.setNull();
+		}
+	}
+
+	void _UrlRequest_HttpConnection::_onConnect(AsyncTcpSocket* socket, const SocketAddress& address, sl_bool flagError)
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		if (flagError) {
+			close("Failed to connect to " + address.toString());
+			return;
+		}
+		m_flagConnected = sl_true;
+		Ref<_UrlRequest_HttpConnection> thiz = this;
+		for (Link< Ref<UrlRequest_Impl> >* link = m_requests.getFront(); link; link = link->next) {
+			_send(link->value.get());
+			if (m_flagClosed) {
+				return;
+			}
+		}
+		_read();
+	}
+
+	void _UrlRequest_HttpConnection::_onSend(AsyncStreamResult* result)
+	{
+		if (result->flagError) {
+			close("Failed to send the request");
+		}
+	}
+
+	void _UrlRequest_HttpConnection::_onReceive(AsyncStreamResult* result)
+	{
+		if (m_flagClosed) {
+			return;
+		}
+		Ref<_UrlRequest_HttpConnection> thiz = this;
+		if (result->size > 0) {
+			_processData((sl_uint8*)(result->data), result->size);
+			if (m_flagClosed) {
+				return;
+			}
+		}
+		if (result->flagError) {
+			// the peer has closed the connection: take the data left in the socket buffer
+			Ref<Socket> socket = m_socket->getSocket();
+			if (socket.isNotNull()) {
+				sl_uint8* buf = (sl_uint8*)(m_bufRead.getData());
+				sl_uint32 sizeBuf = (sl_uint32)(m_bufRead.getSize());
+				for (;;) {
+					sl_int32 n = socket->receive(buf, sizeBuf);
+					if (n <= 0) {
+						break;
+					}
+					_processData(buf, (sl_uint32)n);
+					if (m_flagClosed) {
+						return;
+					}
+				}
+			}
+			if (m_flagReadingContent && m_flagReadingUntilClose) {
+				_completeResponse();
+			}
+			close("Connection closed by the server");
+			return;
+		}
+		_read();
+	}
+
+	void _UrlRequest_HttpConnection::_onIdleTimeout()
+	{
+		m_timerIdle.setNull();
+		if (m_requests.isEmpty()) {
+			close(sl_null);
+		}
+	}
+
+
+	_UrlRequest_HttpHost::_UrlRequest_HttpHost(const Ref<AsyncIoLoop>& loop, const Ref<ThreadPool>& threadPool, const String& name, sl_uint16 port)
+	{
+		m_loop = loop;
+		m_threadPool = threadPool;
+		m_name = name;
+		m_port = port;
+		m_flagIncomingPending = 0;
+		m_address.port = port;
+		m_flagIPAddress = m_address.ip.parse(name);
+		m_flagResolved = m_flagIPAddress;
+		m_flagResolving = sl_false;
+		m_flagProcessing = sl_false;
+		m_flagProcessAgain = sl_false;
+	}
+
+	_UrlRequest_HttpHost::~_UrlRequest_HttpHost()
+	{
+	}
+
+	void _UrlRequest_HttpHost::add(UrlRequest_Impl* request)
+	{
+		m_queueIncoming.push(request);
+		if (Base::interlockedCompareExchange32(&m_flagIncomingPending, 1, 0)) {
+			m_loop->addTask(SLIB_INLINE_BIND_REF(void(), _UrlRequest_HttpHost, _onIncoming, this));
+		}
+	}
+
+	void _UrlRequest_HttpHost::process()
+	{
+		if (m_flagProcessing) {
+			m_flagProcessAgain = sl_true;
+			return;
+		}
+		if (m_queueWaiting.isEmpty()) {
+			_removeIfUnused();
+			return;
+		}
+		if (!m_flagResolved) {
+			if (!m_flagResolving) {
+				m_flagResolving = sl_true;
+				if (!(m_threadPool->addTask(SLIB_FUNCTION_REF(_UrlRequest_HttpHost, _resolve, this)))) {
+					m_flagResolving = sl_false;
+					_failWaitingRequests("Failed to resolve the host: " + m_name);
+				}
+			}
+			return;
+		}
+		m_flagProcessing = sl_true;
+		do {
+			m_flagProcessAgain = sl_false;
+			Link< Ref<UrlRequest_Impl> >* link;
+			while ((link = m_queueWaiting.getFront())) {
+				Ref<UrlRequest_Impl> request = link->value;
+				if (request->isClosed()) {
+					m_queueWaiting.popFront_NoLock();
+					continue;
+				}
+				Ref<_UrlRequest_HttpConnection> connection = _getConnection(request.get());
+				if (connection.isNull()) {
+					if (m_connections.isEmpty()) {
+						m_queueWaiting.popFront_NoLock();
+						request->fail("Failed to create the connection to " + m_address.toString());
+						continue;
+					}
+					// all the connections are busy
+					break;
+				}
+				m_queueWaiting.popFront_NoLock();
+				connection->sendRequest(request.get());
+			}
+		} while (m_flagProcessAgain);
+		m_flagProcessing = sl_false;
+		_removeIfUnused();
+	}
+
+	void _UrlRequest_HttpHost::onConnectionIdle(_UrlRequest_HttpConnection* connection)
+	{
+		process();
+	}
+
+	void _UrlRequest_HttpHost::onConnectionClosed(_UrlRequest_HttpConnection* connection, CLinkedList< Ref<UrlRequest_Impl> >& requestsRetry, sl_bool flagConnected)
+	{
+		m_connections.removeValue_NoLock(connection);
+		if (!flagConnected && !m_flagIPAddress) {
+			// resolve again for the next connection
+			m_flagResolved = sl_false;
+		}
+		m_queueWaiting.pushFrontAll_NoLock(&requestsRetry);
+		process();
+	}
+
+	Ref<_UrlRequest_HttpConnection> _UrlRequest_HttpHost::_getConnection(UrlRequest_Impl* request)
+	{
+		for (Link< Ref<_UrlRequest_HttpConnection> >* link = m_connections.getFront(); link; link = link->next) {
+			if (link->value->isIdle()) {
+				return link->value;
+			}
+		}
+		if (m_connections.getCount() < _SLIB_URL_REQUEST_MAX_CONNECTIONS_PER_HOST) {
+			Ref<_UrlRequest_HttpConnection> connection = _UrlRequest_HttpConnection::create(this, m_address);
+			if (connection.isNotNull()) {
+				m_connections.pushBack_NoLock(connection);
+				return connection;
+			}
+			return sl_null;
+		}
+		if (request->m_flagPipelining) {
+			_UrlRequest_HttpConnection* best = sl_null;
+			sl_uint32 nBest = _SLIB_URL_REQUEST_MAX_PIPELINE_DEPTH;
+			for (Link< Ref<_UrlRequest_HttpConnection> >* link = m_connections.getFront(); link; link = link->next) {
+				_UrlRequest_HttpConnection* connection = link->value.get();
+				if (connection->isPipelining()) {
+					sl_uint32 n = connection->getRequestsCount();
+					if (n < nBest) {
+						best = connection;
+						nBest = n;
+					}
+				}
+			}
+			return best;
+		}
+		return sl_null;
+	}
+
+	void _UrlRequest_HttpHost::_failWaitingRequests(const String& error)
+	{
+		Ref<UrlRequest_Impl> request;
+		while (m_queueWaiting.popFront_NoLock(&request)) {
+			request->fail(error);
+		}
+		_removeIfUnused();
+	}
+
+	void _UrlRequest_HttpHost::_removeIfUnused()
+	{
+		if (m_flagProcessing || m_flagResolving || m_connections.isNotEmpty() || m_queueWaiting.isNotEmpty() || m_flagIncomingPending) {
+			return;
+		}
+		// `add()` may still push a request to the removed host: it is served by this host, and the next requests create a new one
+		_UrlRequest_HttpClient* client = _UrlRequest_getHttpClient();
+		if (client) {
+			client->removeHost(this);
+		}
+	}
+
+	void _UrlRequest_HttpHost::_onIncoming()
+	{
+		// clear before draining: the requests pushed from now will dispatch again
+		Base::interlockedCompareExchange32(&m_flagIncomingPending, 0, 1);
+		Ref<UrlRequest_Impl> request;
+		while (m_queueIncoming.pop(&request)) {
+			request->startTimer();
+			m_queueWaiting.pushBack_NoLock(request);
+		}
+		process();
+	}
+
+	void _UrlRequest_HttpHost::_resolve()
+	{
+		IPAddress ip = Network::getIPAddressFromHostName(m_name);
+		m_loop->addTask(SLIB_INLINE_BIND_REF(void(), _UrlRequest_HttpHost, _onResolved, this, ip));
+	}
+
+	void _UrlRequest_HttpHost::_onResolved(const IPAddress& ip)
+	{
+		m_flagResolving = sl_false;
+		if (ip.isNone()) {
+			_failWaitingRequests("Failed to resolve the host: " + m_name);
+			return;
+		}
+		m_address.ip = ip;
+		m_flagResolved = sl_true;
+		process();
+	}
+
+
+	Ref<UrlRequest> UrlRequest::_create(const UrlRequestParam& param, const String& url)
+	{
+		return Ref<UrlRequest>::from(UrlRequest_Impl::create(param, url));
+	}
+
+}
+
+#endif
@@ -12,10 +12,325 @@
 
 #include "slib/web/service.h"
 #include "slib/core/xml.h"
+#include "slib/core/json.h"
+#include "slib/core/log.h"
+#include "slib/network/url.h"
 
 namespace slib
 {
 
+	class _WebRouterNode
+	{
+	public:
+		struct Child
+		{
+			const sl_char8* data;
+			sl_size length;
+			sl_uint32 hash;
+			_WebRouterNode* node;
+			String segment;
+		};
+		// open-addressing table of the static children, the capacity is a power of two
+		List<Child> children;
+		sl_size countChildren;
+		_WebRouterNode* param;
+		_WebRouterNode* wildcard;
+
+		WebHandler handler;
+		List<String> parameterNames;
+
+	public:
+		_WebRouterNode()
+		{
+			countChildren = 0;
+			param = sl_null;
+			wildcard = sl_null;
+		}
+
+		~_WebRouterNode()
+		{
+			ListElements<Child> list(children);
+			for (sl_size i = 0; i < list.count; i++) {
+				if (list[i].node) {
+					delete list[i].node;
+				}
+			}
+			if (param) {
+				delete param;
+			}
+			if (wildcard) {
+				delete wildcard;
+			}
+		}
+
+	public:
+		// FNV-1a, computed while scanning the segment in `match()`
+		static sl_uint32 hashSegment(const sl_char8* segment, sl_size len)
+		{
+			sl_uint32 hash = 2166136261U;
+			for (sl_size i = 0; i < len; i++) {
+				hash = (hash ^ (sl_uint8)(segment[i])) * 16777619U;
+			}
+			return hash;
+		}
+
+		_WebRouterNode* findChild(const sl_char8* segment, sl_size len, sl_uint32 hash) const
+		{
+			if (!countChildren) {
+				return sl_null;
+			}
+			Child* data = children.getData();
+			sl_size mask = children.getCount() - 1;
+			sl_size index = hash & mask;
+			for (;;) {
+				Child& child = data[index];
+				if (!(child.node)) {
+					return sl_null;
+				}
+				if (child.hash == hash && child.length == len && Base::equalsMemory(child.data, segment, len)) {
+					return child.node;
+				}
+				index = (index + 1) & mask;
+			}
+		}
+
+		static void _insertChild(Child* data, sl_size mask, const Child& child)
+		{
+			sl_size index = child.hash & mask;
+			while (data[index].node) {
+				index = (index + 1) & mask;
+			}
+			data[index] = child;
+		}
+
+		_WebRouterNode* getChild(const String& segment)
+		{
+			sl_uint32 hash = hashSegment(segment.getData(), segment.getLength());
+			_WebRouterNode* node = findChild(segment.getData(), segment.getLength(), hash);
+			if (node) {
+				return node;
+			}
+			sl_size capacity = children.getCount();
+			if ((countChildren + 1) << 1 > capacity) {
+				sl_size capacityNew = capacity ? capacity << 1 : 4;
+				List<Child> table;
+				if (!(table.setCount_NoLock(capacityNew))) {
+					return sl_null;
+				}
+				Child* data = table.getData();
+				for (sl_size i = 0; i < capacityNew; i++) {
+					data[i].node = sl_null;
+				}
+				ListElements<Child> list(children);
+				for (sl_size i = 0; i < list.count; i++) {
+					if (list[i].node) {
+						_insertChild(data, capacityNew - 1, list[i]);
+					}
+				}
+				children = table;
+			}
+			node = new _WebRouterNode;
+			if (node) {
+				Child child;
+				child.segment = segment;
+				child.data = segment.getData();
+				child.length = segment.getLength();
+				child.hash = hash;
+				child.node = node;
+				_insertChild(children.getData(), children.getCount() - 1, child);
+				countChildren++;
+			}
+			return node;
+		}
+
+		// `path` is the rest of the path after the slash, `flagSegment` is false when no segment is left
+		const _WebRouterNode* match(const sl_char8* path, const sl_char8* end, sl_bool flagSegment, WebRouteMatch& match) const
+		{
+			if (!flagSegment) {
+				if (handler.isNotNull()) {
+					return this;
+				}
+				return sl_null;
+			}
+			const sl_char8* p = path;
+			sl_uint32 hash = 2166136261U;
+			while (p < end && *p != '/') {
+				hash = (hash ^ (sl_uint8)(*p)) * 16777619U;
+				p++;
+			}
+			const sl_char8* next = p + 1;
+			sl_bool flagNext = p < end;
+			if (countChildren) {
+				_WebRouterNode* child = findChild(path, p - path, hash);
+				if (child) {
+					const _WebRouterNode* ret = child->match(next, end, flagNext, match);
+					if (ret) {
+						return ret;
+					}
+				}
+			}
+			sl_uint32 n = match.countParameters;
+			if (param && p > path && n < SLIB_WEB_ROUTER_MAX_PARAMETERS) {
+				match.parameterValues[n] = path;
+				match.parameterLengths[n] = p - path;
+				match.countParameters = n + 1;
+				const _WebRouterNode* ret = param->match(next, end, flagNext, match);
+				if (ret) {
+					return ret;
+				}
+				match.countParameters = n;
+			}
+			if (wildcard && wildcard->handler.isNotNull() && n < SLIB_WEB_ROUTER_MAX_PARAMETERS) {
+				match.parameterValues[n] = path;
+				match.parameterLengths[n] = end - path;
+				match.countParameters = n + 1;
+				return wildcard;
+			}
+			return sl_null;
+		}
+
+	};
+
+
+	WebRouteMatch::WebRouteMatch()
+	{
+		handler = sl_null;
+		parameterNames = sl_null;
+		countParameters = 0;
+	}
+
+	String WebRouteMatch::getParameterValue(sl_uint32 index) const
+	{
+		if (index < countParameters) {
+			return String(parameterValues[index], parameterLengths[index]);
+		}
+		return sl_null;
+	}
+
+
+	SLIB_DEFINE_OBJECT(WebRouter, Referable)
+
+	WebRouter::WebRouter()
+	{
+		for (sl_uint32 i = 0; i < SLIB_WEB_ROUTER_METHODS_COUNT; i++) {
+			m_roots[i] = sl_null;
+		}
+	}
+
+	WebRouter::~WebRouter()
+	{
+		for (sl_uint32 i = 0; i < SLIB_WEB_ROUTER_METHODS_COUNT; i++) {
+			if (m_roots[i]) {
+				delete m_roots[i];
+			}
+		}
+	}
+
+	sl_bool WebRouter::add(HttpMethod method, const String& pattern, const WebHandler& handler)
+	{
+		sl_uint32 indexMethod = (sl_uint32)method;
+		if (indexMethod >= SLIB_WEB_ROUTER_METHODS_COUNT || handler.isNull()) {
+			return sl_false;
+		}
+		List<String> segments;
+		{
+			const sl_char8* sz = pattern.getData();
+			sl_size len = pattern.getLength();
+			sl_size pos = 0;
+			if (len && sz[0] == '/') {
+				pos = 1;
+			}
+			if (pos < len) {
+				sl_size start = pos;
+				for (; pos <= len; pos++) {
+					if (pos == len || sz[pos] == '/') {
+						segments.add_NoLock(String(sz + start, pos - start));
+						start = pos + 1;
+					}
+				}
+			}
+		}
+		List<String> names;
+		_WebRouterNode* node = m_roots[indexMethod];
+		if (!node) {
+			node = new _WebRouterNode;
+			if (!node) {
+				return sl_false;
+			}
+			m_roots[indexMethod] = node;
+		}
+		ListElements<String> list(segments);
+		for (sl_size i = 0; i < list.count; i++) {
+			String& segment = list[i];
+			sl_size len = segment.getLength();
+			const sl_char8* sz = segment.getData();
+			_WebRouterNode** pChild = sl_null;
+			if (len >= 2 && sz[0] == '{' && sz[len - 1] == '}') {
+				names.add_NoLock(String(sz + 1, len - 2));
+				pChild = &(node->param);
+			} else if (len >= 1 && sz[0] == '*') {
+				if (i + 1 != list.count) {
+					LogError("WebRouter", "Wildcard must be the last segment: %s", pattern);
+					return sl_false;
+				}
+				if (len == 1) {
+					names.add_NoLock(segment);
+				} else {
+					names.add_NoLock(String(sz + 1, len - 1));
+				}
+				pChild = &(node->wildcard);
+			}
+			if (pChild) {
+				if (names.getCount() > SLIB_WEB_ROUTER_MAX_PARAMETERS) {
+					LogError("WebRouter", "Too many parameters: %s", pattern);
+					return sl_false;
+				}
+				if (!(*pChild)) {
+					*pChild = new _WebRouterNode;
+				}
+				node = *pChild;
+			} else {
+				node = node->getChild(segment);
+			}
+			if (!node) {
+				return sl_false;
+			}
+		}
+		node->handler = handler;
+		node->parameterNames = names;
+		return sl_true;
+	}
+
+	sl_bool WebRouter::match(HttpMethod method, const sl_char8* path, sl_size length, WebRouteMatch& match) const
+	{
+		sl_uint32 indexMethod = (sl_uint32)method;
+		if (indexMethod >= SLIB_WEB_ROUTER_METHODS_COUNT) {
+			return sl_false;
+		}
+		_WebRouterNode* root = m_roots[indexMethod];
+		if (!root) {
+			return sl_false;
+		}
+		const sl_char8* end = path + length;
+		if (length && *path == '/') {
+			path++;
+		}
+		match.countParameters = 0;
+		const _WebRouterNode* node = root->match(path, end, path < end, match);
+		if (node) {
+			match.handler = &(node->handler);
+			match.parameterNames = node->parameterNames.getData();
+			return sl_true;
+		}
+		return sl_false;
+	}
+
+	sl_bool WebRouter::match(HttpMethod method, const String& path, WebRouteMatch& match) const
+	{
+		return this->match(method, path.getData(), path.getLength(), match);
+	}
+
+
 	SLIB_DEFINE_OBJECT(WebController, Object)
 
 	WebController::WebController()
@@ -30,25 +345,36 @@ namespace slib
 	void WebController::registerHandler(HttpMethod method, const String& path, const WebHandler& handler)
 	{
 		if (handler.isNotNull()) {
-			String sig = _getHandlerSignature(method, path);
-			m_handlers.put(sig, handler);
+			ObjectLocker lock(this);
+			_Handler h;
+			h.method = method;
+			h.path = path;
+			h.handler = handler;
+			m_handlers.add_NoLock(h);
+			m_router.setNull();
 		}
 	}
 
 	sl_bool WebController::onHttpRequest(const Ref<HttpServiceContext>& context)
 	{
+		Ref<WebRouter> router = _getRouter();
+		if (router.isNull()) {
+			return sl_false;
+		}
 		HttpMethod method = context->getMethod();
 		String path = context->getPath();
-		String sig = _getHandlerSignature(method, path);
-		WebHandler handler;
-		if (m_handlers.get(sig, &handler)) {
-			Variant ret(handler(context, method, path));
+		WebRouteMatch match;
+		if (router->match(method, path, match)) {
+			for (sl_uint32 i = 0; i < match.countParameters; i++) {
+				context->setPathParameter(match.parameterNames[i], Url::decodeUriComponentByUTF8(match.getParameterValue(i)));
+			}
+			Variant ret((*(match.handler))(context, method, path));
 			if (ret.isNotNull()) {
 				if (ret.isObject()) {
 					Ref<Referable> obj = ret.getObject();
 					if (obj.isNotNull()) {
 						if (IsInstanceOf< Map<String, Variant> >(obj)) {
-							context->write(ret.toJsonString());
+							context->writeJson(ret);
 						} else if (XmlDocument* xml = CastInstance<XmlDocument>(obj.get())) {
 							context->write(xml->toString());
 						} else if (CMemory* mem = CastInstance<CMemory>(obj.get())) {
@@ -64,9 +390,27 @@ namespace slib
 		return sl_false;
 	}
 
-	String WebController::_getHandlerSignature(HttpMethod method, const String& path)
+	Ref<WebRouter> WebController::_getRouter()
 	{
-		return HttpMethods::toString(method) + " " + path;
+		Ref<WebRouter> router = m_router;
+		if (router.isNotNull()) {
+			return router;
+		}
+		ObjectLocker lock(this);
+		router = m_router;
+		if (router.isNotNull()) {
+			return router;
+		}
+		router = new WebRouter;
+		if (router.isNull()) {
+			return sl_null;
+		}
+		ListElements<_Handler> list(m_handlers);
+		for (sl_size i = 0; i < list.count; i++) {
+			router->add(list[i].method, list[i].path, list[i].handler);
+		}
+		m_router = router;
+		return router;
 	}
 
 
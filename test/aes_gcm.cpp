@@ -0,0 +1,407 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/crypto/aes.h"
+#include "slib/core/mio.h"
+#include "slib/core/string.h"
+
+#include "test.h"
+
+#include <vector>
+
+using namespace slib;
+
+/*
+	Validates AES and AES-GCM with the known-answer vectors of FIPS-197 and of the GCM specification,
+	then compares the multi-block operations (AES-NI and PCLMULQDQ when available) with a scalar reference:
+	the T-table cipher (`AES::encrypt()` on the words) and a bitwise GHASH (NIST SP 800-38D, Algorithm 1).
+*/
+
+typedef std::vector<sl_uint8> Bytes;
+
+static Bytes fromHex(const char* hex)
+{
+	String s(hex);
+	Bytes ret(s.getLength() / 2);
+	if (ret.size()) {
+		SLIB_TEST_CHECK(s.parseHexString(ret.data()))
+	}
+	return ret;
+}
+
+static sl_uint32 g_random = 0x2545F491;
+
+static sl_uint32 getRandom()
+{
+	sl_uint32 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_random = x;
+	return x;
+}
+
+static Bytes getRandomBytes(sl_size n)
+{
+	Bytes ret(n);
+	for (sl_size i = 0; i < n; i++) {
+		ret[i] = (sl_uint8)(getRandom());
+	}
+	return ret;
+}
+
+static void encryptReference(const AES& aes, const sl_uint8* src, sl_uint8* dst)
+{
+	sl_uint32 d0 = MIO::readUint32BE(src);
+	sl_uint32 d1 = MIO::readUint32BE(src + 4);
+	sl_uint32 d2 = MIO::readUint32BE(src + 8);
+	sl_uint32 d3 = MIO::readUint32BE(src + 12);
+	aes.encrypt(d0, d1, d2, d3);
+	MIO::writeUint32BE(dst, d0);
+	MIO::writeUint32BE(dst + 4, d1);
+	MIO::writeUint32BE(dst + 8, d2);
+	MIO::writeUint32BE(dst + 12, d3);
+}
+
+static void decryptReference(const AES& aes, const sl_uint8* src, sl_uint8* dst)
+{
+	sl_uint32 d0 = MIO::readUint32BE(src);
+	sl_uint32 d1 = MIO::readUint32BE(src + 4);
+	sl_uint32 d2 = MIO::readUint32BE(src + 8);
+	sl_uint32 d3 = MIO::readUint32BE(src + 12);
+	aes.decrypt(d0, d1, d2, d3);
+	MIO::writeUint32BE(dst, d0);
+	MIO::writeUint32BE(dst + 4, d1);
+	MIO::writeUint32BE(dst + 8, d2);
+	MIO::writeUint32BE(dst + 12, d3);
+}
+
+static void increaseCounter(sl_uint8* counter, sl_uint32 sizeCounter)
+{
+	for (sl_uint32 i = 15; i >= 16 - sizeCounter; i--) {
+		if (++(counter[i])) {
+			break;
+		}
+	}
+}
+
+// X = X * Y in GF(2^128), bit by bit
+static void multiplyReference(sl_uint8* X, const sl_uint8* Y)
+{
+	sl_uint8 Z[16] = {0};
+	sl_uint8 V[16];
+	Base::copyMemory(V, Y, 16);
+	for (sl_uint32 i = 0; i < 128; i++) {
+		if ((X[i >> 3] >> (7 - (i & 7))) & 1) {
+			for (sl_uint32 k = 0; k < 16; k++) {
+				Z[k] ^= V[k];
+			}
+		}
+		sl_bool flagLsb = V[15] & 1;
+		for (sl_uint32 k = 15; k > 0; k--) {
+			V[k] = (sl_uint8)((V[k] >> 1) | (V[k - 1] << 7));
+		}
+		V[0] >>= 1;
+		if (flagLsb) {
+			V[0] ^= 0xE1;
+		}
+	}
+	Base::copyMemory(X, Z, 16);
+}
+
+static void ghashReference(sl_uint8* X, const sl_uint8* H, const Bytes& data)
+{
+	for (sl_size i = 0; i < data.size(); i += 16) {
+		for (sl_size k = 0; k < 16 && i + k < data.size(); k++) {
+			X[k] ^= data[i + k];
+		}
+		multiplyReference(X, H);
+	}
+}
+
+static void gcmReference(const Bytes& key, const Bytes& iv, const Bytes& aad, const Bytes& input, Bytes& output, sl_uint8* tag)
+{
+	AES aes;
+	SLIB_TEST_CHECK(aes.setKey(key.data(), (sl_uint32)(key.size())))
+	sl_uint8 H[16] = {0};
+	encryptReference(aes, H, H);
+	sl_uint8 J0[16] = {0};
+	if (iv.size() == 12) {
+		Base::copyMemory(J0, iv.data(), 12);
+		J0[15] = 1;
+	} else {
+		ghashReference(J0, H, iv);
+		sl_uint8 len[16] = {0};
+		MIO::writeUint64BE(len + 8, (sl_uint64)(iv.size()) * 8);
+		for (sl_uint32 k = 0; k < 16; k++) {
+			J0[k] ^= len[k];
+		}
+		multiplyReference(J0, H);
+	}
+	sl_uint8 counter[16];
+	Base::copyMemory(counter, J0, 16);
+	output.resize(input.size());
+	for (sl_size i = 0; i < input.size(); i += 16) {
+		increaseCounter(counter, 4);
+		sl_uint8 mask[16];
+		encryptReference(aes, counter, mask);
+		for (sl_size k = 0; k < 16 && i + k < input.size(); k++) {
+			output[i + k] = input[i + k] ^ mask[k];
+		}
+	}
+	sl_uint8 X[16] = {0};
+	ghashReference(X, H, aad);
+	ghashReference(X, H, output);
+	sl_uint8 len[16];
+	MIO::writeUint64BE(len, (sl_uint64)(aad.size()) * 8);
+	MIO::writeUint64BE(len + 8, (sl_uint64)(output.size()) * 8);
+	for (sl_uint32 k = 0; k < 16; k++) {
+		X[k] ^= len[k];
+	}
+	multiplyReference(X, H);
+	encryptReference(aes, J0, tag);
+	for (sl_uint32 k = 0; k < 16; k++) {
+		tag[k] ^= X[k];
+	}
+}
+
+static void testBlockVectors()
+{
+	SLIB_TEST_SECTION("FIPS-197 known-answer vectors")
+
+	static const char* vectors[][3] = {
+		{"000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a"},
+		{"000102030405060708090a0b0c0d0e0f1011121314151617", "00112233445566778899aabbccddeeff", "dda97ca4864cdfe06eaf70a0ec0d7191"},
+		{"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", "00112233445566778899aabbccddeeff", "8ea2b7ca516745bfeafc49904b496089"}
+	};
+	for (sl_size i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		Bytes key = fromHex(vectors[i][0]);
+		Bytes plain = fromHex(vectors[i][1]);
+		Bytes cipher = fromHex(vectors[i][2]);
+		AES aes;
+		SLIB_TEST_CHECK(aes.setKey(key.data(), (sl_uint32)(key.size())))
+		sl_uint8 out[16];
+		aes.encryptBlock(plain.data(), out);
+		SLIB_TEST_CHECK(Base::equalsMemory(out, cipher.data(), 16))
+		aes.decryptBlock(cipher.data(), out);
+		SLIB_TEST_CHECK(Base::equalsMemory(out, plain.data(), 16))
+		encryptReference(aes, plain.data(), out);
+		SLIB_TEST_CHECK(Base::equalsMemory(out, cipher.data(), 16))
+	}
+	printf("  hardware accelerated: %s\n", AES::isHardwareAccelerated() ? "yes" : "no");
+}
+
+static void testGcmVectors()
+{
+	SLIB_TEST_SECTION("GCM known-answer vectors")
+
+	static const char* P = "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255";
+	static const char* P60 = "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+	static const char* K = "feffe9928665731c6d6a8f9467308308";
+	static const char* K256 = "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308";
+	static const char* IV = "cafebabefacedbaddecaf888";
+	static const char* A = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+	// key, IV, AAD, plain, cipher, tag (test cases 1-6, 13-16)
+	static const char* vectors[][6] = {
+		{"00000000000000000000000000000000", "000000000000000000000000", "", "", "", "58e2fccefa7e3061367f1d57a4e7455a"},
+		{"00000000000000000000000000000000", "000000000000000000000000", "", "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78", "ab6e47d42cec13bdf53a67b21257bddf"},
+		{K, IV, "", P, "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985", "4d5c2af327cd64a62cf35abd2ba6fab4"},
+		{K, IV, A, P60, "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091", "5bc94fbc3221a5db94fae95ae7121a47"},
+		{K, "cafebabefacedbad", A, P60, "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c742373806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598", "3612d2e79e3b0785561be14aaca2fccb"},
+		{K, "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b", A, P60, "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5", "619cc5aefffe0bfa462af43c1699d050"},
+		{"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "", "", "", "530f8afbc74536b9a963b4f1c4cb738b"},
+		{"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "", "00000000000000000000000000000000", "cea7403d4d606b6e074ec5d3baf39d18", "d0d1c8a799996bf0265b98b5d48ab919"},
+		{K256, IV, "", P, "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad", "b094dac5d93471bdec1a502270e3cc6c"},
+		{K256, IV, A, P60, "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662", "76fc6ece0f4e1768cddf8853bb2d551b"}
+	};
+	for (sl_size i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		Bytes key = fromHex(vectors[i][0]);
+		Bytes iv = fromHex(vectors[i][1]);
+		Bytes aad = fromHex(vectors[i][2]);
+		Bytes plain = fromHex(vectors[i][3]);
+		Bytes cipher = fromHex(vectors[i][4]);
+		Bytes tag = fromHex(vectors[i][5]);
+
+		Bytes output;
+		sl_uint8 tagOut[16];
+		gcmReference(key, iv, aad, plain, output, tagOut);
+		SLIB_TEST_CHECK(output == cipher)
+		SLIB_TEST_CHECK(Base::equalsMemory(tagOut, tag.data(), 16))
+
+		AES_GCM gcm;
+		gcm.setKey(key.data(), (sl_uint32)(key.size()));
+		output.resize(plain.size() + 1);
+		SLIB_TEST_CHECK(gcm.encrypt(iv.data(), iv.size(), aad.data(), aad.size(), plain.data(), output.data(), plain.size(), tagOut))
+		output.resize(plain.size());
+		SLIB_TEST_CHECK(output == cipher)
+		SLIB_TEST_CHECK(Base::equalsMemory(tagOut, tag.data(), 16))
+		output.resize(plain.size() + 1);
+		SLIB_TEST_CHECK(gcm.decrypt(iv.data(), iv.size(), aad.data(), aad.size(), cipher.data(), output.data(), cipher.size(), tag.data()))
+		output.resize(plain.size());
+		SLIB_TEST_CHECK(output == plain)
+		tag[i % 16] ^= 1;
+		SLIB_TEST_CHECK(!(gcm.check(iv.data(), iv.size(), aad.data(), aad.size(), cipher.data(), cipher.size(), tag.data())))
+	}
+}
+
+static void testGcmRandom()
+{
+	SLIB_TEST_SECTION("GCM matches the scalar reference")
+
+	static const sl_uint32 keyLengths[] = {16, 24, 32};
+	static const sl_size sizes[] = {0, 1, 15, 16, 17, 127, 128, 129, 1023, 1024, 4096 + 7, 70000};
+	for (sl_size iKey = 0; iKey < 3; iKey++) {
+		for (sl_size iSize = 0; iSize < sizeof(sizes) / sizeof(sizes[0]); iSize++) {
+			Bytes key = getRandomBytes(keyLengths[iKey]);
+			Bytes iv = getRandomBytes((iSize % 3) ? 12 : 1 + getRandom() % 64);
+			Bytes aad = getRandomBytes(getRandom() % 100);
+			sl_size size = sizes[iSize];
+			// unaligned buffers
+			Bytes input = getRandomBytes(size + 3);
+			Bytes plain(input.begin() + 3, input.end());
+
+			Bytes expected;
+			sl_uint8 tagExpected[16];
+			gcmReference(key, iv, aad, plain, expected, tagExpected);
+
+			AES_GCM gcm;
+			gcm.setKey(key.data(), keyLengths[iKey]);
+			Bytes output(size + 5);
+			sl_uint8 tag[16];
+			SLIB_TEST_CHECK(gcm.encrypt(iv.data(), iv.size(), aad.data(), aad.size(), input.data() + 3, output.data() + 5, size, tag))
+			SLIB_TEST_CHECK(Base::equalsMemory(output.data() + 5, expected.data(), size))
+			SLIB_TEST_CHECK(Base::equalsMemory(tag, tagExpected, 16))
+
+			// streaming in place, in pieces of whole blocks (a partial block ends the stream)
+			Bytes stream = plain;
+			SLIB_TEST_CHECK(gcm.start(iv.data(), iv.size()))
+			gcm.put(aad.data(), aad.size());
+			sl_size pos = 0;
+			while (pos < size) {
+				sl_size n = 16 * (1 + getRandom() % 80);
+				if (n > size - pos) {
+					n = size - pos;
+				}
+				gcm.encrypt(stream.data() + pos, stream.data() + pos, n);
+				pos += n;
+			}
+			SLIB_TEST_CHECK(gcm.finish(aad.size(), size, tag))
+			SLIB_TEST_CHECK(stream == expected)
+			SLIB_TEST_CHECK(Base::equalsMemory(tag, tagExpected, 16))
+
+			Bytes decrypted(size + 1);
+			SLIB_TEST_CHECK(gcm.decrypt(iv.data(), iv.size(), aad.data(), aad.size(), expected.data(), decrypted.data(), size, tagExpected))
+			decrypted.resize(size);
+			SLIB_TEST_CHECK(decrypted == plain)
+		}
+	}
+
+	SLIB_TEST_SECTION("GCM counter wraps in the low 32 bits")
+
+	Bytes key = getRandomBytes(16);
+	// starting at IV || 0xFFFFFFFE, the third block uses the counter 0x00000000 without carrying into the IV
+	Bytes iv = getRandomBytes(12);
+	AES aes;
+	SLIB_TEST_CHECK(aes.setKey(key.data(), 16))
+	sl_uint8 counter[16];
+	Base::copyMemory(counter, iv.data(), 12);
+	MIO::writeUint32BE(counter + 12, 0xFFFFFFFE);
+	Bytes plain = getRandomBytes(16 * 20);
+	Bytes output(plain.size());
+	sl_uint8 counterRef[16];
+	Base::copyMemory(counterRef, counter, 16);
+	aes.encryptBlocks_CTR(counter, plain.data(), output.data(), 20, 4);
+	for (sl_size i = 0; i < 20; i++) {
+		sl_uint8 mask[16];
+		encryptReference(aes, counterRef, mask);
+		for (sl_uint32 k = 0; k < 16; k++) {
+			SLIB_TEST_CHECK(output[i * 16 + k] == (plain[i * 16 + k] ^ mask[k]))
+		}
+		increaseCounter(counterRef, 4);
+	}
+	SLIB_TEST_CHECK(Base::equalsMemory(counter, counterRef, 16))
+	SLIB_TEST_CHECK(Base::equalsMemory(counter, iv.data(), 12))
+}
+
+static void testBlockModes()
+{
+	SLIB_TEST_SECTION("multi-block ECB, CBC and CTR match the scalar reference")
+
+	static const sl_uint32 keyLengths[] = {16, 24, 32};
+	static const sl_size counts[] = {1, 2, 7, 8, 9, 16, 17, 100};
+	for (sl_size iKey = 0; iKey < 3; iKey++) {
+		for (sl_size iCount = 0; iCount < sizeof(counts) / sizeof(counts[0]); iCount++) {
+			sl_size n = counts[iCount];
+			Bytes key = getRandomBytes(keyLengths[iKey]);
+			AES aes;
+			SLIB_TEST_CHECK(aes.setKey(key.data(), keyLengths[iKey]))
+			Bytes plain = getRandomBytes(n * 16);
+
+			// ECB
+			Bytes expected(n * 16);
+			for (sl_size i = 0; i < n; i++) {
+				encryptReference(aes, plain.data() + i * 16, expected.data() + i * 16);
+			}
+			Bytes output(n * 16);
+			aes.encryptBlocks_ECB(plain.data(), output.data(), n);
+			SLIB_TEST_CHECK(output == expected)
+			aes.decryptBlocks_ECB(output.data(), output.data(), n);
+			SLIB_TEST_CHECK(output == plain)
+
+			// CBC decryption, out of place and in place
+			Bytes iv = getRandomBytes(16);
+			Bytes cipher = getRandomBytes(n * 16);
+			expected.assign(n * 16, 0);
+			for (sl_size i = 0; i < n; i++) {
+				decryptReference(aes, cipher.data() + i * 16, expected.data() + i * 16);
+				const sl_uint8* prev = i ? cipher.data() + (i - 1) * 16 : iv.data();
+				for (sl_uint32 k = 0; k < 16; k++) {
+					expected[i * 16 + k] ^= prev[k];
+				}
+			}
+			Bytes ivWork = iv;
+			aes.decryptBlocks_CBC(ivWork.data(), cipher.data(), output.data(), n);
+			SLIB_TEST_CHECK(output == expected)
+			SLIB_TEST_CHECK(Base::equalsMemory(ivWork.data(), cipher.data() + (n - 1) * 16, 16))
+			output = cipher;
+			ivWork = iv;
+			aes.decryptBlocks_CBC(ivWork.data(), output.data(), output.data(), n);
+			SLIB_TEST_CHECK(output == expected)
+
+			// CTR with a carry over the 64-bit boundary
+			sl_uint8 counter[16];
+			Base::copyMemory(counter, iv.data(), 16);
+			MIO::writeUint64BE(counter + 8, (sl_uint64)0 - 3);
+			sl_uint8 counterRef[16];
+			Base::copyMemory(counterRef, counter, 16);
+			for (sl_size i = 0; i < n; i++) {
+				sl_uint8 mask[16];
+				encryptReference(aes, counterRef, mask);
+				for (sl_uint32 k = 0; k < 16; k++) {
+					expected[i * 16 + k] = plain[i * 16 + k] ^ mask[k];
+				}
+				increaseCounter(counterRef, 16);
+			}
+			aes.encryptBlocks_CTR(counter, plain.data(), output.data(), n);
+			SLIB_TEST_CHECK(output == expected)
+			SLIB_TEST_CHECK(Base::equalsMemory(counter, counterRef, 16))
+		}
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	testBlockVectors();
+	testGcmVectors();
+	testGcmRandom();
+	testBlockModes();
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/math/bigint.h"
+
+#include "test.h"
+
+#include <vector>
+
+using namespace slib;
+
+/*
+	Validates the 64-bit limb multiplication (schoolbook and Karatsuba) and the Montgomery exponentiation
+	(variable and constant time) against a scalar reference on the 32-bit elements:
+	schoolbook products, and square-and-multiply reduced by `CBigInt::divAbs()`.
+	The sizes cross the Karatsuba and the Montgomery cutoffs and the limb boundaries.
+*/
+
+typedef std::vector<sl_uint32> Elements;
+
+static sl_uint32 g_random = 0x9E3779B9;
+
+static sl_uint32 getRandom()
+{
+	sl_uint32 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_random = x;
+	return x;
+}
+
+// random elements, sometimes all ones or with zero runs to exercise the carries
+static Elements getRandomElements(sl_size n)
+{
+	Elements e(n);
+	sl_uint32 pattern = getRandom() % 8;
+	for (sl_size i = 0; i < n; i++) {
+		if (pattern == 0) {
+			e[i] = 0xFFFFFFFF;
+		} else if (pattern == 1) {
+			e[i] = (getRandom() % 4) ? 0 : getRandom();
+		} else {
+			e[i] = getRandom();
+		}
+	}
+	if (n) {
+		e[n - 1] |= 0x80000000;
+	}
+	return e;
+}
+
+static void setElements(CBigInt& a, const Elements& e)
+{
+	SLIB_TEST_CHECK(a.setValueFromElements(e.data(), e.size()))
+}
+
+static Elements getElements(const CBigInt& a)
+{
+	sl_size n = a.getMostSignificantElements();
+	return Elements(a.elements, a.elements + n);
+}
+
+static void trim(Elements& e)
+{
+	while (e.size() && !(e.back())) {
+		e.pop_back();
+	}
+}
+
+static Elements mulReference(const Elements& a, const Elements& b)
+{
+	Elements c(a.size() + b.size(), 0);
+	for (sl_size i = 0; i < a.size(); i++) {
+		sl_uint64 carry = 0;
+		for (sl_size j = 0; j < b.size(); j++) {
+			sl_uint64 t = (sl_uint64)(a[i]) * b[j] + c[i + j] + carry;
+			c[i + j] = (sl_uint32)t;
+			carry = t >> 32;
+		}
+		c[i + b.size()] = (sl_uint32)carry;
+	}
+	trim(c);
+	return c;
+}
+
+static Elements modReference(const Elements& a, const CBigInt& m)
+{
+	CBigInt A, R;
+	setElements(A, a);
+	SLIB_TEST_CHECK(CBigInt::divAbs(A, m, sl_null, &R))
+	return getElements(R);
+}
+
+static Elements powReference(const Elements& a, const Elements& e, const CBigInt& m)
+{
+	Elements base = modReference(a, m);
+	Elements result(1, 1);
+	result = modReference(result, m);
+	for (sl_size i = e.size() * 32; i > 0; i--) {
+		result = modReference(mulReference(result, result), m);
+		if ((e[(i - 1) / 32] >> ((i - 1) % 32)) & 1) {
+			result = modReference(mulReference(result, base), m);
+		}
+	}
+	return result;
+}
+
+static void testMul()
+{
+	SLIB_TEST_SECTION("products match the schoolbook reference")
+
+	// lengths in 32-bit elements: odd lengths leave a half limb, the larger ones use Karatsuba
+	static const sl_size lengths[] = {1, 2, 3, 7, 8, 31, 32, 33, 63, 64, 65, 95, 127, 128, 129, 200, 255, 256, 257, 400};
+	const sl_size nLengths = sizeof(lengths) / sizeof(lengths[0]);
+	sl_uint32 count = 0;
+	for (sl_size i = 0; i < nLengths; i++) {
+		for (sl_size j = 0; j < nLengths; j++) {
+			Elements a = getRandomElements(lengths[i]);
+			Elements b = getRandomElements(lengths[j]);
+			CBigInt A, B, C;
+			setElements(A, a);
+			setElements(B, b);
+			SLIB_TEST_CHECK(C.mul(A, B))
+			SLIB_TEST_CHECK(getElements(C) == mulReference(a, b))
+			// in place and squaring
+			SLIB_TEST_CHECK(A.mul(A, A))
+			SLIB_TEST_CHECK(getElements(A) == mulReference(a, a))
+			count++;
+		}
+	}
+	printf("  %u cases\n", count);
+
+	SLIB_TEST_SECTION("signs of the products")
+
+	CBigInt A, B, C;
+	setElements(A, getRandomElements(70));
+	setElements(B, getRandomElements(90));
+	Elements p = mulReference(getElements(A), getElements(B));
+	A.makeNagative();
+	SLIB_TEST_CHECK(C.mul(A, B))
+	SLIB_TEST_CHECK(C.sign < 0 && getElements(C) == p)
+	B.makeNagative();
+	SLIB_TEST_CHECK(C.mul(A, B))
+	SLIB_TEST_CHECK(C.sign > 0 && getElements(C) == p)
+	B.setZero();
+	SLIB_TEST_CHECK(C.mul(A, B))
+	SLIB_TEST_CHECK(C.isZero())
+}
+
+static void testPowMontgomery()
+{
+	SLIB_TEST_SECTION("Montgomery exponentiation matches the square-and-multiply reference")
+
+	// modulus lengths in 32-bit elements, below and above the Montgomery Karatsuba cutoff
+	static const sl_size lengths[] = {1, 2, 3, 16, 17, 32, 33, 64, 96, 97, 128};
+	const sl_size nLengths = sizeof(lengths) / sizeof(lengths[0]);
+	sl_uint32 count = 0;
+	for (sl_size i = 0; i < nLengths; i++) {
+		sl_size n = lengths[i];
+		for (sl_uint32 k = 0; k < 3; k++) {
+			Elements m = getRandomElements(n);
+			m[0] |= 1;
+			Elements a = getRandomElements(n + (k == 1 ? 3 : 0));
+			// full length exponents up to 2048 bits, short exponents for the larger moduli
+			Elements e = getRandomElements(n <= 64 ? n : 2);
+			if (k == 2) {
+				e.assign(1, 65537);
+			}
+			CBigInt M, A, E;
+			setElements(M, m);
+			setElements(A, a);
+			setElements(E, e);
+			Elements expected = powReference(a, e, M);
+			CBigInt C;
+			SLIB_TEST_CHECK(C.pow_montgomery(A, E, M))
+			SLIB_TEST_CHECK(getElements(C) == expected)
+			SLIB_TEST_CHECK(C.pow_montgomery(A, E, M, sl_true))
+			SLIB_TEST_CHECK(getElements(C) == expected)
+			// the member overload powers itself
+			SLIB_TEST_CHECK(A.pow_montgomery(E, M))
+			SLIB_TEST_CHECK(getElements(A) == expected)
+			count++;
+		}
+	}
+	printf("  %u cases\n", count);
+
+	SLIB_TEST_SECTION("even moduli fall back to the generic path")
+
+	CBigInt M, A, E, C, D;
+	setElements(M, getRandomElements(20));
+	M.elements[0] &= ~1;
+	setElements(A, getRandomElements(20));
+	setElements(E, getRandomElements(4));
+	SLIB_TEST_CHECK(C.pow_montgomery(A, E, M))
+	SLIB_TEST_CHECK(getElements(C) == powReference(getElements(A), getElements(E), M))
+	SLIB_TEST_CHECK(D.pow_mod(A, E, M))
+	SLIB_TEST_CHECK(D.compare(C) == 0)
+}
+
+int main(int argc, const char* argv[])
+{
+	testMul();
+	testPowMontgomery();
+	printf("OK\n");
+	return 0;
+}
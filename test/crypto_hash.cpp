@@ -0,0 +1,263 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/crypto/md5.h"
+#include "slib/crypto/sha1.h"
+#include "slib/crypto/sha2.h"
+#include "slib/crypto/parallel_file_hasher.h"
+#include "slib/core/file.h"
+#include "slib/core/string.h"
+
+#include "test.h"
+
+#include <vector>
+
+using namespace slib;
+
+/*
+	Validates MD5, SHA-1 and SHA-224/256 (SHA-NI and scalar single hashing, AVX2 multi-buffer batches)
+	with the known-answer vectors of RFC 1321 and FIPS 180, with digests of a byte pattern around the
+	padding boundaries (computed by an independent implementation), and against each other:
+	split updates and batches must give the digests of the one-shot hashing.
+	Also checks the Merkle root of ParallelFileHasher against RFC 6962 built from single digests.
+*/
+
+typedef std::vector<sl_uint8> Bytes;
+
+static sl_uint32 g_random = 0x6C8E9CF5;
+
+static sl_uint32 getRandom()
+{
+	sl_uint32 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_random = x;
+	return x;
+}
+
+static Bytes getPattern(sl_size n)
+{
+	Bytes ret(n);
+	for (sl_size i = 0; i < n; i++) {
+		ret[i] = (sl_uint8)(i * 7 + (i >> 8));
+	}
+	return ret;
+}
+
+template <class HASH>
+static String getDigest(const void* data, sl_size size)
+{
+	sl_uint8 out[64];
+	HASH::hash(data, size, out);
+	return String::makeHexString(out, HASH::getHashSize());
+}
+
+static void testKnownAnswers()
+{
+	SLIB_TEST_SECTION("known-answer vectors")
+
+	// message, MD5, SHA-1, SHA-224, SHA-256
+	static const char* vectors[][5] = {
+		{"", "d41d8cd98f00b204e9800998ecf8427e", "da39a3ee5e6b4b0d3255bfef95601890afd80709", "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+		{"abc", "900150983cd24fb0d6963f7d28e17f72", "a9993e364706816aba3e25717850c26c9cd0d89d", "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+		{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "8215ef0796a20bcaaae116d3876c664a", "84983e441c3bd26ebaae4aa1f95129e5e54670f1", "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"}
+	};
+	for (sl_size i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		const char* s = vectors[i][0];
+		sl_size n = Base::getStringLength(s);
+		SLIB_TEST_CHECK(getDigest<MD5>(s, n) == vectors[i][1])
+		SLIB_TEST_CHECK(getDigest<SHA1>(s, n) == vectors[i][2])
+		SLIB_TEST_CHECK(getDigest<SHA224>(s, n) == vectors[i][3])
+		SLIB_TEST_CHECK(getDigest<SHA256>(s, n) == vectors[i][4])
+	}
+
+	// one million 'a', hashed in updates of 1000 bytes
+	Bytes a(1000, 'a');
+	MD5 md5;
+	SHA1 sha1;
+	SHA224 sha224;
+	SHA256 sha256;
+	CryptoHash* hashes[] = {&md5, &sha1, &sha224, &sha256};
+	static const char* digests[] = {"7707d6ae4e027c70eea2a935c2296f21", "34aa973cd4c4daa4f61eeb2bdbad27316534016f", "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67", "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"};
+	for (sl_size i = 0; i < 4; i++) {
+		CryptoHash* hash = hashes[i];
+		hash->start();
+		for (sl_uint32 k = 0; k < 1000; k++) {
+			hash->update(a.data(), a.size());
+		}
+		sl_uint8 out[64];
+		hash->finish(out);
+		SLIB_TEST_CHECK(String::makeHexString(out, hash->getSize()) == digests[i])
+	}
+
+	SLIB_TEST_SECTION("digests around the padding boundaries")
+
+	// size, MD5, SHA-1, SHA-256 of `getPattern(size)`
+	static const char* patterns[][4] = {
+		{"55", "8d24280288a696559fd8d5aa1b6d8c6e", "aecd1643c9903b9bae8cb94f53c50f8a4e18605b", "576a1bf8d4478657e6dc4af9398544765c2a92cde28478b019235cfed315fc09"},
+		{"56", "ef2c72b7254c92459e498eddd4ace573", "f5d65c621c02cc8e785159feff8088e3072da1bc", "9b20501dfd1d99161c257950f3444f3e49230c351c5c8e0943ef369f85f5205d"},
+		{"63", "c4c8c6d513f4e1604eb18508a1769364", "4952f0fe097e4d6410ae9eab4855aa836caf3bff", "30b345906b493f06f69444b6521113511c242f30e29840462950035043682f1e"},
+		{"64", "a2fcb39a253b9b785b1f97518fa37683", "1e17ae1fc093e5daca033553c97a5192ca164486", "d8bc63b4fc1156e5e7d95a418b9bf54cd3174bedbc2db40f74895349b229b3c0"},
+		{"65", "e49fe82d0bb12967a196c85de313e446", "ac44f5dbe3e9b5d2733fc9537fcad715c3c20bc3", "1ee23b0fbcaecc1aff4a9e8f1645f35ab2c8e13609cd73b68df8b5e3f63ce073"},
+		{"119", "1640deea49ebb258ec6ede18d4b2d2d7", "b4a4e69060d0b1e7e8ebbf7041a4211c63438b57", "7a6589821178918ca8d9edaba5abfc1e9b2669564f4469b66885379c1530b2c8"},
+		{"1000", "bd8c10439abeb42fb5c19745991e360e", "36b3862969aef72235b9f6aadcf795eefeacd183", "c85a431e0fe575b2609289d3a4042414715f400612575a125d2ce5573d608732"},
+		{"4097", "031005cd8d3ab11c5bec3a19fa756a7f", "23861ca014ce309635035c7f89f7815e49b1d5f2", "5b1f71a5f659c11e04f10eeba5faad22d4e326245df505c18741f32df150c712"}
+	};
+	for (sl_size i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+		sl_size n = String(patterns[i][0]).parseUint32();
+		// unaligned input
+		Bytes data = getPattern(n);
+		data.insert(data.begin(), 0);
+		SLIB_TEST_CHECK(getDigest<MD5>(data.data() + 1, n) == patterns[i][1])
+		SLIB_TEST_CHECK(getDigest<SHA1>(data.data() + 1, n) == patterns[i][2])
+		SLIB_TEST_CHECK(getDigest<SHA256>(data.data() + 1, n) == patterns[i][3])
+	}
+}
+
+template <class HASH>
+static void testSplitUpdates()
+{
+	for (sl_uint32 iter = 0; iter < 200; iter++) {
+		sl_size n = getRandom() % 3000;
+		Bytes data = getPattern(n + 1);
+		sl_uint8 expected[64];
+		HASH::hash(data.data(), n, expected);
+		HASH hash;
+		hash.start();
+		sl_size pos = 0;
+		while (pos < n) {
+			sl_size m = getRandom() % 200;
+			if (m > n - pos) {
+				m = n - pos;
+			}
+			hash.update(data.data() + pos, m);
+			pos += m;
+		}
+		sl_uint8 out[64];
+		hash.finish(out);
+		SLIB_TEST_CHECK(Base::equalsMemory(out, expected, HASH::getHashSize()))
+	}
+}
+
+template <class HASH>
+static void testBatch()
+{
+	static const sl_size counts[] = {0, 1, 7, 8, 9, 16, 33, 100};
+	for (sl_size iCount = 0; iCount < sizeof(counts) / sizeof(counts[0]); iCount++) {
+		sl_size count = counts[iCount];
+		std::vector<Bytes> messages(count);
+		std::vector<const void*> inputs(count + 1);
+		std::vector<sl_size> sizes(count + 1);
+		for (sl_size i = 0; i < count; i++) {
+			// mixed lengths, so the lanes finish and refill at different blocks
+			sl_size n = (i % 5 == 0) ? getRandom() % 5000 : getRandom() % 300;
+			messages[i] = getPattern(n + 1);
+			Bytes& m = messages[i];
+			for (sl_size k = 0; k < m.size(); k++) {
+				m[k] ^= (sl_uint8)i;
+			}
+			inputs[i] = m.data() + 1;
+			sizes[i] = n;
+		}
+		sl_uint32 hashSize = HASH::getHashSize();
+		Bytes outputs(count * hashSize + 1);
+		HASH::hashBatch(inputs.data(), sizes.data(), count, outputs.data());
+		for (sl_size i = 0; i < count; i++) {
+			sl_uint8 expected[64];
+			HASH::hash(inputs[i], sizes[i], expected);
+			SLIB_TEST_CHECK(Base::equalsMemory(outputs.data() + i * hashSize, expected, hashSize))
+		}
+	}
+}
+
+static void testSinglePaths()
+{
+	SLIB_TEST_SECTION("split updates give the one-shot digests")
+
+	testSplitUpdates<MD5>();
+	testSplitUpdates<SHA1>();
+	testSplitUpdates<SHA224>();
+	testSplitUpdates<SHA256>();
+
+	SLIB_TEST_SECTION("batches give the one-shot digests")
+
+	testBatch<MD5>();
+	testBatch<SHA1>();
+	testBatch<SHA256>();
+}
+
+// RFC 6962, section 2.1
+static void getMerkleRoot(const sl_uint8* data, sl_size size, sl_size chunkSize, sl_uint8* output)
+{
+	if (size <= chunkSize) {
+		Bytes leaf(size + 1);
+		leaf[0] = 0;
+		Base::copyMemory(leaf.data() + 1, data, size);
+		SHA256::hash(leaf.data(), leaf.size(), output);
+		return;
+	}
+	sl_size nChunks = (size + chunkSize - 1) / chunkSize;
+	sl_size k = 1;
+	while (k * 2 < nChunks) {
+		k *= 2;
+	}
+	sl_uint8 node[65];
+	node[0] = 1;
+	getMerkleRoot(data, k * chunkSize, chunkSize, node + 1);
+	getMerkleRoot(data + k * chunkSize, size - k * chunkSize, chunkSize, node + 33);
+	SHA256::hash(node, 65, output);
+}
+
+static void testParallelFileHasher()
+{
+	SLIB_TEST_SECTION("ParallelFileHasher gives the RFC 6962 Merkle root")
+
+	Ref<ThreadPool> pool = ThreadPool::create(4, 4);
+	SLIB_TEST_CHECK(pool.isNotNull())
+	Bytes data = getPattern(300000);
+	static const sl_size chunkSizes[] = {4096, 10000, 65536, 1 << 20};
+	static const sl_size sizes[] = {1, 4096, 4097, 12288, 50001, 300000};
+	for (sl_size iChunk = 0; iChunk < sizeof(chunkSizes) / sizeof(chunkSizes[0]); iChunk++) {
+		for (sl_size iSize = 0; iSize < sizeof(sizes) / sizeof(sizes[0]); iSize++) {
+			sl_size chunkSize = chunkSizes[iChunk];
+			sl_size size = sizes[iSize];
+			sl_uint8 expected[32];
+			getMerkleRoot(data.data(), size, chunkSize, expected);
+			sl_uint8 out[32];
+			ParallelFileHasher::hash(data.data(), size, out, chunkSize, pool);
+			SLIB_TEST_CHECK(Base::equalsMemory(out, expected, 32))
+			ParallelFileHasher::hash(data.data(), size, out, chunkSize);
+			SLIB_TEST_CHECK(Base::equalsMemory(out, expected, 32))
+		}
+	}
+	sl_uint8 out[32];
+	ParallelFileHasher::hash(data.data(), 0, out);
+	SLIB_TEST_CHECK(getDigest<SHA256>(sl_null, 0) == String::makeHexString(out, 32))
+
+	String path = "crypto_hash.bin";
+	SLIB_TEST_CHECK(File::writeAllBytes(path, data.data(), data.size()) == data.size())
+	sl_uint8 expected[32];
+	getMerkleRoot(data.data(), data.size(), 10000, expected);
+	SLIB_TEST_CHECK(ParallelFileHasher::hashFile(path, out, 10000, pool))
+	SLIB_TEST_CHECK(Base::equalsMemory(out, expected, 32))
+	File::deleteFile(path);
+	SLIB_TEST_CHECK(!(ParallelFileHasher::hashFile(path, out, 10000, pool)))
+	pool->release();
+}
+
+int main(int argc, const char* argv[])
+{
+	testKnownAnswers();
+	testSinglePaths();
+	testParallelFileHasher();
+	printf("OK\n");
+	return 0;
+}
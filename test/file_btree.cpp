@@ -0,0 +1,221 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/db/file_btree.h"
+#include "slib/core/file.h"
+#include "slib/core/mio.h"
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	Crash/replay validation of FileBTree's write-ahead log.
+
+	A crash between the log flush and the page writes of `commit()` is simulated by
+	rebuilding the log of a committed transaction from the images of the main file
+	before (`before`) and after (`after`) the commit, then restoring `before`.
+*/
+
+typedef FileBTree<String, sl_int64> Tree;
+
+static String g_path = "file_btree_test.db";
+static String g_pathLog = "file_btree_test.db.wal";
+
+static FileBTreeParam getParam(sl_uint32 maxKeyLength = 16)
+{
+	FileBTreeParam param(g_path);
+	param.maxKeyLength = maxKeyLength;
+	return param;
+}
+
+static void clear()
+{
+	File::deleteFile(g_path);
+	File::deleteFile(g_pathLog);
+}
+
+static void fill(Tree& tree, sl_int32 start, sl_int32 count)
+{
+	for (sl_int32 i = start; i < start + count; i++) {
+		SLIB_TEST_CHECK(tree.put(String::fromInt32(i), i))
+	}
+}
+
+static void verify(sl_int32 count)
+{
+	Tree tree;
+	SLIB_TEST_CHECK(tree.open(getParam()))
+	SLIB_TEST_CHECK(tree.getCount() == (sl_size)count)
+	for (sl_int32 i = 0; i < count; i++) {
+		sl_int64 v = -1;
+		SLIB_TEST_CHECK(tree.get(String::fromInt32(i), &v) && v == i)
+	}
+	SLIB_TEST_CHECK(!(tree.get(String::fromInt32(count))))
+}
+
+// builds the log which `commit()` writes for the transition from `before` to `after`
+static Memory buildLog(const Memory& before, const Memory& after, sl_bool flagCommit, sl_bool flagHeader = sl_true)
+{
+	sl_uint32 pageSize = MIO::readUint32LE((sl_uint8*)(after.getData()) + 4);
+	sl_size sizeRecord = 8 + pageSize;
+	MemoryBuffer log;
+	Memory record = Memory::create(sizeRecord);
+	sl_uint8* r = (sl_uint8*)(record.getData());
+	sl_uint64 checksum = SLIB_FILE_BTREE_CHECKSUM_INIT;
+	sl_uint64 count = 0;
+	sl_uint64 nPages = after.getSize() / pageSize;
+	for (sl_uint64 i = 0; i < nPages; i++) {
+		if (!i && !flagHeader) {
+			continue;
+		}
+		const sl_uint8* page = (sl_uint8*)(after.getData()) + i * pageSize;
+		if ((i + 1) * pageSize <= before.getSize() && Base::equalsMemory(page, (sl_uint8*)(before.getData()) + i * pageSize, pageSize)) {
+			continue;
+		}
+		MIO::writeUint64LE(r, i);
+		Base::copyMemory(r + 8, page, pageSize);
+		log.add(Memory::create(r, sizeRecord));
+		checksum = _FileBTreeLog::updateChecksum(checksum, r, sizeRecord);
+		count++;
+	}
+	if (flagCommit) {
+		Base::zeroMemory(r, sizeRecord);
+		MIO::writeUint64LE(r, SLIB_FILE_BTREE_LOG_COMMIT);
+		MIO::writeUint64LE(r + 8, count);
+		MIO::writeUint64LE(r + 16, checksum);
+		log.add(Memory::create(r, sizeRecord));
+	}
+	return log.merge();
+}
+
+static sl_bool isSame(const Memory& m1, const Memory& m2)
+{
+	return m1.getSize() == m2.getSize() && Base::equalsMemory(m1.getData(), m2.getData(), m1.getSize());
+}
+
+static void simulateCrash(const Memory& before, const Memory& log)
+{
+	clear();
+	if (before.isNotNull()) {
+		SLIB_TEST_CHECK(File::writeAllBytes(g_path, before) == before.getSize())
+	}
+	SLIB_TEST_CHECK(File::writeAllBytes(g_pathLog, log) == log.getSize())
+}
+
+int main(int argc, const char * argv[])
+{
+	SLIB_TEST_SECTION("put through BTree& rejects the oversized items")
+	{
+		clear();
+		Tree tree;
+		SLIB_TEST_CHECK(tree.open(getParam(8)))
+		BTree<String, sl_int64>& base = tree;
+		SLIB_TEST_CHECK(base.put("abcdefgh", 1))
+		SLIB_TEST_CHECK(!(base.put("abcdefghi", 2)))
+		SLIB_TEST_CHECK(!(base.addIfNewKeyAndValue("abcdefghi", 3)))
+		SLIB_TEST_CHECK(tree.commit())
+		SLIB_TEST_CHECK(tree.getCount() == 1)
+		SLIB_TEST_CHECK(tree.get("abcdefgh"))
+		SLIB_TEST_CHECK(!(tree.get("abcdefghi")))
+	}
+
+	SLIB_TEST_SECTION("uncommitted changes are dropped")
+	{
+		clear();
+		{
+			Tree tree;
+			SLIB_TEST_CHECK(tree.open(getParam()))
+			fill(tree, 0, 100);
+			SLIB_TEST_CHECK(tree.commit())
+			fill(tree, 100, 2000);
+		}
+		verify(100);
+		SLIB_TEST_CHECK(File::getSize(g_pathLog) == 0)
+	}
+
+	Memory imageBefore, imageAfter;
+	{
+		clear();
+		{
+			Tree tree;
+			SLIB_TEST_CHECK(tree.open(getParam()))
+			fill(tree, 0, 100);
+			SLIB_TEST_CHECK(tree.commit())
+		}
+		imageBefore = File::readAllBytes(g_path);
+		{
+			Tree tree;
+			SLIB_TEST_CHECK(tree.open(getParam()))
+			fill(tree, 100, 2000);
+			SLIB_TEST_CHECK(tree.commit())
+		}
+		imageAfter = File::readAllBytes(g_path);
+		SLIB_TEST_CHECK(imageBefore.getSize() > 0 && imageAfter.getSize() > imageBefore.getSize())
+	}
+
+	SLIB_TEST_SECTION("committed log is replayed")
+	{
+		simulateCrash(imageBefore, buildLog(imageBefore, imageAfter, sl_true));
+		verify(2100);
+		SLIB_TEST_CHECK(File::getSize(g_pathLog) == 0)
+		SLIB_TEST_CHECK(isSame(File::readAllBytes(g_path), imageAfter))
+	}
+
+	SLIB_TEST_SECTION("committed log creates the main file")
+	{
+		simulateCrash(sl_null, buildLog(sl_null, imageAfter, sl_true));
+		verify(2100);
+	}
+
+	SLIB_TEST_SECTION("log without the commit record is discarded")
+	{
+		simulateCrash(imageBefore, buildLog(imageBefore, imageAfter, sl_false));
+		verify(100);
+		SLIB_TEST_CHECK(File::getSize(g_pathLog) == 0)
+	}
+
+	SLIB_TEST_SECTION("log with a torn record is discarded")
+	{
+		Memory log = buildLog(imageBefore, imageAfter, sl_true);
+		((sl_uint8*)(log.getData()))[100] ^= 0xFF;
+		simulateCrash(imageBefore, log);
+		verify(100);
+	}
+
+	SLIB_TEST_SECTION("header mismatch fails the open before the replay")
+	{
+		Memory log = buildLog(imageBefore, imageAfter, sl_true);
+		simulateCrash(imageBefore, log);
+		{
+			Tree tree;
+			SLIB_TEST_CHECK(!(tree.open(getParam(32))))
+		}
+		SLIB_TEST_CHECK(isSame(File::readAllBytes(g_pathLog), log))
+		SLIB_TEST_CHECK(isSame(File::readAllBytes(g_path), imageBefore))
+		verify(2100);
+	}
+
+	SLIB_TEST_SECTION("failed replay keeps the log")
+	{
+		// the main file is missing, and the committed log has no header to create it
+		Memory log = buildLog(sl_null, imageAfter, sl_true, sl_false);
+		simulateCrash(sl_null, log);
+		{
+			Tree tree;
+			SLIB_TEST_CHECK(!(tree.open(getParam())))
+		}
+		SLIB_TEST_CHECK(isSame(File::readAllBytes(g_pathLog), log))
+	}
+
+	clear();
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/flat_hashtable.h"
+#include "slib/core/string.h"
+
+#include "test.h"
+
+#include <map>
+
+using namespace slib;
+
+/*
+	Validates FlatHashTable against std::map under random puts and removes,
+	with the erase/rehash paths forced by a degenerate hash (every key in one probe chain).
+*/
+
+static sl_int32 g_countLiveValues = 0;
+
+class TrackedValue
+{
+public:
+	sl_int32 value;
+
+public:
+	TrackedValue(): value(0) { g_countLiveValues++; }
+
+	TrackedValue(sl_int32 _value): value(_value) { g_countLiveValues++; }
+
+	TrackedValue(const TrackedValue& other): value(other.value) { g_countLiveValues++; }
+
+	~TrackedValue() { g_countLiveValues--; }
+
+	TrackedValue& operator=(const TrackedValue& other) { value = other.value; return *this; }
+
+};
+
+class CollidingHash
+{
+public:
+	sl_uint32 operator()(sl_uint32 key) const
+	{
+		// the same group and the same 7-bit tag for the keys differing in the low bits
+		return (key >> 6) * 0x9E3779B9;
+	}
+};
+
+static sl_uint32 g_random = 0x12345678;
+
+static sl_uint32 getRandom()
+{
+	sl_uint32 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_random = x;
+	return x;
+}
+
+template <class TABLE>
+static void verify(TABLE& table, std::map<sl_uint32, sl_int32>& ref)
+{
+	SLIB_TEST_CHECK(table.getCount() == ref.size())
+	sl_size n = 0;
+	typename TABLE::Entry* entry = table.getFirstEntry();
+	while (entry) {
+		std::map<sl_uint32, sl_int32>::iterator it = ref.find(entry->key);
+		SLIB_TEST_CHECK(it != ref.end() && it->second == entry->value.value)
+		n++;
+		entry = table.getNextEntry(entry);
+	}
+	SLIB_TEST_CHECK(n == ref.size())
+	for (std::map<sl_uint32, sl_int32>::iterator it = ref.begin(); it != ref.end(); it++) {
+		TrackedValue* p = table.getItemPointer(it->first);
+		SLIB_TEST_CHECK(p && p->value == it->second)
+	}
+}
+
+template <class TABLE>
+static void runRandomOperations(TABLE& table, sl_uint32 keyRange, sl_uint32 nOperations)
+{
+	std::map<sl_uint32, sl_int32> ref;
+	for (sl_uint32 i = 0; i < nOperations; i++) {
+		sl_uint32 key = getRandom() % keyRange;
+		sl_uint32 op = getRandom() % 16;
+		if (op < 8) {
+			sl_int32 value = (sl_int32)(getRandom());
+			sl_bool flagExist = sl_false;
+			SLIB_TEST_CHECK(table.put(key, TrackedValue(value), MapPutMode::Default, &flagExist))
+			SLIB_TEST_CHECK(flagExist == (ref.find(key) != ref.end()))
+			ref[key] = value;
+		} else if (op < 14) {
+			TrackedValue removed;
+			sl_bool flagRemoved = table.remove(key, &removed);
+			std::map<sl_uint32, sl_int32>::iterator it = ref.find(key);
+			SLIB_TEST_CHECK(flagRemoved == (it != ref.end()))
+			if (it != ref.end()) {
+				SLIB_TEST_CHECK(removed.value == it->second)
+				ref.erase(it);
+			}
+		} else if (op == 14) {
+			SLIB_TEST_CHECK(table.get(key) == (ref.find(key) != ref.end()))
+		} else {
+			if (getRandom() % 64 == 0) {
+				SLIB_TEST_CHECK(table.rehash())
+				SLIB_TEST_CHECK(table.getCapacity() >= table.getCount())
+			}
+		}
+		if (i % 4096 == 0) {
+			verify(table, ref);
+		}
+	}
+	verify(table, ref);
+	table.removeAll();
+	SLIB_TEST_CHECK(table.getCount() == 0 && !(table.getFirstEntry()))
+}
+
+int main(int argc, const char * argv[])
+{
+	SLIB_TEST_SECTION("random puts, removes and rehashes against std::map")
+	{
+		FlatHashTable<sl_uint32, TrackedValue> table;
+		runRandomOperations(table, 5000, 200000);
+	}
+	SLIB_TEST_CHECK(g_countLiveValues == 0)
+
+	SLIB_TEST_SECTION("colliding keys: probing across the groups and the deleted slots")
+	{
+		FlatHashTable<sl_uint32, TrackedValue, CollidingHash> table;
+		runRandomOperations(table, 2000, 100000);
+	}
+	SLIB_TEST_CHECK(g_countLiveValues == 0)
+
+	SLIB_TEST_SECTION("erasing and refilling reuses the deleted slots without growing")
+	{
+		FlatHashTable<sl_uint32, TrackedValue> table;
+		SLIB_TEST_CHECK(table.reserve(1000))
+		sl_size capacity = table.getCapacity();
+		for (sl_uint32 round = 0; round < 100; round++) {
+			for (sl_uint32 i = 0; i < 1000; i++) {
+				SLIB_TEST_CHECK(table.put(round * 1000 + i, TrackedValue(i)))
+			}
+			SLIB_TEST_CHECK(table.getCount() == 1000)
+			for (sl_uint32 i = 0; i < 1000; i++) {
+				SLIB_TEST_CHECK(table.remove(round * 1000 + i))
+			}
+			SLIB_TEST_CHECK(table.getCount() == 0)
+		}
+		SLIB_TEST_CHECK(table.getCapacity() == capacity)
+		SLIB_TEST_CHECK(table.rehash())
+	}
+	SLIB_TEST_CHECK(g_countLiveValues == 0)
+
+	SLIB_TEST_SECTION("duplicated keys")
+	{
+		FlatHashTable<String, sl_int32> table;
+		for (sl_int32 i = 0; i < 100; i++) {
+			SLIB_TEST_CHECK(table.put(String::fromInt32(i % 10), i, MapPutMode::AddAlways))
+		}
+		SLIB_TEST_CHECK(table.getCount() == 100)
+		SLIB_TEST_CHECK(table.getValues("3").getCount() == 10)
+		SLIB_TEST_CHECK(table.removeKeyAndValue("3", 43))
+		SLIB_TEST_CHECK(!(table.removeKeyAndValue("3", 43)))
+		SLIB_TEST_CHECK(table.removeItems("3") == 9)
+		SLIB_TEST_CHECK(table.getCount() == 90)
+		SLIB_TEST_CHECK(table.rehash(1024))
+		SLIB_TEST_CHECK(table.getCapacity() >= 1024)
+		SLIB_TEST_CHECK(table.getValues("4").getCount() == 10)
+	}
+
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/network/http_service.h"
+#include "slib/network/socket.h"
+#include "slib/crypto/zlib.h"
+#include "slib/core/file.h"
+#include "slib/core/app.h"
+#include "slib/core/thread.h"
+
+#include "test.h"
+
+using namespace slib;
+
+/*
+	Validates the response compression of HttpService over a loopback connection:
+	the negotiated coding, `Vary`, the bodies decompressed back to the identity body,
+	the responses left uncompressed, and the cache of the precompressed static files.
+*/
+
+#define TEST_PORT 18941
+#define TEST_ASSET_DIR "http_compression_www"
+
+class Response
+{
+public:
+	sl_uint32 status;
+	String contentEncoding;
+	String vary;
+	Memory body;
+
+public:
+	Response(): status(0) {}
+
+};
+
+static String getHeader(const String& headers, const String& name)
+{
+	ListElements<String> lines(headers.split("\r\n"));
+	for (sl_size i = 1; i < lines.count; i++) {
+		sl_reg index = lines[i].indexOf(':');
+		if (index > 0 && lines[i].substring(0, index).trim().equalsIgnoreCase(name)) {
+			return lines[i].substring(index + 1).trim();
+		}
+	}
+	return sl_null;
+}
+
+static Response request(const String& path, const String& acceptEncoding)
+{
+	Ref<Socket> socket = Socket::openTcp();
+	SLIB_TEST_CHECK(socket.isNotNull())
+	SLIB_TEST_CHECK(socket->connectAndWait(SocketAddress(IPv4Address(127, 0, 0, 1), TEST_PORT), 5000))
+	// `connectAndWait()` leaves the socket in the non-blocking mode
+	socket->setNonBlockingMode(sl_false);
+	socket->setOption_ReceiveTimeout(5000);
+	String req = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n";
+	if (acceptEncoding.isNotEmpty()) {
+		req += "Accept-Encoding: " + acceptEncoding + "\r\n";
+	}
+	req += "\r\n";
+	SLIB_TEST_CHECK(socket->send(req.getData(), (sl_uint32)(req.getLength())) == (sl_int32)(req.getLength()))
+
+	// reads the header, then the body by `Content-Length` (the connection is kept alive)
+	MemoryBuffer buf;
+	String headers;
+	sl_reg posBody = -1;
+	sl_uint64 sizeTotal = 0;
+	char data[16384];
+	for (;;) {
+		if (posBody >= 0) {
+			sl_uint64 sizeBody = getHeader(headers, "Content-Length").parseUint64();
+			if (sizeTotal >= (sl_uint64)posBody + sizeBody) {
+				break;
+			}
+		}
+		sl_int32 n = socket->receive(data, sizeof(data));
+		SLIB_TEST_CHECK(n > 0)
+		buf.add(Memory::create(data, n));
+		sizeTotal += n;
+		if (posBody < 0) {
+			Memory all = buf.merge();
+			buf.clear();
+			buf.add(all);
+			String s((char*)(all.getData()), all.getSize());
+			sl_reg index = s.indexOf("\r\n\r\n");
+			if (index >= 0) {
+				headers = s.substring(0, index);
+				posBody = index + 4;
+			}
+		}
+	}
+	Memory all = buf.merge();
+	Response response;
+	ListElements<String> statusLine(headers.split(" "));
+	SLIB_TEST_CHECK(statusLine.count >= 2)
+	response.status = statusLine[1].parseUint32();
+	response.contentEncoding = getHeader(headers, "Content-Encoding");
+	response.vary = getHeader(headers, "Vary");
+	response.body = all.sub(posBody);
+	return response;
+}
+
+static Memory decode(const Response& response)
+{
+	if (response.contentEncoding.isEmpty()) {
+		return response.body;
+	}
+	// `Zlib::decompress()` detects the gzip and zlib wrappers
+	return Zlib::decompress(response.body.getData(), response.body.getSize());
+}
+
+static sl_bool isSame(const Memory& m, const String& s)
+{
+	return m.getSize() == s.getLength() && Base::compareMemory((sl_uint8*)(m.getData()), (sl_uint8*)(s.getData()), s.getLength()) == 0;
+}
+
+static String g_json;
+static String g_script;
+
+static void testDynamicResponses()
+{
+	SLIB_TEST_SECTION("dynamic responses are compressed by Accept-Encoding")
+
+	Response response = request("/json", "gzip, deflate");
+	SLIB_TEST_CHECK(response.status == 200 && response.contentEncoding == "gzip")
+	SLIB_TEST_CHECK(response.vary == "Accept-Encoding")
+	SLIB_TEST_CHECK(response.body.getSize() < g_json.getLength())
+	SLIB_TEST_CHECK(isSame(decode(response), g_json))
+
+	response = request("/json", "gzip;q=0, deflate");
+	SLIB_TEST_CHECK(response.contentEncoding == "deflate")
+	SLIB_TEST_CHECK(isSame(decode(response), g_json))
+
+	response = request("/json", "*");
+	SLIB_TEST_CHECK(response.contentEncoding == "gzip")
+	SLIB_TEST_CHECK(isSame(decode(response), g_json))
+
+	response = request("/json", "br, gzip;q=0");
+	SLIB_TEST_CHECK(response.contentEncoding.isEmpty())
+	SLIB_TEST_CHECK(isSame(response.body, g_json))
+
+	response = request("/json", sl_null);
+	SLIB_TEST_CHECK(response.contentEncoding.isEmpty())
+	SLIB_TEST_CHECK(response.vary == "Accept-Encoding")
+	SLIB_TEST_CHECK(isSame(response.body, g_json))
+}
+
+static void testUncompressedResponses()
+{
+	SLIB_TEST_SECTION("small and binary responses stay uncompressed")
+
+	Response response = request("/small", "gzip");
+	SLIB_TEST_CHECK(response.status == 200 && response.contentEncoding.isEmpty())
+	SLIB_TEST_CHECK(isSame(response.body, "small"))
+
+	response = request("/binary", "gzip");
+	SLIB_TEST_CHECK(response.status == 200 && response.contentEncoding.isEmpty())
+	SLIB_TEST_CHECK(response.body.getSize() == g_json.getLength())
+}
+
+static void testStaticFiles(HttpService* service)
+{
+	SLIB_TEST_SECTION("static files are compressed once and served from the cache")
+
+	HttpServiceCompressionStatistics stats = service->getCompressionStatistics();
+	for (sl_uint32 i = 0; i < 3; i++) {
+		Response response = request("/script.js", "gzip");
+		SLIB_TEST_CHECK(response.status == 200 && response.contentEncoding == "gzip")
+		SLIB_TEST_CHECK(isSame(decode(response), g_script))
+	}
+	Response response = request("/script.js", "deflate");
+	SLIB_TEST_CHECK(response.contentEncoding == "deflate")
+	SLIB_TEST_CHECK(isSame(decode(response), g_script))
+	HttpServiceCompressionStatistics statsAfter = service->getCompressionStatistics();
+	SLIB_TEST_CHECK(statsAfter.countCacheMisses - stats.countCacheMisses == 2)
+	SLIB_TEST_CHECK(statsAfter.countCacheHits - stats.countCacheHits == 2)
+
+	SLIB_TEST_SECTION("an edited static file is compressed again")
+
+	String path = Application::getApplicationDirectory() + "/" TEST_ASSET_DIR "/script.js";
+	g_script += "// edited\n";
+	SLIB_TEST_CHECK(File::writeAllTextUTF8(path, g_script))
+	Time time = Time::now();
+	time.addSeconds(10);
+	SLIB_TEST_CHECK(File::setModifiedTime(path, time))
+	response = request("/script.js", "gzip");
+	SLIB_TEST_CHECK(response.contentEncoding == "gzip")
+	SLIB_TEST_CHECK(isSame(decode(response), g_script))
+	SLIB_TEST_CHECK(service->getCompressionStatistics().countCacheMisses - statsAfter.countCacheMisses == 1)
+}
+
+int main(int argc, const char* argv[])
+{
+	for (sl_uint32 i = 0; i < 500; i++) {
+		g_json += String::format("%s{\"id\":%d,\"name\":\"item %d\",\"tags\":[\"a\",\"b\"]}", i ? "," : "[", i, i);
+	}
+	g_json += "]";
+	for (sl_uint32 i = 0; i < 1000; i++) {
+		g_script += String::format("function f%d(x) { return x + %d; }\n", i, i);
+	}
+	String dir = Application::getApplicationDirectory() + "/" TEST_ASSET_DIR;
+	File::createDirectory(dir);
+	SLIB_TEST_CHECK(File::writeAllTextUTF8(dir + "/script.js", g_script))
+
+	HttpServiceParam param;
+	param.port = TEST_PORT;
+	param.flagUseAsset = sl_true;
+	param.prefixAsset = TEST_ASSET_DIR "/";
+	param.flagUseCompression = sl_true;
+	param.onRequest = [](HttpService*, HttpServiceContext* context) -> sl_bool {
+		String path = context->getPath();
+		if (path == "/json") {
+			context->setResponseContentType("application/json");
+			context->write(g_json);
+			return sl_true;
+		}
+		if (path == "/small") {
+			context->setResponseContentType("text/plain");
+			context->write(String("small"));
+			return sl_true;
+		}
+		if (path == "/binary") {
+			context->setResponseContentType("image/png");
+			context->write(g_json);
+			return sl_true;
+		}
+		return sl_false;
+	};
+	Ref<HttpService> service = HttpService::create(param);
+	SLIB_TEST_CHECK(service.isNotNull())
+
+	testDynamicResponses();
+	testUncompressedResponses();
+	testStaticFiles(service.get());
+
+	service->release();
+	File::deleteDirectoryRecursively(dir);
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/inline_function.h"
+#include "slib/core/function.h"
+#include "slib/core/ref.h"
+
+#include "test.h"
+
+#include <memory>
+
+using namespace slib;
+
+/*
+	Validates the ownership of the callables in InlineFunction, stored in place and on the heap:
+	every constructed capture is destroyed exactly once through moves, assignments and resets,
+	and a moved-from InlineFunction is null.
+*/
+
+static sl_int32 g_countLiveCaptures = 0;
+
+class TrackedCapture
+{
+public:
+	sl_int32 value;
+
+public:
+	TrackedCapture(sl_int32 _value): value(_value) { g_countLiveCaptures++; }
+
+	TrackedCapture(const TrackedCapture& other): value(other.value) { g_countLiveCaptures++; }
+
+	TrackedCapture(TrackedCapture&& other): value(other.value) { other.value = -1; g_countLiveCaptures++; }
+
+	~TrackedCapture() { g_countLiveCaptures--; }
+
+};
+
+class SmallCallable
+{
+public:
+	TrackedCapture capture;
+
+public:
+	SmallCallable(sl_int32 value): capture(value) {}
+
+	sl_int32 operator()(sl_int32 x) { return capture.value + x; }
+
+};
+
+class LargeCallable
+{
+public:
+	TrackedCapture capture;
+	sl_uint8 padding[200];
+
+public:
+	LargeCallable(sl_int32 value): capture(value) { padding[0] = 1; }
+
+	sl_int32 operator()(sl_int32 x) { return capture.value + x + padding[0] - 1; }
+
+};
+
+class alignas(32) OverAlignedCallable
+{
+public:
+	TrackedCapture capture;
+
+public:
+	OverAlignedCallable(sl_int32 value): capture(value) {}
+
+	sl_int32 operator()(sl_int32 x)
+	{
+		// the heap storage must keep the alignment
+		SLIB_TEST_CHECK(((sl_size)this & 31) == 0)
+		return capture.value + x;
+	}
+
+};
+
+class MoveOnlyCallable
+{
+public:
+	std::unique_ptr<TrackedCapture> capture;
+
+public:
+	MoveOnlyCallable(sl_int32 value): capture(new TrackedCapture(value)) {}
+
+	sl_int32 operator()(sl_int32 x) { return capture->value * x; }
+
+};
+
+typedef InlineFunction<sl_int32(sl_int32)> Callback;
+
+template <class CALLABLE>
+static void testOwnership()
+{
+	{
+		Callback f(CALLABLE(10));
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+		SLIB_TEST_CHECK(f.isNotNull() && f(5) == 15)
+
+		// move construction
+		Callback g(Move(f));
+		SLIB_TEST_CHECK(f.isNull() && f(5) == 0)
+		SLIB_TEST_CHECK(g(5) == 15)
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+
+		// move assignment over a callable destroys it
+		Callback h(CALLABLE(20));
+		SLIB_TEST_CHECK(g_countLiveCaptures == 2)
+		h = Move(g);
+		SLIB_TEST_CHECK(g.isNull())
+		SLIB_TEST_CHECK(h(1) == 11)
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+
+		// self move keeps the callable
+		Callback& r = h;
+		h = Move(r);
+		SLIB_TEST_CHECK(h(1) == 11)
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+
+		// assigning a callable, then null
+		h = CALLABLE(30);
+		SLIB_TEST_CHECK(h(1) == 31)
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+		h = sl_null;
+		SLIB_TEST_CHECK(h.isNull())
+		SLIB_TEST_CHECK(g_countLiveCaptures == 0)
+
+		f = CALLABLE(40);
+		f.setNull();
+		SLIB_TEST_CHECK(g_countLiveCaptures == 0)
+
+		// moving between the callbacks back and forth
+		Callback a(CALLABLE(1));
+		Callback b;
+		for (sl_uint32 i = 0; i < 100; i++) {
+			b = Move(a);
+			a = Move(b);
+		}
+		SLIB_TEST_CHECK(a(0) == 1 && b.isNull())
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+	}
+	// destructor
+	SLIB_TEST_CHECK(g_countLiveCaptures == 0)
+}
+
+static void testStorage()
+{
+	SLIB_TEST_SECTION("small callables are stored in place, large and over-aligned ones on the heap")
+
+	SLIB_TEST_CHECK(Callback::isStoredInPlace<SmallCallable>())
+	SLIB_TEST_CHECK(!(Callback::isStoredInPlace<LargeCallable>()))
+	SLIB_TEST_CHECK(!(Callback::isStoredInPlace<OverAlignedCallable>()))
+	SLIB_TEST_CHECK((InlineFunction<sl_int32(sl_int32), 256>::isStoredInPlace<LargeCallable>()))
+
+	SLIB_TEST_SECTION("moves and assignments destroy every capture once")
+
+	testOwnership<SmallCallable>();
+	testOwnership<LargeCallable>();
+	testOwnership<OverAlignedCallable>();
+}
+
+class Counter : public Referable
+{
+public:
+	sl_int32 count;
+
+public:
+	Counter(): count(0) {}
+
+	sl_int32 add(sl_int32 x)
+	{
+		count += x;
+		return count;
+	}
+
+	void addTwice(sl_int32 x)
+	{
+		count += x * 2;
+	}
+
+};
+
+static void testWrappers()
+{
+	SLIB_TEST_SECTION("move-only captures, Function and the class binders")
+
+	{
+		Callback f(MoveOnlyCallable(7));
+		SLIB_TEST_CHECK(f(3) == 21)
+		Callback g(Move(f));
+		SLIB_TEST_CHECK(g(2) == 14)
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+	}
+	SLIB_TEST_CHECK(g_countLiveCaptures == 0)
+
+	{
+		Function<sl_int32(sl_int32)> func = SmallCallable(100);
+		Callback f(func);
+		func.setNull();
+		// the callable of `Function` is kept alive by the reference
+		SLIB_TEST_CHECK(g_countLiveCaptures == 1)
+		SLIB_TEST_CHECK(f(1) == 101)
+		f.setNull();
+		SLIB_TEST_CHECK(g_countLiveCaptures == 0)
+	}
+
+	Ref<Counter> counter = new Counter;
+	Callback f = Callback::fromRef(counter, &Counter::add);
+	SLIB_TEST_CHECK(f(2) == 2 && counter->count == 2)
+	Callback g = Callback::fromClass(counter.get(), &Counter::add);
+	SLIB_TEST_CHECK(g(3) == 5)
+	Callback w = Callback::fromWeakRef(WeakRef<Counter>(counter), &Counter::add);
+	SLIB_TEST_CHECK(w(1) == 6)
+	InlineFunction<void()> b = InlineFunction<void()>::bindRef(counter, &Counter::addTwice, 2);
+	b();
+	SLIB_TEST_CHECK(counter->count == 10)
+	InlineFunction<void()> bw = InlineFunction<void()>::bindWeakRef(WeakRef<Counter>(counter), &Counter::addTwice, 1);
+	bw();
+	SLIB_TEST_CHECK(counter->count == 12)
+	// the weak binder returns the default value after the object is released
+	f.setNull();
+	b.setNull();
+	counter.setNull();
+	SLIB_TEST_CHECK(w(1) == 0)
+	bw();
+}
+
+int main(int argc, const char* argv[])
+{
+	testStorage();
+	testWrappers();
+	printf("OK\n");
+	return 0;
+}
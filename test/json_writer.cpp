@@ -0,0 +1,411 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/json_writer.h"
+#include "slib/core/json.h"
+#include "slib/core/io.h"
+#include "slib/core/string.h"
+#include "slib/core/time.h"
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace slib;
+
+/*
+	Validates JsonWriter: the shortest doubles and floats are parsed back to the same bits,
+	the integers and the escaped strings match the reference formatting, the `Variant` trees of every type
+	are read back by the JSON parser as the trees written by `Variant::toJsonString()`,
+	the nesting errors are reported, and the chunked output equals the memory output.
+*/
+
+static sl_uint64 g_random = 0x9E3779B97F4A7C15;
+
+static sl_uint64 getRandom()
+{
+	sl_uint64 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	g_random = x;
+	return x;
+}
+
+static String writeDouble(double value)
+{
+	JsonWriter writer;
+	writer.open();
+	SLIB_TEST_CHECK(writer.writeDouble(value))
+	return writer.getOutputString();
+}
+
+static String writeFloat(float value)
+{
+	JsonWriter writer;
+	writer.open();
+	SLIB_TEST_CHECK(writer.writeFloat(value))
+	return writer.getOutputString();
+}
+
+// a decimal point or an exponent, so that the value is not read back as an integer
+static sl_bool isFloatingText(const String& s)
+{
+	return s.indexOf('.') >= 0 || s.indexOf('e') >= 0 || s.indexOf('E') >= 0;
+}
+
+static void testDoubles()
+{
+	SLIB_TEST_SECTION("doubles and floats are parsed back to the same bits")
+
+	static const char* fixed[][2] = {
+		{"0", "0.0"}, {"1", "1.0"}, {"-2.5", "-2.5"}, {"0.1", "0.1"}, {"100", "100.0"}, {"123456.789", "123456.789"}
+	};
+	for (sl_size i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+		SLIB_TEST_CHECK(writeDouble(strtod(fixed[i][0], sl_null)) == fixed[i][1])
+	}
+	SLIB_TEST_CHECK(writeDouble(0.0 / 0.0) == "null")
+	SLIB_TEST_CHECK(writeDouble(1.0 / 0.0) == "null")
+	SLIB_TEST_CHECK(writeDouble(-1.0 / 0.0) == "null")
+	SLIB_TEST_CHECK(writeFloat(0.1f) == "0.1")
+
+	static const double specials[] = {-0.0, 5e-324, 2.2250738585072009e-308, 2.2250738585072014e-308, 1.7976931348623157e308, 1e21, 1e22, 1e-7, 9007199254740993.0, 0.3};
+	for (sl_size i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+		String s = writeDouble(specials[i]);
+		double d = strtod(s.getData(), sl_null);
+		SLIB_TEST_CHECK(Base::equalsMemory(&d, &(specials[i]), sizeof(double)))
+		SLIB_TEST_CHECK(isFloatingText(s))
+	}
+
+	sl_uint32 nDoubles = 0;
+	for (sl_uint32 i = 0; i < 200000; i++) {
+		sl_uint64 bits = getRandom();
+		if (i & 1) {
+			// values of usual magnitudes
+			bits = (bits & 0x800FFFFFFFFFFFFF) | ((sl_uint64)(1023 - 40 + (bits >> 52) % 80) << 52);
+		}
+		double value;
+		Base::copyMemory(&value, &bits, sizeof(double));
+		if (value != value || value - value != 0) {
+			continue;
+		}
+		String s = writeDouble(value);
+		double d = strtod(s.getData(), sl_null);
+		SLIB_TEST_CHECK(Base::equalsMemory(&d, &value, sizeof(double)))
+		SLIB_TEST_CHECK(isFloatingText(s))
+		SLIB_TEST_CHECK(s.getLength() <= 25)
+		nDoubles++;
+	}
+	sl_uint32 nFloats = 0;
+	for (sl_uint32 i = 0; i < 100000; i++) {
+		sl_uint32 bits = (sl_uint32)(getRandom());
+		float value;
+		Base::copyMemory(&value, &bits, sizeof(float));
+		if (value != value || value - value != 0) {
+			continue;
+		}
+		String s = writeFloat(value);
+		float f = strtof(s.getData(), sl_null);
+		SLIB_TEST_CHECK(Base::equalsMemory(&f, &value, sizeof(float)))
+		SLIB_TEST_CHECK(isFloatingText(s))
+		nFloats++;
+	}
+	printf("  %u doubles, %u floats\n", nDoubles, nFloats);
+}
+
+static void testIntegers()
+{
+	SLIB_TEST_SECTION("integers match the reference formatting")
+
+	static const sl_int64 values[] = {0, 1, -1, 9, 10, 99, 100, -100, 2147483647, -2147483647 - 1, 4294967295LL, 9223372036854775807LL, -9223372036854775807LL - 1};
+	for (sl_size i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.writeInt64(values[i]))
+		SLIB_TEST_CHECK(writer.getOutputString() == String::format("%d", values[i]))
+	}
+	for (sl_uint32 i = 0; i < 10000; i++) {
+		sl_uint64 v = getRandom() >> (getRandom() % 64);
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.writeUint64(v))
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v);
+		SLIB_TEST_CHECK(writer.getOutputString() == buf)
+		writer.open();
+		SLIB_TEST_CHECK(writer.writeInt32((sl_int32)v))
+		snprintf(buf, sizeof(buf), "%d", (int)(sl_int32)v);
+		SLIB_TEST_CHECK(writer.getOutputString() == buf)
+	}
+	JsonWriter writer;
+	writer.open();
+	SLIB_TEST_CHECK(writer.writeUint64(18446744073709551615ULL))
+	SLIB_TEST_CHECK(writer.getOutputString() == "18446744073709551615")
+}
+
+static String escapeReference(const String& s)
+{
+	String ret = "\"";
+	for (sl_size i = 0; i < s.getLength(); i++) {
+		sl_uint8 ch = (sl_uint8)(s.getData()[i]);
+		switch (ch) {
+			case '"':
+				ret += "\\\"";
+				break;
+			case '\\':
+				ret += "\\\\";
+				break;
+			case '\b':
+				ret += "\\b";
+				break;
+			case '\f':
+				ret += "\\f";
+				break;
+			case '\n':
+				ret += "\\n";
+				break;
+			case '\r':
+				ret += "\\r";
+				break;
+			case '\t':
+				ret += "\\t";
+				break;
+			default:
+				if (ch < 0x20) {
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", ch);
+					ret += buf;
+				} else {
+					ret += String((sl_char8*)&ch, 1);
+				}
+				break;
+		}
+	}
+	ret += "\"";
+	return ret;
+}
+
+static void testStrings()
+{
+	SLIB_TEST_SECTION("strings are escaped")
+
+	static const char* cases[][2] = {
+		{"", "\"\""},
+		{"abc", "\"abc\""},
+		{"\"\\/\b\f\n\r\t", "\"\\\"\\\\/\\b\\f\\n\\r\\t\""},
+		{"\x01\x1f\x7f", "\"\\u0001\\u001f\x7f\""},
+		{"\xea\xb0\x80\xf0\x9f\x98\x80", "\"\xea\xb0\x80\xf0\x9f\x98\x80\""}
+	};
+	for (sl_size i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.writeString(cases[i][0]))
+		SLIB_TEST_CHECK(writer.getOutputString() == cases[i][1])
+	}
+
+	// the special characters at every offset of the 16-byte scan
+	for (sl_uint32 len = 1; len < 70; len++) {
+		for (sl_uint32 pos = 0; pos < len; pos++) {
+			static const char specials[] = {'"', '\\', '\n', '\x01', '\x1f', '\x7f', '/'};
+			char ch = specials[(len + pos) % sizeof(specials)];
+			String s = String::allocate(len);
+			char* p = s.getData();
+			for (sl_uint32 k = 0; k < len; k++) {
+				p[k] = (char)('a' + k % 26);
+			}
+			p[pos] = ch;
+			JsonWriter writer;
+			writer.open();
+			SLIB_TEST_CHECK(writer.writeString(s))
+			SLIB_TEST_CHECK(writer.getOutputString() == escapeReference(s))
+		}
+	}
+
+	// UTF-16 with a surrogate pair is transcoded while escaping
+	sl_char16 sz16[] = {'a', '"', 0xAC00, 0xD83D, 0xDE00, '\n', 0};
+	JsonWriter writer;
+	writer.open();
+	SLIB_TEST_CHECK(writer.writeString(String16(sz16)))
+	SLIB_TEST_CHECK(writer.getOutputString() == "\"a\\\"\xea\xb0\x80\xf0\x9f\x98\x80\\n\"")
+}
+
+static Variant createTree()
+{
+	// the strings are referenced by the `Sz16` variant, and kept in the BMP so that `toJsonString()` writes them as they are
+	static const sl_char16 sz16[] = {'u', 't', 'f', 0xAC00, 0x00E9, 0};
+	Map<String, Variant> map;
+	map.put("null", Variant());
+	map.put("int32", (sl_int32)-123456);
+	map.put("uint32", (sl_uint32)4000000000U);
+	map.put("int64", (sl_int64)-9000000000000000000LL);
+	map.put("uint64", (sl_uint64)9000000000000000001ULL);
+	map.put("float", 1.5f);
+	map.put("double", -0.25);
+	map.put("true", sl_true);
+	map.put("false", sl_false);
+	map.put("string", String("text \"quoted\"\n\\"));
+	map.put("string16", String16(sz16));
+	map.put("sz8", Variant::fromSz8("sz8"));
+	map.put("sz16", Variant::fromSz16(sz16));
+	map.put("time", Time(2017, 3, 4, 5, 6, 7));
+	map.put("empty string", String::getEmpty());
+
+	List<Variant> list;
+	list.add(1);
+	list.add("two");
+	list.add(Variant());
+	list.add(List<Variant>());
+	list.add(Map<String, Variant>());
+	map.put("list", list);
+
+	Map<String, Variant> child;
+	child.put("key with \"quotes\"", 1);
+	child.put("nested", list);
+	map.put("map", child);
+
+	List< Map<String, Variant> > mapList;
+	mapList.add(child);
+	mapList.add(Map<String, Variant>());
+	map.put("map list", mapList);
+
+	return map;
+}
+
+static void testVariants()
+{
+	SLIB_TEST_SECTION("Variant trees of every type are read back as Variant::toJsonString()")
+
+	Variant tree = createTree();
+	String json = JsonWriter::serializeToString(tree);
+	Json parsed = Json::parseJson(json);
+	SLIB_TEST_CHECK(parsed.isNotNull())
+	Json expected = Json::parseJson(tree.toJsonString());
+	SLIB_TEST_CHECK(expected.isNotNull())
+	SLIB_TEST_CHECK(parsed.toJsonString() == expected.toJsonString())
+	SLIB_TEST_CHECK(parsed.getItem("uint64").getUint64() == 9000000000000000001ULL)
+	SLIB_TEST_CHECK(parsed.getItem("int64").getInt64() == -9000000000000000000LL)
+
+	// the output of the writer is stable through a parse
+	SLIB_TEST_CHECK(JsonWriter::serializeToString(parsed) == json)
+
+	Memory mem = JsonWriter::serialize(tree);
+	SLIB_TEST_CHECK(mem.getSize() == json.getLength() && Base::equalsMemory(mem.getData(), json.getData(), mem.getSize()))
+
+	// a reference to an object which is not a container is written as null
+	SLIB_TEST_CHECK(JsonWriter::serializeToString(Variant(Ref<Referable>(new Referable))) == "null")
+}
+
+static void testNesting()
+{
+	SLIB_TEST_SECTION("nesting errors are reported")
+
+	{
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.beginObject())
+		SLIB_TEST_CHECK(!(writer.writeInt32(1)))
+		SLIB_TEST_CHECK(writer.isError())
+		SLIB_TEST_CHECK(!(writer.endObject()))
+	}
+	{
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.beginArray())
+		SLIB_TEST_CHECK(!(writer.endObject()))
+		SLIB_TEST_CHECK(writer.isError())
+	}
+	{
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.beginArray())
+		SLIB_TEST_CHECK(!(writer.writeKey("key")))
+		SLIB_TEST_CHECK(writer.isError())
+	}
+	{
+		JsonWriter writer;
+		writer.open();
+		SLIB_TEST_CHECK(writer.beginObject())
+		SLIB_TEST_CHECK(writer.writeKey("a"))
+		SLIB_TEST_CHECK(writer.beginArray())
+		SLIB_TEST_CHECK(writer.getDepth() == 2)
+		SLIB_TEST_CHECK(writer.writeNull())
+		SLIB_TEST_CHECK(writer.writeBoolean(sl_true))
+		SLIB_TEST_CHECK(writer.writeRawValue("{\"x\":1}", 7))
+		SLIB_TEST_CHECK(writer.endArray())
+		SLIB_TEST_CHECK(writer.writeKey("b"))
+		SLIB_TEST_CHECK(writer.writeString("c"))
+		SLIB_TEST_CHECK(writer.endObject())
+		SLIB_TEST_CHECK(writer.getDepth() == 0 && !(writer.isError()))
+		// top-level values are separated by new lines
+		SLIB_TEST_CHECK(writer.writeInt32(2))
+		SLIB_TEST_CHECK(writer.getOutputString() == "{\"a\":[null,true,{\"x\":1}],\"b\":\"c\"}\n2")
+	}
+}
+
+static void testChunks()
+{
+	SLIB_TEST_SECTION("the chunked and streamed outputs equal the memory output")
+
+	List<Variant> list;
+	for (sl_uint32 i = 0; i < 20000; i++) {
+		Map<String, Variant> item;
+		item.put("id", i);
+		item.put("name", String::format("item \"%d\"", i));
+		item.put("value", (double)i / 7);
+		list.add(item);
+	}
+	Variant tree(list);
+
+	JsonWriter writer;
+	writer.open();
+	SLIB_TEST_CHECK(writer.writeValue(tree))
+	Memory output = writer.getOutput();
+	SLIB_TEST_CHECK(output.getSize() == writer.getOutputLength())
+	SLIB_TEST_CHECK(output.getSize() > SLIB_JSON_WRITER_DEFAULT_CHUNK_SIZE * 2)
+
+	// without copying
+	List<Memory> chunks = writer.getOutputChunks();
+	SLIB_TEST_CHECK(chunks.getCount() > 1)
+	sl_size pos = 0;
+	ListElements<Memory> elements(chunks);
+	for (sl_size i = 0; i < elements.count; i++) {
+		sl_size n = elements[i].getSize();
+		SLIB_TEST_CHECK(pos + n <= output.getSize())
+		SLIB_TEST_CHECK(Base::equalsMemory((sl_uint8*)(output.getData()) + pos, elements[i].getData(), n))
+		pos += n;
+	}
+	SLIB_TEST_CHECK(pos == output.getSize())
+
+	static const sl_size chunkSizes[] = {16, 1000, 65536};
+	for (sl_size i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++) {
+		Ref<MemoryWriter> stream = new MemoryWriter;
+		JsonWriter w;
+		w.open(stream, chunkSizes[i]);
+		SLIB_TEST_CHECK(w.writeValue(tree))
+		SLIB_TEST_CHECK(w.close())
+		Memory data = stream->getData();
+		SLIB_TEST_CHECK(data.getSize() == output.getSize())
+		SLIB_TEST_CHECK(Base::equalsMemory(data.getData(), output.getData(), data.getSize()))
+	}
+	SLIB_TEST_CHECK(Json::parseJsonUtf8(output).getElementsCount() == 20000)
+}
+
+int main(int argc, const char* argv[])
+{
+	testDoubles();
+	testIntegers();
+	testStrings();
+	testVariants();
+	testNesting();
+	testChunks();
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/mpsc_queue.h"
+#include "slib/core/inline_function.h"
+#include "slib/core/ref.h"
+#include "slib/core/system.h"
+
+#include "test.h"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+
+using namespace slib;
+
+/*
+	Validates MpscQueue with concurrent producers: every pushed value is popped exactly once,
+	in the order of each producer, and the recycled nodes destroy their values.
+	Also prints the throughput of the push/pop pair.
+*/
+
+#define PRODUCERS 4
+#define ITEMS_PER_PRODUCER 200000
+
+static std::atomic<sl_int32> g_countLiveObjects(0);
+
+class TrackedObject : public Referable
+{
+public:
+	sl_uint32 producer;
+	sl_uint32 sequence;
+
+public:
+	TrackedObject(sl_uint32 _producer, sl_uint32 _sequence): producer(_producer), sequence(_sequence)
+	{
+		g_countLiveObjects++;
+	}
+
+	~TrackedObject()
+	{
+		g_countLiveObjects--;
+	}
+
+};
+
+static void testProducers()
+{
+	SLIB_TEST_SECTION("values from concurrent producers are popped once, in the order of each producer")
+
+	MpscQueue< Ref<TrackedObject> > queue;
+	std::vector<std::thread> producers;
+	sl_uint32 timeStart = System::getTickCount();
+	for (sl_uint32 p = 0; p < PRODUCERS; p++) {
+		producers.emplace_back([&queue, p]() {
+			for (sl_uint32 i = 0; i < ITEMS_PER_PRODUCER; i++) {
+				SLIB_TEST_CHECK(queue.push(new TrackedObject(p, i)))
+			}
+		});
+	}
+	sl_uint32 nextSequences[PRODUCERS] = {0};
+	sl_uint64 countPopped = 0;
+	Ref<TrackedObject> object;
+	while (countPopped < (sl_uint64)PRODUCERS * ITEMS_PER_PRODUCER) {
+		if (queue.pop(&object)) {
+			SLIB_TEST_CHECK(object.isNotNull() && object->producer < PRODUCERS)
+			SLIB_TEST_CHECK(object->sequence == nextSequences[object->producer])
+			nextSequences[object->producer]++;
+			countPopped++;
+			object.setNull();
+		}
+	}
+	for (sl_uint32 p = 0; p < PRODUCERS; p++) {
+		producers[p].join();
+	}
+	sl_uint32 elapsed = System::getTickCount() - timeStart;
+	SLIB_TEST_CHECK(!(queue.pop()))
+	SLIB_TEST_CHECK(queue.isEmpty())
+	SLIB_TEST_CHECK(g_countLiveObjects == 0)
+	printf("  %u producers, %u items: %u ms\n", (sl_uint32)PRODUCERS, (sl_uint32)(PRODUCERS * ITEMS_PER_PRODUCER), elapsed);
+}
+
+static void testRecycledNodes()
+{
+	SLIB_TEST_SECTION("recycled nodes hold move-only callables")
+
+	MpscQueue< InlineFunction<void()> > queue;
+	sl_uint32 count = 0;
+	for (sl_uint32 i = 0; i < 1000; i++) {
+		SLIB_TEST_CHECK(queue.push([&count]() { count++; }))
+		InlineFunction<void()> task;
+		SLIB_TEST_CHECK(queue.pop(&task))
+		SLIB_TEST_CHECK(task.isNotNull())
+		task();
+	}
+	SLIB_TEST_CHECK(count == 1000)
+	SLIB_TEST_CHECK(!(queue.pop()))
+}
+
+static void testRemoveAll()
+{
+	SLIB_TEST_SECTION("removeAll() and the destructor release the pending values")
+
+	{
+		MpscQueue< Ref<TrackedObject> > queue;
+		for (sl_uint32 i = 0; i < 1000; i++) {
+			SLIB_TEST_CHECK(queue.push(new TrackedObject(0, i)))
+		}
+		// keep some nodes on the free list
+		for (sl_uint32 i = 0; i < 500; i++) {
+			SLIB_TEST_CHECK(queue.pop())
+		}
+		SLIB_TEST_CHECK(g_countLiveObjects == 500)
+		SLIB_TEST_CHECK(queue.removeAll() == 500)
+		SLIB_TEST_CHECK(g_countLiveObjects == 0)
+		SLIB_TEST_CHECK(queue.isEmpty())
+		for (sl_uint32 i = 0; i < 100; i++) {
+			SLIB_TEST_CHECK(queue.push(new TrackedObject(0, i)))
+		}
+		SLIB_TEST_CHECK(g_countLiveObjects == 100)
+	}
+	SLIB_TEST_CHECK(g_countLiveObjects == 0)
+}
+
+int main(int argc, const char* argv[])
+{
+	testProducers();
+	testRecycledNodes();
+	testRemoveAll();
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,31 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CHECKHEADER_SLIB_TEST_TEST
+#define CHECKHEADER_SLIB_TEST_TEST
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+	Shared by the validation programs in this directory.
+	Each program is registered as a CTest test: it exits with a non-zero code on the first failed check.
+*/
+
+#define SLIB_TEST_CHECK(EXPR) \
+	if (!(EXPR)) { \
+		fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #EXPR); \
+		exit(1); \
+	}
+
+#define SLIB_TEST_SECTION(NAME) \
+	printf("- %s\n", NAME);
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ *  Copyright (c) 2008-2017 SLIBIO. All Rights Reserved.
+ *
+ *  This file is part of the SLib.io project.
+ *
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "slib/core/timer_wheel.h"
+
+#include "test.h"
+
+#include <map>
+#include <set>
+
+using namespace slib;
+
+/*
+	Validates the cascading and the timeout of TimerWheel against a sorted reference set:
+	every entry must expire at the first `advance()` reaching its time, never earlier,
+	and `getTimeout()` must never be later than the earliest deadline.
+	The reference is a sorted set of the due times.
+*/
+
+static sl_uint32 g_random = 0x2545F491;
+
+static sl_uint32 getRandom()
+{
+	sl_uint32 x = g_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_random = x;
+	return x;
+}
+
+// delays spread over all levels: 64^n ms for n = 1 ~ 5
+static sl_uint64 getRandomDelay()
+{
+	sl_uint32 level = getRandom() % 5;
+	sl_uint64 range = (sl_uint64)1 << (6 * (level + 1));
+	return (((sl_uint64)(getRandom()) << 32) | getRandom()) % range;
+}
+
+/*
+	Due times of the scheduled entries.
+	An entry added for a tick which is already processed (before `getCurrentTime()`) is due at `getCurrentTime()`.
+*/
+class Reference
+{
+public:
+	std::set< std::pair<sl_uint64, TimerWheelEntry*> > entries;
+	std::map<TimerWheelEntry*, sl_uint64> dues;
+
+public:
+	void add(TimerWheel& wheel, TimerWheelEntry* entry)
+	{
+		sl_uint64 due = entry->getTime();
+		if (due < wheel.getCurrentTime()) {
+			due = wheel.getCurrentTime();
+		}
+		entries.insert(std::make_pair(due, entry));
+		dues[entry] = due;
+	}
+
+	// returns the due time
+	sl_uint64 remove(TimerWheelEntry* entry)
+	{
+		std::map<TimerWheelEntry*, sl_uint64>::iterator it = dues.find(entry);
+		SLIB_TEST_CHECK(it != dues.end())
+		sl_uint64 due = it->second;
+		SLIB_TEST_CHECK(entries.erase(std::make_pair(due, entry)) == 1)
+		dues.erase(it);
+		return due;
+	}
+
+	sl_bool isEmpty()
+	{
+		return entries.empty();
+	}
+
+	sl_size getCount()
+	{
+		return entries.size();
+	}
+
+	sl_uint64 getFirstDue()
+	{
+		return entries.begin()->first;
+	}
+
+};
+
+static void advance(TimerWheel& wheel, Reference& ref, sl_uint64 now, sl_uint32& countFired)
+{
+	List< Ref<TimerWheelEntry> > expired;
+	wheel.advance(now, expired);
+	ListElements< Ref<TimerWheelEntry> > items(expired);
+	sl_uint64 dueLast = 0;
+	for (sl_size i = 0; i < items.count; i++) {
+		TimerWheelEntry* entry = items[i].get();
+		SLIB_TEST_CHECK(!(entry->isScheduled()))
+		sl_uint64 due = ref.remove(entry);
+		SLIB_TEST_CHECK(due <= now)
+		SLIB_TEST_CHECK(due >= dueLast)
+		dueLast = due;
+		entry->getTask()();
+	}
+	// nothing due is left behind
+	SLIB_TEST_CHECK(ref.isEmpty() || ref.getFirstDue() > now)
+	SLIB_TEST_CHECK(wheel.getCount() == ref.getCount())
+	countFired += (sl_uint32)(items.count);
+}
+
+int main(int argc, const char * argv[])
+{
+	SLIB_TEST_SECTION("entries over all levels expire in order, exactly when they are due")
+	{
+		TimerWheel wheel(1000);
+		Reference ref;
+		List< Ref<TimerWheelEntry> > entries;
+		sl_uint32 countCalled = 0;
+		sl_uint32 countFired = 0;
+		sl_uint64 now = 1000;
+		for (sl_uint32 step = 0; step < 20000; step++) {
+			sl_uint32 op = getRandom() % 8;
+			if (op < 4) {
+				sl_uint64 time = now + getRandomDelay();
+				Ref<TimerWheelEntry> entry = wheel.add(time, [&countCalled]() {
+					countCalled++;
+				});
+				SLIB_TEST_CHECK(entry.isNotNull() && entry->isScheduled() && entry->getTime() == time)
+				ref.add(wheel, entry.get());
+				entries.add_NoLock(entry);
+			} else if (op == 4 && !(ref.isEmpty())) {
+				// removes or moves a scheduled entry
+				Ref<TimerWheelEntry> entry = entries.getValueAt_NoLock(getRandom() % entries.getCount());
+				if (entry->isScheduled()) {
+					ref.remove(entry.get());
+					if (getRandom() % 2) {
+						SLIB_TEST_CHECK(wheel.remove(entry.get()))
+						SLIB_TEST_CHECK(!(entry->isScheduled()))
+						SLIB_TEST_CHECK(!(wheel.remove(entry.get())))
+					} else {
+						sl_uint64 time = now + getRandomDelay();
+						SLIB_TEST_CHECK(wheel.add(entry.get(), time))
+						ref.add(wheel, entry.get());
+					}
+				}
+			} else {
+				// the timeout is never later than the earliest deadline
+				sl_int64 timeout = wheel.getTimeout(now);
+				if (ref.isEmpty()) {
+					SLIB_TEST_CHECK(timeout < 0)
+				} else {
+					SLIB_TEST_CHECK(timeout >= 0)
+					SLIB_TEST_CHECK(now + (sl_uint64)timeout <= ref.getFirstDue())
+				}
+				sl_uint64 delta;
+				switch (getRandom() % 4) {
+					case 0:
+						delta = getRandom() % 4;
+						break;
+					case 1:
+						delta = getRandom() % 300;
+						break;
+					case 2:
+						// jumps to the timeout, cascading the upper levels
+						delta = timeout > 0 ? (sl_uint64)timeout : 1;
+						break;
+					default:
+						delta = getRandomDelay();
+						break;
+				}
+				now += delta;
+				advance(wheel, ref, now, countFired);
+			}
+		}
+		// drains by following the timeouts
+		while (!(ref.isEmpty())) {
+			sl_int64 timeout = wheel.getTimeout(now);
+			SLIB_TEST_CHECK(timeout >= 0 && now + (sl_uint64)timeout <= ref.getFirstDue())
+			now += timeout > 0 ? timeout : 1;
+			advance(wheel, ref, now, countFired);
+		}
+		SLIB_TEST_CHECK(wheel.getCount() == 0)
+		SLIB_TEST_CHECK(wheel.getTimeout(now) < 0)
+		SLIB_TEST_CHECK(countCalled == countFired)
+	}
+
+	SLIB_TEST_SECTION("entries in the past expire on the next advance")
+	{
+		TimerWheel wheel(5000);
+		Reference ref;
+		sl_uint32 countFired = 0;
+		Ref<TimerWheelEntry> entry = wheel.add(10, []() {});
+		ref.add(wheel, entry.get());
+		SLIB_TEST_CHECK(wheel.getTimeout(5000) == 0)
+		advance(wheel, ref, 5000, countFired);
+		SLIB_TEST_CHECK(countFired == 1)
+	}
+
+	SLIB_TEST_SECTION("a far jump cascades every level")
+	{
+		TimerWheel wheel(0);
+		Reference ref;
+		sl_uint32 countFired = 0;
+		for (sl_uint32 level = 0; level < 5; level++) {
+			sl_uint64 time = ((sl_uint64)1 << (6 * (level + 1))) - 1;
+			Ref<TimerWheelEntry> entry = wheel.add(time, []() {});
+			ref.add(wheel, entry.get());
+		}
+		advance(wheel, ref, ((sl_uint64)1 << 30) - 2, countFired);
+		SLIB_TEST_CHECK(countFired == 4 && ref.getCount() == 1)
+		advance(wheel, ref, (sl_uint64)1 << 30, countFired);
+		SLIB_TEST_CHECK(countFired == 5 && ref.isEmpty())
+	}
+
+	SLIB_TEST_SECTION("removeAll() unschedules the entries")
+	{
+		TimerWheel wheel(0);
+		Ref<TimerWheelEntry> entry1 = wheel.add(100, []() {});
+		Ref<TimerWheelEntry> entry2 = wheel.add(100000, []() {});
+		wheel.removeAll();
+		SLIB_TEST_CHECK(wheel.getCount() == 0)
+		SLIB_TEST_CHECK(!(entry1->isScheduled()) && !(entry2->isScheduled()))
+		SLIB_TEST_CHECK(wheel.add(entry1.get(), 50))
+		SLIB_TEST_CHECK(wheel.getCount() == 1)
+	}
+
+	printf("OK\n");
+	return 0;
+}